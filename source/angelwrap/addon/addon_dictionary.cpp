@@ -2,14 +2,31 @@
 #include "addon_dictionary.h"
 #include "addon_scriptarray.h"
 #include "addon_string.h"
+#include <map>
 
 BEGIN_AS_NAMESPACE
 
 using namespace std;
 
+#define DICT_MIN_ENTRIES	8
+#define DICT_MAX_ENTRIES	( 1u << 24 )	// keeps the table size and allocation sizes from overflowing
+
 //--------------------------------------------------------------------------
 // CScriptDictionary implementation
 
+// FNV-1a over the key characters, lookups hash the script string in place
+static unsigned int ScriptDictionary_HashKey(const asstring_t &key)
+{
+	unsigned int hash = 2166136261u;
+
+	for( asUINT i = 0; i < key.len; i++ )
+	{
+		hash ^= (unsigned char)key.buffer[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
 CScriptDictionary::CScriptDictionary(asIScriptEngine *engine)
 {
 	Initialize(engine);
@@ -25,6 +42,12 @@ CScriptDictionary::CScriptDictionary(asBYTE *buffer)
 	// so we can get the engine from the active context
 	asIScriptContext *ctx = asGetActiveContext();
 	engine = ctx->GetEngine();
+	stringTypeId = engine->GetTypeIdByDecl("String");
+
+	entries = NULL;
+	numEntries = numDeleted = maxEntries = 0;
+	table = NULL;
+	tableSize = 0;
 
 	// Notify the garbage collector of this object
 	// TODO: The type id should be cached
@@ -126,6 +149,12 @@ void CScriptDictionary::Initialize(asIScriptEngine *engine)
 	// We don't increment the reference counter, because the 
 	// engine will hold a pointer to the object. 
 	this->engine = engine;
+	stringTypeId = engine->GetTypeIdByDecl("String");
+
+	entries = NULL;
+	numEntries = numDeleted = maxEntries = 0;
+	table = NULL;
+	tableSize = 0;
 
 	// Notify the garbage collector of this object
 	// TODO: The type id should be cached
@@ -136,6 +165,11 @@ CScriptDictionary::~CScriptDictionary()
 {
 	// Delete all keys and values
 	DeleteAll();
+
+	if( entries )
+		QAS_DELETEARRAY(entries);
+	if( table )
+		QAS_DELETEARRAY(table);
 }
 
 void CScriptDictionary::AddRef() const
@@ -171,11 +205,10 @@ bool CScriptDictionary::GetGCFlag()
 void CScriptDictionary::EnumReferences(asIScriptEngine *engine)
 {
 	// Call the gc enum callback for each of the objects
-	map<std::string, valueStruct>::iterator it;
-	for( it = dict.begin(); it != dict.end(); it++ )
+	for( asUINT i = 0; i < numEntries; i++ )
 	{
-		if( it->second.typeId & asTYPEID_MASK_OBJECT )
-			engine->GCEnumCallback(it->second.valueObj);
+		if( entries[i].key && (entries[i].value.typeId & asTYPEID_MASK_OBJECT) )
+			engine->GCEnumCallback(entries[i].value.valueObj);
 	}
 }
 
@@ -192,21 +225,175 @@ CScriptDictionary &CScriptDictionary::operator =(const CScriptDictionary &other)
 	DeleteAll();
 
 	// Do a shallow copy of the dictionary
-	map<std::string, valueStruct>::const_iterator it;
-	for( it = other.dict.begin(); it != other.dict.end(); it++ )
+	Reserve(other.GetSize());
+	for( asUINT i = 0; i < other.numEntries; i++ )
 	{
-		if( it->second.typeId & asTYPEID_OBJHANDLE )
-			Set_(it->first.c_str(), (void*)&it->second.valueObj, it->second.typeId);
-		else if( it->second.typeId & asTYPEID_MASK_OBJECT )
-			Set_(it->first.c_str(), (void*)it->second.valueObj, it->second.typeId);
+		const entryStruct &e = other.entries[i];
+		if( !e.key )
+			continue;
+
+		if( e.value.typeId & asTYPEID_OBJHANDLE )
+			Set_(*e.key, (void*)&e.value.valueObj, e.value.typeId);
+		else if( e.value.typeId & asTYPEID_MASK_OBJECT )
+			Set_(*e.key, (void*)e.value.valueObj, e.value.typeId);
 		else
-			Set_(it->first.c_str(), (void*)&it->second.valueInt, it->second.typeId);
+			Set_(*e.key, (void*)&e.value.valueInt, e.value.typeId);
 	}
 
 	return *this;
 }
 
-void CScriptDictionary::Set_(const char *key, void *value, int typeId)
+// Returns the hash table slot holding the key, or -1
+int CScriptDictionary::FindSlot(const asstring_t &key, unsigned int hash) const
+{
+	if( !tableSize )
+		return -1;
+
+	asUINT mask = tableSize - 1;
+	for( asUINT slot = hash & mask; table[slot] >= 0; slot = (slot + 1) & mask )
+	{
+		const entryStruct &e = entries[table[slot]];
+		if( e.hash == hash && e.key->len == key.len && !memcmp(e.key->buffer, key.buffer, key.len) )
+			return (int)slot;
+	}
+
+	return -1;
+}
+
+// Rebuilds the hash table for the given capacity, dropping deleted entries
+void CScriptDictionary::Rehash(asUINT newMaxEntries)
+{
+	asUINT i, n, slot, mask;
+	entryStruct *newEntries;
+
+	if( newMaxEntries < DICT_MIN_ENTRIES )
+		newMaxEntries = DICT_MIN_ENTRIES;
+	if( newMaxEntries > DICT_MAX_ENTRIES )
+		newMaxEntries = DICT_MAX_ENTRIES;
+	if( newMaxEntries < numEntries - numDeleted )
+		newMaxEntries = numEntries - numDeleted;
+
+	newEntries = QAS_NEWARRAY(entryStruct, newMaxEntries);
+	for( i = 0, n = 0; i < numEntries; i++ )
+	{
+		if( entries[i].key )
+			newEntries[n++] = entries[i];
+	}
+	if( entries )
+		QAS_DELETEARRAY(entries);
+	entries = newEntries;
+	numEntries = n;
+	numDeleted = 0;
+	maxEntries = newMaxEntries;
+
+	// keep the load factor at or below one half
+	if( tableSize < maxEntries * 2 )
+	{
+		if( table )
+			QAS_DELETEARRAY(table);
+		for( tableSize = DICT_MIN_ENTRIES * 2; tableSize < maxEntries * 2; tableSize <<= 1 );
+		table = QAS_NEWARRAY(int, tableSize);
+	}
+
+	mask = tableSize - 1;
+	for( i = 0; i < tableSize; i++ )
+		table[i] = -1;
+	for( i = 0; i < numEntries; i++ )
+	{
+		for( slot = entries[i].hash & mask; table[slot] >= 0; slot = (slot + 1) & mask );
+		table[slot] = (int)i;
+	}
+}
+
+void CScriptDictionary::InsertEntry(const asstring_t &key, unsigned int hash, const valueStruct &value)
+{
+	asUINT slot, mask;
+
+	if( numEntries == maxEntries )
+	{
+		// reuse the room of deleted entries before growing
+		if( numDeleted > numEntries / 2 || maxEntries >= DICT_MAX_ENTRIES )
+			Rehash(maxEntries);
+		else
+			Rehash(maxEntries * 2);
+
+		if( numEntries == maxEntries )
+		{
+			asIScriptContext *ctx = asGetActiveContext();
+			if( ctx )
+				ctx->SetException("Too large dictionary size");
+
+			valueStruct dropped = value;
+			FreeValue(dropped);
+			return;
+		}
+	}
+
+	entryStruct &e = entries[numEntries];
+	e.key = objectString_FactoryBuffer(key.buffer, key.len);
+	e.hash = hash;
+	e.value = value;
+
+	mask = tableSize - 1;
+	for( slot = hash & mask; table[slot] >= 0; slot = (slot + 1) & mask );
+	table[slot] = (int)numEntries++;
+}
+
+// Removes the entry from the hash table, shifting back the following entries of
+// the probe sequence so that no tombstones are needed
+void CScriptDictionary::DeleteSlot(int slot)
+{
+	asUINT i, j, k, mask = tableSize - 1;
+	int index = table[slot];
+
+	FreeValue(entries[index].value);
+	objectString_Release(entries[index].key);
+	entries[index].key = NULL;
+
+	// deleting the newest entry doesn't leave a hole
+	if( (asUINT)index == numEntries - 1 )
+		numEntries--;
+	else
+		numDeleted++;
+	if( numEntries == numDeleted )
+		numEntries = numDeleted = 0;
+
+	i = j = (asUINT)slot;
+	table[i] = -1;
+	for( ;; )
+	{
+		j = (j + 1) & mask;
+		if( table[j] < 0 )
+			break;
+
+		// the entry can only move back if its home slot isn't cyclically in (i, j]
+		k = entries[table[j]].hash & mask;
+		if( i <= j ? (i < k && k <= j) : (i < k || k <= j) )
+			continue;
+
+		table[i] = table[j];
+		table[j] = -1;
+		i = j;
+	}
+}
+
+void CScriptDictionary::Reserve(asUINT count)
+{
+	if( count <= maxEntries )
+		return;
+
+	if( count > DICT_MAX_ENTRIES )
+	{
+		asIScriptContext *ctx = asGetActiveContext();
+		if( ctx )
+			ctx->SetException("Too large dictionary size");
+		return;
+	}
+
+	Rehash(count);
+}
+
+void CScriptDictionary::Set_(const asstring_t &key, void *value, int typeId)
 {
 	valueStruct valStruct = {{0},0};
 	valStruct.typeId = typeId;
@@ -229,29 +416,30 @@ void CScriptDictionary::Set_(const char *key, void *value, int typeId)
 		memcpy(&valStruct.valueInt, value, size);
 	}
 
-	map<std::string, valueStruct>::iterator it;
-	it = dict.find(key);
-	if( it != dict.end() )
+	unsigned int hash = ScriptDictionary_HashKey(key);
+	int slot = FindSlot(key, hash);
+	if( slot >= 0 )
 	{
-		FreeValue(it->second);
+		valueStruct &old = entries[table[slot]].value;
+		FreeValue(old);
 
 		// Insert the new value
-		it->second = valStruct;
+		old = valStruct;
 	}
 	else
 	{
-		dict.insert(map<std::string, valueStruct>::value_type(key, valStruct));
+		InsertEntry(key, hash, valStruct);
 	}
 }
 
 void CScriptDictionary::Set(const asstring_t &key, void *value, int typeId)
 {
-	Set_(key.buffer, value, typeId);
+	Set_(key, value, typeId);
 }
 
 void CScriptDictionary::Set(const asstring_t &key, asstring_t *value)
 {
-	return Set_(key.buffer, value, engine->GetTypeIdByDecl("String"));
+	return Set_(key, value, stringTypeId);
 }
 
 // This overloaded method is implemented so that all integer and
@@ -276,23 +464,24 @@ void CScriptDictionary::Set(const asstring_t &key, double &value)
 // Returns true if the value was successfully retrieved
 bool CScriptDictionary::Get(const asstring_t &key, void *value, int typeId) const
 {
-	map<std::string, valueStruct>::const_iterator it;
-	it = dict.find(key.buffer);
-	if( it != dict.end() )
+	int slot = FindSlot(key, ScriptDictionary_HashKey(key));
+	if( slot >= 0 )
 	{
+		const valueStruct &found = entries[table[slot]].value;
+
 		// Return the value
 		if( typeId & asTYPEID_OBJHANDLE )
 		{
 			// A handle can be retrieved if the stored type is a handle of same or compatible type
 			// or if the stored type is an object that implements the interface that the handle refer to.
-			if( (it->second.typeId & asTYPEID_MASK_OBJECT) )
+			if( (found.typeId & asTYPEID_MASK_OBJECT) )
 			{
 				// Don't allow the get if the stored handle is to a const, but the desired handle is not
-				if( (it->second.typeId & asTYPEID_HANDLETOCONST) && !(typeId & asTYPEID_HANDLETOCONST) )
+				if( (found.typeId & asTYPEID_HANDLETOCONST) && !(typeId & asTYPEID_HANDLETOCONST) )
 					return false;
 
 				// RefCastObject will increment the refcount if successful
-				engine->RefCastObject(it->second.valueObj, engine->GetTypeInfoById(it->second.typeId), engine->GetTypeInfoById(typeId), reinterpret_cast<void**>(value));
+				engine->RefCastObject(found.valueObj, engine->GetTypeInfoById(found.typeId), engine->GetTypeInfoById(typeId), reinterpret_cast<void**>(value));
 
 				return true;
 			}
@@ -301,35 +490,35 @@ bool CScriptDictionary::Get(const asstring_t &key, void *value, int typeId) cons
 		{
 			// Verify that the copy can be made
 			bool isCompatible = false;
-			if( it->second.typeId == typeId )
+			if( found.typeId == typeId )
 				isCompatible = true;
 
 			// Copy the object into the given reference
 			if( isCompatible )
 			{
-				engine->AssignScriptObject(value, it->second.valueObj, engine->GetTypeInfoById(typeId));
+				engine->AssignScriptObject(value, found.valueObj, engine->GetTypeInfoById(typeId));
 
 				return true;
 			}
 		}
 		else
 		{
-			if( it->second.typeId == typeId )
+			if( found.typeId == typeId )
 			{
 				int size = engine->GetSizeOfPrimitiveType(typeId);
-				memcpy(value, &it->second.valueInt, size);
+				memcpy(value, &found.valueInt, size);
 				return true;
 			}
 
 			// We know all numbers are stored as either int64 or double, since we register overloaded functions for those
-			if( it->second.typeId == asTYPEID_INT64 && typeId == asTYPEID_DOUBLE )
+			if( found.typeId == asTYPEID_INT64 && typeId == asTYPEID_DOUBLE )
 			{
-				*(double*)value = double(it->second.valueInt);
+				*(double*)value = double(found.valueInt);
 				return true;
 			}
-			else if( it->second.typeId == asTYPEID_DOUBLE && typeId == asTYPEID_INT64 )
+			else if( found.typeId == asTYPEID_DOUBLE && typeId == asTYPEID_INT64 )
 			{
-				*(asINT64*)value = asINT64(it->second.valueFlt);
+				*(asINT64*)value = asINT64(found.valueFlt);
 				return true;
 			}
 		}
@@ -354,22 +543,17 @@ bool CScriptDictionary::Get(const asstring_t &key, double &value) const
 
 bool CScriptDictionary::Get(const asstring_t &key, asstring_t *value) const
 {
-	return Get(key, value, engine->GetTypeIdByDecl("String"));
+	return Get(key, value, stringTypeId);
 }
 
 bool CScriptDictionary::Exists(const asstring_t &key) const
 {
-	map<std::string, valueStruct>::const_iterator it;
-	it = dict.find(key.buffer);
-	if( it != dict.end() )
-		return true;
-
-	return false;
+	return FindSlot(key, ScriptDictionary_HashKey(key)) >= 0;
 }
 
 bool CScriptDictionary::IsEmpty() const
 {
-	if( dict.size() == 0 )
+	if( numEntries == numDeleted )
 		return true;
 
 	return false;
@@ -377,27 +561,29 @@ bool CScriptDictionary::IsEmpty() const
 
 asUINT CScriptDictionary::GetSize() const
 {
-	return asUINT(dict.size());
+	return numEntries - numDeleted;
 }
 
 void CScriptDictionary::Delete(const asstring_t &key)
 {
-	map<std::string, valueStruct>::iterator it;
-	it = dict.find(key.buffer);
-	if( it != dict.end() )
-	{
-		FreeValue(it->second);
-		dict.erase(it);
-	}
+	int slot = FindSlot(key, ScriptDictionary_HashKey(key));
+	if( slot >= 0 )
+		DeleteSlot(slot);
 }
 
 void CScriptDictionary::DeleteAll()
 {
-	map<std::string, valueStruct>::iterator it;
-	for( it = dict.begin(); it != dict.end(); it++ )
-		FreeValue(it->second);
+	for( asUINT i = 0; i < numEntries; i++ )
+	{
+		if( !entries[i].key )
+			continue;
+		FreeValue(entries[i].value);
+		objectString_Release(entries[i].key);
+	}
+	numEntries = numDeleted = 0;
 
-	dict.clear();
+	for( asUINT i = 0; i < tableSize; i++ )
+		table[i] = -1;
 }
 
 void CScriptDictionary::FreeValue(valueStruct &value)
@@ -425,14 +611,14 @@ CScriptArrayInterface * CScriptDictionary::GetKeys() const
 	asITypeInfo *ti = engine->GetTypeInfoById(stringArrayType);
 
 	// Create the array object
-	CScriptArrayInterface *arr = QAS_NEW(CScriptArray)(dict.size(), ti);
+	CScriptArrayInterface *arr = QAS_NEW(CScriptArray)(GetSize(), ti);
 	int n = 0;
-	std::map<std::string, valueStruct>::const_iterator it;
-	for( it = dict.begin(); it != dict.end(); it++ )
+	for( asUINT i = 0; i < numEntries; i++ )
 	{
-		const char *c_str = it->first.c_str();
-		asstring_t *str = objectString_FactoryBuffer( c_str, strlen( c_str ) );
-		*((asstring_t **)arr->At(n++)) = str;
+		// copied, scripts may modify the strings they get
+		const asstring_t *key = entries[i].key;
+		if( key )
+			*((asstring_t **)arr->At(n++)) = objectString_FactoryBuffer( key->buffer, key->len );
 	}
 
 	return arr;
@@ -559,6 +745,12 @@ void ScriptDictionaryDeleteAll_Generic(asIScriptGeneric *gen)
 	dict->DeleteAll();
 }
 
+void ScriptDictionaryReserve_Generic(asIScriptGeneric *gen)
+{
+	CScriptDictionary *dict = (CScriptDictionary*)gen->GetObject();
+	dict->Reserve(gen->GetArgDWord(0));
+}
+
 static void ScriptDictionaryGetRefCount_Generic(asIScriptGeneric *gen)
 {
 	CScriptDictionary *self = (CScriptDictionary*)gen->GetObject();
@@ -629,6 +821,7 @@ static void RegisterScriptDictionary_Native(asIScriptEngine *engine)
 	r = engine->RegisterObjectMethod("Dictionary", "uint getSize() const", asMETHOD(CScriptDictionary, GetSize), asCALL_THISCALL); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("Dictionary", "void delete(const String &in)", asMETHOD(CScriptDictionary,Delete), asCALL_THISCALL); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("Dictionary", "void deleteAll()", asMETHOD(CScriptDictionary,DeleteAll), asCALL_THISCALL); assert( r >= 0 );
+	r = engine->RegisterObjectMethod("Dictionary", "void reserve(uint)", asMETHOD(CScriptDictionary,Reserve), asCALL_THISCALL); assert( r >= 0 );
 
 	r = engine->RegisterObjectMethod("Dictionary", "array<String @> @getKeys() const", asMETHOD(CScriptDictionary,GetKeys), asCALL_THISCALL); assert( r >= 0 );
 
@@ -679,6 +872,7 @@ static void RegisterScriptDictionary_Generic(asIScriptEngine *engine)
 	r = engine->RegisterObjectMethod("Dictionary", "bool exists(const String &in) const", asFUNCTION(ScriptDictionaryExists_Generic), asCALL_GENERIC); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("Dictionary", "void delete(const String &in)", asFUNCTION(ScriptDictionaryDelete_Generic), asCALL_GENERIC); assert( r >= 0 );
 	r = engine->RegisterObjectMethod("Dictionary", "void deleteAll()", asFUNCTION(ScriptDictionaryDeleteAll_Generic), asCALL_GENERIC); assert( r >= 0 );
+	r = engine->RegisterObjectMethod("Dictionary", "void reserve(uint)", asFUNCTION(ScriptDictionaryReserve_Generic), asCALL_GENERIC); assert( r >= 0 );
 
 	r = engine->RegisterObjectMethod("Dictionary", "array<String @> @getKeys() const", asFUNCTION(CScriptDictionaryGetKeys_Generic), asCALL_GENERIC); assert( r >= 0 );
 
@@ -707,6 +901,88 @@ void RegisterScriptDictionary(asIScriptEngine *engine)
 		RegisterScriptDictionary_Native(engine);
 }
 
+//--------------------------------------------------------------------------
+// Benchmark
+
+// Mimics the per-player state race scripts keep: a key per player and
+// checkpoint, set, read back and partly cleared every round. The std::map
+// run does the same work the way the dictionary used to, building a
+// std::string out of every key.
+void ScriptDictionaryBench_f(void)
+{
+	const int numPlayers = 64, numCheckpoints = 16;
+	const int numKeys = numPlayers * numCheckpoints;
+	int i, round, rounds;
+	unsigned int start, dictTime, mapTime;
+	int64_t value, sum1 = 0, sum2 = 0;
+	asstring_t *keys[numKeys];
+	char name[32];
+	bool maxPortability = false;
+
+	rounds = trap_Cmd_Argc() > 1 ? atoi( trap_Cmd_Argv( 1 ) ) : 200;
+	if( rounds < 1 )
+		rounds = 1;
+
+	asIScriptEngine *engine = qasCreateEngine( &maxPortability );
+	if( !engine )
+	{
+		QAS_Printf( "as_dictbench: failed to create a script engine\n" );
+		return;
+	}
+
+	for( i = 0; i < numKeys; i++ )
+	{
+		Q_snprintfz( name, sizeof( name ), "player%i_cp%i", i / numCheckpoints, i % numCheckpoints );
+		keys[i] = objectString_FactoryBuffer( name, strlen( name ) );
+	}
+
+	CScriptDictionary *dict = QAS_NEW(CScriptDictionary)( engine );
+	start = trap_Milliseconds();
+	for( round = 0; round < rounds; round++ )
+	{
+		for( i = 0; i < numKeys; i++ )
+		{
+			value = round + i;
+			dict->Set( *keys[i], value );
+		}
+		for( i = 0; i < numKeys; i++ )
+		{
+			if( dict->Exists( *keys[i] ) && dict->Get( *keys[i], value ) )
+				sum1 += value;
+		}
+		for( i = 0; i < numKeys; i += 2 )
+			dict->Delete( *keys[i] );
+	}
+	dictTime = trap_Milliseconds() - start;
+	dict->Release();
+
+	std::map<std::string, int64_t> map;
+	start = trap_Milliseconds();
+	for( round = 0; round < rounds; round++ )
+	{
+		for( i = 0; i < numKeys; i++ )
+			map[keys[i]->buffer] = round + i;
+		for( i = 0; i < numKeys; i++ )
+		{
+			std::map<std::string, int64_t>::const_iterator it = map.find( keys[i]->buffer );
+			if( it != map.end() && map.find( keys[i]->buffer ) != map.end() )
+				sum2 += it->second;
+		}
+		for( i = 0; i < numKeys; i += 2 )
+			map.erase( keys[i]->buffer );
+	}
+	mapTime = trap_Milliseconds() - start;
+
+	for( i = 0; i < numKeys; i++ )
+		objectString_Release( keys[i] );
+	qasReleaseEngine( engine );
+
+	QAS_Printf( "%i keys, %i rounds, %i operations per round%s\n", numKeys, rounds, numKeys * 3 + numKeys / 2,
+		sum1 != sum2 ? " (RESULTS DIFFER)" : "" );
+	QAS_Printf( "Dictionary: %u ms\n", dictTime );
+	QAS_Printf( "std::map:   %u ms\n", mapTime );
+}
+
 END_AS_NAMESPACE
 
 
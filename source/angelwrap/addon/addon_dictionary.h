@@ -17,8 +17,6 @@
 #pragma warning (disable:4786)
 #endif
 
-#include <map>
-
 // Sometimes it may be desired to use the same method names as used by C++ STL.
 // This may for example reduce time when converting code from script to C++ or
 // back.
@@ -74,6 +72,9 @@ public:
 	// Deletes all keys
 	void DeleteAll();
 
+	// Preallocates room for the given number of keys
+	void Reserve(asUINT count);
+
 	// Get an array of all keys
 	CScriptArrayInterface *GetKeys() const;
 
@@ -97,6 +98,16 @@ protected:
 		int   typeId;
 	};
 
+	// Keys and values are kept in insertion order in a dense array, which also
+	// gives a stable iteration order. The open addressing (linear probing) hash
+	// table holds indices into that array, -1 marks an empty slot.
+	struct entryStruct
+	{
+		asstring_t *key;		// NULL for deleted entries
+		unsigned int hash;
+		valueStruct value;
+	};
+
 	// We don't want anyone to call the destructor directly, it should be called through the Release method
 	virtual ~CScriptDictionary();
 
@@ -104,15 +115,24 @@ protected:
 	void FreeValue(valueStruct &value);
 	void Initialize(asIScriptEngine *engine);
 
-	void Set_(const char *key, void *value, int typeId);
-	
+	void Set_(const asstring_t &key, void *value, int typeId);
+	int FindSlot(const asstring_t &key, unsigned int hash) const;
+	void InsertEntry(const asstring_t &key, unsigned int hash, const valueStruct &value);
+	void DeleteSlot(int slot);
+	void Rehash(asUINT maxEntries);
+
 	// Our properties
 	asIScriptEngine *engine;
 	mutable int refCount;
 	mutable bool gcFlag;
-
-	// TODO: optimize: Use C++11 std::unordered_map instead
-	std::map<std::string, valueStruct> dict;
+	int stringTypeId;
+
+	entryStruct *entries;
+	asUINT numEntries;		// used entries, including deleted ones
+	asUINT numDeleted;
+	asUINT maxEntries;
+	int *table;
+	asUINT tableSize;		// power of two, at least twice maxEntries
 };
 
 // This function will determine the configuration of the engine
@@ -120,6 +140,9 @@ protected:
 void RegisterScriptDictionary(asIScriptEngine *engine);
 void PreRegisterScriptDictionary(asIScriptEngine *engine);
 
+// Console command timing the dictionary against a std::map based one
+void ScriptDictionaryBench_f(void);
+
 END_AS_NAMESPACE
 
 #endif
@@ -26,27 +26,111 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #define CONST_STRING_BITFLAG	(1<<31)
 #define ENABLE_STRING_IMPLICIT_CASTS
 
-static inline asstring_t *objectString_Alloc( void )
+// String objects are carved out of fixed size blocks which also carry inline storage
+// for short strings, so most script strings cost no allocation at all once the pool
+// has warmed up. Longer strings keep their characters in a separate heap buffer.
+#define STRING_BLOCK_SIZE		64
+#define STRING_INLINE_SIZE		( STRING_BLOCK_SIZE - sizeof( asstring_t ) )
+#define STRING_BLOCKS_PER_CHUNK	512
+
+typedef union stringblock_u
 {
-	static asstring_t *object;
+	asstring_t obj;
+	union stringblock_u *next;
+	uint8_t raw[STRING_BLOCK_SIZE];
+} stringblock_t;
 
-	object = new asstring_t;
-	object->asRefCount = 1;
-	return object;
+typedef struct stringchunk_s
+{
+	struct stringchunk_s *next;
+	stringblock_t blocks[STRING_BLOCKS_PER_CHUNK];
+} stringchunk_t;
+
+typedef struct
+{
+	unsigned int objects;	// string objects handed out
+	unsigned int buffers;	// heap buffers allocated for long strings
+	unsigned int chunks;	// pool chunks allocated
+	unsigned int live;		// string objects in use
+	unsigned int time;		// time of the last stats reset
+} stringstats_t;
+
+static stringchunk_t *stringChunks;
+static stringblock_t *stringFreeBlocks;
+static stringstats_t stringStats;
+
+static inline char *objectString_InlineBuffer( asstring_t *obj )
+{
+	return ( char * )( ( stringblock_t * )obj )->raw + sizeof( asstring_t );
 }
 
-static inline void objectString_Free( asstring_t* obj )
+static inline bool objectString_IsInline( asstring_t *obj )
 {
-	if( ( obj->size & CONST_STRING_BITFLAG ) == 0 )
+	return obj->buffer == objectString_InlineBuffer( obj );
+}
+
+static inline void objectString_AllocBuffer( asstring_t *obj, unsigned int size )
+{
+	if( size <= STRING_INLINE_SIZE )
 	{
-		delete[] obj->buffer;
-		delete obj;
+		obj->buffer = objectString_InlineBuffer( obj );
+		obj->size = STRING_INLINE_SIZE;
+		return;
 	}
-	else
+
+	obj->buffer = new char[size];
+	obj->size = size;
+	stringStats.buffers++;
+}
+
+static inline void objectString_FreeBuffer( asstring_t *obj )
+{
+	if( !objectString_IsInline( obj ) )
+		delete[] obj->buffer;
+}
+
+static asstring_t *objectString_Alloc( unsigned int size )
+{
+	int i;
+	stringblock_t *block;
+	asstring_t *object;
+
+	if( !stringFreeBlocks )
 	{
-		uint8_t *rawmem = ( uint8_t * )obj;
-		delete[] rawmem;
+		stringchunk_t *chunk = new stringchunk_t;
+
+		chunk->next = stringChunks;
+		stringChunks = chunk;
+		for( i = STRING_BLOCKS_PER_CHUNK - 1; i >= 0; i-- )
+		{
+			chunk->blocks[i].next = stringFreeBlocks;
+			stringFreeBlocks = &chunk->blocks[i];
+		}
+		stringStats.chunks++;
 	}
+
+	block = stringFreeBlocks;
+	stringFreeBlocks = block->next;
+
+	object = &block->obj;
+	object->asRefCount = 1;
+	object->len = 0;
+	objectString_AllocBuffer( object, size );
+
+	stringStats.objects++;
+	stringStats.live++;
+	return object;
+}
+
+static inline void objectString_Free( asstring_t* obj )
+{
+	stringblock_t *block = ( stringblock_t * )obj;
+
+	objectString_FreeBuffer( obj );
+
+	block->next = stringFreeBlocks;
+	stringFreeBlocks = block;
+	stringStats.live--;
 }
 
 asstring_t *objectString_FactoryBuffer( const char *buffer, unsigned int length )
@@ -55,16 +139,13 @@ asstring_t *objectString_FactoryBuffer( const char *buffer, unsigned int length
 	unsigned int size = (length + 1) & ~CONST_STRING_BITFLAG;
 
 	length = size-1;
-	object = objectString_Alloc();
-	object->buffer = new char[size];
-	object->len = length;
-	object->size = size;
+	object = objectString_Alloc( size );
 	if( buffer ) {
+		object->len = length;
 		memcpy( object->buffer, buffer, length );
 		object->buffer[length] = '\0';
 	}
 	else {
-		object->len = 0;
 		object->buffer[0] = '\0';
 	}
 	return object;
@@ -73,18 +154,31 @@ asstring_t *objectString_FactoryBuffer( const char *buffer, unsigned int length
 const asstring_t *objectString_ConstFactoryBuffer( const char *buffer, unsigned int length )
 {
 	asstring_t *object;
-	uint8_t *rawmem;
-	unsigned int size = (length + 1) & ~CONST_STRING_BITFLAG;
 
-	length = size - 1;
-	rawmem = new uint8_t[sizeof( asstring_t ) + size];
-	object = ( asstring_t * )rawmem;
-	object->asRefCount = 1;
-	object->buffer = ( char * )( object + 1 );
-	object->len = length;
-	object->size = size | CONST_STRING_BITFLAG;
-	memcpy( object->buffer, buffer, length );
-	object->buffer[length] = '\0';
+	object = objectString_FactoryBuffer( buffer, length );
+	object->size |= CONST_STRING_BITFLAG;
+
+	return object;
+}
+
+/*
+* objectString_Concat
+* creates a new string out of two character ranges, copying each of them once
+*/
+static asstring_t *objectString_Concat( const char *first, size_t firstlen, const char *second, size_t seclen )
+{
+	asstring_t *object;
+	unsigned int size = (firstlen + seclen + 1) & ~CONST_STRING_BITFLAG;
+
+	if( firstlen > size - 1 )
+		firstlen = size - 1;
+	seclen = size - 1 - firstlen;
+
+	object = objectString_Alloc( size );
+	object->len = size - 1;
+	memcpy( object->buffer, first, firstlen );
+	memcpy( object->buffer + firstlen, second, seclen );
+	object->buffer[object->len] = '\0';
 
 	return object;
 }
@@ -95,16 +189,15 @@ asstring_t *objectString_AssignString( asstring_t *self, const char *string, siz
 
 	if( strlen_ >= self->size )
 	{
-		delete[] self->buffer;
+		objectString_FreeBuffer( self );
 
 		size = (strlen_ + 1) & ~CONST_STRING_BITFLAG;
-		self->size = size;
-		self->buffer = new char[size];
+		objectString_AllocBuffer( self, size );
 		strlen_ = size - 1;
 	}
 
 	self->len = strlen_;
-	memcpy( self->buffer, string, strlen_ );
+	memmove( self->buffer, string, strlen_ );
 	self->buffer[strlen_] = '\0';
 
 	return self;
@@ -113,7 +206,7 @@ asstring_t *objectString_AssignString( asstring_t *self, const char *string, siz
 static asstring_t *objectString_AssignPattern( asstring_t *self, const char *pattern, ... )
 {
 	va_list	argptr;
-	static char buf[4096];
+	char buf[512];
 
 	va_start( argptr, pattern );
 	Q_vsnprintfz( buf, sizeof( buf ), pattern, argptr );
@@ -122,22 +215,44 @@ static asstring_t *objectString_AssignPattern( asstring_t *self, const char *pat
 	return objectString_AssignString( self, buf, strlen( buf ) );
 }
 
+/*
+* objectString_AddAssignString
+* appends in place when the string has room for it, otherwise grows the buffer
+* geometrically so that strings built up piece by piece are not copied on each append
+*/
 static asstring_t *objectString_AddAssignString( asstring_t *self, const char *string, size_t strlen_ )
 {
 	if( strlen_ )
 	{
-		char *tem = self->buffer;
 		unsigned int length = strlen_ + self->len;
 		unsigned int size = (length + 1) & ~CONST_STRING_BITFLAG;
 
 		length = size - 1;
-		self->len = length;
-		self->size = size;
-		self->buffer = new char[size];
+		strlen_ = length - self->len;
 
-		Q_snprintfz( self->buffer, size, "%s%s", tem, string );
+		if( size > self->size )
+		{
+			char *tem = self->buffer;
+			bool wasInline = objectString_IsInline( self );
+			unsigned int newsize = std::max( size, (self->size * 2) & ~CONST_STRING_BITFLAG );
+
+			// the appended string may live in the old buffer (s += s), so free it last
+			self->buffer = new char[newsize];
+			self->size = newsize;
+			stringStats.buffers++;
+			memcpy( self->buffer, tem, self->len );
+			memcpy( self->buffer + self->len, string, strlen_ );
+
+			if( !wasInline )
+				delete[] tem;
+		}
+		else
+		{
+			memmove( self->buffer + self->len, string, strlen_ );
+		}
 
-		delete[] tem;
+		self->len = length;
+		self->buffer[length] = '\0';
 	}
 
 	return self;
@@ -146,7 +261,7 @@ static asstring_t *objectString_AddAssignString( asstring_t *self, const char *s
 static asstring_t *objectString_AddAssignPattern( asstring_t *self, const char *pattern, ... )
 {
 	va_list	argptr;
-	static char buf[4096];
+	char buf[512];
 
 	va_start( argptr, pattern );
 	Q_vsnprintfz( buf, sizeof( buf ), pattern, argptr );
@@ -157,17 +272,13 @@ static asstring_t *objectString_AddAssignPattern( asstring_t *self, const char *
 
 static asstring_t *objectString_AddString( asstring_t *first, const char *second, size_t seclen )
 {
-	asstring_t *self = objectString_FactoryBuffer( NULL, first->len + seclen );
-
-	Q_snprintfz( self->buffer, self->size, "%s%s", first->buffer, second );
-	self->len = self->size - 1;
-	return self;
+	return objectString_Concat( first->buffer, first->len, second, seclen );
 }
 
 static asstring_t *objectString_AddPattern( asstring_t *first, const char *pattern, ... )
 {
 	va_list	argptr;
-	static char buf[4096];
+	char buf[512];
 
 	va_start( argptr, pattern );
 	Q_vsnprintfz( buf, sizeof( buf ), pattern, argptr );
@@ -176,6 +287,21 @@ static asstring_t *objectString_AddPattern( asstring_t *first, const char *patte
 	return objectString_AddString( first, buf, strlen( buf ) );
 }
 
+/*
+* objectString_PrependPattern
+*/
+static asstring_t *objectString_PrependPattern( asstring_t *second, const char *pattern, ... )
+{
+	va_list	argptr;
+	char buf[512];
+
+	va_start( argptr, pattern );
+	Q_vsnprintfz( buf, sizeof( buf ), pattern, argptr );
+	va_end( argptr );
+
+	return objectString_Concat( buf, strlen( buf ), second->buffer, second->len );
+}
+
 static asstring_t *objectString_Factory( void )
 {
 	return objectString_FactoryBuffer( NULL, 0 );
@@ -218,6 +344,55 @@ void objectString_Release( asstring_t *obj )
 		objectString_Free(obj);
 }
 
+/*
+* objectString_PrintStats_f
+* "as_stringstats [reset]": string allocations since the last reset, per second
+* and per game frame, for measuring the string churn of gametype scripts
+*/
+void objectString_PrintStats_f( void )
+{
+	float seconds, frames, fps;
+
+	seconds = ( trap_Milliseconds() - stringStats.time ) * 0.001f;
+	fps = trap_Cvar_Value( "sv_fps" );
+	frames = seconds * fps;
+
+	QAS_Printf( "String objects: %u (%u live), heap buffers: %u, pool chunks: %u (%u KB)\n",
+		stringStats.objects, stringStats.live, stringStats.buffers, stringStats.chunks,
+		(unsigned)( stringStats.chunks * sizeof( stringchunk_t ) / 1024 ) );
+	if( seconds > 0 )
+		QAS_Printf( "%.1f objects/s, %.1f buffers/s\n", stringStats.objects / seconds, stringStats.buffers / seconds );
+	if( frames >= 1 )
+		QAS_Printf( "%.2f objects/frame, %.2f buffers/frame at %g fps\n", stringStats.objects / frames, stringStats.buffers / frames, fps );
+
+	if( trap_Cmd_Argc() > 1 && !Q_stricmp( trap_Cmd_Argv( 1 ), "reset" ) )
+	{
+		stringStats.objects = stringStats.buffers = 0;
+		stringStats.time = trap_Milliseconds();
+	}
+}
+
+/*
+* objectString_Shutdown
+*/
+void objectString_Shutdown( void )
+{
+	stringchunk_t *chunk, *next;
+
+	// string constants may outlive us if an engine was leaked, keep the pool then
+	if( stringStats.live )
+		return;
+
+	for( chunk = stringChunks; chunk; chunk = next )
+	{
+		next = chunk->next;
+		delete chunk;
+	}
+	stringChunks = NULL;
+	stringFreeBlocks = NULL;
+	stringStats.chunks = 0;
+}
+
 class StringFactory : public asIStringFactory
 {
 private:
@@ -352,8 +527,7 @@ static asstring_t *objectString_AddBehaviourSI( asstring_t *first, int second )
 
 static asstring_t *objectString_AddBehaviourIS( int first, asstring_t *second )
 {
-	asstring_t *res = objectString_Factory();
-	return objectString_AssignPattern( res, "%i%s", first, second->buffer );
+	return objectString_PrependPattern( second, "%i", first );
 }
 
 static asstring_t *objectString_AddBehaviourSD( asstring_t *first, double second )
@@ -363,8 +537,7 @@ static asstring_t *objectString_AddBehaviourSD( asstring_t *first, double second
 
 static asstring_t *objectString_AddBehaviourDS( double first, asstring_t *second )
 {
-	asstring_t *res = objectString_FactoryBuffer( NULL, 0 );
-	return objectString_AssignPattern( res, "%g%s", first, second->buffer );
+	return objectString_PrependPattern( second, "%g", first );
 }
 
 static asstring_t *objectString_AddBehaviourSF( asstring_t *first, float second )
@@ -374,8 +547,7 @@ static asstring_t *objectString_AddBehaviourSF( asstring_t *first, float second
 
 static asstring_t *objectString_AddBehaviourFS( float first, asstring_t *second )
 {
-	asstring_t *res = objectString_FactoryBuffer( NULL, 0 );
-	return objectString_AssignPattern( res, "%f%s", first, second->buffer );
+	return objectString_PrependPattern( second, "%f", first );
 }
 
 static bool objectString_EqualBehaviour( asstring_t *first, asstring_t *second )
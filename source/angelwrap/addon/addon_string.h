@@ -27,6 +27,9 @@ const asstring_t *objectString_ConstFactoryBuffer( const char *buffer, unsigned
 void objectString_Release( asstring_t *obj );
 asstring_t *objectString_AssignString( asstring_t *self, const char *string, size_t strlen );
 
+void objectString_PrintStats_f( void );
+void objectString_Shutdown( void );
+
 void PreRegisterStringAddon( asIScriptEngine *engine );
 void RegisterStringAddon( asIScriptEngine *engine );
 
@@ -19,6 +19,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 */
 
 #include "qas_precompiled.h"
+#include "addon/addon_string.h"
+#include "addon/addon_dictionary.h"
 
 struct mempool_s *angelwrappool;
 
@@ -69,11 +71,18 @@ int QAS_Init( void )
 	srand( time( NULL ) );
 
 	QAS_InitAngelExport();
+
+	trap_Cmd_AddCommand( "as_stringstats", objectString_PrintStats_f );
+	trap_Cmd_AddCommand( "as_dictbench", ScriptDictionaryBench_f );
 	return 1;
 }
 
 void QAS_ShutDown( void )
 {
+	trap_Cmd_RemoveCommand( "as_stringstats" );
+	trap_Cmd_RemoveCommand( "as_dictbench" );
+	objectString_Shutdown();
+
 	QAS_MemFreePool( &angelwrappool );
 }
 
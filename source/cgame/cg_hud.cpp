@@ -814,6 +814,45 @@ static const reference_numeric_t cg_numeric_references[] =
 	{ NULL, NULL, NULL }
 };
 
+#define NUM_NUMERIC_REFERENCES ( sizeof( cg_numeric_references ) / sizeof( cg_numeric_references[0] ) )
+
+// numeric references are evaluated once per layout program run and cached,
+// a stamp of 0 means caching is disabled (touch pass)
+static int layout_reference_values[NUM_NUMERIC_REFERENCES];
+static unsigned int layout_reference_stamps[NUM_NUMERIC_REFERENCES];
+static unsigned int layout_reference_stamp;
+
+/*
+* CG_GetNumericReferenceValue
+*/
+static int CG_GetNumericReferenceValue( int index )
+{
+	const reference_numeric_t *ref = &cg_numeric_references[index];
+
+	if( !layout_reference_stamp )
+		return ref->func( ref->parameter );
+
+	if( layout_reference_stamps[index] != layout_reference_stamp )
+	{
+		layout_reference_values[index] = ref->func( ref->parameter );
+		layout_reference_stamps[index] = layout_reference_stamp;
+	}
+	return layout_reference_values[index];
+}
+
+/*
+* CG_NextNumericReferenceStamp
+*/
+static unsigned int CG_NextNumericReferenceStamp( void )
+{
+	if( !++layout_reference_stamp )
+	{
+		memset( layout_reference_stamps, 0, sizeof( layout_reference_stamps ) );
+		layout_reference_stamp = 1;
+	}
+	return layout_reference_stamp;
+}
+
 //=============================================================================
 
 #define MAX_OBITUARIES 32
@@ -3810,7 +3849,7 @@ static float CG_GetNumericArg( struct cg_layoutnode_s **argumentsnode )
 	*argumentsnode = anode->next;
 	if( anode->type == LNODE_REFERENCE_NUMERIC )
 	{
-		value = cg_numeric_references[anode->integer].func( cg_numeric_references[anode->integer].parameter );
+		value = CG_GetNumericReferenceValue( anode->integer );
 	}
 	else
 	{
@@ -4313,114 +4352,257 @@ static void CG_RecursePrintLayoutThread( cg_layoutnode_t *rootnode, int level )
 }
 #endif
 
+//=============================================================================
+
 /*
-* CG_ParseLayoutScript
+* Layout programs
+* The parsed node tree is compiled once into a flat array of instructions, each one holding
+* the command node, its first argument node and the validated argument count. "if" commands
+* store the number of instructions in their subthread, so when the condition fails the
+* interpreter jumps over them instead of recursing.
 */
-static void CG_ParseLayoutScript( char *string, cg_layoutnode_t *rootnode )
+typedef struct
 {
+	cg_layoutnode_t *command;
+	cg_layoutnode_t *arguments;
+	int numArguments;
+	int skip;
+} cg_layoutinstruction_t;
 
-	CG_RecurseFreeLayoutThread( cg.statusBar );
-	cg.statusBar = CG_RecurseParseLayoutScript( &string, 0 );
+typedef struct cg_layoutprogram_s
+{
+	cg_layoutnode_t *root;
+	cg_layoutinstruction_t *code;
+	int numInstructions;
+} cg_layoutprogram_t;
 
-#if 0
-	CG_RecursePrintLayoutThread( cg_layoutRootNode, 0 );
-#endif
-}
+/*
+* CG_RecurseCountLayoutCommands
+*/
+static int CG_RecurseCountLayoutCommands( cg_layoutnode_t *rootnode )
+{
+	int count = 0;
+	cg_layoutnode_t *node;
 
-//=============================================================================
+	for( node = rootnode; node; node = node->parent )
+	{
+		if( node->type != LNODE_COMMAND )
+			continue;
+		count++;
+		if( node->ifthread )
+			count += CG_RecurseCountLayoutCommands( node->ifthread );
+	}
 
-//=============================================================================
+	return count;
+}
 
 /*
-* CG_RecurseExecuteLayoutThread
-* Execution works like this: First node (on backwards) is expected to be the command, followed by arguments nodes.
-* we keep a pointer to the command and run the tree counting arguments until we reach the next command,
-* then we call the command function sending the pointer to first argument and the pointer to the command.
-* At return we advance one node (we stopped at last argument node) so it starts again from the next command (if any).
-* 
-* When finding an "if" command with a subtree, we execute the "if" command. In the case it
-* returns any value, we recurse execute the subtree
+* CG_RecurseCompileLayoutThread
+* Emits the instructions for a thread and returns their count. Argument count mismatches
+* used to be reported by the interpreter every frame, now they are reported once here and,
+* as before, cut the rest of the thread off.
 */
-static void CG_RecurseExecuteLayoutThread( cg_layoutnode_t *rootnode, bool touch )
+static int CG_RecurseCompileLayoutThread( cg_layoutnode_t *rootnode, cg_layoutinstruction_t *code )
 {
-	cg_layoutnode_t	*argumentnode = NULL;
-	cg_layoutnode_t	*commandnode = NULL;
 	int numArguments;
+	cg_layoutnode_t	*commandnode, *argumentnode;
+	cg_layoutinstruction_t *insn = code;
 
 	if( !rootnode )
-		return;
+		return 0;
 
 	// run until the real root
 	commandnode = rootnode;
 	while( commandnode->parent )
-	{
 		commandnode = commandnode->parent;
-	}
 
-	// now run backwards up to the next command node
 	while( commandnode )
 	{
-		argumentnode = commandnode->next;
-
-		// we could trust the parser, but I prefer counting the arguments here
 		numArguments = 0;
-		while( argumentnode )
+		for( argumentnode = commandnode->next; argumentnode; argumentnode = argumentnode->next )
 		{
 			if( argumentnode->type == LNODE_COMMAND )
 				break;
-
-			argumentnode = argumentnode->next;
 			numArguments++;
 		}
 
-		// reset
-		argumentnode = commandnode->next;
-
-		// Execute the command node
 		if( commandnode->integer != numArguments )
 		{
 			CG_Printf( "ERROR: Layout command %s: invalid argument count (expecting %i, found %i)\n", commandnode->string, commandnode->integer, numArguments );
-			return;
-		}
-		if( !touch && commandnode->func )
-		{
-			//special case for if commands
-			if( commandnode->func( commandnode, argumentnode, numArguments ) )
-			{
-				// execute the "if" thread when command returns a value
-				if( commandnode->ifthread )
-					CG_RecurseExecuteLayoutThread( commandnode->ifthread, touch );
-			}
-		}
-		else if( touch && commandnode->touchfunc )
-		{
-			//special case for if commands
-			if( commandnode->touchfunc( commandnode, argumentnode, numArguments ) )
-			{
-				// execute the "if" thread when command returns a value
-				if( commandnode->ifthread )
-					CG_RecurseExecuteLayoutThread( commandnode->ifthread, touch );
-			}
+			break;
 		}
 
-		//move up to next command node
+		insn->command = commandnode;
+		insn->arguments = commandnode->next;
+		insn->numArguments = numArguments;
+		insn->skip = CG_RecurseCompileLayoutThread( commandnode->ifthread, insn + 1 );
+		insn += 1 + insn->skip;
+
+		// the old interpreter stopped as soon as the node following a command was the
+		// last node of the thread, so a last command preceded by a command without
+		// arguments never ran. Keep that so existing HUD scripts draw the same
+		if( commandnode->next == rootnode )
+			break;
+
 		commandnode = argumentnode;
-		if( commandnode == rootnode )
-			return;
+	}
+
+	return insn - code;
+}
+
+/*
+* CG_FreeLayoutProgram
+*/
+static void CG_FreeLayoutProgram( cg_layoutprogram_t *program )
+{
+	if( !program )
+		return;
+
+	CG_RecurseFreeLayoutThread( program->root );
+	if( program->code )
+		CG_Free( program->code );
+	CG_Free( program );
+}
+
+/*
+* CG_CompileLayoutProgram
+*/
+static cg_layoutprogram_t *CG_CompileLayoutProgram( cg_layoutnode_t *rootnode )
+{
+	int numCommands;
+	cg_layoutprogram_t *program;
+
+	program = ( cg_layoutprogram_t * )CG_Malloc( sizeof( *program ) );
+	program->root = rootnode;
+
+	numCommands = CG_RecurseCountLayoutCommands( rootnode );
+	if( numCommands )
+	{
+		program->code = ( cg_layoutinstruction_t * )CG_Malloc( numCommands * sizeof( *program->code ) );
+		program->numInstructions = CG_RecurseCompileLayoutThread( rootnode, program->code );
+	}
+
+	if( cg_debugHUD && cg_debugHUD->integer )
+		CG_Printf( "HUD: compiled %i instructions\n", program->numInstructions );
+
+	return program;
+}
+
+/*
+* CG_ParseLayoutScript
+*/
+static void CG_ParseLayoutScript( char *string )
+{
+	CG_FreeLayoutProgram( cg.statusBar );
+	cg.statusBar = CG_CompileLayoutProgram( CG_RecurseParseLayoutScript( &string, 0 ) );
+
+#if 0
+	CG_RecursePrintLayoutThread( cg.statusBar->root, 0 );
+#endif
+}
+
+//=============================================================================
+
+/*
+* CG_RunLayoutProgram
+* When a command returns false, the instructions of its "if" thread (if any) are skipped.
+* In dry runs only the arguments are evaluated and only the conditionals are executed,
+* which lets the interpreter be timed without a renderer.
+*/
+static void CG_RunLayoutProgram( const cg_layoutprogram_t *program, bool touch, bool dryRun )
+{
+	cg_layoutnode_t *commandnode, *argumentnode;
+	const cg_layoutinstruction_t *insn, *end;
+	bool ( *func )( struct cg_layoutnode_s *commandnode, struct cg_layoutnode_s *argumentnode, int numArguments );
+
+	insn = program->code;
+	end = insn + program->numInstructions;
+	while( insn < end )
+	{
+		commandnode = insn->command;
+		func = touch ? commandnode->touchfunc : commandnode->func;
 
-		while( commandnode && commandnode->type != LNODE_COMMAND )
+		if( dryRun && func && !commandnode->ifthread )
 		{
-			commandnode = commandnode->next;
+			for( argumentnode = insn->arguments; argumentnode && argumentnode->type != LNODE_COMMAND; )
+			{
+				if( argumentnode->type == LNODE_NUMERIC || argumentnode->type == LNODE_REFERENCE_NUMERIC )
+					CG_GetNumericArg( &argumentnode );
+				else
+					argumentnode = argumentnode->next;
+			}
+			insn++;
+			continue;
 		}
+
+		if( func && func( commandnode, insn->arguments, insn->numArguments ) )
+			insn++; // step into the "if" thread
+		else
+			insn += 1 + insn->skip;
 	}
 }
 
 /*
 * CG_ExecuteLayoutProgram
 */
-void CG_ExecuteLayoutProgram( struct cg_layoutnode_s *rootnode, bool touch )
+void CG_ExecuteLayoutProgram( struct cg_layoutprogram_s *program, bool touch )
+{
+	if( !program )
+		return;
+
+	// the touch pass updates the state some references read, so don't cache it
+	layout_reference_stamp = 0;
+	if( !touch )
+		CG_NextNumericReferenceStamp();
+
+	CG_RunLayoutProgram( program, touch, false );
+
+	layout_reference_stamp = 0;
+}
+
+/*
+* Cmd_CG_HudBench_f
+* Times the interpreter over the current HUD program against the current snapshot,
+* (recorded player states when playing back a demo), with and without reference caching.
+*/
+void Cmd_CG_HudBench_f( void )
 {
-	CG_RecurseExecuteLayoutThread( rootnode, touch );
+	int i, iterations;
+	unsigned int start, cachedTime, uncachedTime;
+
+	if( !cg.statusBar || !cg.statusBar->numInstructions )
+	{
+		CG_Printf( "No HUD program loaded\n" );
+		return;
+	}
+	if( !cg.frame.valid )
+	{
+		CG_Printf( "No valid snapshot\n" );
+		return;
+	}
+
+	iterations = trap_Cmd_Argc() > 1 ? atoi( trap_Cmd_Argv( 1 ) ) : 10000;
+	if( iterations < 1 )
+		iterations = 1;
+
+	start = trap_Milliseconds();
+	for( i = 0; i < iterations; i++ )
+	{
+		CG_NextNumericReferenceStamp();
+		CG_RunLayoutProgram( cg.statusBar, false, true );
+	}
+	cachedTime = trap_Milliseconds() - start;
+
+	layout_reference_stamp = 0;
+
+	start = trap_Milliseconds();
+	for( i = 0; i < iterations; i++ )
+		CG_RunLayoutProgram( cg.statusBar, false, true );
+	uncachedTime = trap_Milliseconds() - start;
+
+	CG_Printf( "HUD: %i instructions, %i runs\n", cg.statusBar->numInstructions, iterations );
+	CG_Printf( "cached references: %u ms (%.2f us/run)\n", cachedTime, cachedTime * 1000.0f / iterations );
+	CG_Printf( "uncached references: %u ms (%.2f us/run)\n", uncachedTime, uncachedTime * 1000.0f / iterations );
 }
 
 //=============================================================================
@@ -4830,7 +5012,7 @@ static void CG_LoadStatusBarFile( char *path )
 	CG_ClearHUDInputState();
 
 	// load the new status bar program
-	CG_ParseLayoutScript( opt, cg.statusBar );
+	CG_ParseLayoutScript( opt );
 	// Free the opt buffer!
 	CG_Free( opt );
 
@@ -624,7 +624,7 @@ typedef struct
 	int award_head;
 
 	// statusbar program
-	struct cg_layoutnode_s *statusBar;
+	struct cg_layoutprogram_s *statusBar;
 
 	cg_viewweapon_t weapon;
 	cg_viewdef_t view;
@@ -842,7 +842,8 @@ extern cvar_t *cg_touch_zoomTime;
 void CG_SC_ResetObituaries( void );
 void CG_SC_Obituary( void );
 void Cmd_CG_PrintHudHelp_f( void );
-void CG_ExecuteLayoutProgram( struct cg_layoutnode_s *rootnode, bool touch );
+void Cmd_CG_HudBench_f( void );
+void CG_ExecuteLayoutProgram( struct cg_layoutprogram_s *program, bool touch );
 void CG_GetHUDTouchButtons( unsigned int *buttons, int *upmove );
 void CG_UpdateHUDPostDraw( void );
 void CG_UpdateHUDPostTouch( void );
@@ -364,6 +364,7 @@ void CG_ScreenInit( void )
 	trap_Cmd_AddCommand( "sizeup", CG_SizeUp_f );
 	trap_Cmd_AddCommand( "sizedown", CG_SizeDown_f );
 	trap_Cmd_AddCommand( "help_hud", Cmd_CG_PrintHudHelp_f );
+	trap_Cmd_AddCommand( "hudbench", Cmd_CG_HudBench_f );
 	trap_Cmd_AddCommand( "gamemenu", CG_GameMenu_f );
 
 	trap_Cmd_AddCommand( "+quickmenu", &CG_QuickMenuOn_f );
@@ -383,6 +384,7 @@ void CG_ScreenShutdown( void )
 	trap_Cmd_RemoveCommand( "sizeup" );
 	trap_Cmd_RemoveCommand( "sizedown" );
 	trap_Cmd_RemoveCommand( "help_hud" );
+	trap_Cmd_RemoveCommand( "hudbench" );
 
 	trap_Cmd_RemoveCommand( "+quickmenu" );
 	trap_Cmd_RemoveCommand( "-quickmenu" );
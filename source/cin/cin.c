@@ -444,3 +444,124 @@ void CIN_Close( cinematics_t *cin )
 	CIN_Free( cin );
 	CIN_FreePool( &mempool );
 }
+
+// =====================================================================
+
+/*
+* CIN_Benchmark_RawSamples
+*/
+static void CIN_Benchmark_RawSamples( void *listener, unsigned int samples, unsigned int rate, 
+	unsigned short width, unsigned short channels, const uint8_t *data )
+{
+}
+
+/*
+* CIN_BenchmarkFile
+*/
+static bool CIN_BenchmarkFile( const char *name, unsigned int *numframes, uint64_t *usec )
+{
+	cinematics_t *cin;
+	cin_yuv_t *cyuv;
+	bool redraw;
+	unsigned int frames;
+	uint64_t start, frametime, maxtime, total;
+
+	cin = CIN_Open( name, trap_Milliseconds(), 0, NULL, NULL );
+	if( !cin )
+	{
+		Com_Printf( "Couldn't open %s\n", name );
+		return false;
+	}
+
+	frames = 0;
+	maxtime = total = 0;
+
+	do
+	{
+		// audio is decoded as in playback, the samples are dropped
+		CIN_AddRawSamplesListener( cin, NULL, CIN_Benchmark_RawSamples, NULL );
+
+		start = trap_Microseconds();
+		cyuv = CIN_ReadNextFrameYUV( cin, NULL, NULL, NULL, NULL, &redraw );
+		frametime = trap_Microseconds() - start;
+
+		total += frametime;
+		if( cyuv )
+		{
+			frames++;
+			maxtime = max( maxtime, frametime );
+		}
+	} while( cyuv );
+
+	if( frames )
+	{
+		Com_Printf( "%s: %ix%i, %u frames in %.3f seconds: %.1f frames per second, avg %.3f max %.3f ms\n",
+			cin->name, cin->width, cin->height, frames, total * 0.000001, total ? frames * 1000000.0 / total : 0.0,
+			total * 0.001 / frames, maxtime * 0.001 );
+	}
+
+	CIN_Close( cin );
+
+	*numframes += frames;
+	*usec += total;
+	return true;
+}
+
+/*
+* CIN_Benchmark_f
+*
+* cinbenchmark [name]
+*
+* Decodes the named cinematic, or every one in video/, as fast as possible and prints
+* the decoding times. Needs neither a renderer nor a sound device. The time measured is
+* that of the main thread, which includes waiting for the decoding thread with "cin_threads 1".
+*/
+void CIN_Benchmark_f( void )
+{
+	int i, j, numfiles, length;
+	char buffer[1024], *s;
+	unsigned int numframes;
+	uint64_t usec;
+
+	numframes = 0;
+	usec = 0;
+
+	if( trap_Cmd_Argc() > 1 )
+	{
+		const char *arg = trap_Cmd_Argv( 1 );
+
+		// same lookup as the cinematic command
+		if( strstr( arg, "/" ) == NULL && strstr( arg, "\\" ) == NULL )
+			arg = va( "video/%s", arg );
+		CIN_BenchmarkFile( arg, &numframes, &usec );
+		return;
+	}
+
+	numfiles = trap_FS_GetFileList( "video", ROQ_FILE_EXTENSIONS, NULL, 0, 0, 0 );
+	if( !numfiles )
+	{
+		Com_Printf( "No cinematics found\n" );
+		return;
+	}
+
+	for( i = 0; i < numfiles; )
+	{
+		if( ( j = trap_FS_GetFileList( "video", ROQ_FILE_EXTENSIONS, buffer, sizeof( buffer ), i, numfiles ) ) == 0 )
+		{
+			i++;
+			continue;
+		}
+
+		for( s = buffer; j > 0; j--, s += length+1, i++ )
+		{
+			length = strlen( s );
+			CIN_BenchmarkFile( va( "video/%s", s ), &numframes, &usec );
+		}
+	}
+
+	if( numframes )
+	{
+		Com_Printf( "%i cinematics, %u frames in %.3f seconds: %.1f frames per second\n", numfiles,
+			numframes, usec * 0.000001, usec ? numframes * 1000000.0 / usec : 0.0 );
+	}
+}
@@ -22,6 +22,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 struct mempool_s *cinPool;
 
+cvar_t *cin_threads;
+
 /*
 * CIN_API
 */
@@ -37,6 +39,10 @@ bool CIN_Init( bool verbose )
 {
 	cinPool = CIN_AllocPool( "Generic pool" );
 
+	cin_threads = trap_Cvar_Get( "cin_threads", "1", CVAR_ARCHIVE );
+
+	trap_Cmd_AddCommand( "cinbenchmark", CIN_Benchmark_f );
+
 	return true;
 }
 
@@ -45,6 +51,8 @@ bool CIN_Init( bool verbose )
 */
 void CIN_Shutdown( bool verbose )
 {
+	trap_Cmd_RemoveCommand( "cinbenchmark" );
+
 	CIN_FreePool( &cinPool );
 }
 
@@ -24,7 +24,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 // cin_public.h -- cinematics playback as a separate dll, making the engine
 // container- and format- agnostic
 
-#define	CIN_API_VERSION				8
+#define	CIN_API_VERSION				9
 
 #define CIN_LOOP					1
 #define CIN_NOAUDIO					2
@@ -134,6 +134,10 @@ typedef struct
 	void ( *Mem_Free )( void *data, const char *filename, int fileline );
 	void ( *Mem_FreePool )( struct mempool_s **pool, const char *filename, int fileline );
 	void ( *Mem_EmptyPool )( struct mempool_s *pool, const char *filename, int fileline );
+
+	// multithreading
+	struct qthread_s *( *Thread_Create )( void *(*routine) (void*), void *param );
+	void ( *Thread_Join )( struct qthread_s *thread );
 } cin_import_t;
 
 //
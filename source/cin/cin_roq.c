@@ -54,19 +54,54 @@ Based on work by Dr. Tim Ferguson: http://www.csse.monash.edu.au/~timf/
 #include "cin_roq.h"
 #include "roq.h"
 
+// codebook entries expanded to the block sizes they are applied at,
+// so that whole block rows can be stored at once
+typedef struct
+{
+	uint8_t y[4][4];
+	uint8_t u[2][2];
+	uint8_t v[2][2];
+} roq_block4_t;
+
+typedef struct
+{
+	uint8_t y[8][8];
+	uint8_t u[4][4];
+	uint8_t v[4][4];
+} roq_block8_t;
+
 typedef struct
 {
 	roq_chunk_t		chunk;
 	roq_cell_t		cells[256];
 	roq_qcell_t		qcells[256];
 
+	roq_block4_t	qcells4[256];	// four 2x2 cells
+	roq_block8_t	qcells8[256];	// four 2x2 cells scaled up to 4x4
+
 	int				width_2;
 	int				height_2;
 
 	cin_yuv_t		cyuv[2];
 	uint8_t			*yuv_pixels;
+
+	// the QUAD_VQ payload of the last frame, decoded on the worker thread
+	uint8_t			*vq;
+	unsigned int	vq_size;
+	unsigned int	vq_alloc;
+	unsigned short	vq_argument;
+	struct qthread_s *thread;
 } roq_info_t;
 
+// plane pointers of the frame being decoded and of the previous one
+typedef struct
+{
+	uint8_t			*y, *u, *v;
+	const uint8_t	*y1, *u1, *v1;
+	int				stride;
+	int				stride_2;
+} roq_frame_t;
+
 static short snd_sqr_arr[256];
 
 /*
@@ -182,6 +217,51 @@ static void RoQ_ReadInfo( cinematics_t *cin )
 	}
 }
 
+/*
+* RoQ_ExpandCodebook
+*/
+static void RoQ_ExpandCodebook( roq_info_t *roq )
+{
+	int i, j, k, x, y;
+	const roq_cell_t *cell;
+	roq_block4_t *b4;
+	roq_block8_t *b8;
+
+	for( i = 0; i < 256; i++ )
+	{
+		b4 = &roq->qcells4[i];
+		b8 = &roq->qcells8[i];
+
+		for( j = 0; j < 4; j++ )
+		{
+			cell = roq->cells + roq->qcells[i].idx[j];
+			x = ( j & 1 ) * 2;
+			y = ( j & 2 );
+
+			b4->y[y+0][x+0] = cell->y[0];
+			b4->y[y+0][x+1] = cell->y[1];
+			b4->y[y+1][x+0] = cell->y[2];
+			b4->y[y+1][x+1] = cell->y[3];
+			b4->u[y/2][x/2] = cell->u;
+			b4->v[y/2][x/2] = cell->v;
+
+			x *= 2;
+			y *= 2;
+
+			for( k = 0; k < 4; k++ )
+			{
+				b8->y[y+k][x+0] = b8->y[y+k][x+1] = cell->y[( k & 2 ) + 0];
+				b8->y[y+k][x+2] = b8->y[y+k][x+3] = cell->y[( k & 2 ) + 1];
+			}
+			for( k = 0; k < 2; k++ )
+			{
+				b8->u[y/2+k][x/2+0] = b8->u[y/2+k][x/2+1] = cell->u;
+				b8->v[y/2+k][x/2+0] = b8->v[y/2+k][x/2+1] = cell->v;
+			}
+		}
+	}
+}
+
 /*
 * RoQ_ReadCodebook
 */
@@ -201,210 +281,153 @@ static void RoQ_ReadCodebook( cinematics_t *cin )
 
 	trap_FS_Read( roq->cells, sizeof( roq_cell_t )*nv1, cin->file );
 	trap_FS_Read( roq->qcells, sizeof( roq_qcell_t )*nv2, cin->file );
+
+	RoQ_ExpandCodebook( roq );
 }
 
 /*
 * RoQ_ApplyVector2x2
 */
-static void RoQ_ApplyVector2x2( cinematics_t *cin, int xpos, int ypos, const roq_cell_t *cell )
+static inline void RoQ_ApplyVector2x2( const roq_frame_t *f, int xpos, int ypos, const roq_cell_t *cell )
 {
-	uint8_t *dst_y0, *dst_y1;
-	uint8_t *dst_u, *dst_v;
-	roq_info_t *roq = cin->fdata;
-	cin_img_plane_t *plane;
-	int xpos_2 = xpos / 2, ypos_2 = ypos / 2;
-
-	// Y
-	plane = &roq->cyuv[0].yuv[0];
-	dst_y0 = plane->data + ypos * plane->stride + xpos;
-	dst_y1 = dst_y0 + plane->stride;
-
-	// U
-	plane = &roq->cyuv[0].yuv[1];
-	dst_u = plane->data + ypos_2 * plane->stride + xpos_2;
-
-	// V
-	plane = &roq->cyuv[0].yuv[2];
-	dst_v = plane->data + ypos_2 * plane->stride + xpos_2;
-
-	dst_y0[0] = cell->y[0];
-	dst_y0[1] = cell->y[1];
-	dst_y1[0] = cell->y[2];
-	dst_y1[1] = cell->y[3];
-	*dst_u = cell->u;
-	*dst_v = cell->v;
+	uint8_t *dst_y = f->y + ypos * f->stride + xpos;
+	int uv = ( ypos / 2 ) * f->stride_2 + xpos / 2;
+
+	dst_y[0] = cell->y[0];
+	dst_y[1] = cell->y[1];
+	dst_y[f->stride+0] = cell->y[2];
+	dst_y[f->stride+1] = cell->y[3];
+	f->u[uv] = cell->u;
+	f->v[uv] = cell->v;
 }
 
 /*
-* RoQ_ApplyVector4x4
+* RoQ_ApplyBlock4x4
 */
-static void RoQ_ApplyVector4x4( cinematics_t *cin, int xpos, int ypos, const roq_cell_t *cell )
+static inline void RoQ_ApplyBlock4x4( const roq_frame_t *f, int xpos, int ypos, const roq_block4_t *block )
 {
-	uint8_t *dst_y0, *dst_y1;
-	uint8_t *dst_u0, *dst_v0;
-	uint8_t p[4], u[2], v[2];
-	roq_info_t *roq = cin->fdata;
-	cin_img_plane_t *y_plane, *u_plane, *v_plane;
-	int xpos_2 = xpos / 2, ypos_2 = ypos / 2;
-
-	// Y
-	y_plane = &roq->cyuv[0].yuv[0];
-	dst_y0 = y_plane->data + ypos * y_plane->stride + xpos;
-	dst_y1 = dst_y0 + y_plane->stride;
-
-	p[0] = p[1] = cell->y[0];
-	p[2] = p[3] = cell->y[1];
-	*(int *)dst_y0 = *(int *)p;
-	*(int *)dst_y1 = *(int *)p;
-
-	dst_y0 += y_plane->stride * 2;
-	dst_y1 += y_plane->stride * 2;
+	int j;
+	uint8_t *dst_y = f->y + ypos * f->stride + xpos;
+	int uv = ( ypos / 2 ) * f->stride_2 + xpos / 2;
 
-	p[0] = p[1] = cell->y[2];
-	p[2] = p[3] = cell->y[3];
-	*(int *)dst_y0 = *(int *)p;
-	*(int *)dst_y1 = *(int *)p;
+	for( j = 0; j < 4; j++, dst_y += f->stride )
+		memcpy( dst_y, block->y[j], 4 );
 
-	// U
-	u_plane = &roq->cyuv[0].yuv[1];
-	dst_u0 = u_plane->data + ypos_2 * u_plane->stride + xpos_2;
-
-	// V
-	v_plane = &roq->cyuv[0].yuv[2];
-	dst_v0 = v_plane->data + ypos_2 * v_plane->stride + xpos_2;
-
-	u[0] = u[1] = cell->u;
-	v[0] = v[1] = cell->v;
+	for( j = 0; j < 2; j++, uv += f->stride_2 ) {
+		memcpy( f->u + uv, block->u[j], 2 );
+		memcpy( f->v + uv, block->v[j], 2 );
+	}
+}
 
-	*(short *)dst_u0 = *(short *)u;
-	*(short *)dst_v0 = *(short *)v;
+/*
+* RoQ_ApplyBlock8x8
+*/
+static inline void RoQ_ApplyBlock8x8( const roq_frame_t *f, int xpos, int ypos, const roq_block8_t *block )
+{
+	int j;
+	uint8_t *dst_y = f->y + ypos * f->stride + xpos;
+	int uv = ( ypos / 2 ) * f->stride_2 + xpos / 2;
 
-	dst_u0 += u_plane->stride;
-	dst_v0 += v_plane->stride;
+	for( j = 0; j < 8; j++, dst_y += f->stride )
+		memcpy( dst_y, block->y[j], 8 );
 
-	*(short *)dst_u0 = *(short *)u;
-	*(short *)dst_v0 = *(short *)v;
+	for( j = 0; j < 4; j++, uv += f->stride_2 ) {
+		memcpy( f->u + uv, block->u[j], 4 );
+		memcpy( f->v + uv, block->v[j], 4 );
+	}
 }
 
 /*
 * RoQ_ApplyMotion4x4
 */
-static void RoQ_ApplyMotion4x4( cinematics_t *cin, int xpos, int ypos, uint8_t mv, char mean_x, char mean_y )
+static inline void RoQ_ApplyMotion4x4( const roq_frame_t *f, int xpos, int ypos, int xpos1, int ypos1 )
 {
-	int i, j;
-	int xpos_2, ypos_2;
-	int xpos1, ypos1, xpos1_2, ypos1_2;
-	uint8_t *src, *dst;
-	roq_info_t *roq = cin->fdata;
-	cin_img_plane_t *plane, *plane1;
-
-	// calc source coords
-	xpos1 = xpos + 8 - ( mv >> 4 ) - mean_x;
-	ypos1 = ypos + 8 - ( mv & 0xF ) - mean_y;
-
-	xpos_2 = xpos / 2;
-	ypos_2 = ypos / 2;
-	xpos1_2 = xpos1 / 2;
-	ypos1_2 = ypos1 / 2;
+	int j;
+	int dst, src;
 
 	// Y
-	plane  = &roq->cyuv[0].yuv[0];
-	plane1 = &roq->cyuv[1].yuv[0];
-	dst = plane->data  + ( ypos *  plane->stride  + xpos );
-	src = plane1->data + ( ypos1 * plane1->stride + xpos1 );
-	for( j = 0; j < 4; j++ ) {
-		*(int *)dst = *(int *)src;
-		src += plane1->stride;
-		dst += plane->stride;
-	}
+	dst = ypos * f->stride + xpos;
+	src = ypos1 * f->stride + xpos1;
+	for( j = 0; j < 4; j++, dst += f->stride, src += f->stride )
+		memcpy( f->y + dst, f->y1 + src, 4 );
 
 	// UV
-	for( i = 1; i < 3; i++ ) {
-		plane  = &roq->cyuv[0].yuv[i];
-		plane1 = &roq->cyuv[1].yuv[i];
-		dst = plane->data  + ( ypos_2 *  plane->stride  + xpos_2 );
-		src = plane1->data + ( ypos1_2 * plane1->stride + xpos1_2 );
-		for( j = 0; j < 2; j++ ) {
-			*(short *)dst = *(short *)src;
-			src += plane1->stride;
-			dst += plane->stride;
-		}
+	dst = ( ypos / 2 ) * f->stride_2 + xpos / 2;
+	src = ( ypos1 / 2 ) * f->stride_2 + xpos1 / 2;
+	for( j = 0; j < 2; j++, dst += f->stride_2, src += f->stride_2 ) {
+		memcpy( f->u + dst, f->u1 + src, 2 );
+		memcpy( f->v + dst, f->v1 + src, 2 );
 	}
 }
 
 /*
 * RoQ_ApplyMotion8x8
 */
-static void RoQ_ApplyMotion8x8( cinematics_t *cin, int xpos, int ypos, uint8_t mv, char mean_x, char mean_y )
+static inline void RoQ_ApplyMotion8x8( const roq_frame_t *f, int xpos, int ypos, int xpos1, int ypos1 )
 {
-	int i, j;
-	int xpos_2, ypos_2;
-	int xpos1, ypos1, xpos1_2, ypos1_2;
-	uint8_t *src, *dst;
-	roq_info_t *roq = cin->fdata;
-	cin_img_plane_t *plane, *plane1;
-
-	// calc source coords
-	xpos1 = xpos + 8 - ( mv >> 4 ) - mean_x;
-	ypos1 = ypos + 8 - ( mv & 0xF ) - mean_y;
-
-	xpos_2 = xpos / 2;
-	ypos_2 = ypos / 2;
-	xpos1_2 = xpos1 / 2;
-	ypos1_2 = ypos1 / 2;
+	int j;
+	int dst, src;
 
 	// Y
-	plane  = &roq->cyuv[0].yuv[0];
-	plane1 = &roq->cyuv[1].yuv[0];
-	dst = plane->data  + ( ypos *  plane->stride  + xpos );
-	src = plane1->data + ( ypos1 * plane1->stride + xpos1 );
-	for( j = 0; j < 8; j++ ) {
-		memcpy( dst, src, 8 );
-		src += plane1->stride;
-		dst += plane->stride;
-	}
+	dst = ypos * f->stride + xpos;
+	src = ypos1 * f->stride + xpos1;
+	for( j = 0; j < 8; j++, dst += f->stride, src += f->stride )
+		memcpy( f->y + dst, f->y1 + src, 8 );
 
 	// UV
-	for( i = 1; i < 3; i++ ) {
-		plane  = &roq->cyuv[0].yuv[i];
-		plane1 = &roq->cyuv[1].yuv[i];
-		dst = plane->data  + ( ypos_2 *  plane->stride  + xpos_2 );
-		src = plane1->data + ( ypos1_2 * plane1->stride + xpos1_2 );
-		for( j = 0; j < 4; j++ ) {
-			*(int *)dst = *(int *)src;
-			src += plane1->stride;
-			dst += plane->stride;
-		}
+	dst = ( ypos / 2 ) * f->stride_2 + xpos / 2;
+	src = ( ypos1 / 2 ) * f->stride_2 + xpos1 / 2;
+	for( j = 0; j < 4; j++, dst += f->stride_2, src += f->stride_2 ) {
+		memcpy( f->u + dst, f->u1 + src, 4 );
+		memcpy( f->v + dst, f->v1 + src, 4 );
 	}
 }
 
 /*
-* RoQ_ReadVideo
+* RoQ_DecodeVideo
+*
+* Decodes the buffered QUAD_VQ payload into cyuv[0], using cyuv[1] as the
+* previous frame. Touches nothing else in roq_info_t so that it can run on
+* the worker thread while the next chunks are being read.
 */
-#define RoQ_READ_BLOCK	0x4000
-static cin_yuv_t *RoQ_ReadVideo( cinematics_t *cin )
+static void RoQ_DecodeVideo( roq_info_t *roq )
 {
-	roq_info_t *roq = cin->fdata;
-	roq_chunk_t *chunk = &roq->chunk;
 	int i, vqflg, vqflg_pos, vqid;
 	int xpos, ypos, x, y, xp, yp;
+	int width, height, dx, dy;
 	uint8_t c;
-	roq_qcell_t *qcell;
-	uint8_t raw[RoQ_READ_BLOCK];
-	unsigned remaining, bpos, read;
+	const roq_qcell_t *qcell;
+	const uint8_t *p, *end;
+	roq_frame_t f;
+
+	f.y = roq->cyuv[0].yuv[0].data;
+	f.u = roq->cyuv[0].yuv[1].data;
+	f.v = roq->cyuv[0].yuv[2].data;
+	f.y1 = roq->cyuv[1].yuv[0].data;
+	f.u1 = roq->cyuv[1].yuv[1].data;
+	f.v1 = roq->cyuv[1].yuv[2].data;
+	f.stride = roq->cyuv[0].yuv[0].stride;
+	f.stride_2 = roq->cyuv[0].yuv[1].stride;
+
+	width = roq->cyuv[0].width;
+	height = roq->cyuv[0].height;
+
+	// motion vectors are relative to the mean vector in the chunk argument
+	dx = 8 - ( int8_t )( ( roq->vq_argument >> 8 ) & 0xff );
+	dy = 8 - ( int8_t )( roq->vq_argument & 0xff );
+
+	p = roq->vq;
+	end = roq->vq + roq->vq_size;
 
 	vqflg = 0;
 	vqflg_pos = -1;
 	xpos = ypos = 0;
 
-#define RoQ_ReadRaw() read = min( sizeof( raw ), remaining ); remaining -= read; trap_FS_Read( raw, read, cin->file );
-#define RoQ_ReadByte( x ) if( bpos >= read ) { RoQ_ReadRaw(); bpos = 0; } ( x ) = raw[bpos++];
-#define RoQ_ReadShort( x ) if( bpos+1 == read ) { c = raw[bpos]; RoQ_ReadRaw(); ( x ) = ( raw[0] << 8 )|c; bpos = 1; } \
-	else { if( bpos+1 > read ) { RoQ_ReadRaw(); bpos = 0; } ( x ) = ( raw[bpos+1] << 8 )|raw[bpos]; bpos += 2; }
-#define RoQ_ReadFlag() if( vqflg_pos < 0 ) { RoQ_ReadShort( vqflg ); vqflg_pos = 7; } \
+#define RoQ_ReadByte( x ) if( p >= end ) return; ( x ) = *p++;
+#define RoQ_ReadFlag() if( vqflg_pos < 0 ) { if( end - p < 2 ) return; vqflg = ( p[1] << 8 )|p[0]; p += 2; vqflg_pos = 7; } \
 	vqid = ( vqflg >> ( vqflg_pos * 2 ) ) & 0x3; vqflg_pos--;
 
-	for( bpos = read = 0, remaining = chunk->size; bpos < read || remaining; )
+	while( p < end )
 	{
 		for( yp = ypos; yp < ypos + 16; yp += 8 )
 			for( xp = xpos; xp < xpos + 16; xp += 8 )
@@ -418,18 +441,12 @@ static cin_yuv_t *RoQ_ReadVideo( cinematics_t *cin )
 
 				case RoQ_ID_FCC:
 					RoQ_ReadByte( c );
-					RoQ_ApplyMotion8x8( cin, xp, yp, c, 
-						( char )( ( chunk->argument >> 8 ) & 0xff ), 
-						( char )( chunk->argument & 0xff ) );
+					RoQ_ApplyMotion8x8( &f, xp, yp, xp + dx - ( c >> 4 ), yp + dy - ( c & 0xF ) );
 					break;
 
 				case RoQ_ID_SLD:
 					RoQ_ReadByte( c );
-					qcell = roq->qcells + c;
-					RoQ_ApplyVector4x4( cin, xp, yp, roq->cells + qcell->idx[0] );
-					RoQ_ApplyVector4x4( cin, xp+4, yp, roq->cells + qcell->idx[1] );
-					RoQ_ApplyVector4x4( cin, xp, yp+4, roq->cells + qcell->idx[2] );
-					RoQ_ApplyVector4x4( cin, xp+4, yp+4, roq->cells + qcell->idx[3] );
+					RoQ_ApplyBlock8x8( &f, xp, yp, roq->qcells8 + c );
 					break;
 
 				case RoQ_ID_CCC:
@@ -447,57 +464,114 @@ static cin_yuv_t *RoQ_ReadVideo( cinematics_t *cin )
 
 						case RoQ_ID_FCC:
 							RoQ_ReadByte( c );
-							RoQ_ApplyMotion4x4( cin, x, y, c, 
-								( char )( ( chunk->argument >> 8 ) & 0xff ), 
-								( char )( chunk->argument & 0xff ) );
+							RoQ_ApplyMotion4x4( &f, x, y, x + dx - ( c >> 4 ), y + dy - ( c & 0xF ) );
 							break;
 
 						case RoQ_ID_SLD:
 							RoQ_ReadByte( c );
-							qcell = roq->qcells + c;
-							RoQ_ApplyVector2x2( cin, x, y, roq->cells + qcell->idx[0] );
-							RoQ_ApplyVector2x2( cin, x+2, y, roq->cells + qcell->idx[1] );
-							RoQ_ApplyVector2x2( cin, x, y+2, roq->cells + qcell->idx[2] );
-							RoQ_ApplyVector2x2( cin, x+2, y+2, roq->cells + qcell->idx[3] );
+							RoQ_ApplyBlock4x4( &f, x, y, roq->qcells4 + c );
 							break;
 
 						case RoQ_ID_CCC:
-							RoQ_ReadByte( c ); RoQ_ApplyVector2x2( cin, x, y, roq->cells + c );
-							RoQ_ReadByte( c ); RoQ_ApplyVector2x2( cin, x+2, y, roq->cells + c );
-							RoQ_ReadByte( c ); RoQ_ApplyVector2x2( cin, x, y+2, roq->cells + c );
-							RoQ_ReadByte( c ); RoQ_ApplyVector2x2( cin, x+2, y+2, roq->cells + c );
-							break;
-
-						default:
-							Com_DPrintf( "Unknown vq code: %d\n", vqid );
+							if( end - p < 4 )
+								return;
+							qcell = ( const roq_qcell_t * )p;
+							RoQ_ApplyVector2x2( &f, x, y, roq->cells + qcell->idx[0] );
+							RoQ_ApplyVector2x2( &f, x+2, y, roq->cells + qcell->idx[1] );
+							RoQ_ApplyVector2x2( &f, x, y+2, roq->cells + qcell->idx[2] );
+							RoQ_ApplyVector2x2( &f, x+2, y+2, roq->cells + qcell->idx[3] );
+							p += 4;
 							break;
 						}
 					}
 					break;
-
-				default:
-					Com_DPrintf( "Unknown vq code: %d\n", vqid );
-					break;
 				}
 			}
 
 			xpos += 16;
-			if( xpos >= cin->width )
+			if( xpos >= width )
 			{
-				xpos -= cin->width;
+				xpos -= width;
 
 				ypos += 16;
-				if( ypos >= cin->height )
-				{
-					RoQ_SkipBlock( cin, remaining ); // ignore remaining trash
-					break;
-				}
+				if( ypos >= height )
+					break; // ignore remaining trash
 			}
 	}
 
-	return roq->cyuv;
+#undef RoQ_ReadByte
+#undef RoQ_ReadFlag
+}
+
+/*
+* RoQ_DecodeVideoThreadProc
+*/
+static void *RoQ_DecodeVideoThreadProc( void *param )
+{
+	RoQ_DecodeVideo( param );
+	return NULL;
 }
 
+/*
+* RoQ_FinishVideo
+*
+* Waits for the worker thread to finish decoding. Must be called before anything
+* the decoder reads or writes is changed. Returns true if a frame was pending.
+*/
+static bool RoQ_FinishVideo( roq_info_t *roq )
+{
+	if( !roq || !roq->thread )
+		return false;
+
+	trap_Thread_Join( roq->thread );
+	roq->thread = NULL;
+	return true;
+}
+
+/*
+* RoQ_ReadVideo
+*
+* Buffers the QUAD_VQ payload so that it can be decoded away from the file
+*/
+static bool RoQ_ReadVideo( cinematics_t *cin )
+{
+	roq_info_t *roq = cin->fdata;
+	roq_chunk_t *chunk = &roq->chunk;
+	int read;
+	unsigned int size, max_size;
+
+	if( !roq->yuv_pixels )
+	{
+		// no INFO chunk yet
+		RoQ_SkipChunk( cin );
+		return false;
+	}
+
+	// a frame made of nothing but 2x2 cells takes a little over 2 bits
+	// per pixel, anything past that is trash the decoder never reaches
+	max_size = cin->width * cin->height + 16;
+	size = min( chunk->size, max_size );
+
+	if( roq->vq_alloc < size )
+	{
+		if( roq->vq )
+			CIN_Free( roq->vq );
+		roq->vq_alloc = size;
+		roq->vq = CIN_Alloc( cin->mempool, roq->vq_alloc );
+	}
+
+	read = trap_FS_Read( roq->vq, size, cin->file );
+	roq->vq_size = read > 0 ? read : 0;
+	roq->vq_argument = chunk->argument;
+
+	if( chunk->size > size )
+		RoQ_SkipBlock( cin, chunk->size - size );
+
+	return true;
+}
+
+#define RoQ_READ_BLOCK	0x4000
+
 /*
 * RoQ_ReadAudio
 */
@@ -558,12 +632,22 @@ static void RoQ_ReadAudio( cinematics_t *cin )
 
 /*
 * RoQ_ReadNextFrameYUV_CIN
+*
+* Frames are returned one frame late: the one returned is the reference for
+* the frame just read, which is decoded on a worker thread until the next call
 */
 cin_yuv_t *RoQ_ReadNextFrameYUV_CIN( cinematics_t *cin, bool *redraw )
 {
 	roq_info_t *roq = cin->fdata;
 	roq_chunk_t *chunk = &roq->chunk;
 	cin_yuv_t *cyuv = NULL;
+	bool video = false;
+
+	if( RoQ_FinishVideo( roq ) ) {
+		// the frame decoded in the background becomes the reference
+		cin_yuv_t tp;
+		tp = roq->cyuv[0]; roq->cyuv[0] = roq->cyuv[1]; roq->cyuv[1] = tp;
+	}
 
 	while( !trap_FS_Eof( cin->file ) )
 	{
@@ -582,9 +666,11 @@ cin_yuv_t *RoQ_ReadNextFrameYUV_CIN( cinematics_t *cin, bool *redraw )
 			RoQ_ReadAudio( cin );
 		}
 		else if( chunk->id == RoQ_QUAD_VQ ) {
-			*redraw = true;
-			cyuv = RoQ_ReadVideo( cin );
-			break;
+			video = RoQ_ReadVideo( cin );
+			if( video ) {
+				*redraw = true;
+				break;
+			}
 		}
 		else if( chunk->id == RoQ_QUAD_CODEBOOK )
 			RoQ_ReadCodebook( cin );
@@ -592,18 +678,34 @@ cin_yuv_t *RoQ_ReadNextFrameYUV_CIN( cinematics_t *cin, bool *redraw )
 			RoQ_SkipChunk( cin );
 	}
 
-	if( cyuv ) {
+	if( video ) {
 		if( cin->frame > 0 ) {
-			// swap buffers
-			cin_yuv_t tp;
-			tp = roq->cyuv[0]; roq->cyuv[0] = roq->cyuv[1]; roq->cyuv[1] = tp;
+			if( cin_threads->integer )
+				roq->thread = trap_Thread_Create( RoQ_DecodeVideoThreadProc, roq );
+
+			if( roq->thread ) {
+				// swapped once the decoding is finished
+				cyuv = &roq->cyuv[1];
+			} else {
+				cin_yuv_t tp;
+
+				RoQ_DecodeVideo( roq );
+
+				// swap buffers
+				tp = roq->cyuv[0]; roq->cyuv[0] = roq->cyuv[1]; roq->cyuv[1] = tp;
+				cyuv = &roq->cyuv[0];
+			}
 		} else {
 			int i;
+
+			RoQ_DecodeVideo( roq );
+
 			// init back buffer for inter-frame motion compensation
 			for( i = 0; i < 3; i++ ) {
 				memcpy( roq->cyuv[1].yuv[i].data, roq->cyuv[0].yuv[i].data, 
 					roq->cyuv[0].yuv[i].width * roq->cyuv[0].yuv[i].height );
 			}
+			cyuv = &roq->cyuv[0];
 		}
 		cin->frame++;
 	}
@@ -657,7 +759,7 @@ bool RoQ_HasOggAudio_CIN( cinematics_t *cin )
 */
 void RoQ_Shutdown_CIN( cinematics_t *cin )
 {
-
+	RoQ_FinishVideo( cin->fdata );
 }
 
 /*
@@ -665,6 +767,8 @@ void RoQ_Shutdown_CIN( cinematics_t *cin )
 */
 void RoQ_Reset_CIN( cinematics_t *cin )
 {
+	RoQ_FinishVideo( cin->fdata );
+
 	// try again from the beginning if looping
 	trap_FS_Seek( cin->file, cin->headerlen, FS_SEEK_SET );
 }
@@ -206,3 +206,14 @@ static inline void trap_UnloadLibrary( void **lib )
 {
 	CIN_IMPORT.Sys_UnloadLibrary( lib );
 }
+
+// multithreading
+static inline struct qthread_s *trap_Thread_Create( void *(*routine) (void*), void *param )
+{
+	return CIN_IMPORT.Thread_Create( routine, param );
+}
+
+static inline void trap_Thread_Join( struct qthread_s *thread )
+{
+	CIN_IMPORT.Thread_Join( thread );
+}
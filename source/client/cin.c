@@ -137,6 +137,9 @@ void CIN_LoadLibrary( bool verbose )
 	import.Mem_FreePool = &CL_CinModule_MemFreePool;
 	import.Mem_EmptyPool = &CL_CinModule_MemEmptyPool;
 
+	import.Thread_Create = QThread_Create;
+	import.Thread_Join = QThread_Join;
+
 	// load dynamic library
 	cin_export = NULL;
 	if( verbose ) {
@@ -333,7 +333,13 @@ void CL_ReadDemoPackets( void )
 
 	while( cls.demo.playing && ( cl.receivedSnapNum <= 0 || !cl.snapShots[cl.receivedSnapNum&UPDATE_MASK].valid || cl.snapShots[cl.receivedSnapNum&UPDATE_MASK].serverTime < cl.serverTime ) )
 	{
-		CL_ReadDemoMessage();
+		if( cls.demo.benchmark ) {
+			uint64_t start = Sys_Microseconds();
+			CL_ReadDemoMessage();
+			cls.demo.benchmark_parse += Sys_Microseconds() - start;
+		} else {
+			CL_ReadDemoMessage();
+		}
 		if( cls.demo.paused ) {
 			return;
 		}
@@ -585,6 +591,190 @@ void CL_PlayDemoToAvi_f( void )
 	}
 }
 
+#define CL_DEMOBENCH_FRAMETIME	16
+
+typedef struct
+{
+	unsigned int total;
+	unsigned int parse;
+	unsigned int cgame;
+} cl_demobenchframe_t;
+
+// kept between runs, a demo dropped with an error would leak it otherwise
+static cl_demobenchframe_t *demobenchframes;
+static unsigned int demobenchframes_size;
+
+// parsed snapshot sizes, and what their player states take in each snapshot mode
+static struct
+{
+	unsigned int snaps;
+	size_t snapBytes;
+	size_t standardBytes;
+	size_t compactBytes;
+} demobenchsnaps;
+
+/*
+* CL_DemoBench_CompareUInt
+*/
+static int CL_DemoBench_CompareUInt( const void *a, const void *b )
+{
+	unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+	return x < y ? -1 : ( x > y ? 1 : 0 );
+}
+
+/*
+* CL_DemoBench_PrintTimes
+*
+* Sorts the samples in place and prints their distribution in milliseconds
+*/
+static void CL_DemoBench_PrintTimes( const char *name, unsigned int *samples, unsigned int count )
+{
+	unsigned int i;
+	uint64_t total;
+
+	qsort( samples, count, sizeof( *samples ), CL_DemoBench_CompareUInt );
+
+	for( i = 0, total = 0; i < count; i++ )
+		total += samples[i];
+
+	Com_Printf( "%-6s avg %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f ms\n", name,
+		total * 0.001 / count, samples[count * 50 / 100] * 0.001, samples[count * 90 / 100] * 0.001,
+		samples[count * 99 / 100] * 0.001, samples[count - 1] * 0.001 );
+}
+
+/*
+* CL_DemoBenchmarkSnap
+*
+* Re-encodes the player states of a parsed snapshot against its delta base in both
+* snapshot modes. Entity deltas are the same in either, so over a recorded demo this
+* shows what compact snaps save on real traffic.
+*/
+void CL_DemoBenchmarkSnap( snapshot_t *deltaSnap, snapshot_t *snap, size_t snapBytes )
+{
+	int i;
+
+	demobenchsnaps.snaps++;
+	demobenchsnaps.snapBytes += snapBytes;
+	for( i = 0; i < snap->numplayers; i++ )
+	{
+		SNAP_MeasurePlayerstateDelta( deltaSnap && deltaSnap->numplayers > i ? &deltaSnap->playerStates[i] : NULL,
+			&snap->playerStates[i], &demobenchsnaps.standardBytes, &demobenchsnaps.compactBytes );
+	}
+}
+
+/*
+* CL_DemoBenchmark_f
+*
+* demobenchmark <demoname> [msec]
+*
+* Plays a demo back to back on a fixed clock and prints the client frame times. Unlike
+* timedemo it isn't held to the millisecond resolution of the main loop. With
+* "vid_null 1" and "s_module 0" it measures demo parsing and the client game alone,
+* on machines with no GPU. It also prints the snapshot bandwidth of the demo, and what
+* its player states take in the standard and the compact snapshot mode.
+*/
+void CL_DemoBenchmark_f( void )
+{
+	int msec;
+	char *name;
+	unsigned int i, numframes, framecount;
+	uint64_t start, elapsed, frametime;
+	unsigned int *samples;
+
+	if( Cmd_Argc() < 2 )
+	{
+		Com_Printf( "Usage: %s <demoname> [msec]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	msec = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : CL_DEMOBENCH_FRAMETIME;
+	clamp( msec, 1, 100 );
+
+	memset( &demobenchsnaps, 0, sizeof( demobenchsnaps ) );
+
+	name = TempCopyString( Cmd_Argv( 1 ) );
+	CL_StartDemo( name, false );
+	Mem_TempFree( name );
+
+	if( !cls.demo.playing )
+		return;
+	cls.demo.benchmark = true;
+
+	numframes = 0;
+	elapsed = frametime = 0;
+	framecount = cls.framecount;
+
+	// CL_DemoCompleted clears cls.demo, which ends the loop
+	while( cls.demo.playing )
+	{
+		Cbuf_Execute();
+
+		start = Sys_Microseconds();
+		CL_Frame( msec, msec );
+		frametime += Sys_Microseconds() - start;
+
+		// cl_maxfps may have held the frame back
+		if( cls.framecount == framecount )
+			continue;
+		framecount = cls.framecount;
+
+		if( cls.state == CA_ACTIVE && cls.demo.playing )
+		{
+			if( numframes == demobenchframes_size )
+			{
+				demobenchframes_size = max( demobenchframes_size * 2, 4096 );
+				if( demobenchframes )
+					demobenchframes = Mem_Realloc( demobenchframes, demobenchframes_size * sizeof( *demobenchframes ) );
+				else
+					demobenchframes = Mem_ZoneMalloc( demobenchframes_size * sizeof( *demobenchframes ) );
+			}
+
+			demobenchframes[numframes].total = frametime;
+			demobenchframes[numframes].parse = cls.demo.benchmark_parse;
+			demobenchframes[numframes].cgame = cls.demo.benchmark_cgame;
+			numframes++;
+			elapsed += frametime;
+		}
+
+		// loading isn't measured
+		frametime = 0;
+		cls.demo.benchmark_parse = cls.demo.benchmark_cgame = 0;
+	}
+
+	if( !numframes )
+	{
+		Com_Printf( "No frames measured\n" );
+		return;
+	}
+
+	Com_Printf( "%u frames of %i msec in %.3f seconds: %.1f frames per second, %.1fx realtime\n", numframes, msec,
+		elapsed * 0.000001, elapsed ? numframes * 1000000.0 / elapsed : 0.0,
+		elapsed ? numframes * msec * 1000.0 / elapsed : 0.0 );
+
+	samples = Mem_TempMalloc( numframes * sizeof( *samples ) );
+
+	for( i = 0; i < numframes; i++ )
+		samples[i] = demobenchframes[i].total;
+	CL_DemoBench_PrintTimes( "frame", samples, numframes );
+	for( i = 0; i < numframes; i++ )
+		samples[i] = demobenchframes[i].parse;
+	CL_DemoBench_PrintTimes( "parse", samples, numframes );
+	for( i = 0; i < numframes; i++ )
+		samples[i] = demobenchframes[i].cgame;
+	CL_DemoBench_PrintTimes( "cgame", samples, numframes );
+
+	Mem_TempFree( samples );
+
+	if( demobenchsnaps.snaps && demobenchsnaps.snapBytes )
+	{
+		Com_Printf( "%u snapshots, %.1f bytes per snapshot\n", demobenchsnaps.snaps,
+			(double)demobenchsnaps.snapBytes / demobenchsnaps.snaps );
+		Com_Printf( "Player states: %.1f bytes per snapshot standard, %.1f compact (%.1f%% of snapshot bytes saved)\n",
+			(double)demobenchsnaps.standardBytes / demobenchsnaps.snaps, (double)demobenchsnaps.compactBytes / demobenchsnaps.snaps,
+			100.0 * ( (double)demobenchsnaps.standardBytes - (double)demobenchsnaps.compactBytes ) / demobenchsnaps.snapBytes );
+	}
+}
+
 /*
 * CL_ReadDemoMetaData
 */
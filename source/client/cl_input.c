@@ -734,6 +734,110 @@ void IN_ClearState( void )
 	}
 }
 
+//===============================================================================
+//
+//	UCMD RECORDING
+//
+//===============================================================================
+
+static int ucmd_record_file;
+static unsigned int ucmd_record_start;
+static usercmd_t ucmd_record_last;
+
+/*
+* CL_UcmdRecordWrite
+*/
+static void CL_UcmdRecordWrite( const usercmd_t *ucmd )
+{
+	msg_t msg;
+	uint8_t msgbuf[64];
+	usercmd_t cmd;
+
+	if( !ucmd_record_file )
+		return;
+
+	cmd = *ucmd;
+	cmd.serverTimeStamp = cls.realtime - ucmd_record_start;
+
+	MSG_Init( &msg, msgbuf, sizeof( msgbuf ) );
+	MSG_WriteByte( &msg, 0 ); // length, filled in below
+	MSG_WriteDeltaUsercmd( &msg, &ucmd_record_last, &cmd );
+	msgbuf[0] = msg.cursize - 1;
+
+	FS_Write( msgbuf, msg.cursize, ucmd_record_file );
+	ucmd_record_last = cmd;
+}
+
+/*
+* CL_UcmdStop_f
+*/
+static void CL_UcmdStop_f( void )
+{
+	if( !ucmd_record_file )
+	{
+		Com_Printf( "Not recording usercmds.\n" );
+		return;
+	}
+
+	FS_FCloseFile( ucmd_record_file );
+	ucmd_record_file = 0;
+	Com_Printf( "Stopped recording usercmds.\n" );
+}
+
+/*
+* CL_UcmdRecord_f
+*
+* Records the usercmds we send for replaying them with the swarm tool
+*/
+static void CL_UcmdRecord_f( void )
+{
+	char *name;
+	size_t name_size;
+	const char *filename;
+
+	if( Cmd_Argc() < 2 )
+	{
+		Com_Printf( "ucmdrecord <name>\n" );
+		return;
+	}
+
+	if( ucmd_record_file )
+	{
+		Com_Printf( "Already recording usercmds.\n" );
+		return;
+	}
+
+	filename = Cmd_Argv( 1 );
+	name_size = sizeof( char ) * ( strlen( "ucmds/" ) + strlen( filename ) + strlen( UCMDFILE_EXTENSION ) + 1 );
+	name = Mem_TempMalloc( name_size );
+
+	Q_snprintfz( name, name_size, "ucmds/%s", filename );
+	COM_SanitizeFilePath( name );
+	COM_DefaultExtension( name, UCMDFILE_EXTENSION, name_size );
+
+	if( !COM_ValidateRelativeFilename( name ) )
+	{
+		Com_Printf( "Invalid filename.\n" );
+		Mem_TempFree( name );
+		return;
+	}
+
+	if( FS_FOpenFile( name, &ucmd_record_file, FS_WRITE ) == -1 )
+	{
+		Com_Printf( "Error: Couldn't create %s.\n", name );
+		ucmd_record_file = 0;
+		Mem_TempFree( name );
+		return;
+	}
+
+	FS_Write( UCMDFILE_MAGIC, strlen( UCMDFILE_MAGIC ), ucmd_record_file );
+	memset( &ucmd_record_last, 0, sizeof( ucmd_record_last ) );
+	ucmd_record_start = cls.realtime;
+
+	Com_Printf( "Recording usercmds: %s\n", name );
+	Mem_TempFree( name );
+}
+
 static bool in_initialized = false;
 
 /*
@@ -785,6 +889,9 @@ void CL_InitInput( void )
 	Cmd_AddCommand( "+zoom", IN_ZoomDown );
 	Cmd_AddCommand( "-zoom", IN_ZoomUp );
 
+	Cmd_AddCommand( "ucmdrecord", CL_UcmdRecord_f );
+	Cmd_AddCommand( "ucmdstop", CL_UcmdStop_f );
+
 	cl_ucmdMaxResend =	Cvar_Get( "cl_ucmdMaxResend", "3", CVAR_ARCHIVE );
 	cl_ucmdFPS =		Cvar_Get( "cl_ucmdFPS", "62", CVAR_DEVELOPER );
 
@@ -865,6 +972,12 @@ void CL_ShutdownInput( void )
 	Cmd_RemoveCommand( "-special" );
 	Cmd_RemoveCommand( "+zoom" );
 	Cmd_RemoveCommand( "-zoom" );
+
+	if( ucmd_record_file )
+		CL_UcmdStop_f();
+	Cmd_RemoveCommand( "ucmdrecord" );
+	Cmd_RemoveCommand( "ucmdstop" );
+
 	Dynvar_Destroy( Dynvar_Lookup( "m_filterBufferDecay" ) );
 	Dynvar_Destroy( Dynvar_Lookup( "m_filterBufferSize" ) );
 	Mem_ZoneFree( buf_x );
@@ -1066,6 +1179,8 @@ void CL_NewUserCommand( int realmsec )
 	if( ucmd->msec < 1 )
 		ucmd->msec = 1;
 
+	CL_UcmdRecordWrite( ucmd );
+
 	// advance head and init the new command
 	cls.ucmdHead++;
 	ucmd = &cl.cmds[cls.ucmdHead & CMD_MASK];
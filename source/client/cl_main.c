@@ -37,6 +37,7 @@ cvar_t *cl_sleep;
 cvar_t *cl_pps;
 cvar_t *cl_compresspackets;
 cvar_t *cl_shownet;
+cvar_t *cl_compactsnaps;
 
 cvar_t *cl_extrapolationTime;
 cvar_t *cl_extrapolate;
@@ -281,15 +282,19 @@ static void CL_Crash_f( void )
 */
 static void CL_SendConnectPacket( void )
 {
+	int flags;
+
 	userinfo_modified = false;
 
+	flags = cl_compactsnaps->integer ? CONNECT_FLAG_COMPACTSNAPS : 0;
+
 	Com_DPrintf("CL_MM_Initialized: %d, cls.mm_ticket: %u\n", CL_MM_Initialized(), cls.mm_ticket );
 	if( CL_MM_Initialized() && cls.mm_ticket != 0 )
 		Netchan_OutOfBandPrint( cls.socket, &cls.serveraddress, "connect %i %i %i \"%s\" %i %u\n",
-				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), 0, cls.mm_ticket );
+				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), flags, cls.mm_ticket );
 	else
 		Netchan_OutOfBandPrint( cls.socket, &cls.serveraddress, "connect %i %i %i \"%s\" %i\n",
-				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), 0 );
+				APP_PROTOCOL_VERSION, Netchan_GamePort(), cls.challenge, Cvar_Userinfo(), flags );
 }
 
 /*
@@ -2186,6 +2191,7 @@ static void CL_InitLocal( void )
 	cl_masterservers =	Cvar_Get( "masterservers", DEFAULT_MASTER_SERVERS_IPS, 0 );
 
 	cl_shownet =		Cvar_Get( "cl_shownet", "0", 0 );
+	cl_compactsnaps =	Cvar_Get( "cl_compactsnaps", "0", CVAR_ARCHIVE );
 	cl_timeout =		Cvar_Get( "cl_timeout", "120", 0 );
 	cl_timedemo =		Cvar_Get( "timedemo", "0", CVAR_CHEAT );
 	cl_demoavi_video =	Cvar_Get( "cl_demoavi_video", "1", CVAR_ARCHIVE );
@@ -2298,6 +2304,7 @@ static void CL_InitLocal( void )
 	Cmd_AddCommand( "writeconfig", CL_WriteConfig_f );
 	Cmd_AddCommand( "showip", CL_ShowIP_f ); // jal : wsw : print our ip
 	Cmd_AddCommand( "demo", CL_PlayDemo_f );
+	Cmd_AddCommand( "demobenchmark", CL_DemoBenchmark_f );
 	Cmd_AddCommand( "demoavi", CL_PlayDemoToAvi_f );
 	Cmd_AddCommand( "next", CL_SetNext_f );
 	Cmd_AddCommand( "pingserver", CL_PingServer_f );
@@ -2309,6 +2316,7 @@ static void CL_InitLocal( void )
 
 	Cmd_SetCompletionFunc( "writeconfig", CL_CompleteWriteConfigBuildList );
 	Cmd_SetCompletionFunc( "demo", CL_DemoComplete );
+	Cmd_SetCompletionFunc( "demobenchmark", CL_DemoComplete );
 	Cmd_SetCompletionFunc( "demoavi", CL_DemoComplete );
 }
 
@@ -2340,6 +2348,7 @@ static void CL_ShutdownLocal( void )
 	Cmd_RemoveCommand( "writeconfig" );
 	Cmd_RemoveCommand( "showip" );
 	Cmd_RemoveCommand( "demo" );
+	Cmd_RemoveCommand( "demobenchmark" );
 	Cmd_RemoveCommand( "demoavi" );
 	Cmd_RemoveCommand( "next" );
 	Cmd_RemoveCommand( "pingserver" );
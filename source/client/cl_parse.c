@@ -22,7 +22,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "client.h"
 
 static void CL_InitServerDownload( const char *filename, int size, unsigned checksum, bool allow_localhttpdownload,
-							const char *url, bool initial );
+							const char *url, bool windowed, bool initial );
 void CL_StopServerDownload( void );
 
 //=============================================================================
@@ -119,7 +119,7 @@ bool CL_DownloadRequest( const char *filename, bool requestpak )
 	cls.download.requestname = Mem_ZoneMalloc( sizeof( char ) * ( strlen( filename ) + 1 ) );
 	Q_strncpyz( cls.download.requestname, filename, sizeof( char ) * ( strlen( filename ) + 1 ) );
 	cls.download.timeout = Sys_Milliseconds() + 5000;
-	CL_AddReliableCommand( va( "download %i \"%s\"", requestpak, filename ) );
+	CL_AddReliableCommand( va( "download %i \"%s\" 1", requestpak, filename ) ); // 1 = supports windowed download
 
 	return true;
 }
@@ -305,10 +305,11 @@ static void CL_WebDownloadDoneCb( int status, const char *contentType, void *pri
 		unsigned checksum = download.checksum;
 		char *url = ZoneCopyString( download.web_url );
 		bool allow_localhttp = download.web_local_http;
+		bool windowed = download.windowed;
 
 		cls.download.cancelled = true; // remove the temp file
 		CL_StopServerDownload();
-		CL_InitServerDownload( filename, size, checksum, allow_localhttp, url, false );
+		CL_InitServerDownload( filename, size, checksum, allow_localhttp, url, windowed, false );
 		
 		Mem_Free( filename );
 		Mem_Free( url );
@@ -351,7 +352,7 @@ static size_t CL_WebDownloadReadCb( const void *buf, size_t numb, float percenta
 * Hanldles server's initdownload message, starts web or server download if possible
 */
 static void CL_InitServerDownload( const char *filename, int size, unsigned checksum, bool allow_localhttpdownload,
-							  const char *url, bool initial )
+							  const char *url, bool windowed, bool initial )
 {
 	int alloc_size;
 	bool modules_download = false;
@@ -535,6 +536,9 @@ static void CL_InitServerDownload( const char *filename, int size, unsigned chec
 	cls.download.offset = 0;
 	cls.download.baseoffset = 0;
 	cls.download.pending_reconnect = false;
+	cls.download.windowed = windowed;
+	cls.download.received = 0;
+	cls.download.ackpending = false;
 
 	Cvar_ForceSet( "cl_download_name", COM_FileBase( filename ) );
 	Cvar_ForceSet( "cl_download_percent", "0" );
@@ -624,10 +628,13 @@ static void CL_InitServerDownload( const char *filename, int size, unsigned chec
 		return;
 	}
 
+	if( cls.download.windowed && !cls.download.window )
+		cls.download.window = Mem_ZoneMalloc( DOWNLOAD_WINDOW_BLOCKS * DOWNLOAD_BLOCK_SIZE );
+
 	cls.download.timeout = Sys_Milliseconds() + 3000;
 	cls.download.retries = 0;
 
-	CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.name, cls.download.offset ) );
+	CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.origname, cls.download.offset ) );
 }
 
 /*
@@ -640,6 +647,7 @@ static void CL_InitDownload_f( void )
 	int size;
 	unsigned checksum;
 	bool allow_localhttpdownload;
+	bool windowed;
 	
 	// ignore download commands coming from demo files
 	if( cls.demo.playing )
@@ -651,8 +659,9 @@ static void CL_InitDownload_f( void )
 	checksum = strtoul( Cmd_Argv( 3 ), NULL, 10 );
 	allow_localhttpdownload = ( atoi( Cmd_Argv( 4 ) ) != 0 ) && cls.httpbaseurl != NULL;
 	url = Cmd_Argv( 5 );
+	windowed = ( atoi( Cmd_Argv( 6 ) ) != 0 ); // not sent by old servers
 	
-	CL_InitServerDownload( filename, size, checksum, allow_localhttpdownload, url, true );
+	CL_InitServerDownload( filename, size, checksum, allow_localhttpdownload, url, windowed, true );
 }
 
 /*
@@ -675,12 +684,29 @@ void CL_StopServerDownload( void )
 	Mem_ZoneFree( cls.download.tempname );
 	cls.download.tempname = NULL;
 
-	Mem_ZoneFree( cls.download.origname );
+	if( cls.download.windowed && cls.download.origname ) {
+		// the server may still have blocks of this file in flight
+		if( cls.download.stalename )
+			Mem_ZoneFree( cls.download.stalename );
+		cls.download.stalename = cls.download.origname;
+		cls.download.stalesize = cls.download.size;
+	}
+	else {
+		Mem_ZoneFree( cls.download.origname );
+	}
 	cls.download.origname = NULL;
 
 	Mem_ZoneFree( cls.download.web_url );
 	cls.download.web_url = NULL;
 
+	if( cls.download.window ) {
+		Mem_ZoneFree( cls.download.window );
+		cls.download.window = NULL;
+	}
+	cls.download.windowed = false;
+	cls.download.received = 0;
+	cls.download.ackpending = false;
+
 	cls.download.offset = 0;
 	cls.download.size = 0;
 	cls.download.percent = 0;
@@ -704,23 +730,38 @@ static void CL_RetryDownload( void )
 		Com_Printf( "Download timed out: %s\n", cls.download.name );
 
 		// let the server know we're done
-		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.name, -2 ) );
+		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.origname, -2 ) );
 		CL_DownloadDone();
 	}
 	else
 	{
 		cls.download.timeout = Sys_Milliseconds() + 3000;
-		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.name, cls.download.offset ) );
+		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.origname, cls.download.offset ) );
 	}
 }
 
 /*
 * CL_CheckDownloadTimeout
 * Retry downloading if too much time has passed since last download packet was received
+* Also sends pending acknowledgements for windowed downloads
 */
 void CL_CheckDownloadTimeout( void )
 {
-	if( !cls.download.timeout || cls.download.timeout > Sys_Milliseconds() )
+	unsigned int now = Sys_Milliseconds();
+
+	// acknowledge windowed download blocks right away, but as acks are cumulative,
+	// keep only a few of them in flight in the reliable commands buffer
+	if( cls.download.windowed && cls.download.ackpending && cls.download.filenum && !cls.download.web &&
+		now >= cls.download.acktime && cls.reliableSequence - cls.reliableAcknowledge < 4 )
+	{
+		CL_AddReliableCommand( va( "dlack \"%s\" %i %u", cls.download.origname, (int)cls.download.offset,
+			cls.download.received ) );
+		CL_SendMessagesToServer( true );
+		cls.download.ackpending = false;
+		cls.download.acktime = now + 30;
+	}
+
+	if( !cls.download.timeout || cls.download.timeout > now )
 		return;
 
 	if( cls.download.filenum )
@@ -778,11 +819,83 @@ void CL_DownloadCancel_f( void )
 	cls.download.cancelled = true;
 
 	if( !cls.download.web ) {
-		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.name, -2 ) ); // let the server know we're done
+		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.origname, -2 ) ); // let the server know we're done
 		CL_DownloadDone();
 	}
 }
 
+/*
+* CL_WriteDownloadBlock
+* Appends data at current download offset
+*/
+static void CL_WriteDownloadBlock( const uint8_t *data, size_t size )
+{
+	FS_Write( data, size, cls.download.filenum );
+	cls.download.offset += size;
+	cls.download.percent = (double)cls.download.offset / (double)cls.download.size;
+	clamp( cls.download.percent, 0, 1 );
+
+	Cvar_ForceSet( "cl_download_percent", va( "%.1f", cls.download.percent * 100 ) );
+}
+
+/*
+* CL_ParseWindowedDownload
+* Buffers blocks received ahead of the download offset and writes out the contiguous ones.
+* Received blocks are acknowledged from CL_CheckDownloadTimeout.
+*/
+static void CL_ParseWindowedDownload( const uint8_t *data, size_t offset, size_t size )
+{
+	size_t rel, index, slot;
+
+	// acknowledge duplicates too, as they mean our last ack might have been lost
+	cls.download.ackpending = true;
+	cls.download.timeout = Sys_Milliseconds() + 3000;
+	cls.download.retries = 0;
+
+	if( offset < cls.download.offset )
+		return;
+
+	rel = offset - cls.download.offset;
+	index = rel / DOWNLOAD_BLOCK_SIZE;
+	if( rel % DOWNLOAD_BLOCK_SIZE || index >= DOWNLOAD_WINDOW_BLOCKS ||
+		size != min( cls.download.size - offset, DOWNLOAD_BLOCK_SIZE ) )
+		return;
+
+	if( index > 0 )
+	{
+		if( !( cls.download.received & ( 1u << index ) ) )
+		{
+			slot = ( ( offset - cls.download.baseoffset ) / DOWNLOAD_BLOCK_SIZE ) % DOWNLOAD_WINDOW_BLOCKS;
+			memcpy( cls.download.window + slot * DOWNLOAD_BLOCK_SIZE, data, size );
+			cls.download.received |= 1u << index;
+		}
+		return;
+	}
+
+	CL_WriteDownloadBlock( data, size );
+	cls.download.received >>= 1;
+
+	// flush the blocks that were waiting for this one
+	while( cls.download.received & 1 )
+	{
+		slot = ( ( cls.download.offset - cls.download.baseoffset ) / DOWNLOAD_BLOCK_SIZE ) % DOWNLOAD_WINDOW_BLOCKS;
+		CL_WriteDownloadBlock( cls.download.window + slot * DOWNLOAD_BLOCK_SIZE,
+			min( cls.download.size - cls.download.offset, DOWNLOAD_BLOCK_SIZE ) );
+		cls.download.received >>= 1;
+	}
+}
+
+/*
+* CL_IsStaleDownloadBlock
+* 
+* Whether the block belongs to the last windowed download, which already ended
+*/
+static bool CL_IsStaleDownloadBlock( const char *svFilename, size_t offset, size_t size )
+{
+	return cls.download.stalename && !Q_stricmp( cls.download.stalename, svFilename ) &&
+		offset + size <= cls.download.stalesize;
+}
+
 /*
 * CL_ParseDownload
 * Handles download message from the server.
@@ -813,14 +926,16 @@ static void CL_ParseDownload( msg_t *msg )
 
 	if( !cls.download.filenum )
 	{
-		Com_Printf( "Error: Download message while not dowloading\n" );
+		if( !CL_IsStaleDownloadBlock( svFilename, offset, size ) )
+			Com_Printf( "Error: Download message while not dowloading\n" );
 		msg->readcount += size;
 		return;
 	}
 
-	if( Q_stricmp( cls.download.name, svFilename ) )
+	if( Q_stricmp( cls.download.origname, svFilename ) )
 	{
-		Com_Printf( "Error: Download message for wrong file\n" );
+		if( !CL_IsStaleDownloadBlock( svFilename, offset, size ) )
+			Com_Printf( "Error: Download message for wrong file\n" );
 		msg->readcount += size;
 		return;
 	}
@@ -833,37 +948,41 @@ static void CL_ParseDownload( msg_t *msg )
 		return;
 	}
 
-	if( cls.download.offset != offset )
+	if( cls.download.windowed )
 	{
-		Com_Printf( "Error: Download message for wrong position\n" );
+		CL_ParseWindowedDownload( msg->data + msg->readcount, offset, size );
 		msg->readcount += size;
-		CL_RetryDownload();
-		return;
 	}
+	else
+	{
+		if( cls.download.offset != offset )
+		{
+			Com_Printf( "Error: Download message for wrong position\n" );
+			msg->readcount += size;
+			CL_RetryDownload();
+			return;
+		}
 
-	FS_Write( msg->data + msg->readcount, size, cls.download.filenum );
-	msg->readcount += size;
-	cls.download.offset += size;
-	cls.download.percent = (double)cls.download.offset / (double)cls.download.size;
-	clamp( cls.download.percent, 0, 1 );
-
-	Cvar_ForceSet( "cl_download_percent", va( "%.1f", cls.download.percent * 100 ) );
+		CL_WriteDownloadBlock( msg->data + msg->readcount, size );
+		msg->readcount += size;
 
-	if( cls.download.offset < cls.download.size )
-	{
-		cls.download.timeout = Sys_Milliseconds() + 3000;
-		cls.download.retries = 0;
+		if( cls.download.offset < cls.download.size )
+		{
+			cls.download.timeout = Sys_Milliseconds() + 3000;
+			cls.download.retries = 0;
 
-		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.name, cls.download.offset ) );
+			CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.origname, cls.download.offset ) );
+		}
 	}
-	else
+
+	if( cls.download.offset >= cls.download.size )
 	{
 		Com_Printf( "Download complete: %s\n", cls.download.name );
 
 		CL_DownloadComplete();
 
 		// let the server know we're done
-		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.name, -1 ) );
+		CL_AddReliableCommand( va( "nextdl \"%s\" %i", cls.download.origname, -1 ) );
 
 		CL_DownloadDone();
 	}
@@ -1013,6 +1132,7 @@ static void CL_ParseServerData( msg_t *msg )
 	cls.sv_pure = ( sv_bitflags & SV_BITFLAGS_PURE ) != 0;
 	cls.pure_restart = cls.sv_pure && old_sv_pure == false;
 	cls.sv_tv = ( sv_bitflags & SV_BITFLAGS_TVSERVER ) != 0;
+	cls.compactSnaps = ( sv_bitflags & SV_BITFLAGS_COMPACTSNAPS ) != 0;
 
 #ifdef PURE_CHEAT
 	cls.sv_pure = cls.pure_restart = false;
@@ -1044,14 +1164,20 @@ static void CL_ParseFrame( msg_t *msg )
 {
 	snapshot_t *snap, *oldSnap;
 	int delta;
+	size_t start;
 
 	oldSnap = ( cl.receivedSnapNum > 0 ) ? &cl.snapShots[cl.receivedSnapNum & UPDATE_MASK] : NULL;
 
-	snap = SNAP_ParseFrame( msg, oldSnap, &cl.suppressCount, cl.snapShots, cl_baselines, cl_shownet->integer );
+	start = msg->readcount;
+	snap = SNAP_ParseFrame( msg, oldSnap, &cl.suppressCount, cl.snapShots, cl_baselines, cl_shownet->integer,
+		cls.compactSnaps );
 	if( snap->valid )
 	{
 		cl.receivedSnapNum = snap->serverFrame;
 
+		if( cls.demo.benchmark )
+			CL_DemoBenchmarkSnap( snap->delta ? &cl.snapShots[snap->deltaFrameNum & UPDATE_MASK] : NULL, snap, msg->readcount - start );
+
 		if( cls.demo.recording )
 		{
 			if( cls.demo.waiting && !snap->delta )
@@ -1065,7 +1191,7 @@ static void CL_ParseFrame( msg_t *msg )
 
 				// write out messages to hold the startup information
 				SNAP_BeginDemoRecording( cls.demo.file, 0x10000 + cl.servercount, cl.snapFrameTime, 
-					cl.servermessage, cls.reliable ? SV_BITFLAGS_RELIABLE : 0, cls.purelist, 
+					cl.servermessage, ( cls.reliable ? SV_BITFLAGS_RELIABLE : 0 ) | ( cls.compactSnaps ? SV_BITFLAGS_COMPACTSNAPS : 0 ), cls.purelist, 
 					cl.configstrings[0], cl_baselines );
 
 				// the rest of the demo file will be individual frames
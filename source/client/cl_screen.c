@@ -661,7 +661,18 @@ static void SCR_RenderView( float stereo_separation )
 
 	// frame is not valid until we load the CM data
 	if( cl.cms != NULL )
-		CL_GameModule_RenderView( stereo_separation );
+	{
+		if( cls.demo.benchmark )
+		{
+			uint64_t start = Sys_Microseconds();
+			CL_GameModule_RenderView( stereo_separation );
+			cls.demo.benchmark_cgame += Sys_Microseconds() - start;
+		}
+		else
+		{
+			CL_GameModule_RenderView( stereo_separation );
+		}
+	}
 }
 
 //============================================================================
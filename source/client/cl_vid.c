@@ -28,6 +28,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "../qcommon/mod_mem.h"
 
 cvar_t *vid_ref;
+cvar_t *vid_null;			// use the null refresh, never archived so a headless run doesn't stick
 cvar_t *vid_width, *vid_height;
 cvar_t *vid_xpos;          // X coordinate of window position
 cvar_t *vid_ypos;          // Y coordinate of window position
@@ -54,6 +55,7 @@ static bool vid_ref_sound_restart;
 static bool vid_ref_active;
 static bool vid_initialized;
 static bool vid_app_active;
+static bool vid_ref_null;
 
 static void		*vid_ref_libhandle = NULL;
 static mempool_t *vid_ref_mempool = NULL;
@@ -270,6 +272,14 @@ static rserr_t VID_ChangeMode( void )
 */
 static void VID_UnloadRefresh( void )
 {
+	if( vid_ref_null ) {
+		if( vid_ref_active ) {
+			re.Shutdown( false );
+			vid_ref_active = false;
+		}
+		vid_ref_null = false;
+	}
+
 	if( vid_ref_libhandle ) {
 		if( vid_ref_active ) {
 			re.Shutdown( false );
@@ -305,6 +315,19 @@ static struct cinematics_s *VID_RefModule_CIN_Open( const char *name, unsigned i
 	return CIN_Open( name, start_time, CIN_LOOP, yuv, framerate );
 }
 
+/*
+** VID_LoadNullRefresh
+*/
+static void VID_LoadNullRefresh( void )
+{
+	VID_UnloadRefresh();
+	Com_Printf( "Using the null refresh\n" );
+	re = *VID_GetNullRefAPI();
+	vid_ref_null = true;
+	// there is no window to get focus, keep the client from throttling itself
+	vid_app_active = true;
+}
+
 /*
 ** VID_LoadRefresh
 */
@@ -495,7 +518,9 @@ void VID_CheckChanges( void )
 		Cvar_GetLatchedVars( CVAR_LATCH_VIDEO );
 
 load_refresh:
-		if( !VID_LoadRefresh( vid_ref->string ) ) {
+		if( vid_null->integer ) {
+			VID_LoadNullRefresh();
+		} else if( !VID_LoadRefresh( vid_ref->string ) ) {
 			// reset to default
 			if( !Q_stricmp( vid_ref->string, VID_DEFAULTREF ) ) {
 				Sys_Error( "Failed to load default refresh DLL" );
@@ -509,7 +534,7 @@ load_refresh:
 		if( ( vid_width->integer <= 0 ) || ( vid_height->integer <= 0 ) ) {
 			// set the mode to the default
 			int w, h;
-			if( !VID_GetDefaultMode( &w, &h ) ) {
+			if( vid_ref_null || !VID_GetDefaultMode( &w, &h ) ) {
 				w = vid_modes[0].width;
 				h = vid_modes[0].height;
 			}
@@ -673,12 +698,21 @@ void VID_InitModes( void )
 	unsigned int numModes, i;
 	int prevWidth = 0, prevHeight = 0;
 
-	numModes = VID_GetSysModes( vid_modes );
-	if( !numModes )
-		Sys_Error( "Failed to get video modes" );
+	if( vid_null->integer ) {
+		// don't ask the system, there may be no display at all
+		static const vidmode_t nullModes[] = { { 1280, 720 }, { 1920, 1080 } };
 
-	vid_modes = Mem_ZoneMalloc( numModes * sizeof( vidmode_t ) );
-	VID_GetSysModes( vid_modes );
+		numModes = sizeof( nullModes ) / sizeof( nullModes[0] );
+		vid_modes = Mem_ZoneMalloc( sizeof( nullModes ) );
+		memcpy( vid_modes, nullModes, sizeof( nullModes ) );
+	} else {
+		numModes = VID_GetSysModes( vid_modes );
+		if( !numModes )
+			Sys_Error( "Failed to get video modes" );
+
+		vid_modes = Mem_ZoneMalloc( numModes * sizeof( vidmode_t ) );
+		VID_GetSysModes( vid_modes );
+	}
 	qsort( vid_modes, numModes, sizeof( vidmode_t ), (int (*)(const void *, const void *))VID_CompareModes );
 
 	// Remove duplicate modes in case the sys code failed to do so.
@@ -703,10 +737,9 @@ void VID_Init( void )
 	if( vid_initialized )
 		return;
 
-	VID_InitModes();
-
 	/* Create the video variables so we know how to start the graphics drivers */
 	vid_ref = Cvar_Get( "vid_ref", VID_DEFAULTREF, CVAR_ARCHIVE|CVAR_LATCH_VIDEO );
+	vid_null = Cvar_Get( "vid_null", "0", CVAR_LATCH_VIDEO );
 	vid_width = Cvar_Get( "vid_width", "0", CVAR_ARCHIVE|CVAR_LATCH_VIDEO );
 	vid_height = Cvar_Get( "vid_height", "0", CVAR_ARCHIVE|CVAR_LATCH_VIDEO );
 	vid_xpos = Cvar_Get( "vid_xpos", "0", CVAR_ARCHIVE );
@@ -719,6 +752,8 @@ void VID_Init( void )
 	win_noalttab = Cvar_Get( "win_noalttab", "0", CVAR_ARCHIVE );
 	win_nowinkeys = Cvar_Get( "win_nowinkeys", "1", CVAR_ARCHIVE );
 
+	VID_InitModes();
+
 	/* Add some console commands that we want to handle */
 	Cmd_AddCommand( "vid_restart", VID_Restart_f );
 	Cmd_AddCommand( "vid_modelist", VID_ModeList_f );
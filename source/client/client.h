@@ -162,6 +162,15 @@ typedef struct
 	int retries;
 	size_t baseoffset;				// for download speed calculation when resuming downloads
 
+	// windowed server download
+	bool windowed;              // server acknowledged windowed download mode
+	uint8_t *window;                // blocks received ahead of offset, indexed by block number
+	unsigned int received;          // bitmask of buffered blocks past offset
+	bool ackpending;
+	unsigned int acktime;
+	char *stalename;                // last windowed download, its late and resent blocks are dropped silently
+	size_t stalesize;
+
 	// web download
 	bool web;
 	bool web_official;
@@ -203,6 +212,11 @@ typedef struct
 
 	char meta_data[SNAP_MAX_DEMO_META_DATA_SIZE];
 	size_t meta_data_realsize;
+
+	// demobenchmark, microseconds spent since the last measured frame
+	bool benchmark;
+	uint64_t benchmark_parse;
+	uint64_t benchmark_cgame;
 } cl_demo_t;
 
 typedef cl_demo_t demorec_t;
@@ -295,6 +309,7 @@ typedef struct
 	// pure list
 	bool sv_pure;
 	bool sv_tv;
+	bool compactSnaps;		// server sends compact player state coordinates
 	bool pure_restart;
 
 	purelist_t *purelist;
@@ -327,6 +342,7 @@ extern cvar_t *cl_anglespeedkey;
 
 extern cvar_t *cl_compresspackets;
 extern cvar_t *cl_shownet;
+extern cvar_t *cl_compactsnaps;
 
 extern cvar_t *cl_extrapolationTime;
 extern cvar_t *cl_extrapolate;
@@ -565,6 +581,8 @@ void CL_WriteDemoMessage( msg_t *msg );
 void CL_DemoCompleted( void );
 void CL_PlayDemo_f( void );
 void CL_PlayDemoToAvi_f( void );
+void CL_DemoBenchmark_f( void );
+void CL_DemoBenchmarkSnap( snapshot_t *deltaSnap, snapshot_t *snap, size_t snapBytes );
 void CL_ReadDemoPackets( void );
 void CL_LatchedDemoJump( void );
 void CL_Stop_f( void );
@@ -640,6 +658,11 @@ extern float scr_conlines;       // lines of console to display
 
 extern ref_export_t re;		// interface to refresh .dll
 
+//
+// vid_null.c
+//
+ref_export_t *VID_GetNullRefAPI( void );
+
 //
 // cl_mm.c
 //
@@ -78,7 +78,7 @@ void GT_asCallSpawn( void )
 	if( error < 0 ) 
 		return;
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -98,7 +98,7 @@ void GT_asCallMatchStateStarted( void )
 	if( error < 0 ) 
 		return;
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -122,7 +122,7 @@ bool GT_asCallMatchStateFinished( int incomingMatchState )
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgDWord( 0, incomingMatchState );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -147,7 +147,7 @@ void GT_asCallThinkRules( void )
 	if( error < 0 ) 
 		return;
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -172,7 +172,7 @@ void GT_asCallPlayerRespawn( edict_t *ent, int old_team, int new_team )
 	ctx->SetArgDWord( 1, old_team );
 	ctx->SetArgDWord( 2, new_team );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -207,7 +207,7 @@ void GT_asCallScoreEvent( gclient_t *client, const char *score_event, const char
 	ctx->SetArgObject( 1, s1 );
 	ctx->SetArgObject( 2, s2 );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -237,7 +237,7 @@ void GT_asCallScoreboardMessage( unsigned int maxlen )
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgDWord( 0, maxlen );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -267,7 +267,7 @@ edict_t *GT_asCallSelectSpawnPoint( edict_t *ent )
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -307,7 +307,7 @@ bool GT_asCallGameCommand( gclient_t *client, const char *cmd, const char *args,
 	ctx->SetArgObject( 2, s2 );
 	ctx->SetArgDWord( 3, argc );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -336,7 +336,7 @@ bool GT_asCallBotStatus( edict_t *ent )
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -359,7 +359,7 @@ void GT_asCallShutdown( void )
 	if( error < 0 ) 
 		return;
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -388,7 +388,7 @@ float GT_asCallVotePower( gclient_t *client, const char *votename, bool voted, b
 	ctx->SetArgByte( 2, voted );
 	ctx->SetArgByte( 3, yes );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 
@@ -548,7 +548,7 @@ static bool G_asInitializeGametypeScript( asIScriptModule *asModule )
 	if( error < 0 ) 
 		return false;
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		return false;
 
@@ -559,9 +559,12 @@ bool GT_asLoadScript( const char *gametypeName )
 {
 	const char *moduleName = GAMETYPE_SCRIPTS_MODULE_NAME;
 	asIScriptModule *asModule;
+	unsigned int starttime;
 
 	GT_ResetScriptData();
 
+	starttime = trap_Milliseconds();
+
 	// Load the script
 	asModule = G_LoadGameScript( moduleName, GAMETYPE_SCRIPTS_DIRECTORY, gametypeName, GAMETYPE_PROJECT_EXTENSION );
 	if( asModule == NULL ) {
@@ -574,5 +577,7 @@ bool GT_asLoadScript( const char *gametypeName )
 		return false;
 	}
 
+	G_Printf( "* Gametype '%s' loaded in %u ms\n", gametypeName, trap_Milliseconds() - starttime );
+
 	return true;
 }
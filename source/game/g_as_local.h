@@ -40,4 +40,5 @@ extern angelwrap_api_t *angelExport;
 #define GAME_AS_ENGINE()					(static_cast<asIScriptEngine *>(game.asEngine))
 
 asIScriptModule *G_LoadGameScript( const char *moduleName, const char *dir, const char *filename, const char *ext );
-bool G_ExecutionErrorReport( int error );
\ No newline at end of file
+bool G_ExecutionErrorReport( int error );
+int G_asExecute( asIScriptContext *ctx );
@@ -0,0 +1,474 @@
+/*
+Copyright (C) 2012 Chasseur de bots
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "g_local.h"
+#include "g_as_local.h"
+
+/*
+* Script profiler
+*
+* With g_asProfile enabled, every script callback run by the game goes through
+* G_asExecute, which accounts its wall time to the script function it enters.
+* A callback run from within another one, e.g. through a game function called by
+* the script, is only charged to the inner callback.
+* While the callback runs, the context line callback takes a sample of the
+* script call stack every g_asProfileInterval microseconds. Samples are kept as
+* folded stacks ("outer;inner;leaf"), which is what flamegraph.pl reads.
+*/
+
+#define ASPROF_HASH_SIZE		256
+#define ASPROF_MAX_STACK		1024
+#define ASPROF_MAX_NESTING		32
+
+typedef struct g_asprofentry_s
+{
+	char *name;
+	unsigned int hashKey;
+
+	unsigned int calls;
+	uint64_t time;
+	uint64_t maxTime;
+
+	unsigned int samples;
+	unsigned int selfSamples;
+	unsigned int stamp;
+
+	struct g_asprofentry_s *hashNext;
+	struct g_asprofentry_s *next;
+} g_asprofentry_t;
+
+typedef struct
+{
+	g_asprofentry_t *hash[ASPROF_HASH_SIZE];
+	g_asprofentry_t *list;
+	unsigned int count;
+} g_asproftable_t;
+
+static struct
+{
+	g_asproftable_t callbacks;
+	g_asproftable_t stacks;
+
+	unsigned int frames;
+	unsigned int samples;
+	uint64_t nextSample;
+
+	// callbacks being executed, outermost first
+	struct
+	{
+		asIScriptContext *ctx;
+		uint64_t childTime;
+	} running[ASPROF_MAX_NESTING];
+	int numRunning;
+} asprof;
+
+/*
+* G_asProfileHashKey
+*/
+static unsigned int G_asProfileHashKey( const char *name )
+{
+	unsigned int hash = 2166136261u;
+
+	while( *name )
+	{
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/*
+* G_asProfileFindEntry
+*/
+static g_asprofentry_t *G_asProfileFindEntry( g_asproftable_t *table, const char *name )
+{
+	unsigned int hashKey = G_asProfileHashKey( name );
+	g_asprofentry_t *entry;
+	size_t len;
+
+	for( entry = table->hash[hashKey % ASPROF_HASH_SIZE]; entry; entry = entry->hashNext )
+	{
+		if( entry->hashKey == hashKey && !strcmp( entry->name, name ) )
+			return entry;
+	}
+
+	len = strlen( name );
+	entry = ( g_asprofentry_t * )G_Malloc( sizeof( *entry ) + len + 1 );
+	entry->name = ( char * )( entry + 1 );
+	memcpy( entry->name, name, len + 1 );
+	entry->hashKey = hashKey;
+	entry->calls = 0;
+	entry->time = entry->maxTime = 0;
+	entry->samples = entry->selfSamples = entry->stamp = 0;
+
+	entry->hashNext = table->hash[hashKey % ASPROF_HASH_SIZE];
+	table->hash[hashKey % ASPROF_HASH_SIZE] = entry;
+	entry->next = table->list;
+	table->list = entry;
+	table->count++;
+
+	return entry;
+}
+
+/*
+* G_asProfileFreeTable
+*/
+static void G_asProfileFreeTable( g_asproftable_t *table )
+{
+	g_asprofentry_t *entry, *next;
+
+	for( entry = table->list; entry; entry = next )
+	{
+		next = entry->next;
+		G_Free( entry );
+	}
+	memset( table, 0, sizeof( *table ) );
+}
+
+/*
+* G_asProfileFunctionName
+*/
+static void G_asProfileFunctionName( asIScriptFunction *func, char *name, size_t size )
+{
+	const char *objName;
+
+	if( !func )
+	{
+		Q_strncpyz( name, "?", size );
+		return;
+	}
+
+	objName = func->GetObjectName();
+	if( objName )
+		Q_snprintfz( name, size, "%s::%s", objName, func->GetName() );
+	else
+		Q_strncpyz( name, func->GetName(), size );
+}
+
+/*
+* G_asProfileSample
+* records the folded call stack of the context, outermost function first
+*/
+static void G_asProfileSample( asIScriptContext *ctx )
+{
+	int level;
+	size_t len = 0;
+	char stack[ASPROF_MAX_STACK], name[MAX_QPATH];
+
+	stack[0] = '\0';
+	for( level = (int)ctx->GetCallstackSize() - 1; level >= 0; level-- )
+	{
+		G_asProfileFunctionName( ctx->GetFunction( level ), name, sizeof( name ) );
+		if( len + strlen( name ) + 2 >= sizeof( stack ) )
+			break;
+		if( len )
+			stack[len++] = ';';
+		Q_strncpyz( stack + len, name, sizeof( stack ) - len );
+		len += strlen( name );
+	}
+
+	if( len )
+	{
+		G_asProfileFindEntry( &asprof.stacks, stack )->samples++;
+		asprof.samples++;
+	}
+}
+
+/*
+* G_asProfileLineCallback
+*/
+static void G_asProfileLineCallback( asIScriptContext *ctx, void *param )
+{
+	uint64_t now = trap_Microseconds();
+
+	if( now < asprof.nextSample )
+		return;
+
+	asprof.nextSample = now + max( g_asProfileInterval->integer, 1 );
+	G_asProfileSample( ctx );
+}
+
+/*
+* G_asExecute
+* executes a prepared context, timing the callback when the profiler is enabled
+*/
+int G_asExecute( asIScriptContext *ctx )
+{
+	int i, error, level;
+	bool outerCallback;
+	uint64_t start, time;
+	char name[MAX_QPATH];
+	g_asprofentry_t *callback;
+
+	if( !g_asProfile->integer || asprof.numRunning == ASPROF_MAX_NESTING )
+		return ctx->Execute();
+
+	G_asProfileFunctionName( ctx->GetFunction(), name, sizeof( name ) );
+
+	// a nested call may run on a context an outer call is using, which keeps its line callback
+	outerCallback = false;
+	for( i = 0; i < asprof.numRunning; i++ )
+	{
+		if( asprof.running[i].ctx == ctx )
+			outerCallback = true;
+	}
+
+	level = asprof.numRunning++;
+	asprof.running[level].ctx = ctx;
+	asprof.running[level].childTime = 0;
+
+	ctx->SetLineCallback( asFUNCTION( G_asProfileLineCallback ), NULL, asCALL_CDECL );
+
+	start = trap_Microseconds();
+	error = ctx->Execute();
+	time = trap_Microseconds() - start;
+
+	if( !outerCallback )
+		ctx->ClearLineCallback();
+
+	asprof.numRunning--;
+	if( level > 0 )
+		asprof.running[level - 1].childTime += time;
+
+	// nested callbacks were charged on their own
+	time -= min( asprof.running[level].childTime, time );
+
+	callback = G_asProfileFindEntry( &asprof.callbacks, name );
+	callback->calls++;
+	callback->time += time;
+	if( time > callback->maxTime )
+		callback->maxTime = time;
+
+	return error;
+}
+
+/*
+* G_asProfileFrame
+*/
+void G_asProfileFrame( void )
+{
+	if( g_asProfile->integer )
+		asprof.frames++;
+}
+
+/*
+* G_asProfileReset
+*/
+static void G_asProfileReset( void )
+{
+	G_asProfileFreeTable( &asprof.callbacks );
+	G_asProfileFreeTable( &asprof.stacks );
+	asprof.frames = 0;
+	asprof.samples = 0;
+	asprof.nextSample = 0;
+}
+
+/*
+* G_asProfileBuildFlatProfile
+* turns the folded stacks into per function inclusive and self sample counts
+*/
+static void G_asProfileBuildFlatProfile( g_asproftable_t *functions )
+{
+	g_asprofentry_t *stack, *func;
+	char *p, *sep;
+	unsigned int stamp = 0;
+	char frames[ASPROF_MAX_STACK];
+
+	memset( functions, 0, sizeof( *functions ) );
+
+	for( stack = asprof.stacks.list; stack; stack = stack->next )
+	{
+		stamp++;
+		Q_strncpyz( frames, stack->name, sizeof( frames ) );
+
+		for( p = frames; p; p = sep )
+		{
+			sep = strchr( p, ';' );
+			if( sep )
+				*sep++ = '\0';
+
+			func = G_asProfileFindEntry( functions, p );
+
+			// recursive functions only count once per stack
+			if( func->stamp != stamp )
+			{
+				func->stamp = stamp;
+				func->samples += stack->samples;
+			}
+			if( !sep )
+				func->selfSamples += stack->samples;
+		}
+	}
+}
+
+/*
+* G_asProfileCompareEntries
+*/
+static int G_asProfileCompareEntries( const void *a, const void *b )
+{
+	const g_asprofentry_t *e1 = *( const g_asprofentry_t ** )a;
+	const g_asprofentry_t *e2 = *( const g_asprofentry_t ** )b;
+
+	if( e1->time != e2->time )
+		return e1->time > e2->time ? -1 : 1;
+	return (int)e2->selfSamples - (int)e1->selfSamples;
+}
+
+/*
+* G_asProfileSortEntries
+*/
+static g_asprofentry_t **G_asProfileSortEntries( g_asproftable_t *table )
+{
+	unsigned int i;
+	g_asprofentry_t *entry, **sorted;
+
+	sorted = ( g_asprofentry_t ** )G_Malloc( ( table->count + 1 ) * sizeof( *sorted ) );
+	for( i = 0, entry = table->list; entry; entry = entry->next )
+		sorted[i++] = entry;
+	qsort( sorted, table->count, sizeof( *sorted ), G_asProfileCompareEntries );
+
+	return sorted;
+}
+
+/*
+* G_asProfilePrintCallbacks
+*/
+static void G_asProfilePrintCallbacks( int file )
+{
+	unsigned int i, frames = max( asprof.frames, 1 );
+	g_asprofentry_t **sorted, *e;
+	char string[1024];
+
+	Q_snprintfz( string, sizeof( string ), "%u frames, %u samples\n\n%-40s %8s %10s %10s %10s %10s\n",
+		asprof.frames, asprof.samples, "callback", "calls", "total ms", "ms/frame", "avg us", "max us" );
+	if( file )
+		trap_FS_Print( file, string );
+	else
+		G_Printf( "%s", string );
+
+	sorted = G_asProfileSortEntries( &asprof.callbacks );
+	for( i = 0; i < asprof.callbacks.count; i++ )
+	{
+		e = sorted[i];
+		Q_snprintfz( string, sizeof( string ), "%-40s %8u %10.2f %10.3f %10.1f %10u\n", e->name, e->calls,
+			e->time * 0.001, e->time * 0.001 / frames, (double)e->time / max( e->calls, 1 ), (unsigned)e->maxTime );
+		if( file )
+			trap_FS_Print( file, string );
+		else
+			G_Printf( "%s", string );
+	}
+	G_Free( sorted );
+}
+
+/*
+* G_asProfileDump
+* writes <name>.txt with the flat profile and <name>.folded with the stacks
+*/
+static void G_asProfileDump( const char *name )
+{
+	int file;
+	unsigned int i;
+	g_asproftable_t functions;
+	g_asprofentry_t *e, **sorted;
+	char filename[MAX_QPATH], string[ASPROF_MAX_STACK + 32];
+
+	Q_snprintfz( filename, sizeof( filename ), "%s.txt", name );
+	COM_SanitizeFilePath( filename );
+	if( trap_FS_FOpenFile( filename, &file, FS_WRITE ) == -1 )
+	{
+		G_Printf( "G_asProfileDump: Couldn't write %s.\n", filename );
+		return;
+	}
+
+	G_asProfilePrintCallbacks( file );
+
+	G_asProfileBuildFlatProfile( &functions );
+	sorted = G_asProfileSortEntries( &functions );
+
+	Q_snprintfz( string, sizeof( string ), "\n%-40s %10s %8s %10s %8s\n", "function", "self", "self %", "total", "total %" );
+	trap_FS_Print( file, string );
+	for( i = 0; i < functions.count; i++ )
+	{
+		e = sorted[i];
+		Q_snprintfz( string, sizeof( string ), "%-40s %10u %7.2f%% %10u %7.2f%%\n", e->name,
+			e->selfSamples, 100.0 * e->selfSamples / max( asprof.samples, 1 ),
+			e->samples, 100.0 * e->samples / max( asprof.samples, 1 ) );
+		trap_FS_Print( file, string );
+	}
+
+	G_Free( sorted );
+	G_asProfileFreeTable( &functions );
+	trap_FS_FCloseFile( file );
+	G_Printf( "Wrote %s\n", filename );
+
+	Q_snprintfz( filename, sizeof( filename ), "%s.folded", name );
+	COM_SanitizeFilePath( filename );
+	if( trap_FS_FOpenFile( filename, &file, FS_WRITE ) == -1 )
+	{
+		G_Printf( "G_asProfileDump: Couldn't write %s.\n", filename );
+		return;
+	}
+
+	for( e = asprof.stacks.list; e; e = e->next )
+	{
+		Q_snprintfz( string, sizeof( string ), "%s %u\n", e->name, e->samples );
+		trap_FS_Print( file, string );
+	}
+
+	trap_FS_FCloseFile( file );
+	G_Printf( "Wrote %s\n", filename );
+}
+
+/*
+* G_asProfile_f
+* "asprofile [dump [name] | reset]"
+*/
+void G_asProfile_f( void )
+{
+	const char *cmd = trap_Cmd_Argv( 1 );
+
+	if( !Q_stricmp( cmd, "reset" ) )
+	{
+		G_asProfileReset();
+		return;
+	}
+
+	if( !Q_stricmp( cmd, "dump" ) )
+	{
+		G_asProfileDump( trap_Cmd_Argc() > 2 ? trap_Cmd_Argv( 2 ) : "asprofile" );
+		return;
+	}
+
+	if( !g_asProfile->integer && !asprof.callbacks.count )
+	{
+		G_Printf( "Script profiler is disabled, set g_asProfile 1 to enable it\n" );
+		return;
+	}
+
+	G_asProfilePrintCallbacks( 0 );
+}
+
+/*
+* G_asProfileShutdown
+*/
+void G_asProfileShutdown( void )
+{
+	G_asProfileReset();
+}
@@ -2290,6 +2290,16 @@ static bool objectGameEntity_IsGhosting( edict_t *self )
 	return G_ISGHOSTING( self ) ? true : false;
 }
 
+static int objectGameEntity_GetSolid( edict_t *self )
+{
+	return self->r.solid;
+}
+
+static void objectGameEntity_SetSolid( int solid, edict_t *self )
+{
+	GClip_SetEntitySolid( self, solid );
+}
+
 static int objectGameEntity_EntNum( edict_t *self )
 {
 	return ( ENTNUM( self ) );
@@ -2584,6 +2594,8 @@ static const asMethod_t gedict_Methods[] =
 	{ ASLIB_FUNCTION_DECL(void, setSize, (const Vec3 &in, const Vec3 &in)), asFUNCTION(objectGameEntity_SetSize), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(Vec3, get_movedir, () const), asFUNCTION(objectGameEntity_GetMovedir), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, set_movedir, ()), asFUNCTION(objectGameEntity_SetMovedir), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL(int, get_solid, () const), asFUNCTION(objectGameEntity_GetSolid), asCALL_CDECL_OBJLAST },
+	{ ASLIB_FUNCTION_DECL(void, set_solid, (int)), asFUNCTION(objectGameEntity_SetSolid), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(bool, isBrushModel, () const), asFUNCTION(objectGameEntity_isBrushModel), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, freeEntity, ()), asFUNCTION(G_FreeEdict), asCALL_CDECL_OBJLAST },
 	{ ASLIB_FUNCTION_DECL(void, linkEntity, ()), asFUNCTION(GClip_LinkEntity), asCALL_CDECL_OBJLAST },
@@ -2647,7 +2659,6 @@ static const asProperty_t gedict_Properties[] =
 	{ ASLIB_PROPERTY_DECL(int, light), ASLIB_FOFFSET(edict_t, s.light) },
 	{ ASLIB_PROPERTY_DECL(const bool, inuse), ASLIB_FOFFSET(edict_t, r.inuse) },
 	{ ASLIB_PROPERTY_DECL(uint, svflags), ASLIB_FOFFSET(edict_t, r.svflags) },
-	{ ASLIB_PROPERTY_DECL(int, solid), ASLIB_FOFFSET(edict_t, r.solid) },
 	{ ASLIB_PROPERTY_DECL(int, clipMask), ASLIB_FOFFSET(edict_t, r.clipmask) },
 	{ ASLIB_PROPERTY_DECL(int, spawnFlags), ASLIB_FOFFSET(edict_t, spawnflags) },
 	{ ASLIB_PROPERTY_DECL(int, style), ASLIB_FOFFSET(edict_t, style) },
@@ -3690,7 +3701,7 @@ bool G_asCallMapEntitySpawnScript( const char *classname, edict_t *ent )
 	// Now we need to pass the parameters to the script function.
 	asContext->SetArgObject( 0, ent );
 
-	error = asContext->Execute();
+	error = G_asExecute( asContext );
 	if( G_ExecutionErrorReport( error ) )
 	{
 		GT_asShutdownScript();
@@ -3780,7 +3791,7 @@ void G_asCallMapEntityThink( edict_t *ent )
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -3816,7 +3827,7 @@ void G_asCallMapEntityTouch( edict_t *ent, edict_t *other, cplane_t *plane, int
 	ctx->SetArgObject( 2, &normal );
 	ctx->SetArgDWord( 3, surfFlags );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -3841,7 +3852,7 @@ void G_asCallMapEntityUse( edict_t *ent, edict_t *other, edict_t *activator )
 	ctx->SetArgObject( 1, other );
 	ctx->SetArgObject( 2, activator );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -3867,7 +3878,7 @@ void G_asCallMapEntityPain( edict_t *ent, edict_t *other, float kick, float dama
 	ctx->SetArgFloat( 2, kick );
 	ctx->SetArgFloat( 3, damage );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -3892,7 +3903,7 @@ void G_asCallMapEntityDie( edict_t *ent, edict_t *inflicter, edict_t *attacker,
 	ctx->SetArgObject( 1, inflicter );
 	ctx->SetArgObject( 2, attacker );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -3915,7 +3926,7 @@ void G_asCallMapEntityStop( edict_t *ent )
 	// Now we need to pass the parameters to the script function.
 	ctx->SetArgObject( 0, ent );
 
-	error = ctx->Execute();
+	error = G_asExecute( ctx );
 	if( G_ExecutionErrorReport( error ) )
 		GT_asShutdownScript();
 }
@@ -3974,14 +3985,243 @@ static char *G_LoadScriptSection( const char *dir, const char *script, int secti
 	return (char *)data;
 }
 
+//=======================================================================
+
+#define G_SCRIPTCACHE_DIRECTORY		"cache/scripts"
+#define G_SCRIPTCACHE_EXTENSION		".asb"
+#define G_SCRIPTCACHE_MAGIC			"WSAB"
+#define G_SCRIPTCACHE_VERSION		1
+
+typedef struct
+{
+	char magic[4];
+	int version;
+	uint64_t hash;
+	int bytecodeSize;
+} g_scriptcache_header_t;
+
+/*
+* G_ScriptBytecodeStream
+* memory stream for saving and loading module bytecode
+*/
+class G_ScriptBytecodeStream : public asIBinaryStream
+{
+	uint8_t *data;
+	size_t size;
+	size_t allocated;
+	size_t offset;
+
+public:
+	G_ScriptBytecodeStream() : data( NULL ), size( 0 ), allocated( 0 ), offset( 0 ) {}
+	G_ScriptBytecodeStream( uint8_t *_data, size_t _size ) : data( _data ), size( _size ), allocated( 0 ), offset( 0 ) {}
+	~G_ScriptBytecodeStream() { if( allocated ) G_Free( data ); }
+
+	const uint8_t *getData( void ) const { return data; }
+	size_t getSize( void ) const { return size; }
+
+	int Read( void *ptr, asUINT len )
+	{
+		if( offset + len > size )
+			return -1;
+		memcpy( ptr, data + offset, len );
+		offset += len;
+		return 0;
+	}
+
+	int Write( const void *ptr, asUINT len )
+	{
+		if( size + len > allocated ) {
+			size_t newsize = max( allocated * 2, size + len + 0x10000 );
+			uint8_t *newdata = ( uint8_t * )G_Malloc( newsize );
+			if( size )
+				memcpy( newdata, data, size );
+			if( allocated )
+				G_Free( data );
+			data = newdata;
+			allocated = newsize;
+		}
+		memcpy( data + size, ptr, len );
+		size += len;
+		return 0;
+	}
+};
+
+/*
+* G_ScriptHash
+* FNV-1a
+*/
+static uint64_t G_ScriptHash( uint64_t hash, const void *data, size_t len )
+{
+	const uint8_t *p = ( const uint8_t * )data;
+
+	while( len-- ) {
+		hash ^= *p++;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/*
+* G_ScriptCacheHash
+* 
+* The key covers the section names and contents, the angelscript and game
+* API versions and the shape of the registered script interface (down to
+* the method and property counts of each type), so
+* stale bytecode is never loaded after the sources or the game module change.
+*/
+static uint64_t G_ScriptCacheHash( asIScriptEngine *asEngine, const char *scriptName, 
+	int numSections, char **sectionNames, char **sections )
+{
+	int i, counts[5];
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	hash = G_ScriptHash( hash, ANGELSCRIPT_VERSION_STRING, strlen( ANGELSCRIPT_VERSION_STRING ) );
+	counts[0] = GAME_API_VERSION;
+	counts[1] = asEngine->GetGlobalFunctionCount();
+	counts[2] = asEngine->GetObjectTypeCount();
+	counts[3] = asEngine->GetGlobalPropertyCount();
+	counts[4] = asEngine->GetEnumCount();
+	hash = G_ScriptHash( hash, counts, sizeof( counts ) );
+
+	// a property turned into accessors keeps the counts above but not the bytecode
+	for( i = 0; i < (int)asEngine->GetObjectTypeCount(); i++ ) {
+		asITypeInfo *type = asEngine->GetObjectTypeByIndex( i );
+		counts[0] = type->GetMethodCount();
+		counts[1] = type->GetPropertyCount();
+		hash = G_ScriptHash( hash, counts, 2 * sizeof( counts[0] ) );
+	}
+
+	hash = G_ScriptHash( hash, scriptName, strlen( scriptName ) + 1 );
+	for( i = 0; i < numSections; i++ ) {
+		hash = G_ScriptHash( hash, sectionNames[i], strlen( sectionNames[i] ) + 1 );
+		hash = G_ScriptHash( hash, sections[i], strlen( sections[i] ) + 1 );
+	}
+
+	return hash;
+}
+
+/*
+* G_ScriptCacheFileName
+*/
+static void G_ScriptCacheFileName( const char *scriptName, char *filename, size_t size )
+{
+	char *p;
+
+	Q_snprintfz( filename, size, "%s/%s", G_SCRIPTCACHE_DIRECTORY, scriptName );
+	COM_StripExtension( filename + strlen( G_SCRIPTCACHE_DIRECTORY ) + 1 );
+	Q_strncatz( filename, G_SCRIPTCACHE_EXTENSION, size );
+
+	// flatten the script path into a single cache directory
+	for( p = filename + strlen( G_SCRIPTCACHE_DIRECTORY ) + 1; *p; p++ ) {
+		if( *p == '/' )
+			*p = '_';
+	}
+}
+
+/*
+* G_LoadCachedGameScript
+*/
+static bool G_LoadCachedGameScript( asIScriptModule *asModule, const char *filename, uint64_t hash )
+{
+	int length, filenum, error;
+	uint8_t *data;
+	bool debugStripped;
+	g_scriptcache_header_t header;
+
+	length = trap_FS_FOpenFile( filename, &filenum, FS_READ|FS_CACHE );
+	if( length == -1 )
+		return false;
+
+	if( length < (int)sizeof( header ) ) {
+		trap_FS_FCloseFile( filenum );
+		return false;
+	}
+
+	trap_FS_Read( &header, sizeof( header ), filenum );
+	if( memcmp( header.magic, G_SCRIPTCACHE_MAGIC, sizeof( header.magic ) ) 
+		|| header.version != G_SCRIPTCACHE_VERSION || header.hash != hash 
+		|| header.bytecodeSize <= 0 || header.bytecodeSize != length - (int)sizeof( header ) ) {
+		trap_FS_FCloseFile( filenum );
+		return false;
+	}
+
+	data = ( uint8_t * )G_Malloc( header.bytecodeSize );
+	trap_FS_Read( data, header.bytecodeSize, filenum );
+	trap_FS_FCloseFile( filenum );
+
+	G_ScriptBytecodeStream stream( data, header.bytecodeSize );
+	error = asModule->LoadByteCode( &stream, &debugStripped );
+
+	G_Free( data );
+
+	return error >= 0;
+}
+
+/*
+* G_SaveCachedGameScript
+*/
+static void G_SaveCachedGameScript( asIScriptModule *asModule, const char *filename, uint64_t hash )
+{
+	int filenum;
+	G_ScriptBytecodeStream stream;
+	g_scriptcache_header_t header;
+
+	if( asModule->SaveByteCode( &stream, false ) < 0 || !stream.getSize() )
+		return;
+
+	if( trap_FS_FOpenFile( filename, &filenum, FS_WRITE|FS_CACHE ) == -1 ) {
+		G_Printf( S_COLOR_YELLOW "Could not open %s for writing.\n", filename );
+		return;
+	}
+
+	memcpy( header.magic, G_SCRIPTCACHE_MAGIC, sizeof( header.magic ) );
+	header.version = G_SCRIPTCACHE_VERSION;
+	header.hash = hash;
+	header.bytecodeSize = (int)stream.getSize();
+
+	trap_FS_Write( &header, sizeof( header ), filenum );
+	trap_FS_Write( stream.getData(), stream.getSize(), filenum );
+	trap_FS_FCloseFile( filenum );
+}
+
+/*
+* G_CompileGameScript
+*/
+static bool G_CompileGameScript( asIScriptModule *asModule, const char *scriptName, 
+	int numSections, char **sectionNames, char **sections )
+{
+	int i, error;
+
+	for( i = 0; i < numSections; i++ ) {
+		error = asModule->AddScriptSection( sectionNames[i], sections[i], strlen( sections[i] ) );
+		if( error ) {
+			G_Printf( S_COLOR_RED "* Failed to add the script section %s with error %i\n", sectionNames[i], error );
+			return false;
+		}
+	}
+
+	error = asModule->Build();
+	if( error ) {
+		G_Printf( S_COLOR_RED "* Failed to build the script '%s'\n", scriptName );
+		return false;
+	}
+
+	return true;
+}
+
 /*
 * G_BuildGameScript
 */
 static asIScriptModule *G_BuildGameScript( const char *moduleName, const char *dir, const char *scriptName, const char *script )
 {
-	int error;
+	int i;
 	int numSections, sectionNum;
 	char *section;
+	char **sections, **sectionNames;
+	char cachename[MAX_QPATH];
+	uint64_t hash = 0;
+	bool useCache, fromCache;
+	unsigned int starttime;
 	asIScriptModule *asModule;
 	asIScriptEngine *asEngine;
 	
@@ -3993,6 +4233,8 @@ static asIScriptModule *G_BuildGameScript( const char *moduleName, const char *d
 
 	G_Printf( "* Initializing script '%s'\n", scriptName );
 
+	starttime = trap_Milliseconds();
+
 	// count referenced script sections
 	for( numSections = 0; ( section = G_ListNameForPosition( script, numSections, SECTIONS_SEPARATOR ) ) != NULL; numSections++ );
 
@@ -4001,44 +4243,64 @@ static asIScriptModule *G_BuildGameScript( const char *moduleName, const char *d
 		return NULL;
 	}
 
-	// load up the script sections
-
 	asModule = asEngine->GetModule( moduleName, asGM_CREATE_IF_NOT_EXISTS );
 	if( asModule == NULL ) {
 		G_Printf( S_COLOR_RED "G_BuildGameScript: GetModule '%s' failed\n", moduleName );
 		return NULL;
 	}
 
-	for( sectionNum = 0; ( section = G_LoadScriptSection( dir, script, sectionNum ) ) != NULL; sectionNum++ ) {
+	// load up the script sections, the cache key needs all of them
+
+	sections = ( char ** )G_Malloc( sizeof( char * ) * numSections * 2 );
+	sectionNames = sections + numSections;
+
+	for( sectionNum = 0; sectionNum < numSections && ( section = G_LoadScriptSection( dir, script, sectionNum ) ) != NULL; sectionNum++ ) {
 		const char *sectionName = G_ListNameForPosition( script, sectionNum, SECTIONS_SEPARATOR );
 
 		// the section name may contain leading whitespace (newlines) which we don't want in the section name
 		while (isspace(*sectionName) && *sectionName != '\0')
 			sectionName++;
 
-		error = asModule->AddScriptSection( sectionName, section, strlen( section ) );
-
-		G_Free( section );
-
-		if( error ) {
-			G_Printf( S_COLOR_RED "* Failed to add the script section %s with error %i\n", sectionName, error );
-			asEngine->DiscardModule( moduleName );
-			return NULL;
-		}
+		sections[sectionNum] = section;
+		sectionNames[sectionNum] = G_CopyString( sectionName );
 	}
 
 	if( sectionNum != numSections ) {
 		G_Printf( S_COLOR_RED "* Error: couldn't load all script sections.\n" );
 		asEngine->DiscardModule( moduleName );
-		return NULL;
+		asModule = NULL;
 	}
+	else {
+		useCache = g_asBytecodeCache->integer != 0;
+		fromCache = false;
 
-	error = asModule->Build();
-	if( error ) {
-		G_Printf( S_COLOR_RED "* Failed to build the script '%s'\n", scriptName );
-		asEngine->DiscardModule( moduleName );
-		return NULL;
+		if( useCache ) {
+			hash = G_ScriptCacheHash( asEngine, scriptName, numSections, sectionNames, sections );
+			G_ScriptCacheFileName( scriptName, cachename, sizeof( cachename ) );
+
+			// a failed load resets the module, so just compile it from the sources then
+			fromCache = G_LoadCachedGameScript( asModule, cachename, hash );
+		}
+
+		if( fromCache ) {
+			G_Printf( "* Loaded script '%s' from bytecode cache in %u ms\n", scriptName, trap_Milliseconds() - starttime );
+		}
+		else if( G_CompileGameScript( asModule, scriptName, numSections, sectionNames, sections ) ) {
+			if( useCache )
+				G_SaveCachedGameScript( asModule, cachename, hash );
+			G_Printf( "* Compiled script '%s' in %u ms\n", scriptName, trap_Milliseconds() - starttime );
+		}
+		else {
+			asEngine->DiscardModule( moduleName );
+			asModule = NULL;
+		}
+	}
+
+	for( i = 0; i < sectionNum; i++ ) {
+		G_Free( sections[i] );
+		G_Free( sectionNames[i] );
 	}
+	G_Free( sections );
 
 	return asModule;
 }
@@ -4175,6 +4437,8 @@ void G_asShutdownGameModuleEngine( void )
 			angelExport->asReleaseEngine( static_cast<asIScriptEngine *>(game.asEngine) );
 		G_ResetGameModuleScriptData();
 	}
+
+	G_asProfileShutdown();
 }
 
 /*
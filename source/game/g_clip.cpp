@@ -64,6 +64,13 @@ typedef struct
 
 static areagrid_t g_areagrid;
 
+// non-client SOLID_TRIGGER entities are linked into a grid of their own,
+// so trigger queries don't walk solids and projectiles and vice versa
+static areagrid_t g_triggergrid;
+
+// the grid each entity was last linked into
+static areagrid_t *g_linkedgrid[MAX_EDICTS];
+
 extern cvar_t *g_antilag;
 extern cvar_t *g_antilag_maxtimedelta;
 
@@ -489,6 +496,18 @@ static int GClip_EntitiesInBox_AreaGrid( areagrid_t *areagrid, const vec3_t mins
 }
 
 
+/*
+* GClip_AreaGridForEntity
+* clients always stay in the solid grid, since antilag may
+* rewind them to a state with a different solidity
+*/
+static areagrid_t *GClip_AreaGridForEntity( edict_t *ent )
+{
+	if( ent->r.solid == SOLID_TRIGGER && ( ENTNUM( ent ) > gs.maxclients ) )
+		return &g_triggergrid;
+	return &g_areagrid;
+}
+
 /*
 * GClip_ClearWorld
 * called after the world model has been loaded, before linking any entities
@@ -502,6 +521,7 @@ void GClip_ClearWorld( void )
 	trap_CM_InlineModelBounds( world_model, world_mins, world_maxs );
 
 	GClip_Init_AreaGrid( &g_areagrid, world_mins, world_maxs );
+	GClip_Init_AreaGrid( &g_triggergrid, world_mins, world_maxs );
 }
 
 /*
@@ -684,7 +704,32 @@ void GClip_LinkEntity( edict_t *ent )
 	ent->linkcount++;
 	ent->linked = true;
 
-	GClip_LinkEntity_AreaGrid( &g_areagrid, ent );
+	g_linkedgrid[ENTNUM( ent )] = GClip_AreaGridForEntity( ent );
+	GClip_LinkEntity_AreaGrid( g_linkedgrid[ENTNUM( ent )], ent );
+}
+
+/*
+* GClip_SetEntitySolid
+* 
+* For code that can't be expected to relink after changing solid (scripts).
+* Moves a linked entity between the solid and the trigger grid when needed,
+* the rest of the link state is updated by the next GClip_LinkEntity as before.
+*/
+void GClip_SetEntitySolid( edict_t *ent, int solid )
+{
+	areagrid_t *areagrid;
+
+	ent->r.solid = (solid_t)solid;
+	if( !ent->linked || ent == game.edicts )
+		return;
+
+	areagrid = GClip_AreaGridForEntity( ent );
+	if( g_linkedgrid[ENTNUM( ent )] == areagrid )
+		return;
+
+	GClip_UnlinkEntity_AreaGrid( ent );
+	g_linkedgrid[ENTNUM( ent )] = areagrid;
+	GClip_LinkEntity_AreaGrid( areagrid, ent );
 }
 
 /*
@@ -717,12 +762,40 @@ void GClip_SetAreaPortalState( edict_t *ent, bool open )
 static int GClip_AreaEdicts( const vec3_t mins, const vec3_t maxs, 
 	int *list, int maxcount, int areatype, int timeDelta )
 {
-	int count;
+	int i, count, numtriggers;
+	c4clipedict_t *clipEnt;
+
+	if( areatype == AREA_TRIGGERS ) {
+		count = GClip_EntitiesInBox_AreaGrid( &g_triggergrid, mins, maxs, 
+			list, maxcount, areatype, timeDelta );
+		count = min( count, maxcount );
+
+		// clients are in the solid grid whatever their solidity
+		for( i = 1; i <= gs.maxclients && count < maxcount; i++ ) {
+			if( !game.edicts[i].linked ) {
+				continue;
+			}
+			clipEnt = GClip_GetClipEdictForDeltaTime( i, timeDelta );
+			if( clipEnt->r.inuse && clipEnt->r.solid == SOLID_TRIGGER && 
+				BoundsIntersect( mins, maxs, clipEnt->r.absmin, clipEnt->r.absmax ) ) {
+				list[count++] = i;
+			}
+		}
+
+		return count;
+	}
 
 	count = GClip_EntitiesInBox_AreaGrid( &g_areagrid, mins, maxs, 
 		list, maxcount, areatype, timeDelta );
+	count = min( count, maxcount );
+
+	if( areatype == AREA_ALL && count < maxcount ) {
+		numtriggers = GClip_EntitiesInBox_AreaGrid( &g_triggergrid, mins, maxs, 
+			list + count, maxcount - count, areatype, timeDelta );
+		count += min( numtriggers, maxcount - count );
+	}
 
-	return min( count, maxcount );
+	return count;
 }
 
 /*
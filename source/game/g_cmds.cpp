@@ -1318,13 +1318,18 @@ static void Cmd_ServerMaplist_f( edict_t *ent )
 
 typedef void ( *gamecommandfunc_t )( edict_t * );
 
-typedef struct
+#define G_COMMANDS_HASH_SIZE	512		// power of two, larger than MAX_GAMECOMMANDS
+
+typedef struct g_gamecommands_s
 {
 	char name[MAX_QPATH];
 	gamecommandfunc_t func;
+	unsigned int hashKey;
+	struct g_gamecommands_s *hashNext;
 } g_gamecommands_t;
 
 g_gamecommands_t g_Commands[MAX_GAMECOMMANDS];
+static g_gamecommands_t *g_CommandsHash[G_COMMANDS_HASH_SIZE];
 
 // FIXME
 void Cmd_ShowPLinks_f( edict_t *ent );
@@ -1341,6 +1346,35 @@ void G_PrecacheGameCommands( void )
 		trap_ConfigString( CS_GAMECOMMANDS + i, g_Commands[i].name );
 }
 
+/*
+* G_CommandHashKey
+*
+* Case insensitive, like the command names
+*/
+static unsigned int G_CommandHashKey( const char *name )
+{
+	unsigned int hash = 2166136261u;
+
+	for( ; *name; name++ )
+		hash = ( hash ^ (unsigned char)tolower( *name ) ) * 16777619u;
+	return hash;
+}
+
+/*
+* G_FindCommand
+*/
+static g_gamecommands_t *G_FindCommand( const char *name, unsigned int hashKey )
+{
+	g_gamecommands_t *command;
+
+	for( command = g_CommandsHash[hashKey & ( G_COMMANDS_HASH_SIZE - 1 )]; command; command = command->hashNext )
+	{
+		if( command->hashKey == hashKey && !Q_stricmp( command->name, name ) )
+			return command;
+	}
+	return NULL;
+}
+
 /*
 * G_AddCommand
 */
@@ -1348,6 +1382,8 @@ void G_AddCommand( const char *name, gamecommandfunc_t callback )
 {
 	int i;
 	char temp[MAX_QPATH];
+	unsigned int hashKey;
+	g_gamecommands_t *command;
 	static const char *blacklist[] = { "callvotevalidate", "callvotepassed", NULL };
 
 	Q_strncpyz( temp, name, sizeof( temp ) );
@@ -1362,17 +1398,20 @@ void G_AddCommand( const char *name, gamecommandfunc_t callback )
 	}
 
 	// see if we already had it in game side
+	hashKey = G_CommandHashKey( temp );
+	command = G_FindCommand( temp, hashKey );
+	if( command )
+	{
+		// update func if different
+		if( command->func != callback )
+			command->func = ( gamecommandfunc_t )callback;
+		return;
+	}
+
 	for( i = 0; i < MAX_GAMECOMMANDS; i++ )
 	{
 		if( !g_Commands[i].name[0] )
 			break;
-		if( !Q_stricmp( g_Commands[i].name, temp ) )
-		{
-			// update func if different
-			if( g_Commands[i].func != callback )
-				g_Commands[i].func = ( gamecommandfunc_t )callback;
-			return;
-		}
 	}
 
 	if( i == MAX_GAMECOMMANDS )
@@ -1384,6 +1423,9 @@ void G_AddCommand( const char *name, gamecommandfunc_t callback )
 	// we don't have it, add it
 	g_Commands[i].func = ( gamecommandfunc_t )callback;
 	Q_strncpyz( g_Commands[i].name, temp, sizeof( g_Commands[i].name ) );
+	g_Commands[i].hashKey = hashKey;
+	g_Commands[i].hashNext = g_CommandsHash[hashKey & ( G_COMMANDS_HASH_SIZE - 1 )];
+	g_CommandsHash[hashKey & ( G_COMMANDS_HASH_SIZE - 1 )] = &g_Commands[i];
 
 	// add the configstring if the precache process was already done
 	if( level.canSpawnEntities )
@@ -1401,7 +1443,9 @@ void G_InitGameCommands( void )
 	{
 		g_Commands[i].func = NULL;
 		g_Commands[i].name[0] = 0;
+		g_Commands[i].hashNext = NULL;
 	}
+	memset( g_CommandsHash, 0, sizeof( g_CommandsHash ) );
 
 	G_AddCommand( "cvarinfo", Cmd_CvarInfo_f );
 	G_AddCommand( "position", Cmd_Position_f );
@@ -1476,29 +1520,25 @@ void G_InitGameCommands( void )
 void ClientCommand( edict_t *ent )
 {
 	char *cmd;
-	int i;
+	g_gamecommands_t *command;
 
 	if( !ent->r.client || trap_GetClientState( PLAYERNUM( ent ) ) < CS_SPAWNED )
 		return; // not fully in game yet
 
 	cmd = trap_Cmd_Argv( 0 );
+	command = G_FindCommand( cmd, G_CommandHashKey( cmd ) );
 
-	if( Q_stricmp( cmd, "cvarinfo" ) ) // skip cvarinfo cmds because they are automatic responses
+	// skip cvarinfo cmds because they are automatic responses
+	if( !command || command->func != Cmd_CvarInfo_f )
 		G_Client_UpdateActivity( ent->r.client ); // activity detected
 
-	for( i = 0; i < MAX_GAMECOMMANDS; i++ )
+	if( command )
 	{
-		if( !g_Commands[i].name[0] )
-			break;
-
-		if( !Q_stricmp( g_Commands[i].name, cmd ) )
-		{
-			if( g_Commands[i].func )
-				g_Commands[i].func( ent );
-			else
-				GT_asCallGameCommand( ent->r.client, cmd, trap_Cmd_Args(), trap_Cmd_Argc() - 1 );
-			return;
-		}
+		if( command->func )
+			command->func( ent );
+		else
+			GT_asCallGameCommand( ent->r.client, cmd, trap_Cmd_Args(), trap_Cmd_Argc() - 1 );
+		return;
 	}
 
 	G_PrintMsg( ent, "Bad user command: %s\n", cmd );
@@ -765,6 +765,22 @@ static edict_t *G_GetNextThinkClient( edict_t *current )
 	return NULL;
 }
 
+// frame profiler zones
+static bool g_zonesRegistered;
+static int g_zoneRunClients, g_zoneRunEntities, g_zoneRunGametype, g_zoneGarbageCollect;
+
+/*
+* G_RegisterProfileZones
+*/
+static void G_RegisterProfileZones( void )
+{
+	g_zoneRunClients = trap_ProfileZone( "G_RunClients" );
+	g_zoneRunEntities = trap_ProfileZone( "G_RunEntities" );
+	g_zoneRunGametype = trap_ProfileZone( "G_RunGametype" );
+	g_zoneGarbageCollect = trap_ProfileZone( "G_LevelGarbageCollect" );
+	g_zonesRegistered = true;
+}
+
 /*
 * G_RunFrame
 * Advances the world
@@ -772,6 +788,10 @@ static edict_t *G_GetNextThinkClient( edict_t *current )
 void G_RunFrame( unsigned int msec, unsigned int serverTime )
 {
 	G_CheckCvars();
+	G_asProfileFrame();
+
+	if( !g_zonesRegistered )
+		G_RegisterProfileZones();
 
 	game.localTime = time( NULL );
 
@@ -783,6 +803,7 @@ void G_RunFrame( unsigned int msec, unsigned int serverTime )
 		G_StartFrameSnap();
 
 	G_CallVotes_Think();
+	G_RaceSpool_Frame();
 
 	if( GS_MatchPaused() )
 	{
@@ -812,11 +833,23 @@ void G_RunFrame( unsigned int msec, unsigned int serverTime )
 
 	// run the world
 	G_asCallMapPreThink();
+
+	trap_ProfileBegin( g_zoneRunClients );
 	G_RunClients();
+	trap_ProfileEnd( g_zoneRunClients );
+
+	trap_ProfileBegin( g_zoneRunEntities );
 	G_RunEntities();
+	trap_ProfileEnd( g_zoneRunEntities );
+
+	trap_ProfileBegin( g_zoneRunGametype );
 	G_RunGametype();
+	trap_ProfileEnd( g_zoneRunGametype );
+
 	G_asCallMapPostThink();
 	GClip_BackUpCollisionFrame();
 
+	trap_ProfileBegin( g_zoneGarbageCollect );
 	G_LevelGarbageCollect();
+	trap_ProfileEnd( g_zoneGarbageCollect );
 }
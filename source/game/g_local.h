@@ -148,7 +148,6 @@ typedef struct
 	gclient_t *clients;     // [maxclients]
 	gclient_quit_t *quits;	// [dynamic] <-- MM
 	clientRating_t *ratings;	// list of ratings for current game and gametype <-- MM
-	linear_allocator_t *raceruns;	// raceRun_t <-- MM
 
 	int protocol;
 	char demoExtension[MAX_QPATH];
@@ -381,10 +380,17 @@ extern cvar_t *g_instajump;
 extern cvar_t *g_instashield;
 
 extern cvar_t *g_asGC_stats;
+extern cvar_t *g_asProfile;
+extern cvar_t *g_asProfileInterval;
 extern cvar_t *g_asGC_interval;
+extern cvar_t *g_asBytecodeCache;
 
 extern cvar_t *g_skillRating;
 
+extern cvar_t *g_racespool_interval;
+extern cvar_t *g_racespool_batch;
+extern cvar_t *g_mockstats_fail;
+
 edict_t **G_Teams_ChallengersQueue( void );
 void G_Teams_Join_Cmd( edict_t *ent );
 bool G_Teams_JoinTeam( edict_t *ent, int team );
@@ -525,6 +531,10 @@ void G_asShutdownGameModuleEngine( void );
 void G_asGarbageCollect( bool force );
 void G_asDumpAPI_f( void );
 
+void G_asProfileFrame( void );
+void G_asProfileShutdown( void );
+void G_asProfile_f( void );
+
 #define world	( (edict_t *)game.edicts )
 
 // item spawnflags
@@ -765,6 +775,7 @@ void GClip_SetBrushModel( edict_t *ent, const char *name );
 void GClip_SetAreaPortalState( edict_t *ent, bool open );
 void GClip_LinkEntity( edict_t *ent );
 void GClip_UnlinkEntity( edict_t *ent );
+void GClip_SetEntitySolid( edict_t *ent, int solid );
 void GClip_TouchTriggers( edict_t *ent );
 void G_PMoveTouchTriggers( pmove_t *pm, vec3_t previous_origin );
 entity_state_t *G_GetEntityStateForDeltaTime( int entNum, int deltaTime );
@@ -1481,7 +1492,19 @@ void G_AddRaceRecords( edict_t *ent, int numSectors, unsigned int *records );
 unsigned int G_GetRaceRecord( edict_t *ent, int sector );
 raceRun_t *G_NewRaceRun( edict_t *ent, int numSectors );
 void G_SetRaceTime( edict_t *ent, int sector, unsigned int time );
+
+//
+// g_racespool.cpp
+//
+void G_RaceSpool_Init( void );
+void G_RaceSpool_Shutdown( void );
+void G_RaceSpool_Frame( void );
+void G_RaceSpool_Append( const raceRun_t *rr );
+void G_RaceSpool_Flush( void );
+void G_RaceSpool_f( void );
 void G_ListRaces_f( void );
+http_response_code_t G_MockStats_WebRequest( http_query_method_t method, const char *resource,
+	const char *query_string, char **content, size_t *content_length );
 
 // web
 http_response_code_t G_WebRequest( http_query_method_t method, const char *resource, 
@@ -106,10 +106,17 @@ cvar_t *g_disable_vote_gametype;
 cvar_t *g_allow_spectator_voting;
 
 cvar_t *g_asGC_stats;
+cvar_t *g_asProfile;
+cvar_t *g_asProfileInterval;
 cvar_t *g_asGC_interval;
+cvar_t *g_asBytecodeCache;
 
 cvar_t *g_skillRating;
 
+cvar_t *g_racespool_interval;
+cvar_t *g_racespool_batch;
+cvar_t *g_mockstats_fail;
+
 
 static char *map_rotation_s = NULL;
 static char **map_rotation_p = NULL;
@@ -351,11 +358,18 @@ void G_Init( unsigned int seed, unsigned int framemsec, int protocol, const char
 	g_disable_vote_gametype = trap_Cvar_Get( "g_disable_vote_gametype", "0", CVAR_ARCHIVE );
 
 	g_asGC_stats = trap_Cvar_Get( "g_asGC_stats", "0", CVAR_ARCHIVE );
+	g_asProfile = trap_Cvar_Get( "g_asProfile", "0", 0 );
+	g_asProfileInterval = trap_Cvar_Get( "g_asProfileInterval", "1000", 0 );
 	g_asGC_interval = trap_Cvar_Get( "g_asGC_interval", "10", CVAR_ARCHIVE );
+	g_asBytecodeCache = trap_Cvar_Get( "g_asBytecodeCache", "1", CVAR_ARCHIVE );
 
 	g_skillRating = trap_Cvar_Get( "sv_skillRating", va("%.0f", MM_RATING_DEFAULT), CVAR_SERVERINFO|CVAR_READONLY );
 	// trap_Cvar_ForceSet( "sv_skillRating", va("%d", MM_RATING_DEFAULT) );
 
+	g_racespool_interval = trap_Cvar_Get( "g_racespool_interval", "30", CVAR_ARCHIVE );
+	g_racespool_batch = trap_Cvar_Get( "g_racespool_batch", "256", CVAR_ARCHIVE );
+	g_mockstats_fail = trap_Cvar_Get( "g_mockstats_fail", "0", 0 );
+
 	// nextmap
 	trap_Cvar_ForceSet( "nextmap", "match \"advance\"" );
 
@@ -369,6 +383,9 @@ void G_Init( unsigned int seed, unsigned int framemsec, int protocol, const char
 
 	game.quits = NULL;
 
+	// pick up race runs left unreported by the previous session
+	G_RaceSpool_Init();
+
 	game.numentities = gs.maxclients + 1;
 
 	trap_LocateEntities( game.edicts, sizeof( game.edicts[0] ), game.numentities, game.maxentities );
@@ -397,6 +414,8 @@ void G_Shutdown( void )
 	// racesow
 	RS_Shutdown();
 
+	G_RaceSpool_Shutdown();
+
 	GT_asCallShutdown();
 	G_asCallMapExit();
 
@@ -20,13 +20,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "g_local.h"
 #include "../matchmaker/mm_query.h"
 
-// number of raceruns to send in one batch
-#define RACERUN_BATCH_SIZE	256
-
 stat_query_api_t *sq_api;
 
-static void G_Match_RaceReport( void );
-
 //====================================================
 
 static clientRating_t *g_ratingAlloc( const char *gametype, float rating, float deviation, int uuid )
@@ -381,8 +376,6 @@ void G_SetRaceTime( edict_t *ent, int sector, unsigned int time )
 		rr->times[sector] = time;
 	else if (rr->numSectors > 0)
 	{
-		raceRun_t *nrr;	// new global racerun
-
 		rr->times[rr->numSectors] = time;
 		rr->timestamp = trap_Milliseconds();
 
@@ -400,47 +393,8 @@ void G_SetRaceTime( edict_t *ent, int sector, unsigned int time )
 			return;
 		}
 
-		if( !game.raceruns )
-			game.raceruns = LinearAllocator( sizeof( raceRun_t ), 0, _G_LevelMalloc, _G_LevelFree );
-
-		// push new run
-		nrr = ( raceRun_t * )LA_Alloc( game.raceruns );
-		memcpy( nrr, rr, sizeof( raceRun_t ) );
-		// reuse this one in nrr
-		rr->times = 0;
-
-		// see if we have to push intermediate result
-		if( LA_Size( game.raceruns ) >= RACERUN_BATCH_SIZE )
-		{
-			G_Match_SendReport();
-			// double-check this for memory-leaks
-			if( game.raceruns != 0 )
-				LinearAllocator_Free( game.raceruns );
-			game.raceruns = 0;
-		}
-	}
-}
-
-void G_ListRaces_f( void )
-{
-	int i, j, size;
-	raceRun_t *run;
-
-	if( !game.raceruns || !LA_Size( game.raceruns ) )
-	{
-		G_Printf("No races to report\n");
-		return;
-	}
-
-	G_Printf(S_COLOR_RED "  session    " S_COLOR_YELLOW "times\n");
-	size = LA_Size( game.raceruns );
-	for( i = 0; i < size; i++ )
-	{
-		run = (raceRun_t*)LA_Pointer( game.raceruns, i );
-		G_Printf(S_COLOR_RED "  %d    " S_COLOR_YELLOW, run->owner );
-		for( j = 0; j < run->numSectors; j++ )
-			G_Printf("%d ", run->times[j] );
-		G_Printf(S_COLOR_GREEN "%d\n", run->times[run->numSectors]);	// SAFE!
+		// runs are uploaded from the spool in the background
+		G_RaceSpool_Append( rr );
 	}
 }
 
@@ -915,7 +869,7 @@ void G_Match_SendReport( void )
 
 	if( GS_RaceGametype() )
 	{
-		G_Match_RaceReport();
+		G_RaceSpool_Flush();
 		return;
 	}
 
@@ -954,75 +908,3 @@ void G_Match_SendReport( void )
 	}
 	game.quits = NULL;
 }
-
-/*
-* G_Match_RaceReport
-*/
-static void G_Match_RaceReport( void )
-{
-	stat_query_t *query;
-	stat_query_section_t *runsArray;
-	stat_query_section_t *timesArray, *dummy;
-	raceRun_t *prr;
-	int i, j, size;
-
-	if( !GS_RaceGametype() )
-	{
-		G_Printf("G_Match_RaceReport.. not race gametype\n");
-		return;
-	}
-
-	if( !game.raceruns || !LA_Size( game.raceruns ) )
-	{
-		G_Printf("G_Match_RaceReport.. no runs to report\n");
-		return;
-	}
-
-	/*
-	* match : { .... }
-	* runs :
-	* [
-	*   {
-	*   	session_id : 3434343,
-	*  	times : [ 12, 43, 56, 7878, 4 ]
-	*    }
-	* ]
-	*  ( TODO: get the nickname there )
-	*/
-	query = sq_api->CreateQuery( NULL, "smr", false );
-	if( !query )
-	{
-		G_Printf("G_Match_RaceReport.. failed to create query object\n");
-		return;
-	}
-
-	g_mm_writeHeader( query, false );
-
-	// Players array
-	runsArray = sq_api->CreateArray( query, 0, "runs" );
-	size = LA_Size( game.raceruns );
-	for( i = 0; i < size; i++ )
-	{
-		prr = (raceRun_t*)LA_Pointer( game.raceruns, i );
-
-		dummy = sq_api->CreateSection( query, runsArray, 0 );
-
-		sq_api->SetNumber( dummy, "session_id", prr->owner );
-		sq_api->SetNumber( dummy, "timestamp", prr->timestamp );
-		timesArray = sq_api->CreateArray( query, dummy, "times" );
-
-		for( j = 0; j < prr->numSectors; j++ )
-			sq_api->AddArrayNumber( timesArray, prr->times[j] );
-
-		// FINAL TIME
-		sq_api->AddArrayNumber( timesArray, prr->times[prr->numSectors] );
-	}
-
-	trap_MM_SendQuery( query );
-
-	query = NULL;
-
-	// clear gameruns
-	LinearAllocator_Free( game.raceruns );
-	game.raceruns = NULL;
-}
@@ -20,7 +20,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
 // g_public.h -- game dll information visible to server
 
-#define	GAME_API_VERSION    50
+#define	GAME_API_VERSION    52
 
 //===============================================================
 
@@ -96,6 +96,12 @@ typedef struct
 	int ( *SkinIndex )( const char *name );
 
 	unsigned int ( *Milliseconds )( void );
+	uint64_t ( *Microseconds )( void );
+
+	// frame profiler zones
+	int ( *ProfileZone )( const char *name );
+	void ( *ProfileBegin )( int zone );
+	void ( *ProfileEnd )( int zone );
 
 	bool ( *inPVS )( const vec3_t p1, const vec3_t p2 );
 
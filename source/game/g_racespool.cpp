@@ -0,0 +1,589 @@
+/*
+Copyright (C) 2014 Chasseur de bots
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// g_racespool.cpp -- durable spool for race run reports
+//
+// Finished runs are appended to a text file in the write directory, one run
+// per line, and uploaded from there in batches. The position of the first
+// run the backend hasn't acknowledged yet is kept in a second file, so runs
+// survive map changes, backend outages and server restarts. A run is removed
+// from the spool only after the report containing it was accepted, which
+// means a run may be reported twice if the server dies in between.
+
+#include "g_local.h"
+#include "../matchmaker/mm_query.h"
+
+#define RACESPOOL_FILE			"stats/racespool.log"
+#define RACESPOOL_POS_FILE		"stats/racespool.pos"
+
+#define RACESPOOL_MAX_BATCH		256		// runs per report
+#define RACESPOOL_MAX_SECTORS	256
+#define RACESPOOL_READ_SIZE		0x10000	// must fit at least one full line
+
+#define RACESPOOL_MIN_BACKOFF	5000
+#define RACESPOOL_MAX_BACKOFF	300000
+
+typedef struct
+{
+	char map[MAX_QPATH];
+	char gametype[MAX_QPATH];
+	int owner;
+	time_t utc;
+	unsigned int timestamp;
+	int numSectors;
+	unsigned int times[RACESPOOL_MAX_SECTORS+1];
+} spooledRun_t;
+
+typedef struct
+{
+	stat_query_api_t *api;
+	stat_query_t *query;		// report in flight
+	size_t pos;					// offset of the first unacknowledged run
+	size_t querySize;			// spool bytes covered by the report in flight
+	int queryRuns;
+
+	unsigned int nextAttempt;
+	unsigned int backoff;
+
+	// counters, for the lifetime of the game module
+	unsigned int queued;
+	unsigned int sent;
+	unsigned int failed;		// runs in reports that didn't go through
+	unsigned int failedReports;
+	unsigned int dropped;		// unparsable lines
+
+	// mock endpoint
+	unsigned int mockReceived;
+	unsigned int mockRejected;
+} raceSpool_t;
+
+static raceSpool_t rspool;
+
+/*
+* G_RaceSpool_ReadPos
+*/
+static size_t G_RaceSpool_ReadPos( void )
+{
+	int file, length;
+	char buf[32];
+
+	length = trap_FS_FOpenFile( RACESPOOL_POS_FILE, &file, FS_READ );
+	if( length < 0 || !file )
+		return 0;
+
+	length = trap_FS_Read( buf, min( length, (int)sizeof( buf ) - 1 ), file );
+	trap_FS_FCloseFile( file );
+	if( length <= 0 )
+		return 0;
+
+	buf[length] = '\0';
+	return strtoul( buf, NULL, 10 );
+}
+
+/*
+* G_RaceSpool_WritePos
+*/
+static void G_RaceSpool_WritePos( size_t pos )
+{
+	int file;
+	const char *s;
+
+	if( trap_FS_FOpenFile( RACESPOOL_POS_FILE, &file, FS_WRITE ) == -1 )
+	{
+		G_Printf( "G_RaceSpool: couldn't open %s for writing\n", RACESPOOL_POS_FILE );
+		return;
+	}
+
+	s = va( "%u\n", (unsigned)pos );
+	trap_FS_Write( s, strlen( s ), file );
+	trap_FS_FCloseFile( file );
+}
+
+/*
+* G_RaceSpool_Advance
+*
+* Drops the given number of bytes from the head of the spool. Once everything
+* has been acknowledged the files are removed so the spool doesn't grow forever.
+*/
+static void G_RaceSpool_Advance( size_t size )
+{
+	int file, length;
+
+	rspool.pos += size;
+
+	length = trap_FS_FOpenFile( RACESPOOL_FILE, &file, FS_READ );
+	if( file )
+		trap_FS_FCloseFile( file );
+
+	if( length < 0 || rspool.pos >= (size_t)length )
+	{
+		trap_FS_RemoveFile( RACESPOOL_FILE );
+		trap_FS_RemoveFile( RACESPOOL_POS_FILE );
+		rspool.pos = 0;
+		return;
+	}
+
+	G_RaceSpool_WritePos( rspool.pos );
+}
+
+/*
+* G_RaceSpool_Append
+*
+* <map> <gametype> <session> <utc> <timestamp> <numSectors> <times...> <final>
+*/
+void G_RaceSpool_Append( const raceRun_t *rr )
+{
+	int i, file;
+	char line[MAX_STRING_CHARS];
+	size_t len;
+
+	if( rr->numSectors < 0 || rr->numSectors > RACESPOOL_MAX_SECTORS )
+		return;
+
+	Q_snprintfz( line, sizeof( line ), "%s %s %i %u %u %i", level.mapname, gs.gametypeName,
+		rr->owner, (unsigned)game.localTime, rr->timestamp, rr->numSectors );
+	for( i = 0; i <= rr->numSectors; i++ )
+		Q_strncatz( line, va( " %u", rr->times[i] ), sizeof( line ) );
+
+	len = strlen( line );
+	if( len + 1 >= sizeof( line ) )
+	{
+		G_Printf( "G_RaceSpool: run too long to spool\n" );
+		return;
+	}
+	line[len++] = '\n';
+
+	if( trap_FS_FOpenFile( RACESPOOL_FILE, &file, FS_APPEND ) == -1 )
+	{
+		G_Printf( "G_RaceSpool: couldn't open %s for appending\n", RACESPOOL_FILE );
+		return;
+	}
+
+	trap_FS_Write( line, len, file );
+	trap_FS_FCloseFile( file );
+
+	rspool.queued++;
+}
+
+/*
+* G_RaceSpool_ParseRun
+*/
+static bool G_RaceSpool_ParseRun( char *line, spooledRun_t *run )
+{
+	char *p, *end;
+	int i;
+
+	p = line;
+	for( i = 0; i < 2; i++ )
+	{
+		char *dst = i ? run->gametype : run->map;
+
+		end = strchr( p, ' ' );
+		if( !end || end == p || end - p >= MAX_QPATH )
+			return false;
+		memcpy( dst, p, end - p );
+		dst[end - p] = '\0';
+		p = end + 1;
+	}
+
+	run->owner = strtol( p, &end, 10 );
+	if( end == p )
+		return false;
+	p = end;
+	run->utc = (time_t)strtoul( p, &end, 10 );
+	if( end == p )
+		return false;
+	p = end;
+	run->timestamp = strtoul( p, &end, 10 );
+	if( end == p )
+		return false;
+	p = end;
+	run->numSectors = strtol( p, &end, 10 );
+	if( end == p || run->numSectors < 0 || run->numSectors > RACESPOOL_MAX_SECTORS )
+		return false;
+	p = end;
+
+	for( i = 0; i <= run->numSectors; i++ )
+	{
+		run->times[i] = strtoul( p, &end, 10 );
+		if( end == p )
+			return false;
+		p = end;
+	}
+
+	return true;
+}
+
+/*
+* G_RaceSpool_WriteHeader
+*
+* Like g_mm_writeHeader but for the map the runs were made on,
+* which isn't necessarily the current one.
+*/
+static void G_RaceSpool_WriteHeader( stat_query_t *query, const spooledRun_t *run )
+{
+	stat_query_api_t *sq = rspool.api;
+	stat_query_section_t *matchsection = sq->CreateSection( query, 0, "match" );
+
+	sq->SetString( matchsection, "gametype", run->gametype );
+	sq->SetString( matchsection, "map", run->map );
+	sq->SetString( matchsection, "hostname", trap_Cvar_String( "sv_hostname" ) );
+	sq->SetNumber( matchsection, "timeplayed", 0 );
+	sq->SetNumber( matchsection, "timelimit", 0 );
+	sq->SetNumber( matchsection, "scorelimit", 0 );
+	sq->SetNumber( matchsection, "instagib", 0 );
+	sq->SetNumber( matchsection, "teamgame", 0 );
+	sq->SetNumber( matchsection, "racegame", 1 );
+	sq->SetString( matchsection, "gamedir", trap_Cvar_String( "fs_game" ) );
+	sq->SetNumber( matchsection, "timestamp", trap_Milliseconds() );
+}
+
+/*
+* G_RaceSpool_QueryDone
+*/
+static void G_RaceSpool_QueryDone( stat_query_t *query, bool success, void *customp )
+{
+	int status = rspool.api->GetStatus( query );
+
+	rspool.query = NULL;
+
+	// the runs are dropped from the spool on success, so only a 2xx reply counts
+	if( !success || status < 200 || status >= 300 )
+	{
+		rspool.failed += rspool.queryRuns;
+		rspool.failedReports++;
+
+		rspool.backoff = rspool.backoff ? min( rspool.backoff * 2, RACESPOOL_MAX_BACKOFF ) : RACESPOOL_MIN_BACKOFF;
+		// spread retries of several servers sharing the backend
+		rspool.nextAttempt = game.realtime + rspool.backoff + (unsigned)( random() * rspool.backoff / 4 );
+
+		G_Printf( "G_RaceSpool: report of %i runs failed, retrying in %.1f seconds\n",
+			rspool.queryRuns, ( rspool.nextAttempt - game.realtime ) * 0.001f );
+		return;
+	}
+
+	rspool.sent += rspool.queryRuns;
+	rspool.backoff = 0;
+
+	G_RaceSpool_Advance( rspool.querySize );
+
+	// keep going while there's a backlog, otherwise let new runs pile up for a while
+	rspool.nextAttempt = game.realtime;
+	if( !rspool.pos )
+		rspool.nextAttempt += max( g_racespool_interval->integer, 0 ) * 1000;
+}
+
+/*
+* G_RaceSpool_Send
+*
+* Builds a report out of the runs at the head of the spool. All runs
+* in a report share the map and gametype of the first one.
+*/
+static void G_RaceSpool_Send( void )
+{
+	int file, length, maxRuns;
+	char *buf, *line, *end;
+	size_t size, consumed;
+	spooledRun_t *run;
+	stat_query_t *query = NULL;
+	stat_query_section_t *runsArray = NULL, *timesArray, *section;
+	char map[MAX_QPATH], gametype[MAX_QPATH];
+	time_t now;
+	int i, numRuns;
+
+	length = trap_FS_FOpenFile( RACESPOOL_FILE, &file, FS_READ );
+	if( length <= 0 || !file )
+	{
+		if( file )
+			trap_FS_FCloseFile( file );
+		rspool.pos = 0;
+		return;
+	}
+
+	if( rspool.pos >= (size_t)length )
+	{
+		// the log is gone or was replaced behind our back
+		trap_FS_FCloseFile( file );
+		G_RaceSpool_Advance( 0 );
+		return;
+	}
+
+	size = min( (size_t)length - rspool.pos, (size_t)RACESPOOL_READ_SIZE );
+	buf = ( char * )G_Malloc( size + 1 );
+	trap_FS_Seek( file, rspool.pos, FS_SEEK_SET );
+	size = trap_FS_Read( buf, size, file );
+	trap_FS_FCloseFile( file );
+	buf[size] = '\0';
+
+	run = ( spooledRun_t * )G_Malloc( sizeof( *run ) );
+	maxRuns = bound( 1, g_racespool_batch->integer, RACESPOOL_MAX_BATCH );
+	now = game.localTime;
+	map[0] = gametype[0] = '\0';
+	numRuns = 0;
+	consumed = 0;
+
+	for( line = buf; numRuns < maxRuns && ( end = strchr( line, '\n' ) ) != NULL; line = end + 1 )
+	{
+		*end = '\0';
+
+		if( !G_RaceSpool_ParseRun( line, run ) )
+		{
+			G_Printf( "G_RaceSpool: dropping malformed run at offset %u\n", (unsigned)( rspool.pos + ( line - buf ) ) );
+			rspool.dropped++;
+			consumed = end + 1 - buf;
+			continue;
+		}
+
+		if( !query )
+		{
+			query = rspool.api->CreateQuery( NULL, "smr", false );
+			if( !query )
+			{
+				G_Printf( "G_RaceSpool: failed to create query object\n" );
+				break;
+			}
+
+			Q_strncpyz( map, run->map, sizeof( map ) );
+			Q_strncpyz( gametype, run->gametype, sizeof( gametype ) );
+
+			G_RaceSpool_WriteHeader( query, run );
+			runsArray = rspool.api->CreateArray( query, 0, "runs" );
+		}
+		else if( strcmp( run->map, map ) || strcmp( run->gametype, gametype ) )
+		{
+			break;
+		}
+
+		section = rspool.api->CreateSection( query, runsArray, 0 );
+		rspool.api->SetNumber( section, "session_id", run->owner );
+		// the backend reads run timestamps relative to the one in the header,
+		// so rebase runs from earlier server sessions onto the current clock
+		rspool.api->SetNumber( section, "timestamp", (double)trap_Milliseconds() - ( now - run->utc ) * 1000.0 );
+		rspool.api->SetNumber( section, "utc", (double)run->utc );
+
+		timesArray = rspool.api->CreateArray( query, section, "times" );
+		for( i = 0; i <= run->numSectors; i++ )
+			rspool.api->AddArrayNumber( timesArray, run->times[i] );
+
+		numRuns++;
+		consumed = end + 1 - buf;
+	}
+
+	if( !consumed && size == RACESPOOL_READ_SIZE )
+	{
+		// a single line that doesn't fit into the buffer, can't be a run of ours
+		G_Printf( "G_RaceSpool: dropping oversized line at offset %u\n", (unsigned)rspool.pos );
+		rspool.dropped++;
+		consumed = size;
+	}
+
+	G_Free( run );
+	G_Free( buf );
+
+	if( !numRuns )
+	{
+		if( query )
+			rspool.api->DestroyQuery( query );
+		if( consumed )
+			G_RaceSpool_Advance( consumed );
+		return;
+	}
+
+	rspool.query = query;
+	rspool.querySize = consumed;
+	rspool.queryRuns = numRuns;
+
+	// the callback may fire right away if the request can't be created
+	rspool.api->SetCallback( query, G_RaceSpool_QueryDone, NULL );
+	trap_MM_SendQuery( query );
+}
+
+/*
+* G_RaceSpool_Flush
+*
+* Upload whatever is spooled without waiting for the batching interval.
+* Doesn't cut retry backoff short.
+*/
+void G_RaceSpool_Flush( void )
+{
+	if( !rspool.backoff )
+		rspool.nextAttempt = game.realtime;
+}
+
+/*
+* G_RaceSpool_Frame
+*/
+void G_RaceSpool_Frame( void )
+{
+	if( !rspool.api || rspool.query )
+		return;
+	if( (int)( game.realtime - rspool.nextAttempt ) < 0 )
+		return;
+
+	// try again in a bit if there's nothing to send now
+	rspool.nextAttempt = game.realtime + max( g_racespool_interval->integer, 0 ) * 1000;
+
+	G_RaceSpool_Send();
+}
+
+/*
+* G_RaceSpool_Init
+*/
+void G_RaceSpool_Init( void )
+{
+	memset( &rspool, 0, sizeof( rspool ) );
+
+	rspool.api = trap_GetStatQueryAPI();
+	rspool.pos = G_RaceSpool_ReadPos();
+	rspool.nextAttempt = game.realtime;
+}
+
+/*
+* G_RaceSpool_Shutdown
+*/
+void G_RaceSpool_Shutdown( void )
+{
+	// the report's runs are still in the spool and will be sent next time
+	if( rspool.query )
+		rspool.api->DestroyQuery( rspool.query );
+	rspool.query = NULL;
+}
+
+/*
+* G_ListRaces_f
+*
+* The spool can grow large while the backend is down, so it's read in chunks
+*/
+void G_ListRaces_f( void )
+{
+	int file, length, i;
+	char *buf, *line, *end;
+	size_t left, size, kept;
+	spooledRun_t *run;
+
+	length = trap_FS_FOpenFile( RACESPOOL_FILE, &file, FS_READ );
+	if( length <= 0 || !file || rspool.pos >= (size_t)length )
+	{
+		if( file )
+			trap_FS_FCloseFile( file );
+		G_Printf( "No races to report\n" );
+		return;
+	}
+
+	buf = ( char * )G_Malloc( RACESPOOL_READ_SIZE + 1 );
+	run = ( spooledRun_t * )G_Malloc( sizeof( *run ) );
+	trap_FS_Seek( file, rspool.pos, FS_SEEK_SET );
+
+	G_Printf( S_COLOR_RED "  session    " S_COLOR_YELLOW "times\n" );
+
+	left = (size_t)length - rspool.pos;
+	kept = 0;
+	while( left > 0 )
+	{
+		length = trap_FS_Read( buf + kept, min( left, (size_t)RACESPOOL_READ_SIZE - kept ), file );
+		if( length <= 0 )
+			break;
+		left -= length;
+		size = kept + length;
+		buf[size] = '\0';
+
+		for( line = buf; ( end = strchr( line, '\n' ) ) != NULL; line = end + 1 )
+		{
+			*end = '\0';
+			if( !G_RaceSpool_ParseRun( line, run ) )
+				continue;
+
+			G_Printf( S_COLOR_RED "  %d    " S_COLOR_YELLOW, run->owner );
+			for( i = 0; i < run->numSectors; i++ )
+				G_Printf( "%d ", run->times[i] );
+			G_Printf( S_COLOR_GREEN "%d " S_COLOR_WHITE "%s\n", run->times[run->numSectors], run->map );
+		}
+
+		// carry the partial last line over to the next chunk, unless it fills the buffer
+		kept = buf + size - line;
+		if( kept == RACESPOOL_READ_SIZE )
+			kept = 0;
+		memmove( buf, line, kept );
+	}
+
+	trap_FS_FCloseFile( file );
+
+	G_Free( run );
+	G_Free( buf );
+}
+
+/*
+* G_RaceSpool_f
+*/
+void G_RaceSpool_f( void )
+{
+	int file, length;
+
+	if( !Q_stricmp( trap_Cmd_Argv( 1 ), "flush" ) )
+	{
+		rspool.backoff = 0;
+		rspool.nextAttempt = game.realtime;
+		return;
+	}
+
+	length = trap_FS_FOpenFile( RACESPOOL_FILE, &file, FS_READ );
+	if( file )
+		trap_FS_FCloseFile( file );
+	if( length < 0 )
+		length = 0;
+
+	G_Printf( "race spool: %u bytes pending\n", (unsigned)( (size_t)length > rspool.pos ? length - rspool.pos : 0 ) );
+	G_Printf( "  queued %u, sent %u, failed %u (%u reports), dropped %u\n",
+		rspool.queued, rspool.sent, rspool.failed, rspool.failedReports, rspool.dropped );
+	if( rspool.query )
+		G_Printf( "  uploading %i runs\n", rspool.queryRuns );
+	else if( rspool.backoff )
+		G_Printf( "  retrying in %.1f seconds\n", (int)( rspool.nextAttempt - game.realtime ) * 0.001f );
+	if( rspool.mockReceived )
+		G_Printf( "  mock endpoint: %u received, %u rejected\n", rspool.mockReceived, rspool.mockRejected );
+}
+
+/*
+* G_MockStats_WebRequest
+*
+* Stand-in for the stats backend, point mm_url at http://<server>/game/mockstats
+* to exercise the uploader. Only served with developer set. g_mockstats_fail is the percentage of reports to reject.
+* The web server caps request bodies, so lower g_racespool_batch for long runs.
+*/
+http_response_code_t G_MockStats_WebRequest( http_query_method_t method, const char *resource,
+	const char *query_string, char **content, size_t *content_length )
+{
+	static const char reply[] = "{ \"status\" : 1 }\n";
+
+	if( method != HTTP_METHOD_POST ) {
+		return HTTP_RESP_BAD_REQUEST;
+	}
+
+	rspool.mockReceived++;
+	if( random() * 100.0f < g_mockstats_fail->value ) {
+		rspool.mockRejected++;
+		return HTTP_RESP_SERVICE_UNAVAILABLE;
+	}
+
+	*content = ( char * )G_Malloc( sizeof( reply ) );
+	memcpy( *content, reply, sizeof( reply ) );
+	*content_length = sizeof( reply ) - 1;
+	return HTTP_RESP_OK;
+}
@@ -583,9 +583,11 @@ void G_AddServerCommands( void )
 	trap_Cmd_AddCommand( "addbotroam", AITools_AddBotRoamNode_Cmd );
 
 	trap_Cmd_AddCommand( "dumpASapi", G_asDumpAPI_f );
+	trap_Cmd_AddCommand( "asprofile", G_asProfile_f );
 
 	trap_Cmd_AddCommand( "listratings", G_ListRatings_f );
 	trap_Cmd_AddCommand( "listraces", G_ListRaces_f );
+	trap_Cmd_AddCommand( "racespool", G_RaceSpool_f );
 
 	trap_Cmd_AddCommand( "listlocations", Cmd_ListLocations_f );
 }
@@ -620,9 +622,11 @@ void G_RemoveCommands( void )
 	trap_Cmd_RemoveCommand( "addbotroam" );
 
 	trap_Cmd_RemoveCommand( "dumpASapi" );
+	trap_Cmd_RemoveCommand( "asprofile" );
 
 	trap_Cmd_RemoveCommand( "listratings" );
 	trap_Cmd_RemoveCommand( "listraces" );
+	trap_Cmd_RemoveCommand( "racespool" );
 
 	trap_Cmd_RemoveCommand( "listlocations" );
 }
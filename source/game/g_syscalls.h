@@ -84,6 +84,26 @@ static inline unsigned int trap_Milliseconds( void )
 	return GAME_IMPORT.Milliseconds();
 }
 
+static inline uint64_t trap_Microseconds( void )
+{
+	return GAME_IMPORT.Microseconds();
+}
+
+static inline int trap_ProfileZone( const char *name )
+{
+	return GAME_IMPORT.ProfileZone( name );
+}
+
+static inline void trap_ProfileBegin( int zone )
+{
+	GAME_IMPORT.ProfileBegin( zone );
+}
+
+static inline void trap_ProfileEnd( int zone )
+{
+	GAME_IMPORT.ProfileEnd( zone );
+}
+
 static inline bool trap_inPVS( const vec3_t p1, const vec3_t p2 )
 {
 	return GAME_IMPORT.inPVS( p1, p2 ) == true;
@@ -35,5 +35,10 @@ http_response_code_t G_WebRequest( http_query_method_t method, const char *resou
 	if( !Q_strnicmp( resource, "players", 7 ) ) {
 		return G_PlayerlistWebRequest( method, resource, query_string, content, content_length );
 	}
+
+	// the stats backend stand-in is only for testing the uploader
+	if( developer->integer && !Q_strnicmp( resource, "mockstats", 9 ) ) {
+		return G_MockStats_WebRequest( method, resource, query_string, content, content_length );
+	}
 	return HTTP_RESP_NOT_FOUND;
 }
@@ -425,6 +425,13 @@ typedef int socket_handle_t;
 #define ATTRIBUTE_NAKED
 #endif
 
+// per-thread copy of a global or static, for scratch buffers used by worker threads
+#if defined ( _MSC_VER )
+#define QF_THREAD_LOCAL        __declspec( thread )
+#else
+#define QF_THREAD_LOCAL        __thread
+#endif
+
 #ifdef HAVE___STRTOI64
 #define strtoll _strtoi64
 #define strtoull _strtoi64
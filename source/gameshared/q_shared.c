@@ -330,8 +330,8 @@ float ( *LittleFloat )(float l) = &LittleFloatDetectSwap;
 */
 float *tv( float x, float y, float z )
 {
-	static int index;
-	static float vecs[8][3];
+	static QF_THREAD_LOCAL int index;
+	static QF_THREAD_LOCAL float vecs[8][3];
 	float *v;
 
 	// use an array so that multiple tempvectors won't collide
@@ -353,8 +353,8 @@ float *tv( float x, float y, float z )
 */
 char *vtos( float v[3] )
 {
-	static int index;
-	static char str[8][32];
+	static QF_THREAD_LOCAL int index;
+	static QF_THREAD_LOCAL char str[8][32];
 	char *s;
 
 	// use an array so that multiple vtos won't collide
@@ -390,8 +390,8 @@ char *va_r( char *dest, size_t size, const char *format, ... )
 char *va( const char *format, ... )
 {
 	va_list	argptr;
-	static int str_index;
-	static char string[8][2048];
+	static QF_THREAD_LOCAL int str_index;
+	static QF_THREAD_LOCAL char string[8][2048];
 
 	str_index = ( str_index+1 ) & 7;
 	va_start( argptr, format );
@@ -631,7 +631,7 @@ skipwhite:
 	return token;
 }
 
-static char com_token[MAX_TOKEN_CHARS];
+static QF_THREAD_LOCAL char com_token[MAX_TOKEN_CHARS];
 
 /*
  * COM_ParseExt
@@ -733,7 +733,7 @@ int Q_GrabWCharFromColorString( const char **pstr, wchar_t *wc, int *colorindex
 */
 const char *COM_RemoveColorTokensExt( const char *str, bool draw )
 {
-	static char cleanString[MAX_STRING_CHARS];
+	static QF_THREAD_LOCAL char cleanString[MAX_STRING_CHARS];
 	char *out = cleanString, *end = cleanString + sizeof( cleanString );
 	const char *in = str;
 	char c;
@@ -877,7 +877,7 @@ const char *Q_ColorStringTerminator( const char *str, int finalcolor )
 	else
 	{
 		int escapecount = 0;
-		static char buf[4];
+		static QF_THREAD_LOCAL char buf[4];
 		char *p = buf;
 
 		// count up trailing ^'s
@@ -935,7 +935,7 @@ int Q_ColorStrLastColor( int previous, const char *s, int maxlen )
 */
 const char *COM_RemoveJunkChars( const char *in )
 {
-	static char cleanString[MAX_STRING_CHARS];
+	static QF_THREAD_LOCAL char cleanString[MAX_STRING_CHARS];
 	char *out = cleanString, *end = cleanString + sizeof( cleanString ) - 1;
 
 	if( in )
@@ -1332,7 +1332,7 @@ size_t Q_WCharToUtf8( wchar_t wc, char *dest, size_t bufsize )
 */
 char *Q_WCharToUtf8Char( wchar_t wc )
 {
-	static char buf[5];	// longest valid utf-8 sequence is 4 bytes
+	static QF_THREAD_LOCAL char buf[5];	// longest valid utf-8 sequence is 4 bytes
 	Q_WCharToUtf8( wc, buf, sizeof( buf ) );
 	return buf;
 }
@@ -1838,8 +1838,8 @@ static char *Info_FindKey( const char *info, const char *key )
 */
 char *Info_ValueForKey( const char *info, const char *key )
 {
-	static char value[2][MAX_INFO_VALUE]; // use two buffers so compares work without stomping on each other
-	static int valueindex;
+	static QF_THREAD_LOCAL char value[2][MAX_INFO_VALUE]; // use two buffers so compares work without stomping on each other
+	static QF_THREAD_LOCAL int valueindex;
 	const char *p, *start;
 	size_t len;
 
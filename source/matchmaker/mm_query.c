@@ -53,6 +53,7 @@ struct stat_query_s
 	char **response_tokens;
 	int response_numtokens;
 
+	int status;		// HTTP response code, or the wswcurl error if negative
 };
 
 //===============================================
@@ -172,6 +173,8 @@ static void StatQuery_CallbackGeneric( wswcurl_req *req, int status, void *custo
 	stat_query_t *query = (stat_query_t *)customp;
 	bool success = status > 0 ? true : false;
 
+	query->status = status;
+
 	// print some stuff out
 	if( status < 0 )
 	{
@@ -580,6 +583,11 @@ static char **StatQuery_GetTokenizedResponse( stat_query_t *query, int *argc )
 	return query->response_tokens;
 }
 
+static int StatQuery_GetStatus( stat_query_t *query )
+{
+	return query->status;
+}
+
 static void StatQuery_Poll( void )
 {
 	// TODO: handle and state validation
@@ -637,6 +645,7 @@ void StatQuery_Init( void )
 	sq_export.AddArrayNumber = StatQuery_AddArrayNumber;
 	sq_export.GetRawResponse = StatQuery_GetRawResponse;
 	sq_export.GetTokenizedResponse = StatQuery_GetTokenizedResponse;
+	sq_export.GetStatus = StatQuery_GetStatus;
 	sq_export.Poll = StatQuery_Poll;
 
 	// init JSON
@@ -68,6 +68,8 @@ typedef struct stat_query_api_s
 	const char *( *GetRawResponse )( stat_query_t *query );
 	// char *const *( *GetTokenizedResponse )( stat_query_t *query, int *argc );
 	char **( *GetTokenizedResponse )( stat_query_t *query, int *argc );
+	// HTTP response code of a finished query, negative on transfer errors
+	int ( *GetStatus )( stat_query_t *query );
 
 	// translates to wswcurl_perform()
 	void ( *Poll )( void );
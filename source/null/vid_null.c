@@ -17,116 +17,850 @@
    Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 
  */
-// vid_null.c -- null video driver to aid porting efforts
-// this assumes that one of the refs is statically linked to the executable
+// vid_null.c -- null refresh, linked into the client and selected with "vid_null 1"
+//
+// Nothing is ever drawn, but models are loaded far enough for the client game to behave
+// the way it does on a real renderer: skeletons, poses and frame bounds of skeletal models,
+// frame bounds and tags of alias models, and inline model bounds from the collision map.
+// This lets the client run its whole CPU path, demo playback included, with no GPU.
 
 #include "../client/client.h"
+#include "../qalgo/hash.h"
+#include "../ref_gl/iqm.h"
 
-viddef_t viddef;             // global video state
-bool vid_ref_active;
-bool vid_ref_modified;
+#define NULLREF_HASH_SIZE		256
+#define NULLREF_PIC_SIZE		64		// reported size of pics, there are no images to take it from
+
+typedef struct nullasset_s
+{
+	char *name;
+	struct nullasset_s *hashNext;
+} nullasset_t;
+
+typedef enum
+{
+	NULLMOD_NONE,
+	NULLMOD_ALIAS,
+	NULLMOD_SKELETAL,
+	NULLMOD_INLINE
+} nullmodtype_t;
+
+typedef struct
+{
+	vec3_t mins, maxs;
+} nullframe_t;
+
+typedef struct
+{
+	char name[MD3_MAX_PATH];
+	quat_t quat;
+	vec3_t origin;
+} nulltag_t;
+
+typedef struct
+{
+	char *name;
+	int parent;
+} nullbone_t;
+
+struct model_s
+{
+	nullasset_t asset;
+	nullmodtype_t type;
+	vec3_t mins, maxs;
+
+	int numframes;
+	nullframe_t *frames;
+
+	int numtags;
+	nulltag_t *tags;			// numframes * numtags
+
+	int numbones;
+	nullbone_t *bones;
+	bonepose_t *boneposes;		// numframes * numbones
+};
+
+struct shader_s
+{
+	nullasset_t asset;
+	int width, height;
+};
+
+struct skinfile_s
+{
+	nullasset_t asset;
+};
+
+static mempool_t *nullref_mempool;
+
+static nullasset_t *nullref_models[NULLREF_HASH_SIZE];
+static nullasset_t *nullref_shaders[NULLREF_HASH_SIZE];
+static nullasset_t *nullref_skinfiles[NULLREF_HASH_SIZE];
 
 /*
-   ==========================================================================
+* NullRef_FindAsset
+*
+* Assets are kept until the refresh is shut down, so registration never hits the disk twice
+*/
+static void *NullRef_FindAsset( nullasset_t **hash, const char *name, size_t size, bool *created )
+{
+	unsigned int key;
+	nullasset_t *asset;
+
+	key = COM_HashKey( name, NULLREF_HASH_SIZE );
+	for( asset = hash[key]; asset; asset = asset->hashNext )
+	{
+		if( !Q_stricmp( asset->name, name ) )
+		{
+			*created = false;
+			return asset;
+		}
+	}
 
-   DIRECT LINK GLUE
+	asset = Mem_Alloc( nullref_mempool, size + strlen( name ) + 1 );
+	asset->name = ( char * )asset + size;
+	strcpy( asset->name, name );
+	asset->hashNext = hash[key];
+	hash[key] = asset;
 
-   ==========================================================================
- */
+	*created = true;
+	return asset;
+}
 
-void VID_NewWindow( int width, int height )
+/*
+* NullRef_LoadAliasModel
+*/
+static void NullRef_LoadAliasModel( struct model_s *mod, uint8_t *buffer, int filelen )
 {
-	viddef.width = width;
-	viddef.height = height;
+	int i, j, k;
+	dmd3header_t header;
+	dmd3frame_t inframe;
+	dmd3tag_t intag;
+	mat3_t axis;
+
+	memcpy( &header, buffer, sizeof( header ) );
+	header.version = LittleLong( header.version );
+	header.num_frames = LittleLong( header.num_frames );
+	header.num_tags = LittleLong( header.num_tags );
+	header.ofs_frames = LittleLong( header.ofs_frames );
+	header.ofs_tags = LittleLong( header.ofs_tags );
+
+	if( header.version != MD3_ALIAS_VERSION || header.num_frames < 1 || header.num_frames > MD3_MAX_FRAMES
+		|| header.num_tags < 0 || header.num_tags > MD3_MAX_TAGS
+		|| header.ofs_frames < 0 || header.ofs_frames + header.num_frames * (int)sizeof( dmd3frame_t ) > filelen
+		|| header.ofs_tags < 0 || header.ofs_tags + header.num_frames * header.num_tags * (int)sizeof( dmd3tag_t ) > filelen )
+	{
+		Com_DPrintf( S_COLOR_YELLOW "NullRef_LoadAliasModel: %s is invalid\n", mod->asset.name );
+		return;
+	}
+
+	mod->type = NULLMOD_ALIAS;
+	mod->numframes = header.num_frames;
+	mod->numtags = header.num_tags;
+	mod->frames = Mem_Alloc( nullref_mempool, sizeof( nullframe_t ) * mod->numframes );
+	if( mod->numtags )
+		mod->tags = Mem_Alloc( nullref_mempool, sizeof( nulltag_t ) * mod->numframes * mod->numtags );
+
+	for( i = 0; i < mod->numframes; i++ )
+	{
+		memcpy( &inframe, buffer + header.ofs_frames + i * sizeof( dmd3frame_t ), sizeof( dmd3frame_t ) );
+		for( j = 0; j < 3; j++ )
+		{
+			mod->frames[i].mins[j] = LittleFloat( inframe.mins[j] );
+			mod->frames[i].maxs[j] = LittleFloat( inframe.maxs[j] );
+		}
+		AddPointToBounds( mod->frames[i].mins, mod->mins, mod->maxs );
+		AddPointToBounds( mod->frames[i].maxs, mod->mins, mod->maxs );
+	}
+
+	for( i = 0; i < mod->numframes * mod->numtags; i++ )
+	{
+		nulltag_t *tag = &mod->tags[i];
+
+		memcpy( &intag, buffer + header.ofs_tags + i * sizeof( dmd3tag_t ), sizeof( dmd3tag_t ) );
+		for( j = 0; j < 3; j++ )
+		{
+			for( k = 0; k < 3; k++ )
+				axis[j * 3 + k] = LittleFloat( intag.axis[j][k] );
+			tag->origin[j] = LittleFloat( intag.origin[j] );
+		}
+
+		Quat_FromMatrix3( axis, tag->quat );
+		Quat_Normalize( tag->quat );
+		Q_strncpyz( tag->name, intag.name, sizeof( tag->name ) );
+	}
 }
 
 /*
-** VID_GetModeInfo
+* NullRef_LoadSkeletalModel
+*
+* Only the skeleton and the frames, the same way ref_gl builds them in Mod_LoadSkeletalModel
 */
-typedef struct vidmode_s
+static void NullRef_LoadSkeletalModel( struct model_s *mod, uint8_t *buffer, int filelen )
 {
-	const char *description;
-	int width, height;
-	int mode;
-} vidmode_t;
-
-vidmode_t vid_modes[] =
-{
-	{ "Mode 0: 320x240", 320, 240, 0 },
-	{ "Mode 1: 400x300", 400, 300, 1 },
-	{ "Mode 2: 512x384", 512, 384, 2 },
-	{ "Mode 3: 640x480", 640, 480, 3 },
-	{ "Mode 4: 800x600", 800, 600, 4 },
-	{ "Mode 5: 960x720", 960, 720, 5 },
-	{ "Mode 6: 1024x768", 1024, 768, 6 },
-	{ "Mode 7: 1152x864", 1152, 864, 7 },
-	{ "Mode 8: 1280x800", 1280, 800, 8 },
-	{ "Mode 9: 1280x960", 1280, 960, 9 },
-	{ "Mode 10: 1280x1024", 1280, 1024, 10 },
-	{ "Mode 11: 1600x1200", 1600, 1200, 11 },
-	{ "Mode 12: 2048x1536", 2048, 1536, 12 }
-};
-#define VID_NUM_MODES ( sizeof( vid_modes ) / sizeof( vid_modes[0] ) )
+	unsigned int i, j, k;
+	struct iqmheader header;
+	struct iqmjoint joint;
+	struct iqmpose *poses;
+	struct iqmbounds inbound;
+	unsigned short *framedata;
+	char *texts;
+
+	memcpy( &header, buffer, sizeof( header ) );
+
+#define H_SWAP(s) (header.s = LittleLong( header.s ))
+	H_SWAP( version );
+	H_SWAP( num_text );
+	H_SWAP( ofs_text );
+	H_SWAP( num_joints );
+	H_SWAP( ofs_joints );
+	H_SWAP( num_poses );
+	H_SWAP( ofs_poses );
+	H_SWAP( num_frames );
+	H_SWAP( num_framechannels );
+	H_SWAP( ofs_frames );
+	H_SWAP( ofs_bounds );
+#undef H_SWAP
+
+	if( header.version != IQM_VERSION || header.num_frames < 1 || !header.num_joints
+		|| header.num_joints != header.num_poses || !header.ofs_bounds
+		|| header.ofs_text + header.num_text > (unsigned)filelen
+		|| header.ofs_joints + header.num_joints * sizeof( struct iqmjoint ) > (unsigned)filelen
+		|| header.ofs_poses + header.num_poses * sizeof( struct iqmpose ) > (unsigned)filelen
+		|| header.ofs_frames + header.num_frames * header.num_framechannels * sizeof( unsigned short ) > (unsigned)filelen
+		|| header.ofs_bounds + header.num_frames * sizeof( struct iqmbounds ) > (unsigned)filelen )
+	{
+		Com_DPrintf( S_COLOR_YELLOW "NullRef_LoadSkeletalModel: %s is invalid\n", mod->asset.name );
+		return;
+	}
 
-bool VID_GetModeInfo( int *width, int *height, int mode )
+	texts = Mem_Alloc( nullref_mempool, header.num_text + 1 );
+	memcpy( texts, buffer + header.ofs_text, header.num_text );
+
+	mod->type = NULLMOD_SKELETAL;
+	mod->numbones = header.num_joints;
+	mod->numframes = header.num_frames;
+	mod->bones = Mem_Alloc( nullref_mempool, sizeof( nullbone_t ) * mod->numbones );
+	mod->boneposes = Mem_Alloc( nullref_mempool, sizeof( bonepose_t ) * mod->numbones * mod->numframes );
+	mod->frames = Mem_Alloc( nullref_mempool, sizeof( nullframe_t ) * mod->numframes );
+
+	for( i = 0; i < header.num_joints; i++ )
+	{
+		memcpy( &joint, buffer + header.ofs_joints + i * sizeof( struct iqmjoint ), sizeof( joint ) );
+		joint.name = LittleLong( joint.name );
+		joint.parent = LittleLong( joint.parent );
+
+		mod->bones[i].name = texts + ( joint.name < header.num_text ? joint.name : header.num_text );
+		mod->bones[i].parent = joint.parent < (int)i ? joint.parent : -1;
+	}
+
+	poses = Mem_TempMalloc( sizeof( struct iqmpose ) * header.num_poses );
+	memcpy( poses, buffer + header.ofs_poses, sizeof( struct iqmpose ) * header.num_poses );
+	for( i = 0; i < header.num_poses; i++ )
+	{
+		poses[i].parent = LittleLong( poses[i].parent );
+		poses[i].mask = LittleLong( poses[i].mask );
+		for( j = 0; j < 10; j++ )
+		{
+			poses[i].channeloffset[j] = LittleFloat( poses[i].channeloffset[j] );
+			poses[i].channelscale[j] = LittleFloat( poses[i].channelscale[j] );
+		}
+	}
+
+	framedata = ( unsigned short * )( buffer + header.ofs_frames );
+	for( i = 0; i < header.num_frames; i++ )
+	{
+		bonepose_t *pbp = mod->boneposes + i * mod->numbones;
+
+		for( j = 0; j < header.num_poses; j++, pbp++ )
+		{
+			const struct iqmpose *pose = &poses[j];
+			vec3_t translate;
+			quat_t rotate;
+			float channels[7];
+
+			for( k = 0; k < 7; k++ )
+			{
+				channels[k] = pose->channeloffset[k];
+				if( pose->mask & ( 1 << k ) )
+					channels[k] += LittleShort( *framedata++ ) * pose->channelscale[k];
+			}
+
+			// scale is unused
+			for( k = 7; k < 10; k++ )
+			{
+				if( pose->mask & ( 1 << k ) )
+					framedata++;
+			}
+
+			VectorCopy( channels, translate );
+			Vector4Copy( channels + 3, rotate );
+			if( rotate[3] > 0 )
+				Vector4Inverse( rotate );
+			Vector4Normalize( rotate );
+
+			DualQuat_FromQuatAndVector( rotate, translate, pbp->dualquat );
+		}
+
+		memcpy( &inbound, buffer + header.ofs_bounds + i * sizeof( struct iqmbounds ), sizeof( inbound ) );
+		for( j = 0; j < 3; j++ )
+		{
+			mod->frames[i].mins[j] = LittleFloat( inbound.bbmin[j] );
+			mod->frames[i].maxs[j] = LittleFloat( inbound.bbmax[j] );
+		}
+		AddPointToBounds( mod->frames[i].mins, mod->mins, mod->maxs );
+		AddPointToBounds( mod->frames[i].maxs, mod->mins, mod->maxs );
+	}
+
+	Mem_TempFree( poses );
+}
+
+/*
+* NullRef_InlineModelBounds
+*/
+static void NullRef_InlineModelBounds( int num, vec3_t mins, vec3_t maxs )
 {
-	if( mode < 0 || mode >= VID_NUM_MODES )
+	struct cmodel_s *cmodel;
+
+	if( !cl.cms || num < 0 || num >= CM_NumInlineModels( cl.cms ) )
+		return;
+
+	cmodel = CM_InlineModel( cl.cms, num );
+	if( cmodel )
+		CM_InlineModelBounds( cl.cms, cmodel, mins, maxs );
+}
+
+/*
+* NullRef_RegisterModel
+*/
+static struct model_s *NullRef_RegisterModel( const char *name )
+{
+	bool created;
+	int filelen;
+	uint8_t *buffer;
+	struct model_s *mod;
+
+	if( !name || !name[0] )
+		return NULL;
+
+	mod = NullRef_FindAsset( nullref_models, name, sizeof( *mod ), &created );
+	if( !created )
+		return mod->type == NULLMOD_NONE ? NULL : mod;
+
+	mod->type = NULLMOD_NONE;
+	ClearBounds( mod->mins, mod->maxs );
+
+	if( name[0] == '*' )
+	{
+		mod->type = NULLMOD_INLINE;
+		VectorClear( mod->mins );
+		VectorClear( mod->maxs );
+		NullRef_InlineModelBounds( atoi( name + 1 ), mod->mins, mod->maxs );
+		return mod;
+	}
+
+	filelen = FS_LoadFile( name, ( void ** )&buffer, NULL, 0 );
+	if( !buffer )
+		return NULL;
+
+	if( filelen >= (int)sizeof( dmd3header_t ) && !memcmp( buffer, IDMD3HEADER, 4 ) )
+		NullRef_LoadAliasModel( mod, buffer, filelen );
+	else if( filelen >= (int)sizeof( struct iqmheader ) && !memcmp( buffer, IQM_MAGIC, sizeof( IQM_MAGIC ) ) )
+		NullRef_LoadSkeletalModel( mod, buffer, filelen );
+
+	FS_FreeFile( buffer );
+
+	if( mod->type == NULLMOD_NONE )
+		return NULL;
+	return mod;
+}
+
+/*
+* NullRef_ModelBounds
+*/
+static void NullRef_ModelBounds( const struct model_s *model, vec3_t mins, vec3_t maxs )
+{
+	if( model )
+	{
+		VectorCopy( model->mins, mins );
+		VectorCopy( model->maxs, maxs );
+		return;
+	}
+
+	// the world
+	NullRef_InlineModelBounds( 0, mins, maxs );
+}
+
+/*
+* NullRef_ModelFrameBounds
+*/
+static void NullRef_ModelFrameBounds( const struct model_s *model, int frame, vec3_t mins, vec3_t maxs )
+{
+	if( !model || !model->numframes )
+		return;
+
+	if( frame < 0 || frame >= model->numframes )
+		frame = 0;
+	VectorCopy( model->frames[frame].mins, mins );
+	VectorCopy( model->frames[frame].maxs, maxs );
+}
+
+/*
+* NullRef_LerpTag
+*/
+static bool NullRef_LerpTag( orientation_t *orient, const struct model_s *mod, int oldframe, int frame, float lerpfrac,
+	const char *name )
+{
+	int i;
+	quat_t quat;
+	const nulltag_t *tag, *oldtag;
+
+	if( !orient )
+		return false;
+
+	VectorClear( orient->origin );
+	Matrix3_Identity( orient->axis );
+
+	if( !name || !mod || mod->type != NULLMOD_ALIAS )
+		return false;
+
+	for( i = 0; i < mod->numtags; i++ )
+	{
+		if( !Q_stricmp( mod->tags[i].name, name ) )
+			break;
+	}
+	if( i == mod->numtags )
 		return false;
 
-	*width  = vid_modes[mode].width;
-	*height = vid_modes[mode].height;
+	if( frame < 0 || frame >= mod->numframes )
+		frame = 0;
+	if( oldframe < 0 || oldframe >= mod->numframes )
+		oldframe = 0;
+
+	tag = mod->tags + frame * mod->numtags + i;
+	oldtag = mod->tags + oldframe * mod->numtags + i;
 
+	Quat_Lerp( oldtag->quat, tag->quat, lerpfrac, quat );
+	Quat_ToMatrix3( quat, orient->axis );
+
+	orient->origin[0] = oldtag->origin[0] + ( tag->origin[0] - oldtag->origin[0] ) * lerpfrac;
+	orient->origin[1] = oldtag->origin[1] + ( tag->origin[1] - oldtag->origin[1] ) * lerpfrac;
+	orient->origin[2] = oldtag->origin[2] + ( tag->origin[2] - oldtag->origin[2] ) * lerpfrac;
 	return true;
 }
 
-static void VID_Restart_f( void )
+/*
+* NullRef_SkeletalGetNumBones
+*/
+static int NullRef_SkeletalGetNumBones( const struct model_s *mod, int *numFrames )
+{
+	if( !mod || mod->type != NULLMOD_SKELETAL )
+		return 0;
+
+	if( numFrames )
+		*numFrames = mod->numframes;
+	return mod->numbones;
+}
+
+/*
+* NullRef_SkeletalGetBoneInfo
+*/
+static int NullRef_SkeletalGetBoneInfo( const struct model_s *mod, int bone, char *name, size_t name_size, int *flags )
+{
+	if( !mod || mod->type != NULLMOD_SKELETAL )
+		return 0;
+
+	if( bone < 0 || bone >= mod->numbones )
+		Com_Error( ERR_DROP, "NullRef_SkeletalGetBoneInfo: bad bone number" );
+
+	if( name && name_size )
+		Q_strncpyz( name, mod->bones[bone].name, name_size );
+	if( flags )
+		*flags = 0;
+	return mod->bones[bone].parent;
+}
+
+/*
+* NullRef_SkeletalGetBonePose
+*/
+static void NullRef_SkeletalGetBonePose( const struct model_s *mod, int bone, int frame, bonepose_t *bonepose )
+{
+	if( !mod || mod->type != NULLMOD_SKELETAL )
+		return;
+
+	if( bone < 0 || bone >= mod->numbones )
+		Com_Error( ERR_DROP, "NullRef_SkeletalGetBonePose: bad bone number" );
+	if( frame < 0 || frame >= mod->numframes )
+		Com_Error( ERR_DROP, "NullRef_SkeletalGetBonePose: bad frame number" );
+
+	if( bonepose )
+		*bonepose = mod->boneposes[frame * mod->numbones + bone];
+}
+
+/*
+* NullRef_RegisterShader
+*/
+static struct shader_s *NullRef_RegisterShader( const char *name, int width, int height )
+{
+	bool created;
+	struct shader_s *shader;
+
+	shader = NullRef_FindAsset( nullref_shaders, name ? name : "", sizeof( *shader ), &created );
+	if( created || width )
+	{
+		shader->width = width ? width : NULLREF_PIC_SIZE;
+		shader->height = height ? height : NULLREF_PIC_SIZE;
+	}
+	return shader;
+}
+
+static struct shader_s *NullRef_RegisterPic( const char *name )
+{
+	return NullRef_RegisterShader( name, 0, 0 );
+}
+
+static struct shader_s *NullRef_RegisterRawPic( const char *name, int width, int height, uint8_t *data, int samples )
+{
+	return NullRef_RegisterShader( name, width, height );
+}
+
+static struct shader_s *NullRef_RegisterRawAlphaMask( const char *name, int width, int height, uint8_t *data )
+{
+	return NullRef_RegisterShader( name, width, height );
+}
+
+static struct shader_s *NullRef_RegisterLevelshot( const char *name, struct shader_s *defaultShader, bool *matchesDefault )
 {
-	VID_Restart( (Cmd_Argc() >= 2 ? true : false) );
+	if( matchesDefault )
+		*matchesDefault = true;
+	return defaultShader;
 }
 
-void VID_Init( void )
+static struct shader_s *NullRef_RegisterSkin( const char *name )
 {
-	viddef.width = 320;
-	viddef.height = 240;
+	return NullRef_RegisterShader( name, 0, 0 );
+}
 
-	Cmd_AddCommand( "vid_restart", VID_Restart_f );
+static struct shader_s *NullRef_RegisterVideo( const char *name )
+{
+	return NullRef_RegisterShader( name, 0, 0 );
+}
+
+/*
+* NullRef_RegisterSkinFile
+*
+* Like ref_gl, fails for skin files that don't exist
+*/
+static struct skinfile_s *NullRef_RegisterSkinFile( const char *name )
+{
+	bool created;
+	struct skinfile_s *skinfile;
+
+	if( !name || !name[0] )
+		return NULL;
+
+	if( FS_FOpenFile( name, NULL, FS_READ ) == -1 )
+		return NULL;
+
+	skinfile = NullRef_FindAsset( nullref_skinfiles, name, sizeof( *skinfile ), &created );
+	return skinfile;
+}
+
+/*
+* NullRef_GetShaderDimensions
+*/
+static void NullRef_GetShaderDimensions( const struct shader_s *shader, int *width, int *height )
+{
+	if( !shader )
+		return;
 
-	vid_ref_active = false;
-	vid_ref_modified = true;
+	if( width )
+		*width = shader->width;
+	if( height )
+		*height = shader->height;
+}
 
-	VID_CheckChanges();
+/*
+* NullRef_LightForOrigin
+*/
+static void NullRef_LightForOrigin( const vec3_t origin, vec3_t dir, vec4_t ambient, vec4_t diffuse, float radius )
+{
+	// what ref_gl returns for maps without a light grid
+	VectorSet( dir, 0.1f, 0.2f, 0.7f );
+	if( ambient )
+		Vector4Set( ambient, 0, 0, 0, 1 );
+	if( diffuse )
+		Vector4Set( diffuse, 0, 0, 0, 1 );
 }
 
-void VID_Shutdown( void )
+/*
+* NullRef_TransformVectorToScreen
+*
+* The projection ref_gl does with its matrices, written out for the single point
+*/
+static void NullRef_TransformVectorToScreen( const refdef_t *rd, const vec3_t in, vec2_t out )
 {
-	if( vid_ref_active )
+	vec3_t v;
+	float forward, left, up, x, y;
+
+	if( !rd || !in || !out )
+		return;
+
+	VectorSubtract( in, rd->vieworg, v );
+	forward = DotProduct( v, &rd->viewaxis[AXIS_FORWARD] );
+	left = DotProduct( v, &rd->viewaxis[AXIS_RIGHT] );
+	up = DotProduct( v, &rd->viewaxis[AXIS_UP] );
+
+	if( rd->rdflags & RDF_USEORTHO )
 	{
-		R_Shutdown();
-		vid_ref_active = false;
+		if( !rd->ortho_x || !rd->ortho_y )
+			return;
+		x = -left / rd->ortho_x;
+		y = up / rd->ortho_y;
+	}
+	else
+	{
+		if( !forward )
+			return;
+		x = -left / ( forward * tan( DEG2RAD( rd->fov_x ) * 0.5 ) );
+		y = up / ( forward * tan( DEG2RAD( rd->fov_y ) * 0.5 ) );
 	}
 
-	Cmd_RemoveCommand( "vid_restart" );
+	if( rd->rdflags & RDF_FLIPPED )
+		x = -x;
+
+	out[0] = rd->x + ( x + 1.0f ) * rd->width * 0.5f;
+	out[1] = viddef.height - ( rd->y + ( y + 1.0f ) * rd->height * 0.5f );
 }
 
-void VID_CheckChanges( void )
+/*
+* NullRef_API
+*/
+static int NullRef_API( void )
 {
-	if( vid_ref_modified )
+	return REF_API_VERSION;
+}
+
+/*
+* NullRef_Init
+*/
+static rserr_t NullRef_Init( const char *applicationName, const char *screenshotsPrefix, int startupColor,
+	int iconResource, const int *iconXPM, void *hinstance, void *wndproc, void *parenthWnd, bool verbose )
+{
+	if( !nullref_mempool )
+		nullref_mempool = Mem_AllocPool( NULL, "Null Refresh" );
+
+	if( verbose )
+		Com_Printf( "Null refresh initialized, nothing will be drawn\n" );
+	return rserr_ok;
+}
+
+/*
+* NullRef_SetMode
+*/
+static rserr_t NullRef_SetMode( int x, int y, int width, int height, int displayFrequency, bool fullScreen, bool stereo )
+{
+	return rserr_ok;
+}
+
+/*
+* NullRef_SetWindow
+*/
+static rserr_t NullRef_SetWindow( void *hinstance, void *wndproc, void *parenthWnd )
+{
+	return rserr_ok;
+}
+
+/*
+* NullRef_Shutdown
+*/
+static void NullRef_Shutdown( bool verbose )
+{
+	memset( nullref_models, 0, sizeof( nullref_models ) );
+	memset( nullref_shaders, 0, sizeof( nullref_shaders ) );
+	memset( nullref_skinfiles, 0, sizeof( nullref_skinfiles ) );
+
+	if( nullref_mempool )
+		Mem_FreePool( &nullref_mempool );
+}
+
+/*
+* NullRef_RegisterWorldModel
+*
+* Model bounds of the world and its inline models come from the collision map, so there
+* is nothing to load. Forget inline models registered for the previous map.
+*/
+static void NullRef_RegisterWorldModel( const char *model, const dvis_t *pvsData )
+{
+	int i;
+	nullasset_t *asset;
+
+	for( i = 0; i < NULLREF_HASH_SIZE; i++ )
 	{
-		if( vid_ref_active )
+		for( asset = nullref_models[i]; asset; asset = asset->hashNext )
 		{
-			R_Shutdown();
-			vid_ref_active = false;
+			struct model_s *mod = ( struct model_s * )asset;
+			if( mod->type == NULLMOD_INLINE )
+			{
+				VectorClear( mod->mins );
+				VectorClear( mod->maxs );
+				NullRef_InlineModelBounds( atoi( asset->name + 1 ), mod->mins, mod->maxs );
+			}
 		}
+	}
+}
 
-		if( R_Init( NULL, NULL, NULL, 0, 0, 0, 0, false ) == -1 )
-			Com_Error( ERR_FATAL, "Couldn't start refresh" );
+static bool NullRef_RenderingEnabled( void )
+{
+	return true;
+}
 
-		vid_ref_active = true;
-		vid_ref_modified = false;
-	}
+static const char *NullRef_GetSpeedsMessage( char *out, size_t size )
+{
+	if( out && size )
+		out[0] = '\0';
+	return out;
 }
 
-void VID_Restart( void )
+static int NullRef_GetAverageFramerate( void )
 {
-	vid_ref_modified = true;
+	return 0;
+}
+
+static int NullRef_GetClippedFragments( const vec3_t origin, float radius, vec3_t axis[3], int maxfverts, vec4_t *fverts,
+	int maxfragments, fragment_t *fragments )
+{
+	return 0;
+}
+
+static struct shader_s *NullRef_GetShaderForOrigin( const vec3_t origin )
+{
+	return NULL;
+}
+
+static struct cinematics_s *NullRef_GetShaderCinematic( struct shader_s *shader )
+{
+	return NULL;
+}
+
+static void NullRef_GetScissor( int *x, int *y, int *w, int *h )
+{
+	if( x )
+		*x = 0;
+	if( y )
+		*y = 0;
+	if( w )
+		*w = viddef.width;
+	if( h )
+		*h = viddef.height;
+}
+
+// everything below draws, and there is nothing to draw to
+static void NullRef_BeginRegistration( void ) {}
+static void NullRef_EndRegistration( void ) {}
+static void NullRef_RemapShader( const char *from, const char *to, int timeOffset ) {}
+static void NullRef_ReplaceRawSubPic( struct shader_s *shader, int x, int y, int width, int height, uint8_t *data ) {}
+static void NullRef_ClearScene( void ) {}
+static void NullRef_AddEntityToScene( const entity_t *ent ) {}
+static void NullRef_AddLightToScene( const vec3_t org, float intensity, float r, float g, float b ) {}
+static void NullRef_AddPolyToScene( const poly_t *poly ) {}
+static void NullRef_AddLightStyleToScene( int style, float r, float g, float b ) {}
+static void NullRef_RenderScene( const refdef_t *fd ) {}
+static void NullRef_DrawStretchPic( int x, int y, int w, int h, float s1, float t1, float s2, float t2,
+	const float *color, const struct shader_s *shader ) {}
+static void NullRef_DrawRotatedStretchPic( int x, int y, int w, int h, float s1, float t1, float s2, float t2,
+	float angle, const vec4_t color, const struct shader_s *shader ) {}
+static void NullRef_DrawStretchRaw( int x, int y, int w, int h, int cols, int rows,
+	float s1, float t1, float s2, float t2, uint8_t *data ) {}
+static void NullRef_DrawStretchRawYUV( int x, int y, int w, int h,
+	float s1, float t1, float s2, float t2, ref_img_plane_t *yuv ) {}
+static void NullRef_DrawStretchPoly( const poly_t *poly, float x_offset, float y_offset ) {}
+static void NullRef_Scissor( int x, int y, int w, int h ) {}
+static void NullRef_ResetScissor( void ) {}
+static void NullRef_SetCustomColor( int num, int r, int g, int b ) {}
+static void NullRef_BeginFrame( float cameraSeparation, bool forceClear, bool forceVsync ) {}
+static void NullRef_EndFrame( void ) {}
+static void NullRef_BeginAviDemo( void ) {}
+static void NullRef_WriteAviFrame( int frame, bool scissor ) {}
+static void NullRef_StopAviDemo( void ) {}
+static void NullRef_AppActivate( bool active, bool destroy ) {}
+
+/*
+* VID_GetNullRefAPI
+*/
+ref_export_t *VID_GetNullRefAPI( void )
+{
+	static ref_export_t globals;
+
+	globals.API = NullRef_API;
+
+	globals.Init = NullRef_Init;
+	globals.SetMode = NullRef_SetMode;
+	globals.SetWindow = NullRef_SetWindow;
+	globals.Shutdown = NullRef_Shutdown;
+
+	globals.BeginRegistration = NullRef_BeginRegistration;
+	globals.EndRegistration = NullRef_EndRegistration;
+
+	globals.ModelBounds = NullRef_ModelBounds;
+	globals.ModelFrameBounds = NullRef_ModelFrameBounds;
+
+	globals.RegisterWorldModel = NullRef_RegisterWorldModel;
+	globals.RegisterModel = NullRef_RegisterModel;
+	globals.RegisterPic = NullRef_RegisterPic;
+	globals.RegisterRawPic = NullRef_RegisterRawPic;
+	globals.RegisterRawAlphaMask = NullRef_RegisterRawAlphaMask;
+	globals.RegisterLevelshot = NullRef_RegisterLevelshot;
+	globals.RegisterSkin = NullRef_RegisterSkin;
+	globals.RegisterSkinFile = NullRef_RegisterSkinFile;
+	globals.RegisterVideo = NullRef_RegisterVideo;
+
+	globals.RemapShader = NullRef_RemapShader;
+	globals.GetShaderDimensions = NullRef_GetShaderDimensions;
+	globals.ReplaceRawSubPic = NullRef_ReplaceRawSubPic;
+
+	globals.ClearScene = NullRef_ClearScene;
+	globals.AddEntityToScene = NullRef_AddEntityToScene;
+	globals.AddLightToScene = NullRef_AddLightToScene;
+	globals.AddPolyToScene = NullRef_AddPolyToScene;
+	globals.AddLightStyleToScene = NullRef_AddLightStyleToScene;
+	globals.RenderScene = NullRef_RenderScene;
+
+	globals.DrawStretchPic = NullRef_DrawStretchPic;
+	globals.DrawRotatedStretchPic = NullRef_DrawRotatedStretchPic;
+	globals.DrawStretchRaw = NullRef_DrawStretchRaw;
+	globals.DrawStretchRawYUV = NullRef_DrawStretchRawYUV;
+	globals.DrawStretchPoly = NullRef_DrawStretchPoly;
+	globals.Scissor = NullRef_Scissor;
+	globals.GetScissor = NullRef_GetScissor;
+	globals.ResetScissor = NullRef_ResetScissor;
+
+	globals.SetCustomColor = NullRef_SetCustomColor;
+	globals.LightForOrigin = NullRef_LightForOrigin;
+
+	globals.LerpTag = NullRef_LerpTag;
+
+	globals.SkeletalGetNumBones = NullRef_SkeletalGetNumBones;
+	globals.SkeletalGetBoneInfo = NullRef_SkeletalGetBoneInfo;
+	globals.SkeletalGetBonePose = NullRef_SkeletalGetBonePose;
+
+	globals.GetClippedFragments = NullRef_GetClippedFragments;
+	globals.GetShaderForOrigin = NullRef_GetShaderForOrigin;
+	globals.GetShaderCinematic = NullRef_GetShaderCinematic;
+
+	globals.TransformVectorToScreen = NullRef_TransformVectorToScreen;
+	globals.RenderingEnabled = NullRef_RenderingEnabled;
+
+	globals.BeginFrame = NullRef_BeginFrame;
+	globals.EndFrame = NullRef_EndFrame;
+	globals.GetSpeedsMessage = NullRef_GetSpeedsMessage;
+	globals.GetAverageFramerate = NullRef_GetAverageFramerate;
+
+	globals.BeginAviDemo = NullRef_BeginAviDemo;
+	globals.WriteAviFrame = NullRef_WriteAviFrame;
+	globals.StopAviDemo = NullRef_StopAviDemo;
+
+	globals.AppActivate = NullRef_AppActivate;
+
+	return &globals;
 }
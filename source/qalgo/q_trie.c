@@ -22,18 +22,39 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "q_trie.h"
 
 #include <assert.h>
+#include <stddef.h>
 #include <string.h>
 
 /* Trie structure definitions */
 
+/*
+* Keys are stored in a radix tree: a node holds the run of letters shared by all keys
+* below it, so nodes only exist where keys branch or end. Nodes are carved out of
+* blocks owned by the trie and recycled through free lists, one per node size class.
+*/
+
+#define TRIE_BLOCK_SIZE			( 32 * 1024 )
+#define TRIE_NODE_GRANULARITY	16
+#define TRIE_NODE_CLASSES		16		// larger nodes are allocated separately
+
+#define TRIE_BLOCK_HEADER_SIZE	( ( sizeof( struct trie_block_s ) + TRIE_NODE_GRANULARITY - 1 ) & ~( TRIE_NODE_GRANULARITY - 1 ) )
+#define TRIE_DUMP_KEY_SIZE		256
+
 struct trie_node_s
 {
-	int depth;
-	char letter;
-	struct trie_node_s *child;
-	struct trie_node_s *sibling;
-	int data_is_set;
+	struct trie_node_s *child;      // children are sorted by the first letter of their label
+	struct trie_node_s *sibling;    // also links free nodes
 	void *data;
+	unsigned int length;            // length of the label
+	unsigned char size_class;       // 0 if not allocated from a block
+	unsigned char data_is_set;
+	char label[1];                  // not terminated
+};
+
+struct trie_block_s
+{
+	struct trie_block_s *next;
+	size_t used;
 };
 
 struct trie_s
@@ -41,71 +62,94 @@ struct trie_s
 	struct trie_node_s *root;
 	unsigned int size;
 	trie_casing_t casing;
+	struct trie_block_s *blocks;
+	struct trie_node_s *free_nodes[TRIE_NODE_CLASSES + 1];
+	size_t memory;
 };
 
-typedef enum trie_remove_result_t
+typedef struct trie_dump_state_s
 {
-	TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT = 0,
-	TRIE_REMOVE_CHILDREN_OR_DATA_LEFT = 1,
-	TRIE_REMOVE_DATA_LEFT,
-	TRIE_REMOVE_KEY_NOT_FOUND
-} trie_remove_result_t;
+	trie_dump_what_t what;
+	int ( *predicate )( void *value, void *cookie );
+	void *cookie;
+	char *key;
+	size_t key_size;
+	struct trie_key_value_s *key_value_vector;
+} trie_dump_state_t;
 
 /* Forward declarations of internal implementation */
 
 static struct trie_node_s *Trie_CreateNode(
-        int depth,
-        char letter,
-        struct trie_node_s *child,
-        struct trie_node_s *sibling,
-        int data_is_set,
-        void *data
+        struct trie_s *trie,
+        const char *label,
+        unsigned int length
+);
+
+static void Trie_FreeNode(
+        struct trie_s *trie,
+        struct trie_node_s *node
+);
+
+static void Trie_FreeNodes(
+        struct trie_s *trie
 );
 
-static void Trie_Destroy_Rec(
+static void Trie_FreeLargeNodes_Rec(
         struct trie_node_s *node
 );
 
-static struct trie_node_s *TRIE_Find_Rec(
+static struct trie_node_s **Trie_FindChild(
         struct trie_node_s *node,
+        char letter,
+        trie_casing_t casing
+);
+
+static unsigned int Trie_MatchLabel(
+        const struct trie_node_s *node,
+        const char *key,
+        trie_casing_t casing
+);
+
+static struct trie_node_s *Trie_FindNode(
+        const struct trie_s *trie,
         const char *key,
         trie_find_mode_t mode,
-        trie_casing_t casing,
+        unsigned int *path_length
+);
+
+static struct trie_node_s *Trie_FirstMatch_Rec(
+        struct trie_node_s *node,
         int ( *predicate )( void *value, void *cookie ),
         void *cookie
 );
 
-static int Trie_Insert_Rec(
-        struct trie_node_s *node,
+static trie_error_t Trie_InsertNode(
+        struct trie_s *trie,
         const char *key,
-        trie_casing_t casing,
         void *data
 );
 
-static trie_remove_result_t Trie_Remove_Rec(
-        struct trie_node_s *node,
+static trie_error_t Trie_RemoveNode(
+        struct trie_s *trie,
         const char *key,
-        trie_casing_t casing,
         void **data
 );
 
+static void Trie_MergeWithChild(
+        struct trie_s *trie,
+        struct trie_node_s **link
+);
+
 static unsigned int Trie_NoOfKeys(
         const struct trie_node_s *node,
-        trie_casing_t casing,
         int ( *predicate )( void *value, void *cookie ),
-        void *cookie,
-        int addSiblings
+        void *cookie
 );
 
 static void Trie_Dump_Rec(
         const struct trie_node_s *node,
-        trie_dump_what_t what,
-        trie_casing_t casing,
-        int ( *predicate )( void *value, void *cookie ),
-        void *cookie,
-        int dumpSiblings,
-        const char *key_prev,
-        struct trie_key_value_s **key_value_vector
+        size_t key_length,
+        trie_dump_state_t *state
 );
 
 static int Trie_AlwaysTrue(
@@ -113,6 +157,10 @@ static int Trie_AlwaysTrue(
         void *
 );
 
+static inline char Trie_LowerCase(
+        char letter
+);
+
 static inline int Trie_LetterCompare(
         char left,
         char right,
@@ -129,9 +177,9 @@ trie_error_t Trie_Create(
 	if( trie )
 	{
 		*trie = (struct trie_s *) malloc( sizeof( struct trie_s ) );
-		( *trie )->root = Trie_CreateNode( 0, '\0', NULL, NULL, 0, NULL );
-		( *trie )->size = 0;
+		memset( *trie, 0, sizeof( struct trie_s ) );
 		( *trie )->casing = casing;
+		( *trie )->root = Trie_CreateNode( *trie, "", 0 );
 		return TRIE_OK;
 	}
 	else
@@ -144,7 +192,7 @@ trie_error_t Trie_Destroy(
 {
 	if( trie )
 	{
-		Trie_Destroy_Rec( trie->root );
+		Trie_FreeNodes( trie );
 		free( trie );
 		return TRIE_OK;
 	}
@@ -158,8 +206,8 @@ trie_error_t Trie_Clear(
 {
 	if( trie )
 	{
-		Trie_Destroy_Rec( trie->root );
-		trie->root = Trie_CreateNode( 0, '\0', NULL, NULL, 0, NULL );
+		Trie_FreeNodes( trie );
+		trie->root = Trie_CreateNode( trie, "", 0 );
 		trie->size = 0;
 		return TRIE_OK;
 	}
@@ -181,6 +229,20 @@ trie_error_t Trie_GetSize(
 		return TRIE_INVALID_ARGUMENT;
 }
 
+trie_error_t Trie_GetMemoryUsage(
+        struct trie_s *trie,
+        size_t *bytes
+)
+{
+	if( trie && bytes )
+	{
+		*bytes = sizeof( struct trie_s ) + trie->memory;
+		return TRIE_OK;
+	}
+	else
+		return TRIE_INVALID_ARGUMENT;
+}
+
 trie_error_t Trie_Insert(
         struct trie_s *trie,
         const char *key,
@@ -189,7 +251,7 @@ trie_error_t Trie_Insert(
 {
 	if( trie && key )
 	{
-		if( !Trie_Insert_Rec( trie->root, key, trie->casing, data ) )
+		if( Trie_InsertNode( trie, key, data ) == TRIE_OK )
 		{
 			// insertion successful
 			++trie->size;
@@ -215,7 +277,7 @@ trie_error_t Trie_Remove(
 {
 	if( trie && key && data )
 	{
-		if( Trie_Remove_Rec( trie->root, key, trie->casing, data ) != TRIE_REMOVE_KEY_NOT_FOUND )
+		if( Trie_RemoveNode( trie, key, data ) == TRIE_OK )
 		{
 			// removal successful
 			--trie->size;
@@ -237,7 +299,7 @@ trie_error_t Trie_Replace(
 {
 	if( trie && key )
 	{
-		struct trie_node_s *result = TRIE_Find_Rec( trie->root, key, TRIE_EXACT_MATCH, trie->casing, Trie_AlwaysTrue, NULL );
+		struct trie_node_s *result = Trie_FindNode( trie, key, TRIE_EXACT_MATCH, NULL );
 		if( result )
 		{
 			// key found, replace data pointer
@@ -271,25 +333,19 @@ trie_error_t Trie_FindIf(
         void **data
 )
 {
-	if( trie && key && data )
+	if( trie && key && data && predicate )
 	{
-		const struct trie_node_s *result = TRIE_Find_Rec( trie->root, key, mode, trie->casing, predicate, cookie );
+		struct trie_node_s *result = Trie_FindNode( trie, key, mode, NULL );
+		if( result )
+		{
+			// for prefix matches, take the first key below the matched node
+			if( mode == TRIE_PREFIX_MATCH )
+				result = Trie_FirstMatch_Rec( result, predicate, cookie );
+			else if( !predicate( result->data, cookie ) )
+				result = NULL;
+		}
 		if( result )
 		{
-			while( result->child && !result->data_is_set )
-			{
-				const struct trie_node_s *sibling;
-				for( sibling = result; sibling->sibling && !sibling->data_is_set; sibling = sibling->sibling )
-					/* search for sibling with data */;
-				if( sibling->data_is_set )
-				{
-					// sibling found, make it the result
-					result = sibling;
-					break;
-				}
-				// descend
-				result = result->child;
-			}
 			assert( result->data_is_set );
 			*data = result->data;
 			return TRIE_OK;
@@ -321,11 +377,11 @@ trie_error_t Trie_NoOfMatchesIf(
         unsigned int *matches
 )
 {
-	if( trie && prefix && matches )
+	if( trie && prefix && predicate && matches )
 	{
-		struct trie_node_s *node = TRIE_Find_Rec( trie->root, prefix, TRIE_PREFIX_MATCH, trie->casing, predicate, cookie );
+		struct trie_node_s *node = Trie_FindNode( trie, prefix, TRIE_PREFIX_MATCH, NULL );
 		*matches = node
-		           ? Trie_NoOfKeys( node, trie->casing, predicate, cookie, 0 )
+		           ? Trie_NoOfKeys( node, predicate, cookie )
 			   : 0;
 		return TRIE_OK;
 	}
@@ -352,18 +408,39 @@ trie_error_t Trie_DumpIf(
         struct trie_dump_s **dump
 )
 {
-	if( prefix && dump && predicate )
+	if( trie && prefix && dump && predicate )
 	{
-		struct trie_node_s *result = TRIE_Find_Rec( trie->root, prefix, TRIE_PREFIX_MATCH, trie->casing, predicate, cookie );
+		unsigned int path_length;
+		struct trie_node_s *result = Trie_FindNode( trie, prefix, TRIE_PREFIX_MATCH, &path_length );
 		*dump = (struct trie_dump_s *) malloc( sizeof( struct trie_dump_s ) );
 		// prefix matches some nodes, begin dump
 		if( result )
 		{
-			( *dump )->size = Trie_NoOfKeys( result, trie->casing, predicate, cookie, 0 );
+			trie_dump_state_t state;
+
+			( *dump )->size = Trie_NoOfKeys( result, predicate, cookie );
 			( *dump )->what = what;
 			( *dump )->key_value_vector = (struct trie_key_value_s *) malloc( sizeof( struct trie_key_value_s ) *( ( *dump )->size + 1 ) );
-			Trie_Dump_Rec( result, what, trie->casing, predicate, cookie, 0, prefix, &( *dump )->key_value_vector );
-			( *dump )->key_value_vector -= ( *dump )->size;
+
+			// keys are built from the matched part of the prefix and the labels below it
+			state.what = what;
+			state.predicate = predicate;
+			state.cookie = cookie;
+			state.key_size = 0;
+			state.key = NULL;
+			if( what & TRIE_DUMP_KEYS )
+			{
+				state.key_size = path_length + TRIE_DUMP_KEY_SIZE;
+				state.key = (char *) malloc( state.key_size );
+				memcpy( state.key, prefix, path_length );
+			}
+			state.key_value_vector = ( *dump )->key_value_vector;
+
+			Trie_Dump_Rec( result, path_length, &state );
+			assert( state.key_value_vector == ( *dump )->key_value_vector + ( *dump )->size );
+
+			if( state.key )
+				free( state.key );
 		}
 		else
 		{
@@ -395,224 +472,349 @@ trie_error_t Trie_FreeDump(
 /* Internal implementations */
 
 static struct trie_node_s *Trie_CreateNode(
-        int depth,
-        char letter,
-        struct trie_node_s *child,
-        struct trie_node_s *sibling,
-        int data_is_set,
-        void *data
+        struct trie_s *trie,
+        const char *label,
+        unsigned int length
 )
 {
-	struct trie_node_s *result = (struct trie_node_s *) malloc( sizeof( struct trie_node_s ) );
+	struct trie_node_s *result;
+	size_t size = offsetof( struct trie_node_s, label ) + length;
+	unsigned int size_class;
+
+	if( size < sizeof( struct trie_node_s ) )
+		size = sizeof( struct trie_node_s );
+	size_class = ( size + TRIE_NODE_GRANULARITY - 1 ) / TRIE_NODE_GRANULARITY;
+
+	if( size_class > TRIE_NODE_CLASSES )
+	{
+		// too long for the blocks
+		result = (struct trie_node_s *) malloc( size );
+		trie->memory += size;
+		size_class = 0;
+	}
+	else if( trie->free_nodes[size_class] )
+	{
+		result = trie->free_nodes[size_class];
+		trie->free_nodes[size_class] = result->sibling;
+	}
+	else
+	{
+		size = size_class * TRIE_NODE_GRANULARITY;
+		if( !trie->blocks || trie->blocks->used + size > TRIE_BLOCK_SIZE )
+		{
+			struct trie_block_s *block = (struct trie_block_s *) malloc( TRIE_BLOCK_SIZE );
+			assert( block );
+			block->next = trie->blocks;
+			block->used = TRIE_BLOCK_HEADER_SIZE;
+			trie->blocks = block;
+			trie->memory += TRIE_BLOCK_SIZE;
+		}
+		result = (struct trie_node_s *)( (char *) trie->blocks + trie->blocks->used );
+		trie->blocks->used += size;
+	}
+
 	assert( result );
-	result->depth = depth;
-	result->letter = letter;
-	result->child = child;
-	result->sibling = sibling;
-	result->data_is_set = data_is_set;
-	result->data = data;
+	result->child = NULL;
+	result->sibling = NULL;
+	result->data = NULL;
+	result->length = length;
+	result->size_class = size_class;
+	result->data_is_set = 0;
+	if( label )
+		memcpy( result->label, label, length );
 	return result;
 }
 
-static void Trie_Destroy_Rec(
+static void Trie_FreeNode(
+        struct trie_s *trie,
         struct trie_node_s *node
 )
 {
 	assert( node );
-	if( node->sibling )
-		Trie_Destroy_Rec( node->sibling );
-	if( node->child )
-		Trie_Destroy_Rec( node->child );
-	free( node );
+	if( !node->size_class )
+	{
+		size_t size = offsetof( struct trie_node_s, label ) + node->length;
+		trie->memory -= size < sizeof( struct trie_node_s ) ? sizeof( struct trie_node_s ) : size;
+		free( node );
+		return;
+	}
+
+	node->sibling = trie->free_nodes[node->size_class];
+	trie->free_nodes[node->size_class] = node;
 }
 
-static struct trie_node_s *TRIE_Find_Rec(
-        struct trie_node_s *node,
-        const char *key,
-        trie_find_mode_t mode,
-        trie_casing_t casing,
-        int ( *predicate )( void *value, void *cookie ),
-        void *cookie
+static void Trie_FreeNodes(
+        struct trie_s *trie
 )
 {
-	assert( key );
-	assert( node );
-	if( !Trie_LetterCompare( *key, node->letter, casing ) )
+	struct trie_block_s *block, *next;
+
+	// only long nodes are allocated separately, the rest goes away with the blocks
+	if( trie->root )
+		Trie_FreeLargeNodes_Rec( trie->root );
+
+	for( block = trie->blocks; block; block = next )
 	{
-		// prefix matches
-		if( !*key || !*( key+1 ) )
-			// end of key reached, see if node contains data
-			if( mode == TRIE_PREFIX_MATCH || node->data_is_set )
-				// node contains data or prefix match only, key is valid
-				return node;
-			else
-				// no data supplied, key only matches prefix of some node in trie
-				return NULL;
-		else if( node->child )
-			// end of key not reached, continue with child
-			return TRIE_Find_Rec( node->child, key + 1, mode, casing, predicate, cookie );
-		else
-			// end of key not reached, but current node is a leaf
-			return NULL;
+		next = block->next;
+		free( block );
 	}
-	else if( node->sibling && Trie_LetterCompare( node->sibling->letter, *key, casing ) <= 0 )
+
+	trie->root = NULL;
+	trie->blocks = NULL;
+	memset( trie->free_nodes, 0, sizeof( trie->free_nodes ) );
+	trie->memory = 0;
+}
+
+static void Trie_FreeLargeNodes_Rec(
+        struct trie_node_s *node
+)
+{
+	struct trie_node_s *sibling;
+
+	for( ; node; node = sibling )
 	{
-		// prefix does not match, but we might have a matching sibling
-		return TRIE_Find_Rec( node->sibling, key, mode, casing, predicate, cookie );
+		sibling = node->sibling;
+		if( node->child )
+			Trie_FreeLargeNodes_Rec( node->child );
+		if( !node->size_class )
+			free( node );
 	}
-	else if( !node->depth )
+}
+
+static struct trie_node_s **Trie_FindChild(
+        struct trie_node_s *node,
+        char letter,
+        trie_casing_t casing
+)
+{
+	struct trie_node_s **link;
+
+	// returns the link to the first child not sorted before the letter
+	for( link = &node->child; *link; link = &( *link )->sibling )
 	{
-		// node is root
-		if( !*key )
-			if( mode == TRIE_PREFIX_MATCH || node->data_is_set )
-				// key is "", return root
-				return node;
-			else
-				// key is "", but root does not contain data
-				return NULL;
-		else if( node->child )
-			return TRIE_Find_Rec( node->child, key, mode, casing, predicate, cookie );
-		else
-			return NULL;
+		if( Trie_LetterCompare( ( *link )->label[0], letter, casing ) >= 0 )
+			break;
+	}
+	return link;
+}
+
+static unsigned int Trie_MatchLabel(
+        const struct trie_node_s *node,
+        const char *key,
+        trie_casing_t casing
+)
+{
+	unsigned int i;
+
+	if( casing == TRIE_CASE_SENSITIVE )
+	{
+		for( i = 0; i < node->length && key[i] && key[i] == node->label[i]; i++ );
 	}
 	else
 	{
-		// prefix does not match, no matching siblings
-		return NULL;
+		for( i = 0; i < node->length && key[i] && !Trie_LetterCompare( key[i], node->label[i], casing ); i++ );
 	}
+	return i;
 }
 
-static int Trie_Insert_Rec(
-        struct trie_node_s *node,
+static struct trie_node_s *Trie_FindNode(
+        const struct trie_s *trie,
         const char *key,
-        trie_casing_t casing,
-        void *data
+        trie_find_mode_t mode,
+        unsigned int *path_length
 )
 {
+	struct trie_node_s *node = trie->root, *child;
+	const char *start = key;
+	unsigned int matched;
+
 	assert( key );
-	assert( node );
-	if( !node->depth || !Trie_LetterCompare( *key, node->letter, casing ) )
+	while( *key )
 	{
-		// node is root or prefix matches
-		if( ( !node->depth && !*key ) || ( node->depth && !*( key+1 ) ) )
+		child = *Trie_FindChild( node, *key, trie->casing );
+		if( !child || Trie_LetterCompare( child->label[0], *key, trie->casing ) )
+			return NULL;
+
+		matched = Trie_MatchLabel( child, key, trie->casing );
+		if( matched < child->length )
 		{
-			// end of key reached, set data
-			if( !node->data_is_set )
+			// the key ends inside the label, which matches every key below the child
+			if( mode == TRIE_PREFIX_MATCH && !key[matched] )
 			{
-				node->data = data;
-				node->data_is_set = 1;
-				return TRIE_OK;
+				if( path_length )
+					*path_length = key - start;
+				return child;
 			}
-			else
-				return TRIE_DUPLICATE_KEY;
-		}
-		else
-		{
-			// not end of key, descend to child
-			const char *const nextKey = node->depth
-			                            ? key + 1
-						    : key;
-			if( !node->child || Trie_LetterCompare( node->child->letter, *nextKey, casing ) > 0 )
-				// no matching child, create one
-				node->child = Trie_CreateNode( node->depth + 1, *nextKey, NULL, node->child, 0, NULL );
-			// descend to matching child
-			return Trie_Insert_Rec( node->child, nextKey, casing, data );
+			return NULL;
 		}
+
+		key += matched;
+		node = child;
 	}
-	else
+
+	if( mode == TRIE_EXACT_MATCH && !node->data_is_set )
+		return NULL;
+	if( path_length )
+		*path_length = key - start - node->length;
+	return node;
+}
+
+static struct trie_node_s *Trie_FirstMatch_Rec(
+        struct trie_node_s *node,
+        int ( *predicate )( void *value, void *cookie ),
+        void *cookie
+)
+{
+	struct trie_node_s *child, *result;
+
+	if( node->data_is_set && predicate( node->data, cookie ) )
+		return node;
+
+	for( child = node->child; child; child = child->sibling )
 	{
-		assert( node->depth );
-		if( !node->sibling || Trie_LetterCompare( node->sibling->letter, *key, casing ) > 0 )
-			node->sibling = Trie_CreateNode( node->depth, *key, NULL, node->sibling, 0, NULL );
-		return Trie_Insert_Rec( node->sibling, key, casing, data );
+		result = Trie_FirstMatch_Rec( child, predicate, cookie );
+		if( result )
+			return result;
 	}
+	return NULL;
 }
 
-static trie_remove_result_t Trie_Remove_Rec(
-        struct trie_node_s *node,
+static trie_error_t Trie_InsertNode(
+        struct trie_s *trie,
         const char *key,
-        trie_casing_t casing,
-        void **data
+        void *data
 )
 {
-	trie_remove_result_t status;
-	assert( node );
+	struct trie_node_s *node = trie->root, **link, *child, *head;
+	unsigned int matched;
+
 	assert( key );
-	if( node->depth && Trie_LetterCompare( node->letter, *key, casing ) < 0 )
-	{
-		// node is not root and prefix does not match
-		if( node->sibling )
-		{
-			// call recursively for sibling
-			status = Trie_Remove_Rec( node->sibling, key, casing, data );
-			if( status == TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT )
-			{
-				// sibling node has no children or data, free it and preserve siblings
-				struct trie_node_s *sibling = node->sibling->sibling;
-				free( node->sibling );
-				node->sibling = sibling;
-				// ch : is this right?
-				// return ( node->child != NULL ) || ( node->data_is_set );
-				return ( node->child != NULL ) || ( node->data_is_set ) ? TRIE_REMOVE_CHILDREN_OR_DATA_LEFT : TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT;
-			}
-			else
-				return status;
-		}
-		else
-			// key not found
-			return TRIE_REMOVE_KEY_NOT_FOUND;
-	}
-	else if( !node->depth || !Trie_LetterCompare( node->letter, *key, casing ) )
+	while( *key )
 	{
-		// prefix matches or node is root, check for end of key
-		if( !( !node->depth && !*key ) && !( node->depth && !*( key+1 ) ) )
+		link = Trie_FindChild( node, *key, trie->casing );
+		child = *link;
+
+		if( !child || Trie_LetterCompare( child->label[0], *key, trie->casing ) )
 		{
-			// not end of key, descend
-			if( node->child )
-			{
-				status = Trie_Remove_Rec( node->child, node->depth ? key + 1 : key, casing, data );
-				if( !status )
-				{
-					// child node has no children, free it and preserve siblings
-					struct trie_node_s *sibling = node->child->sibling;
-					free( node->child );
-					node->child = sibling;
-					// ch : is this right?
-					// return ( node->child != NULL ) || ( node->data_is_set );
-					return ( node->child != NULL ) || ( node->data_is_set ) ? TRIE_REMOVE_CHILDREN_OR_DATA_LEFT : TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT;
-				}
-				else
-					return status;
-			}
-			else
-				// key not found
-				return TRIE_REMOVE_KEY_NOT_FOUND;
+			// no child starts with this letter, the rest of the key becomes a new leaf
+			child = Trie_CreateNode( trie, key, strlen( key ) );
+			child->sibling = *link;
+			child->data = data;
+			child->data_is_set = 1;
+			*link = child;
+			return TRIE_OK;
 		}
-		else
+
+		matched = Trie_MatchLabel( child, key, trie->casing );
+		if( matched < child->length )
 		{
-			// end of key
-			*data = node->data;
-			node->data = NULL;
-			node->data_is_set = 0;
-			// ch : is this right?
-			// return ( node->child != 0 );
-			return ( node->child != 0 ) ? TRIE_REMOVE_CHILDREN_OR_DATA_LEFT : TRIE_REMOVE_NO_CHILDREN_OR_DATA_LEFT;
+			// the key diverges inside the label, split the child in two
+			head = Trie_CreateNode( trie, child->label, matched );
+			head->sibling = child->sibling;
+			head->child = child;
+			memmove( child->label, child->label + matched, child->length - matched );
+			child->length -= matched;
+			child->sibling = NULL;
+			*link = head;
+			child = head;
 		}
+
+		key += matched;
+		node = child;
 	}
-	else
-		// key not found
-		return TRIE_REMOVE_KEY_NOT_FOUND;
+
+	if( node->data_is_set )
+		return TRIE_DUPLICATE_KEY;
+
+	node->data = data;
+	node->data_is_set = 1;
+	return TRIE_OK;
+}
+
+static trie_error_t Trie_RemoveNode(
+        struct trie_s *trie,
+        const char *key,
+        void **data
+)
+{
+	struct trie_node_s *node = trie->root, **link = NULL, **parent_link = NULL, **child_link, *child;
+	unsigned int matched;
+
+	assert( key );
+	while( *key )
+	{
+		child_link = Trie_FindChild( node, *key, trie->casing );
+		child = *child_link;
+		if( !child || Trie_LetterCompare( child->label[0], *key, trie->casing ) )
+			return TRIE_KEY_NOT_FOUND;
+
+		matched = Trie_MatchLabel( child, key, trie->casing );
+		if( matched < child->length )
+			return TRIE_KEY_NOT_FOUND;
+
+		key += matched;
+		parent_link = link;
+		link = child_link;
+		node = child;
+	}
+
+	if( !node->data_is_set )
+		return TRIE_KEY_NOT_FOUND;
+
+	*data = node->data;
+	node->data = NULL;
+	node->data_is_set = 0;
+
+	// the root stays regardless of what is below it
+	if( !link )
+		return TRIE_OK;
+
+	if( !node->child )
+	{
+		// free the leaf, which may leave its parent with a single child
+		*link = node->sibling;
+		Trie_FreeNode( trie, node );
+		if( !parent_link )
+			return TRIE_OK;
+		link = parent_link;
+	}
+
+	Trie_MergeWithChild( trie, link );
+	return TRIE_OK;
+}
+
+static void Trie_MergeWithChild(
+        struct trie_s *trie,
+        struct trie_node_s **link
+)
+{
+	struct trie_node_s *node = *link, *child = node->child, *merged;
+
+	// only keyless nodes with a single child are merged
+	if( node->data_is_set || !child || child->sibling )
+		return;
+
+	merged = Trie_CreateNode( trie, NULL, node->length + child->length );
+	memcpy( merged->label, node->label, node->length );
+	memcpy( merged->label + node->length, child->label, child->length );
+	merged->child = child->child;
+	merged->sibling = node->sibling;
+	merged->data = child->data;
+	merged->data_is_set = child->data_is_set;
+	*link = merged;
+
+	Trie_FreeNode( trie, child );
+	Trie_FreeNode( trie, node );
 }
 
 static unsigned int Trie_NoOfKeys(
         const struct trie_node_s *node,
-        trie_casing_t casing,
         int ( *predicate )( void *value, void *cookie ),
-        void *cookie,
-        int addSiblings
+        void *cookie
 )
 {
 	unsigned int noOfKeys;
+	const struct trie_node_s *child;
 	assert( node );
 	assert( predicate );
 	// if data is set, we have a data node, otherwise just a prefix node
@@ -620,62 +822,55 @@ static unsigned int Trie_NoOfKeys(
 		noOfKeys = 1;
 	else
 		noOfKeys = 0;
-	// recursively add siblings and children
-	if( addSiblings && node->sibling )
-		noOfKeys += Trie_NoOfKeys( node->sibling, casing, predicate, cookie, 1 );
-	if( node->child )
-		noOfKeys += Trie_NoOfKeys( node->child, casing, predicate, cookie, 1 );
+	// recursively add children
+	for( child = node->child; child; child = child->sibling )
+		noOfKeys += Trie_NoOfKeys( child, predicate, cookie );
 	return noOfKeys;
 }
 
 static void Trie_Dump_Rec(
         const struct trie_node_s *node,
-        trie_dump_what_t what,
-        trie_casing_t casing,
-        int ( *predicate )( void *value, void *cookie ),
-        void *cookie,
-        int dumpSiblings,
-        const char *key_prev,
-        struct trie_key_value_s **key_value_vector
+        size_t key_length,
+        trie_dump_state_t *state
 )
 {
-	char *key = NULL;
-	int keyDumped = 0;
-	if( what & TRIE_DUMP_KEYS )
+	const struct trie_node_s *child;
+
+	if( state->what & TRIE_DUMP_KEYS )
 	{
-		key = (char *) malloc( sizeof( char ) * ( node->depth + 1 ) );
-		strncpy( key, key_prev, node->depth ); // copy previous key
-		if( node->depth )
-			key[node->depth - 1] = node->letter; // append/replace letter
-		key[node->depth] = '\0';        // terminate key string
+		// append the label
+		if( key_length + node->length + 1 > state->key_size )
+		{
+			state->key_size = key_length + node->length + 1 + TRIE_DUMP_KEY_SIZE;
+			state->key = (char *) realloc( state->key, state->key_size );
+			assert( state->key );
+		}
+		memcpy( state->key + key_length, node->label, node->length );
 	}
-	if( node->data_is_set && predicate( node->data, cookie ) )
+	key_length += node->length;
+
+	if( node->data_is_set && state->predicate( node->data, state->cookie ) )
 	{
 		// dump key and values if requested
-		if( what & TRIE_DUMP_KEYS )
+		if( state->what & TRIE_DUMP_KEYS )
 		{
-			keyDumped = 1;
-			( *key_value_vector )->key = key;
+			char *key = (char *) malloc( sizeof( char ) * ( key_length + 1 ) );
+			memcpy( key, state->key, key_length );
+			key[key_length] = '\0';
+			state->key_value_vector->key = key;
 		}
 		else
-			( *key_value_vector )->key = NULL;
-		( *key_value_vector )->value = ( what & TRIE_DUMP_VALUES )
-		                               ? node->data
-					       : NULL;
+			state->key_value_vector->key = NULL;
+		state->key_value_vector->value = ( state->what & TRIE_DUMP_VALUES )
+		                                 ? node->data
+						 : NULL;
 		// increment key_vector
-		++ ( *key_value_vector );
+		++state->key_value_vector;
 	}
+
 	// dump children
-	if( node->child )
-		Trie_Dump_Rec( node->child, what, casing, predicate, cookie, 1, key, key_value_vector );
-	// dump siblings
-	if( dumpSiblings && node->sibling )
-		Trie_Dump_Rec( node->sibling, what, casing, predicate, cookie, 1, key, key_value_vector );
-	if( ( what & TRIE_DUMP_KEYS ) && !keyDumped )
-	{
-		assert( key );
-		free( key );
-	}
+	for( child = node->child; child; child = child->sibling )
+		Trie_Dump_Rec( child, key_length, state );
 }
 
 static int Trie_AlwaysTrue(
@@ -686,6 +881,14 @@ static int Trie_AlwaysTrue(
 	return 1;
 }
 
+static inline char Trie_LowerCase(
+        char letter
+)
+{
+	// keys are ASCII, avoid the locale lookup of tolower
+	return ( letter >= 'A' && letter <= 'Z' ) ? letter - 'A' + 'a' : letter;
+}
+
 static inline int Trie_LetterCompare(
         char left,
         char right,
@@ -695,5 +898,5 @@ static inline int Trie_LetterCompare(
 	if( casing == TRIE_CASE_SENSITIVE )
 		return ( (int) left ) - ( (int) right );
 	else
-		return ( (int) tolower( left ) ) - ( (int) tolower( right ) );
+		return ( (int) Trie_LowerCase( left ) ) - ( (int) Trie_LowerCase( right ) );
 }
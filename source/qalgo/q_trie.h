@@ -1,6 +1,8 @@
 #ifndef WSW_TRIE_H
 #define WSW_TRIE_H
 
+#include <stddef.h>
+
 /* Forward declaration of trie structures (layout hidden) */
 struct trie_s;
 struct trie_node_s;
@@ -69,6 +71,11 @@ trie_error_t Trie_GetSize(
         unsigned int *size      // output parameter, size of trie
 );
 
+trie_error_t Trie_GetMemoryUsage(
+        struct trie_s *trie,
+        size_t *bytes           // output parameter, bytes allocated by the trie
+);
+
 /* Key/data insertion and removal */
 
 trie_error_t Trie_Insert(
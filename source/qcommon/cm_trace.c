@@ -491,19 +491,20 @@ BOX TRACING
 #endif
 #define RADIUS_EPSILON		1.0f
 
-static vec3_t trace_start, trace_end;
-static vec3_t trace_mins, trace_maxs;
-static vec3_t trace_startmins, trace_endmins;
-static vec3_t trace_startmaxs, trace_endmaxs;
-static vec3_t trace_absmins, trace_absmaxs;
-static vec3_t trace_extents;
-
-static trace_t	*trace_trace;
+// per thread, TV relay threads trace their own maps concurrently
+static QF_THREAD_LOCAL vec3_t trace_start, trace_end;
+static QF_THREAD_LOCAL vec3_t trace_mins, trace_maxs;
+static QF_THREAD_LOCAL vec3_t trace_startmins, trace_endmins;
+static QF_THREAD_LOCAL vec3_t trace_startmaxs, trace_endmaxs;
+static QF_THREAD_LOCAL vec3_t trace_absmins, trace_absmaxs;
+static QF_THREAD_LOCAL vec3_t trace_extents;
+
+static QF_THREAD_LOCAL trace_t	*trace_trace;
 #ifdef TRACEVICFIX
-static float trace_realfraction;
+static QF_THREAD_LOCAL float trace_realfraction;
 #endif
-static int trace_contents;
-static bool trace_ispoint;      // optimized case
+static QF_THREAD_LOCAL int trace_contents;
+static QF_THREAD_LOCAL bool trace_ispoint;      // optimized case
 
 extern int c_brush_traces;
 
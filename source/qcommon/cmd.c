@@ -748,11 +748,8 @@ typedef struct cmd_function_s
 } cmd_function_t;
 
 
-static int cmd_argc;
-static char *cmd_argv[MAX_STRING_TOKENS];
-static size_t cmd_argv_sizes[MAX_STRING_TOKENS];
+static QF_THREAD_LOCAL cmd_tokens_t cmd_tokens;
 static char *cmd_null_string = "";
-static char cmd_args[MAX_STRING_CHARS];
 
 static trie_t *cmd_function_trie = NULL;
 static const trie_casing_t CMD_FUNCTION_TRIE_CASING = CON_CASE_SENSITIVE ? TRIE_CASE_SENSITIVE : TRIE_CASE_INSENSITIVE;
@@ -772,7 +769,7 @@ static int Cmd_PatternMatchesFunction( void *cmd, void *pattern )
 */
 int Cmd_Argc( void )
 {
-	return cmd_argc;
+	return cmd_tokens.argc;
 }
 
 /*
@@ -780,9 +777,9 @@ int Cmd_Argc( void )
 */
 char *Cmd_Argv( int arg )
 {
-	if( arg >= cmd_argc )
+	if( arg >= cmd_tokens.argc )
 		return cmd_null_string;
-	return cmd_argv[arg];
+	return cmd_tokens.argv[arg];
 }
 
 /*
@@ -792,7 +789,7 @@ char *Cmd_Argv( int arg )
 */
 char *Cmd_Args( void )
 {
-	return cmd_args;
+	return cmd_tokens.args;
 }
 
 /*
@@ -804,10 +801,24 @@ char *Cmd_Args( void )
 */
 void Cmd_TokenizeString( const char *text )
 {
-	char *com_token;
+	Cmd_TokenizeStringExt( &cmd_tokens, text );
+}
 
-	cmd_argc = 0;
-	cmd_args[0] = 0;
+/*
+* Cmd_TokenizeStringExt
+* 
+* Same as Cmd_TokenizeString, but fills the given tokens instead of the ones
+* read by Cmd_Argc/Cmd_Argv/Cmd_Args. Tokens are parsed straight into the
+* buffer the argv points to.
+*/
+void Cmd_TokenizeStringExt( cmd_tokens_t *tokens, const char *text )
+{
+	char *token;
+	size_t size, used;
+
+	tokens->argc = 0;
+	tokens->args[0] = 0;
+	used = 0;
 
 	if( !text )
 		return;
@@ -828,40 +839,41 @@ void Cmd_TokenizeString( const char *text )
 		if( !*text )
 			return;
 
-		// set cmd_args to everything after the first arg
-		if( cmd_argc == 1 )
+		// set args to everything after the first arg
+		if( tokens->argc == 1 )
 		{
 			size_t l;
 
-			strncpy( cmd_args, text, sizeof( cmd_args )-1 );
-			cmd_args[sizeof( cmd_args )-1] = 0;
+			strncpy( tokens->args, text, sizeof( tokens->args )-1 );
+			tokens->args[sizeof( tokens->args )-1] = 0;
 
 			// strip off any trailing whitespace
 			// use > 0 and -1 instead of >= 0 since size_t can be unsigned
-			l = strlen( cmd_args );
+			l = strlen( tokens->args );
 			for(; l > 0; l-- )
-				if( (unsigned char)cmd_args[l-1] <= ' ' )
-					cmd_args[l-1] = 0;
+				if( (unsigned char)tokens->args[l-1] <= ' ' )
+					tokens->args[l-1] = 0;
 				else
 					break;
 		}
 
-		com_token = COM_Parse( &text );
+		// tokens past MAX_STRING_TOKENS are parsed into the spare space and dropped
+		token = tokens->buffer + used;
+		size = min( sizeof( tokens->buffer ) - used, MAX_TOKEN_CHARS );
+		if( tokens->argc >= MAX_STRING_TOKENS || !size )
+		{
+			token = tokens->spare;
+			size = sizeof( tokens->spare );
+		}
+
+		COM_Parse_r( token, size, &text );
 		if( !text )
 			return;
 
-		if( cmd_argc < MAX_STRING_TOKENS )
+		if( token != tokens->spare )
 		{
-			size_t size = strlen( com_token ) + 1;
-			if( cmd_argv_sizes[cmd_argc] < size )
-			{
-				cmd_argv_sizes[cmd_argc] = min( size + 64, MAX_TOKEN_CHARS );
-				if( cmd_argv[cmd_argc] )
-					Mem_ZoneFree( cmd_argv[cmd_argc] );
-				cmd_argv[cmd_argc] = Mem_ZoneMalloc( cmd_argv_sizes[cmd_argc] );
-			}
-			strcpy( cmd_argv[cmd_argc], com_token );
-			cmd_argc++;
+			tokens->argv[tokens->argc++] = token;
+			used += strlen( token ) + 1;
 		}
 	}
 }
@@ -1043,7 +1055,7 @@ char **Cmd_CompleteBuildArgList( const char *partial )
 	if( p )
 	{
 		Cmd_TokenizeString( partial );
-		return Cmd_CompleteBuildArgListExt( cmd_argv[0], cmd_args );
+		return Cmd_CompleteBuildArgListExt( cmd_tokens.argv[0], cmd_tokens.args );
 	}
 
 	return NULL;
@@ -1314,7 +1326,7 @@ void Cmd_ExecuteString( const char *text )
 	if( !Cmd_Argc() )
 		return; // no tokens
 
-	str = cmd_argv[0];
+	str = cmd_tokens.argv[0];
 
 	// FIXME: This routine defines the order in which identifiers are looked-up, but
 	// there are no checks for name-clashes. If a user sets a cvar with the name of
@@ -1372,7 +1384,7 @@ static void Cmd_Help_f(void)
 		return; // no tokens
 	}
 
-	str = cmd_argv[1];
+	str = cmd_tokens.argv[1];
 
 	translated = L10n_TranslateString( "descriptions", str );
 	if (translated)
@@ -1481,12 +1493,7 @@ void Cmd_Shutdown( void )
 		Cmd_RemoveCommand( "wait" );
 		Cmd_RemoveCommand( "vstr" );
 
-		// this is somewhat ugly IMO
-		for( i = 0; i < MAX_STRING_TOKENS && cmd_argv_sizes[i]; i++ )
-		{
-			Mem_ZoneFree( cmd_argv[i] );
-			cmd_argv_sizes[i] = 0;
-		}
+		cmd_tokens.argc = 0;
 
 		Trie_Dump( cmd_function_trie, "", TRIE_DUMP_VALUES, &dump );
 		for( i = 0; i < dump->size; ++i )
@@ -39,11 +39,12 @@ static bool	commands_intialized = false;
 
 static int com_argc;
 static char *com_argv[MAX_NUM_ARGVS+1];
-static char com_errormsg[MAX_PRINTMSG];
+static QF_THREAD_LOCAL char com_errormsg[MAX_PRINTMSG];
 
 static bool com_quit;
 
 static jmp_buf abortframe;     // an ERR_DROP occured, exit the entire frame
+static QF_THREAD_LOCAL jmp_buf *com_threadabortframe;	// same for a worker thread, see Com_SetThreadAbortFrame
 
 cvar_t *host_speeds;
 cvar_t *developer;
@@ -78,6 +79,9 @@ unsigned int time_after_game;
 unsigned int time_before_ref;
 unsigned int time_after_ref;
 
+// profiler zones of Qcommon_Frame
+static int com_zone_curl, com_zone_fs, com_zone_sv, com_zone_cl, com_zone_mm;
+
 // debug/performance counter vars
 int c_pointcontents, c_traces, c_brush_traces;
 
@@ -296,7 +300,7 @@ void Com_Error( com_error_code_t code, const char *format, ... )
 	va_list	argptr;
 	char *msg = com_errormsg;
 	const size_t sizeof_msg = sizeof( com_errormsg );
-	static bool	recursive = false;
+	static QF_THREAD_LOCAL bool recursive = false;
 
 	if( recursive )
 	{
@@ -309,6 +313,14 @@ void Com_Error( com_error_code_t code, const char *format, ... )
 	Q_vsnprintfz( msg, sizeof_msg, format, argptr );
 	va_end( argptr );
 
+	if( code == ERR_DROP && com_threadabortframe )
+	{
+		// a worker thread can't shut the server down, it only abandons its own job
+		Com_Printf( "********************\nERROR: %s\n********************\n", msg );
+		recursive = false;
+		longjmp( *com_threadabortframe, -1 );
+	}
+
 	if( code == ERR_DROP )
 	{
 		Com_Printf( "********************\nERROR: %s\n********************\n", msg );
@@ -334,6 +346,27 @@ void Com_Error( com_error_code_t code, const char *format, ... )
 	Sys_Error( "%s", msg );
 }
 
+/*
+* Com_SetThreadAbortFrame
+* 
+* Makes ERR_DROP errors raised on the calling thread longjmp to frame
+* instead of ending the whole frame, NULL restores the default.
+*/
+void Com_SetThreadAbortFrame( jmp_buf *frame )
+{
+	com_threadabortframe = frame;
+}
+
+/*
+* Com_ErrorMessage
+* 
+* Returns the last error raised on the calling thread
+*/
+const char *Com_ErrorMessage( void )
+{
+	return com_errormsg;
+}
+
 /*
 * Com_DeferQuit
 */
@@ -872,6 +905,13 @@ void Qcommon_Init( int argc, char **argv )
 
 	com_showtrace =	    Cvar_Get( "com_showtrace", "0", 0 );
 
+	Com_ProfileInit();
+	com_zone_curl = Com_ProfileZone( "wswcurl_perform" );
+	com_zone_fs = Com_ProfileZone( "FS_Frame" );
+	com_zone_sv = Com_ProfileZone( "SV_Frame" );
+	com_zone_cl = Com_ProfileZone( "CL_Frame" );
+	com_zone_mm = Com_ProfileZone( "MM_Frame" );
+
 	Cvar_Get( "gamename", APPLICATION, CVAR_READONLY );
 	versioncvar = Cvar_Get( "version", APP_VERSION_STR " " CPUSTRING " " __DATE__ " " BUILDSTRING, CVAR_SERVERINFO|CVAR_READONLY );
 
@@ -935,6 +975,8 @@ void Qcommon_Frame( unsigned int realmsec )
 	if( setjmp( abortframe ) )
 		return; // an ERR_DROP was thrown
 
+	Com_ProfileBeginFrame();
+
 	if( logconsole && logconsole->modified )
 	{
 		logconsole->modified = false;
@@ -965,9 +1007,13 @@ void Qcommon_Frame( unsigned int realmsec )
 		c_pointcontents = 0;
 	}
 
+	Com_ProfileBegin( com_zone_curl );
 	wswcurl_perform();
+	Com_ProfileEnd( com_zone_curl );
 
+	Com_ProfileBegin( com_zone_fs );
 	FS_Frame();
+	Com_ProfileEnd( com_zone_fs );
 
 	if( dedicated->integer )
 	{
@@ -988,12 +1034,16 @@ void Qcommon_Frame( unsigned int realmsec )
 	if( host_speeds->integer )
 		time_before = Sys_Milliseconds();
 
+	Com_ProfileBegin( com_zone_sv );
 	SV_Frame( realmsec, gamemsec );
+	Com_ProfileEnd( com_zone_sv );
 
 	if( host_speeds->integer )
 		time_between = Sys_Milliseconds();
 
+	Com_ProfileBegin( com_zone_cl );
 	CL_Frame( realmsec, gamemsec );
+	Com_ProfileEnd( com_zone_cl );
 
 	if( host_speeds->integer )
 		time_after = Sys_Milliseconds();
@@ -1013,13 +1063,17 @@ void Qcommon_Frame( unsigned int realmsec )
 			all, sv, gm, cl, rf );
 	}
 
+	Com_ProfileBegin( com_zone_mm );
 	MM_Frame( realmsec );
+	Com_ProfileEnd( com_zone_mm );
 
 	// wsw : aiwa : generic observer pattern to plug in arbitrary functionality
 	if( !frametick )
 		frametick = Dynvar_Lookup( "frametick" );
 	Dynvar_CallListeners( frametick, &fc );
 	++fc;
+
+	Com_ProfileEndFrame();
 }
 
 /*
@@ -1044,6 +1098,7 @@ void Qcommon_Shutdown( void )
 
 	Com_Autoupdate_Shutdown();
 
+	Com_ProfileShutdown();
 
 	Qcommon_ShutdownCommands();
 	Memory_ShutdownCommands();
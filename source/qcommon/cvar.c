@@ -179,13 +179,18 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, cvar_flag_t flags
 				var->string = ZoneCopyString( (char *) var_value );
 				var->value = atof( var->string );
 				var->integer = Q_rint( var->value );
+				cvar_modcount++;
 			}
+			if( var->flags != flags )
+				cvar_modcount++;
 			var->flags = flags;
 		}
 
 		if( Cvar_FlagIsSet( flags, CVAR_USERINFO ) && !Cvar_FlagIsSet( var->flags, CVAR_USERINFO ) )
 			userinfo_modified = true; // transmit at next oportunity
 
+		if( ( var->flags | flags ) != var->flags )
+			cvar_modcount++;
 		Cvar_FlagSet( &var->flags, flags );
 		return var;
 	}
@@ -208,6 +213,7 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, cvar_flag_t flags
 	var->integer = Q_rint( var->value );
 	var->flags = flags;
 	Cvar_SetModified( var );
+	cvar_modcount++;
 
 	QMutex_Lock( cvar_mutex );
 	Trie_Insert( cvar_trie, var_name, var );
@@ -304,6 +310,7 @@ static cvar_t *Cvar_Set2( const char *var_name, const char *value, bool force )
 					var->value = atof( var->string );
 					var->integer = Q_rint( var->value );
 					Cvar_SetModified( var );
+					cvar_modcount++;
 				}
 			}
 			return var;
@@ -330,6 +337,7 @@ static cvar_t *Cvar_Set2( const char *var_name, const char *value, bool force )
 	var->value = atof( var->string );
 	var->integer = Q_rint( var->value );
 	Cvar_SetModified( var );
+	cvar_modcount++;
 
 	return var;
 }
@@ -363,6 +371,9 @@ cvar_t *Cvar_FullSet( const char *var_name, const char *value, cvar_flag_t flags
 	if( !var )
 		return Cvar_Get( var_name, value, flags );
 
+	if( overwrite_flags ? var->flags != flags : ( var->flags | flags ) != var->flags )
+		cvar_modcount++;
+
 	if( overwrite_flags )
 	{
 		var->flags = flags;
@@ -426,6 +437,7 @@ void Cvar_GetLatchedVars( cvar_flag_t flags )
 		var->latched_string = NULL;
 		var->value = atof( var->string );
 		var->integer = Q_rint( var->value );
+		cvar_modcount++;
 	}
 	Trie_FreeDump( dump );
 }
@@ -455,6 +467,7 @@ void Cvar_FixCheatVars( void )
 		var->string = ZoneCopyString( var->dvalue );
 		var->value = atof( var->string );
 		var->integer = Q_rint( var->value );
+		cvar_modcount++;
 	}
 	Trie_FreeDump( dump );
 }
@@ -727,6 +740,7 @@ static void Cvar_ArchiveList_f( void )
 #endif
 
 bool userinfo_modified;
+unsigned int cvar_modcount;
 
 static char *Cvar_BitInfo( int bit )
 {
@@ -41,6 +41,10 @@ static inline void	    Cvar_UnsetModified( cvar_t *var );
 // that the client knows to send it to the server
 extern bool	userinfo_modified;
 
+// incremented each time a cvar value or its flags change, so that
+// strings built from cvars can tell when they need to be rebuilt
+extern unsigned int cvar_modcount;
+
 /*
 
    cvar_t variables are used to hold scalar or string variables that can be changed or displayed at the console or prog code as well as accessed directly
@@ -1942,6 +1942,38 @@ void *FS_MMapBaseFile( int file, size_t size, size_t offset )
 * FS_UnMMapBaseFile
 */
 void FS_UnMMapBaseFile( int file, void *data )
+{
+	FS_UnMMapFile( file, data );
+}
+
+/*
+* FS_MMapFile
+*
+* Maps the whole of a file opened for reading. Loose files, VFS files and stored pak entries
+* can be mapped, deflated pak entries and URLs can't and return NULL. The mapping has to be
+* released with FS_UnMMapFile before the file is closed.
+*/
+void *FS_MMapFile( int file )
+{
+	void *data;
+	filehandle_t *fh;
+
+	fh = FS_FileHandleForNum( file );
+	if( !fh->fstream || fh->zipEntry || fh->streamHandle || fh->mapping )
+		return NULL;
+	if( !fh->uncompressedSize )
+		return NULL;
+
+	// pakOffset is the start of the entry for pak and VFS files and 0 for loose files
+	data = Sys_FS_MMapFile( Sys_FS_FileNo( fh->fstream ), fh->uncompressedSize, fh->pakOffset, &fh->mapping, &fh->mapping_offset );
+	fh->mapping_size = fh->uncompressedSize;
+	return data;
+}
+
+/*
+* FS_UnMMapFile
+*/
+void FS_UnMMapFile( int file, void *data )
 {
 	filehandle_t *fh;
 	
@@ -3444,6 +3476,113 @@ static void FS_Path_f( void )
 	QMutex_Unlock( fs_searchpaths_mutex );
 }
 
+/*
+* FS_TrieBench
+*/
+static void FS_TrieBench( const char *name, const char **keys, int numKeys, int iterations )
+{
+	int i, iter;
+	unsigned int found, matches, numMatches;
+	size_t memory;
+	uint64_t start, insertTime, findTime, prefixTime;
+	trie_t *trie;
+	void *data;
+	char prefix[4];
+
+	if( !numKeys )
+	{
+		Com_Printf( "%s: no keys\n", name );
+		return;
+	}
+
+	start = Sys_Microseconds();
+	Trie_Create( TRIE_CASE_INSENSITIVE, &trie );
+	for( i = 0; i < numKeys; i++ )
+		Trie_Insert( trie, keys[i], (void *)keys[i] );
+	insertTime = Sys_Microseconds() - start;
+
+	found = 0;
+	start = Sys_Microseconds();
+	for( iter = 0; iter < iterations; iter++ )
+	{
+		for( i = 0; i < numKeys; i++ )
+		{
+			if( Trie_Find( trie, keys[i], TRIE_EXACT_MATCH, &data ) == TRIE_OK )
+				found++;
+		}
+	}
+	findTime = Sys_Microseconds() - start;
+
+	// what tab completion does for every key typed so far
+	matches = 0;
+	start = Sys_Microseconds();
+	for( i = 0; i < numKeys; i++ )
+	{
+		Q_strncpyz( prefix, keys[i], sizeof( prefix ) );
+		Trie_NoOfMatches( trie, prefix, &numMatches );
+		matches += numMatches;
+	}
+	prefixTime = Sys_Microseconds() - start;
+
+	Trie_GetMemoryUsage( trie, &memory );
+	Trie_Destroy( trie );
+
+	Com_Printf( "%s: %i keys, %u bytes, insert %.3f ms, %.1f ns per lookup (%u found), %.2f us per prefix count\n",
+		name, numKeys, (unsigned)memory, insertTime * 0.001, findTime * 1000.0 / ( (double)numKeys * iterations ), 
+		found, (double)prefixTime / numKeys );
+}
+
+/*
+* FS_TrieBench_f
+*
+* fs_triebench [iterations]
+* Times the trie on the cvar names and the pak file names
+*/
+static void FS_TrieBench_f( void )
+{
+	int i, numKeys, iterations;
+	char **cvars;
+	const char **keys;
+	size_t memory, pakMemory;
+	searchpath_t *s;
+
+	iterations = Cmd_Argc() > 1 ? bound( 1, atoi( Cmd_Argv( 1 ) ), 10000 ) : 10;
+
+	cvars = Cvar_CompleteBuildList( "" );
+	for( numKeys = 0; cvars[numKeys]; numKeys++ );
+	FS_TrieBench( "cvars", (const char **)cvars, numKeys, iterations );
+	Mem_TempFree( cvars );
+
+	QMutex_Lock( fs_searchpaths_mutex );
+
+	numKeys = 0;
+	pakMemory = 0;
+	for( s = fs_searchpaths; s; s = s->next )
+	{
+		if( !s->pack )
+			continue;
+		numKeys += s->pack->numFiles;
+		if( s->pack->trie && Trie_GetMemoryUsage( s->pack->trie, &memory ) == TRIE_OK )
+			pakMemory += memory;
+	}
+
+	keys = ( const char ** )Mem_TempMalloc( sizeof( *keys ) * ( numKeys + 1 ) );
+	numKeys = 0;
+	for( s = fs_searchpaths; s; s = s->next )
+	{
+		if( !s->pack )
+			continue;
+		for( i = 0; i < s->pack->numFiles; i++ )
+			keys[numKeys++] = s->pack->files[i].name;
+	}
+
+	QMutex_Unlock( fs_searchpaths_mutex );
+
+	Com_Printf( "pak tries: %u bytes\n", (unsigned)pakMemory );
+	FS_TrieBench( "pak files", keys, numKeys, iterations );
+	Mem_TempFree( keys );
+}
+
 /*
 * FS_CreateAbsolutePath
 * 
@@ -4335,6 +4474,7 @@ void FS_Init( void )
 	Cmd_AddCommand( "fs_search", Cmd_FS_Search_f );
 	Cmd_AddCommand( "fs_checksum", Cmd_FileChecksum_f );
 	Cmd_AddCommand( "fs_mtime", Cmd_FileMTime_f );
+	Cmd_AddCommand( "fs_triebench", FS_TrieBench_f );
 
 	fs_numsearchfiles = FS_MIN_SEARCHFILES;
 	fs_searchfiles = ( searchfile_t* )FS_Malloc( sizeof( searchfile_t ) * fs_numsearchfiles );
@@ -4468,6 +4608,7 @@ void FS_Shutdown( void )
 	Cmd_RemoveCommand( "fs_search" );
 	Cmd_RemoveCommand( "fs_checksum" );
 	Cmd_RemoveCommand( "fs_mtime" );
+	Cmd_RemoveCommand( "fs_triebench" );
 
 	FS_FreeSearchFiles();
 	FS_Free( fs_searchfiles );
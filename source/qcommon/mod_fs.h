@@ -50,6 +50,9 @@ DECLARE_TYPEDEF_METHOD( int, FS_LoadFileExt, const char *path, int flags, void *
 DECLARE_TYPEDEF_METHOD( int, FS_LoadBaseFileExt, const char *path, int flags, void **buffer, void *stack, size_t stackSize, const char *filename, int fileline );
 DECLARE_TYPEDEF_METHOD( void, FS_FreeFile, void *buffer );
 DECLARE_TYPEDEF_METHOD( void, FS_FreeBaseFile, void *buffer );
+// read-only views of files opened with FS_FOpenFile, NULL for deflated pak entries
+DECLARE_TYPEDEF_METHOD( void *, FS_MMapFile, int file );
+DECLARE_TYPEDEF_METHOD( void, FS_UnMMapFile, int file, void *data );
 #define FS_LoadFile( path, buffer, stack, stacksize ) FS_LoadFileExt( path, 0, buffer, stack, stacksize, __FILE__, __LINE__ )
 #define FS_LoadBaseFile( path, buffer, stack, stacksize ) FS_LoadBaseFileExt( path, 0, buffer, stack, stacksize, __FILE__, __LINE__ )
 #define FS_LoadCacheFile( path, buffer, stack, stacksize ) FS_LoadFileExt( path, FS_CACHE, buffer, stack, stacksize, __FILE__, __LINE__ )
@@ -127,6 +130,8 @@ struct fs_import_s {
 	FS_LoadBaseFileExtFn FS_LoadBaseFileExt;
 	FS_FreeFileFn FS_FreeFile;
 	FS_FreeBaseFileFn FS_FreeBaseFile;
+	FS_MMapFileFn FS_MMapFile;
+	FS_UnMMapFileFn FS_UnMMapFile;
 	FS_CopyFileFn FS_CopyFile;
 	FS_CopyBaseFileFn FS_CopyBaseFile;
 	FS_ExtractFileFn FS_ExtractFile;
@@ -205,6 +210,8 @@ int FS_LoadFileExt(const char *path, int flags, void **buffer, void *stack, size
 int FS_LoadBaseFileExt(const char *path, int flags, void **buffer, void *stack, size_t stackSize, const char *filename, int fileline ){ return fs_import.FS_LoadBaseFileExt(path, flags, buffer, stack, stackSize, filename, fileline);}
 void FS_FreeFile(void *buffer ){ fs_import.FS_FreeFile(buffer);}
 void FS_FreeBaseFile(void *buffer ){ fs_import.FS_FreeBaseFile(buffer);}
+void * FS_MMapFile(int file ){ return fs_import.FS_MMapFile(file);}
+void FS_UnMMapFile(int file, void *data ){ fs_import.FS_UnMMapFile(file, data);}
 bool FS_CopyFile(const char *src, const char *dst ){ return fs_import.FS_CopyFile(src, dst);}
 bool FS_CopyBaseFile(const char *src, const char *dst ){ return fs_import.FS_CopyBaseFile(src, dst);}
 bool FS_ExtractFile(const char *src, const char *dst ){ return fs_import.FS_ExtractFile(src, dst);}
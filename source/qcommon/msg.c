@@ -28,7 +28,6 @@ MESSAGE IO FUNCTIONS
 Handles byte ordering and avoids alignment errors
 ==============================================================================
 */
-#define MAX_MSG_STRING_CHARS	2048
 
 void MSG_Init( msg_t *msg, uint8_t *data, size_t length )
 {
@@ -126,6 +125,37 @@ void MSG_WriteFloat( msg_t *msg, float f )
 	MSG_WriteLong( msg, dat.l );
 }
 
+/*
+* MSG_WriteUintBase128
+*
+* Writes 7 bits per byte, the high bit marks that more bytes follow
+*/
+void MSG_WriteUintBase128( msg_t *msg, uint64_t c )
+{
+	uint8_t buf[10];
+	size_t len = 0;
+
+	do
+	{
+		buf[len] = c & 0x7fU;
+		if( ( c >>= 7 ) != 0 )
+			buf[len] |= 0x80U;
+		len++;
+	} while( c );
+
+	MSG_WriteData( msg, buf, len );
+}
+
+/*
+* MSG_WriteIntBase128
+*
+* Zigzag encodes the value so small negative numbers stay short
+*/
+void MSG_WriteIntBase128( msg_t *msg, int64_t c )
+{
+	MSG_WriteUintBase128( msg, ( (uint64_t)c << 1 ) ^ ( c < 0 ? ~(uint64_t)0 : 0 ) );
+}
+
 void MSG_WriteDir( msg_t *msg, vec3_t dir )
 {
 	MSG_WriteByte( msg, dir ? DirToByte( dir ) : 0 );
@@ -225,6 +255,30 @@ float MSG_ReadFloat( msg_t *msg )
 	return dat.f;
 }
 
+uint64_t MSG_ReadUintBase128( msg_t *msg )
+{
+	int b, shift;
+	uint64_t c;
+
+	c = 0;
+	for( shift = 0; shift < 64; shift += 7 )
+	{
+		b = MSG_ReadByte( msg );
+		if( b == -1 )
+			return 0;
+		c |= (uint64_t)( b & 0x7f ) << shift;
+		if( !( b & 0x80 ) )
+			break;
+	}
+	return c;
+}
+
+int64_t MSG_ReadIntBase128( msg_t *msg )
+{
+	uint64_t c = MSG_ReadUintBase128( msg );
+	return (int64_t)( c >> 1 ) ^ -(int64_t)( c & 1 );
+}
+
 void MSG_ReadDir( msg_t *msg, vec3_t dir )
 {
 	ByteToDir( MSG_ReadByte( msg ), dir );
@@ -252,7 +306,7 @@ int MSG_SkipData( msg_t *msg, size_t length )
 static char *MSG_ReadString2( msg_t *msg, bool linebreak )
 {
 	int l, c;
-	static char string[MAX_MSG_STRING_CHARS];
+	static QF_THREAD_LOCAL char string[MAX_MSG_STRING_CHARS];
 
 	l = 0;
 	do
@@ -284,28 +338,64 @@ char *MSG_ReadStringLine( msg_t *msg )
 // SPECIAL CASES
 //==================================================
 
+// when false, the delta writers skip the whole state compares and check every
+// field as they used to, so snapbench can measure both paths in one build
+static bool msg_deltaShortcuts = true;
+
 /*
-* MSG_WriteDeltaEntity
-* 
-* Writes part of a packetentities message.
-* Can delta from either a baseline or a previous packet_entity
+* MSG_SetDeltaShortcuts
 */
-void MSG_WriteDeltaEntity( entity_state_t *from, entity_state_t *to, msg_t *msg, bool force, bool updateOtherOrigin )
+void MSG_SetDeltaShortcuts( bool enable )
 {
-	int bits;
+	msg_deltaShortcuts = enable;
+}
 
-	if( !to->number )
-		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Unset entity number" );
-	else if( to->number >= MAX_EDICTS )
-		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Entity number >= MAX_EDICTS" );
-	else if( to->number < 0 )
-		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Invalid Entity number" );
+/*
+* MSG_DeltaShortcuts
+*/
+bool MSG_DeltaShortcuts( void )
+{
+	return msg_deltaShortcuts;
+}
 
-	// send an update
-	bits = 0;
+/*
+* MSG_EntityStateHasNaN
+*/
+static bool MSG_EntityStateHasNaN( const entity_state_t *state )
+{
+	int i;
 
-	if( to->number & 0xFF00 )
-		bits |= U_NUMBER16; // number8 is implicit otherwise
+	for( i = 0; i < 3; i++ )
+	{
+		if( state->origin[i] != state->origin[i] || state->origin2[i] != state->origin2[i] 
+			|| state->angles[i] != state->angles[i] || state->linearMovementVelocity[i] != state->linearMovementVelocity[i] )
+			return true;
+	}
+	return state->attenuation != state->attenuation;
+}
+
+/*
+* MSG_DeltaEntityBits
+*
+* Returns the U_* bits of the fields that differ between the two states
+*/
+static int MSG_DeltaEntityBits( const entity_state_t *from, const entity_state_t *to, bool updateOtherOrigin )
+{
+	int bits = 0;
+
+	// most entities don't change from one frame to the next, and when the states
+	// are bitwise equal only the fields sent regardless of the old state can be set
+	// (NaN never compares equal, so leave those to the field by field checks)
+	if( msg_deltaShortcuts && !memcmp( from, to, sizeof( *to ) ) && !MSG_EntityStateHasNaN( to ) )
+	{
+		if( to->events[0] )
+			bits |= U_EVENT;
+		if( to->events[1] )
+			bits |= U_EVENT2;
+		if( updateOtherOrigin && to->teleported )
+			bits |= U_OTHERORIGIN;
+		return bits;
+	}
 
 	if( to->linearMovement )
 	{
@@ -403,6 +493,34 @@ void MSG_WriteDeltaEntity( entity_state_t *from, entity_state_t *to, msg_t *msg,
 	if( to->team != from->team )
 		bits |= U_TEAM;
 
+	return bits;
+}
+
+/*
+* MSG_WriteDeltaEntity
+* 
+* Writes part of a packetentities message.
+* Can delta from either a baseline or a previous packet_entity
+*/
+void MSG_WriteDeltaEntity( entity_state_t *from, entity_state_t *to, msg_t *msg, bool force, bool updateOtherOrigin )
+{
+	int bits;
+
+	if( !to->number )
+		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Unset entity number" );
+	else if( to->number >= MAX_EDICTS )
+		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Entity number >= MAX_EDICTS" );
+	else if( to->number < 0 )
+		Com_Error( ERR_FATAL, "MSG_WriteDeltaEntity: Invalid Entity number" );
+
+	// send an update
+	bits = 0;
+
+	if( to->number & 0xFF00 )
+		bits |= U_NUMBER16; // number8 is implicit otherwise
+
+	bits |= MSG_DeltaEntityBits( from, to, updateOtherOrigin );
+
 	//
 	// write the message
 	//
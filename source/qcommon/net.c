@@ -64,7 +64,7 @@ typedef struct
 } loopback_t;
 
 static loopback_t loopbacks[2];
-static char errorstring[MAX_PRINTMSG];
+static QF_THREAD_LOCAL char errorstring[MAX_PRINTMSG];
 static bool	net_initialized = false;
 
 #define MAX_IPS 16
@@ -1115,7 +1115,7 @@ int NET_Send( const socket_t *socket, const void *data, size_t length, const net
 */
 char *NET_AddressToString( const netadr_t *a )
 {
-	static char s[64];
+	static QF_THREAD_LOCAL char s[64];
 
 	switch( a->type )
 	{
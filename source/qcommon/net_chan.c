@@ -115,7 +115,7 @@ void Netchan_OutOfBand( const socket_t *socket, const netadr_t *address, size_t
 void Netchan_OutOfBandPrint( const socket_t *socket, const netadr_t *address, const char *format, ... )
 {
 	va_list	argptr;
-	static char string[MAX_PACKETLEN - 4];
+	static QF_THREAD_LOCAL char string[MAX_PACKETLEN - 4];
 
 	va_start( argptr, format );
 	Q_vsnprintfz( string, sizeof( string ), format, argptr );
@@ -141,7 +141,8 @@ void Netchan_Setup( netchan_t *chan, const socket_t *socket, const netadr_t *add
 }
 
 
-static uint8_t msg_process_data[MAX_MSGLEN];
+// per thread, TV relay threads decompress their upstream packets concurrently
+static QF_THREAD_LOCAL uint8_t msg_process_data[MAX_MSGLEN];
 
 //=============================================================
 // Zlib compression
@@ -219,17 +220,14 @@ static int Netchan_ZLibDecompressChunk( const uint8_t *source, unsigned long sou
 int Netchan_CompressMessage( msg_t *msg )
 {
 	int length;
+	uint8_t compressed[MAX_MSGLEN];	// not shared, TV relay threads compress concurrently
 
 	if( msg == NULL || !msg->data )
 		return 0;
 
-	// zero-fill our buffer
-	length = 0;
-	memset( msg_process_data, 0, sizeof( msg_process_data ) );
-
 	//compress the message
 	length = Netchan_ZLibCompressChunk( msg->data, msg->cursize, 
-		msg_process_data, sizeof( msg_process_data ), Z_BEST_COMPRESSION, -MAX_WBITS );
+		compressed, sizeof( compressed ), Z_BEST_COMPRESSION, -MAX_WBITS );
 	if( length < 0 )  // failed to compress, return the error
 		return length;
 
@@ -240,7 +238,7 @@ int Netchan_CompressMessage( msg_t *msg )
 
 	//write it back into the original container
 	MSG_Clear( msg );
-	MSG_CopyData( msg, msg_process_data, length );
+	MSG_CopyData( msg, compressed, length );
 	msg->compressed = true;
 
 	return length; // return the new size
@@ -0,0 +1,585 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// profile.c -- per frame timing zones
+
+#include "qcommon.h"
+
+/*
+* Zones are registered once by name and then entered and left from the main
+* thread with Com_ProfileBegin/Com_ProfileEnd. Every Qcommon_Frame is one
+* profiler frame: the inclusive time of each zone and the individual zone
+* events go to a ring buffer, from which percentiles are computed. Frames
+* slower than com_profile_slowframe are also copied to a small list of their
+* own, so they can still be exported as a Chrome trace after the ring wrapped.
+*
+* Other threads can't nest zones, they report finished spans through
+* Com_ProfileAddTime, which get merged into the current frame.
+*/
+
+#define PROFILE_MAX_FRAMES		512
+#define PROFILE_MAX_EVENTS		256
+#define PROFILE_MAX_DEPTH		16
+#define PROFILE_MAX_PENDING		64
+#define PROFILE_MAX_SLOWFRAMES	16
+#define PROFILE_ZONE_NAME_SIZE	32
+
+typedef struct
+{
+	short zone;
+	short depth;
+	int thread;
+	int start;					// microseconds since the start of the frame
+	unsigned int duration;
+} profevent_t;
+
+typedef struct
+{
+	uint64_t start;
+	unsigned int duration;
+	unsigned int framenum;
+	uint64_t zoneMask;
+	unsigned int zoneTime[PROFILE_MAX_ZONES];
+	int numEvents;
+	profevent_t events[PROFILE_MAX_EVENTS];
+} profframe_t;
+
+typedef struct
+{
+	int zone;
+	int event;
+	uint64_t start;
+} profstackentry_t;
+
+typedef struct
+{
+	int zone;
+	uint64_t start;
+	unsigned int duration;
+} profpending_t;
+
+static cvar_t *com_profile;
+static cvar_t *com_profile_slowframe;
+
+static char profile_zones[PROFILE_MAX_ZONES][PROFILE_ZONE_NAME_SIZE];
+static int profile_numZones;
+
+static qmutex_t *profile_mutex;
+static volatile bool profile_active;
+
+static profframe_t *profile_frames;
+static unsigned int profile_head, profile_count;
+static unsigned int profile_framenum;
+
+static profframe_t *profile_slowFrames;
+static unsigned int profile_slowHead, profile_slowCount;
+
+static profframe_t *profile_frame;
+static profstackentry_t profile_stack[PROFILE_MAX_DEPTH];
+static int profile_depth;
+
+static profpending_t profile_pending[PROFILE_MAX_PENDING];
+static int profile_numPending;
+
+/*
+* Com_ProfileZone
+*
+* Returns the index of the named zone, registering it if needed
+*/
+int Com_ProfileZone( const char *name )
+{
+	int i;
+	char *s;
+
+	for( i = 0; i < profile_numZones; i++ )
+	{
+		if( !Q_strnicmp( profile_zones[i], name, PROFILE_ZONE_NAME_SIZE - 1 ) )
+			return i;
+	}
+
+	if( profile_numZones == PROFILE_MAX_ZONES )
+	{
+		Com_DPrintf( "Com_ProfileZone: too many zones, %s ignored\n", name );
+		return -1;
+	}
+
+	Q_strncpyz( profile_zones[profile_numZones], name, PROFILE_ZONE_NAME_SIZE );
+
+	// the names end up in JSON strings
+	for( s = profile_zones[profile_numZones]; *s; s++ )
+	{
+		if( *s == '"' || *s == '\\' || (unsigned char)*s < ' ' )
+			*s = '_';
+	}
+
+	return profile_numZones++;
+}
+
+/*
+* Com_ProfileBegin
+*/
+void Com_ProfileBegin( int zone )
+{
+	profstackentry_t *entry;
+	profevent_t *event;
+
+	if( !profile_frame || zone < 0 )
+		return;
+
+	if( profile_depth >= PROFILE_MAX_DEPTH )
+	{
+		// too deep to record, but keep the count balanced
+		profile_depth++;
+		return;
+	}
+
+	entry = &profile_stack[profile_depth];
+	entry->zone = zone;
+	entry->start = Sys_Microseconds();
+	entry->event = -1;
+
+	if( profile_frame->numEvents < PROFILE_MAX_EVENTS )
+	{
+		entry->event = profile_frame->numEvents++;
+		event = &profile_frame->events[entry->event];
+		event->zone = zone;
+		event->depth = profile_depth;
+		event->thread = 0;
+		event->start = (int)( entry->start - profile_frame->start );
+		event->duration = 0;
+	}
+
+	profile_depth++;
+}
+
+/*
+* Com_ProfileEnd
+*/
+void Com_ProfileEnd( int zone )
+{
+	profstackentry_t *entry;
+	unsigned int duration;
+
+	if( !profile_frame || zone < 0 || !profile_depth )
+		return;
+
+	profile_depth--;
+	if( profile_depth >= PROFILE_MAX_DEPTH )
+		return;
+
+	entry = &profile_stack[profile_depth];
+	if( entry->zone != zone )
+	{
+		// unbalanced begin/end, don't keep this frame
+		Com_DPrintf( "Com_ProfileEnd: expected %s, got %s\n", profile_zones[entry->zone], profile_zones[zone] );
+		profile_frame = NULL;
+		return;
+	}
+
+	duration = (unsigned int)( Sys_Microseconds() - entry->start );
+	profile_frame->zoneMask |= (uint64_t)1 << zone;
+	profile_frame->zoneTime[zone] += duration;
+	if( entry->event >= 0 )
+		profile_frame->events[entry->event].duration = duration;
+}
+
+/*
+* Com_ProfileAddTime
+*
+* Records a finished span of a zone run by another thread
+*/
+void Com_ProfileAddTime( int zone, uint64_t start, unsigned int duration )
+{
+	profpending_t *pending;
+
+	if( !profile_active || zone < 0 )
+		return;
+
+	QMutex_Lock( profile_mutex );
+	if( profile_numPending < PROFILE_MAX_PENDING )
+	{
+		pending = &profile_pending[profile_numPending++];
+		pending->zone = zone;
+		pending->start = start;
+		pending->duration = duration;
+	}
+	QMutex_Unlock( profile_mutex );
+}
+
+/*
+* Com_ProfileAllocFrames
+*/
+static void Com_ProfileAllocFrames( void )
+{
+	QMutex_Lock( profile_mutex );
+	profile_frames = Mem_ZoneMalloc( sizeof( *profile_frames ) * PROFILE_MAX_FRAMES );
+	profile_slowFrames = Mem_ZoneMalloc( sizeof( *profile_slowFrames ) * PROFILE_MAX_SLOWFRAMES );
+	profile_head = profile_count = 0;
+	profile_slowHead = profile_slowCount = 0;
+	profile_numPending = 0;
+	profile_active = true;
+	QMutex_Unlock( profile_mutex );
+}
+
+/*
+* Com_ProfileFreeFrames
+*/
+static void Com_ProfileFreeFrames( void )
+{
+	QMutex_Lock( profile_mutex );
+	profile_active = false;
+	profile_frame = NULL;
+	if( profile_frames )
+	{
+		Mem_Free( profile_frames );
+		profile_frames = NULL;
+	}
+	if( profile_slowFrames )
+	{
+		Mem_Free( profile_slowFrames );
+		profile_slowFrames = NULL;
+	}
+	profile_head = profile_count = 0;
+	profile_slowHead = profile_slowCount = 0;
+	QMutex_Unlock( profile_mutex );
+}
+
+/*
+* Com_ProfileBeginFrame
+*/
+void Com_ProfileBeginFrame( void )
+{
+	if( !com_profile )
+		return;
+
+	if( com_profile->integer && !profile_frames )
+		Com_ProfileAllocFrames();
+	else if( !com_profile->integer && profile_frames )
+		Com_ProfileFreeFrames();
+
+	if( !profile_frames )
+		return;
+
+	// the slot at head is never visible to readers, see Com_ProfileEndFrame
+	profile_frame = &profile_frames[profile_head];
+	profile_frame->start = Sys_Microseconds();
+	profile_frame->duration = 0;
+	profile_frame->framenum = profile_framenum++;
+	profile_frame->zoneMask = 0;
+	memset( profile_frame->zoneTime, 0, sizeof( profile_frame->zoneTime ) );
+	profile_frame->numEvents = 0;
+	profile_depth = 0;
+}
+
+/*
+* Com_ProfileEndFrame
+*/
+void Com_ProfileEndFrame( void )
+{
+	int i;
+	profframe_t *frame = profile_frame;
+	profpending_t *pending;
+	profevent_t *event;
+
+	if( !frame )
+		return;
+
+	profile_frame = NULL;
+	frame->duration = (unsigned int)( Sys_Microseconds() - frame->start );
+
+	QMutex_Lock( profile_mutex );
+
+	for( i = 0, pending = profile_pending; i < profile_numPending; i++, pending++ )
+	{
+		frame->zoneMask |= (uint64_t)1 << pending->zone;
+		frame->zoneTime[pending->zone] += pending->duration;
+
+		if( frame->numEvents < PROFILE_MAX_EVENTS )
+		{
+			event = &frame->events[frame->numEvents++];
+			event->zone = pending->zone;
+			event->depth = 0;
+			event->thread = 1;
+			event->start = (int)( (int64_t)pending->start - (int64_t)frame->start );
+			event->duration = pending->duration;
+		}
+	}
+	profile_numPending = 0;
+
+	// keep one slot free so that the next frame can be written without the lock
+	profile_head = ( profile_head + 1 ) % PROFILE_MAX_FRAMES;
+	if( profile_count < PROFILE_MAX_FRAMES - 1 )
+		profile_count++;
+
+	if( com_profile_slowframe->value > 0 && frame->duration >= com_profile_slowframe->value * 1000 )
+	{
+		memcpy( &profile_slowFrames[profile_slowHead], frame, sizeof( *frame ) );
+		profile_slowHead = ( profile_slowHead + 1 ) % PROFILE_MAX_SLOWFRAMES;
+		if( profile_slowCount < PROFILE_MAX_SLOWFRAMES )
+			profile_slowCount++;
+	}
+
+	QMutex_Unlock( profile_mutex );
+}
+
+/*
+* Com_ProfileCompareTimes
+*/
+static int Com_ProfileCompareTimes( const void *a, const void *b )
+{
+	unsigned int t1 = *( const unsigned int * )a, t2 = *( const unsigned int * )b;
+	return t1 < t2 ? -1 : ( t1 > t2 ? 1 : 0 );
+}
+
+/*
+* Com_ProfileFormatRow
+*/
+static void Com_ProfileFormatRow( const char *name, unsigned int *times, unsigned int numTimes,
+	void ( *print )( void *, const char * ), void *ctx )
+{
+	unsigned int i;
+	uint64_t total = 0;
+	char line[128];
+
+	if( !numTimes )
+		return;
+
+	qsort( times, numTimes, sizeof( *times ), Com_ProfileCompareTimes );
+	for( i = 0; i < numTimes; i++ )
+		total += times[i];
+
+	Q_snprintfz( line, sizeof( line ), "%-24s %6u %8.3f %8.3f %8.3f %8.3f %8.3f\n", name, numTimes,
+		total * 0.001 / numTimes,
+		times[( numTimes - 1 ) * 50 / 100] * 0.001,
+		times[( numTimes - 1 ) * 90 / 100] * 0.001,
+		times[( numTimes - 1 ) * 99 / 100] * 0.001,
+		times[numTimes - 1] * 0.001 );
+	print( ctx, line );
+}
+
+/*
+* Com_ProfileStats
+*
+* Prints percentiles of each zone over the frames in the ring buffer, in milliseconds
+*/
+static void Com_ProfileStats( void ( *print )( void *, const char * ), void *ctx )
+{
+	int zone;
+	unsigned int i, n;
+	unsigned int *times;
+	profframe_t *frame;
+	char line[128];
+
+	QMutex_Lock( profile_mutex );
+
+	if( !profile_count )
+	{
+		QMutex_Unlock( profile_mutex );
+		print( ctx, "No profiled frames\n" );
+		return;
+	}
+
+	Q_snprintfz( line, sizeof( line ), "%-24s %6s %8s %8s %8s %8s %8s\n", "zone", "frames", "avg", "p50", "p90", "p99", "max" );
+	print( ctx, line );
+
+	times = Mem_TempMalloc( sizeof( *times ) * profile_count );
+
+	for( i = 0; i < profile_count; i++ )
+		times[i] = profile_frames[( profile_head + PROFILE_MAX_FRAMES - profile_count + i ) % PROFILE_MAX_FRAMES].duration;
+	Com_ProfileFormatRow( "frame", times, profile_count, print, ctx );
+
+	for( zone = 0; zone < profile_numZones; zone++ )
+	{
+		for( i = 0, n = 0; i < profile_count; i++ )
+		{
+			frame = &profile_frames[( profile_head + PROFILE_MAX_FRAMES - profile_count + i ) % PROFILE_MAX_FRAMES];
+			if( frame->zoneMask & ( (uint64_t)1 << zone ) )
+				times[n++] = frame->zoneTime[zone];
+		}
+		Com_ProfileFormatRow( profile_zones[zone], times, n, print, ctx );
+	}
+
+	Mem_TempFree( times );
+
+	Q_snprintfz( line, sizeof( line ), "%u slow frames kept\n", profile_slowCount );
+	print( ctx, line );
+
+	QMutex_Unlock( profile_mutex );
+}
+
+/*
+* Com_ProfilePrintLine
+*/
+static void Com_ProfilePrintLine( void *ctx, const char *line )
+{
+	Com_Printf( "%s", line );
+}
+
+/*
+* Com_ProfilePrintStats
+*/
+void Com_ProfilePrintStats( void )
+{
+	if( !profile_active )
+	{
+		Com_Printf( "Profiler is disabled, set com_profile 1 to enable it\n" );
+		return;
+	}
+	Com_ProfileStats( Com_ProfilePrintLine, NULL );
+}
+
+typedef struct
+{
+	char *buf;
+	size_t size, len;
+} profbuffer_t;
+
+/*
+* Com_ProfileAppendLine
+*/
+static void Com_ProfileAppendLine( void *ctx, const char *line )
+{
+	profbuffer_t *buffer = ctx;
+	size_t len = strlen( line );
+
+	if( buffer->len + len + 1 > buffer->size )
+	{
+		buffer->size = max( buffer->size * 2, buffer->len + len + 1 );
+		buffer->buf = Mem_Realloc( buffer->buf, buffer->size );
+	}
+	memcpy( buffer->buf + buffer->len, line, len + 1 );
+	buffer->len += len;
+}
+
+/*
+* Com_ProfileStatsString
+*
+* Returns the stats as a zone allocated string, NULL if the profiler is off
+*/
+char *Com_ProfileStatsString( size_t *length )
+{
+	profbuffer_t buffer;
+
+	*length = 0;
+	if( !profile_active )
+		return NULL;
+
+	buffer.size = 4096;
+	buffer.len = 0;
+	buffer.buf = Mem_ZoneMallocExt( buffer.size, 0 );
+	buffer.buf[0] = '\0';
+
+	Com_ProfileStats( Com_ProfileAppendLine, &buffer );
+
+	*length = buffer.len;
+	return buffer.buf;
+}
+
+/*
+* Com_ProfileReset
+*/
+void Com_ProfileReset( void )
+{
+	QMutex_Lock( profile_mutex );
+	profile_count = 0;
+	profile_slowCount = 0;
+	profile_slowHead = 0;
+	QMutex_Unlock( profile_mutex );
+}
+
+/*
+* Com_ProfileWriteTrace
+*
+* Writes the kept slow frames as Chrome trace event JSON (chrome://tracing)
+*/
+bool Com_ProfileWriteTrace( const char *filename )
+{
+	int file;
+	unsigned int i;
+	int j;
+	profframe_t *frame;
+	profevent_t *event;
+
+	QMutex_Lock( profile_mutex );
+
+	if( !profile_slowCount )
+	{
+		QMutex_Unlock( profile_mutex );
+		Com_Printf( "No frames slower than %s ms were recorded\n", com_profile_slowframe->string );
+		return false;
+	}
+
+	if( FS_FOpenFile( filename, &file, FS_WRITE ) == -1 )
+	{
+		QMutex_Unlock( profile_mutex );
+		Com_Printf( "Com_ProfileWriteTrace: Couldn't write %s\n", filename );
+		return false;
+	}
+
+	FS_Printf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	FS_Printf( file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"main\"}},\n" );
+	FS_Printf( file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"other\"}}" );
+
+	for( i = 0; i < profile_slowCount; i++ )
+	{
+		frame = &profile_slowFrames[( profile_slowHead + PROFILE_MAX_SLOWFRAMES - profile_slowCount + i ) % PROFILE_MAX_SLOWFRAMES];
+
+		FS_Printf( file, ",\n{\"name\":\"frame %u\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%llu,\"dur\":%u}",
+			frame->framenum, (unsigned long long)frame->start, frame->duration );
+
+		for( j = 0, event = frame->events; j < frame->numEvents; j++, event++ )
+		{
+			FS_Printf( file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%i,\"ts\":%lld,\"dur\":%u}",
+				profile_zones[event->zone], event->thread, (long long)frame->start + event->start, event->duration );
+		}
+	}
+
+	FS_Printf( file, "\n]}\n" );
+	FS_FCloseFile( file );
+
+	QMutex_Unlock( profile_mutex );
+
+	Com_Printf( "Wrote %u slow frames to %s\n", profile_slowCount, filename );
+	return true;
+}
+
+/*
+* Com_ProfileInit
+*/
+void Com_ProfileInit( void )
+{
+	profile_mutex = QMutex_Create();
+
+	com_profile = Cvar_Get( "com_profile", "0", 0 );
+	com_profile_slowframe = Cvar_Get( "com_profile_slowframe", "50", CVAR_ARCHIVE );
+}
+
+/*
+* Com_ProfileShutdown
+*/
+void Com_ProfileShutdown( void )
+{
+	if( !profile_mutex )
+		return;
+
+	Com_ProfileFreeFrames();
+	QMutex_Destroy( &profile_mutex );
+	com_profile = NULL;
+}
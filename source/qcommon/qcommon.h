@@ -23,6 +23,8 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #ifndef __QCOMMON_H
 #define __QCOMMON_H
 
+#include <setjmp.h>
+
 #include "../gameshared/q_arch.h"
 #include "../gameshared/q_math.h"
 #include "../gameshared/q_shared.h"
@@ -63,6 +65,8 @@ typedef struct
 } msg_t;
 
 // msg.c
+#define MAX_MSG_STRING_CHARS	2048	// max length of a string read from or written to a message
+
 void MSG_Init( msg_t *buf, uint8_t *data, size_t length );
 void MSG_Clear( msg_t *buf );
 void *MSG_GetSpace( msg_t *buf, size_t length );
@@ -80,6 +84,8 @@ void MSG_WriteShort( msg_t *sb, int c );
 void MSG_WriteInt3( msg_t *sb, int c );
 void MSG_WriteLong( msg_t *sb, int c );
 void MSG_WriteFloat( msg_t *sb, float f );
+void MSG_WriteUintBase128( msg_t *sb, uint64_t c );
+void MSG_WriteIntBase128( msg_t *sb, int64_t c );
 void MSG_WriteString( msg_t *sb, const char *s );
 #define MSG_WriteCoord( sb, f ) ( MSG_WriteInt3( ( sb ), Q_rint( ( f*PM_VECTOR_SNAP ) ) ) )
 #define MSG_WritePos( sb, pos ) ( MSG_WriteCoord( ( sb ), ( pos )[0] ), MSG_WriteCoord( sb, ( pos )[1] ), MSG_WriteCoord( sb, ( pos )[2] ) )
@@ -88,6 +94,8 @@ void MSG_WriteString( msg_t *sb, const char *s );
 void MSG_WriteDeltaUsercmd( msg_t *sb, struct usercmd_s *from, struct usercmd_s *cmd );
 void MSG_WriteDeltaEntity( struct entity_state_s *from, struct entity_state_s *to, msg_t *msg, bool force, bool newentity );
 void MSG_WriteDir( msg_t *sb, vec3_t vector );
+void MSG_SetDeltaShortcuts( bool enable );
+bool MSG_DeltaShortcuts( void );
 
 
 void MSG_BeginReading( msg_t *sb );
@@ -99,6 +107,8 @@ int MSG_ReadShort( msg_t *sb );
 int MSG_ReadInt3( msg_t *sb );
 int MSG_ReadLong( msg_t *sb );
 float MSG_ReadFloat( msg_t *sb );
+uint64_t MSG_ReadUintBase128( msg_t *sb );
+int64_t MSG_ReadIntBase128( msg_t *sb );
 char *MSG_ReadString( msg_t *sb );
 char *MSG_ReadStringLine( msg_t *sb );
 #define MSG_ReadCoord( sb ) ( (float)MSG_ReadInt3( ( sb ) )*( 1.0/PM_VECTOR_SNAP ) )
@@ -137,11 +147,81 @@ void Com_FreePureList( purelist_t **purelist );
 
 void SNAP_ParseBaseline( msg_t *msg, entity_state_t *baselines );
 void SNAP_SkipFrame( msg_t *msg, struct snapshot_s *header );
-struct snapshot_s *SNAP_ParseFrame( msg_t *msg, struct snapshot_s *lastFrame, int *suppressCount, struct snapshot_s *backup, entity_state_t *baselines, int showNet );
+struct snapshot_s *SNAP_ParseFrame( msg_t *msg, struct snapshot_s *lastFrame, int *suppressCount, struct snapshot_s *backup, entity_state_t *baselines, int showNet,
+	bool compactSnaps );
+
+// recorded usercmd streams, written by the client "ucmdrecord" command and replayed by the swarm tool
+// and the server benchmark:
+// the magic, then for each usercmd a length byte followed by the usercmd delta compressed against
+// the previous one, with serverTimeStamp holding the milliseconds since the start of the recording
+#define UCMDFILE_MAGIC					"WUC1"
+#define UCMDFILE_EXTENSION				".ucmd"
+
+#define SNAP_BODYCACHE_ENTRIES			64
+#define SNAP_BODYCACHE_SIZE				( 256*1024 )
+
+// encoded frame bodies (areabits, match state, player states and entities),
+// shared by clients receiving frames with the same snapId from the same delta base
+typedef struct snap_bodycache_s
+{
+	unsigned int frameNum;
+	int numEntries;
+	struct
+	{
+		unsigned int snapId;
+		unsigned int oldSnapId;		// 0 if not delta compressed
+		bool compact;				// written with compact player state coordinates
+		size_t offset;
+		size_t size;
+	} entries[SNAP_BODYCACHE_ENTRIES];
+	size_t dataSize;
+	uint8_t data[SNAP_BODYCACHE_SIZE];
+
+	unsigned int hits;
+	unsigned int misses;
+} snap_bodycache_t;
+
+#define SNAP_DELTACACHE_ENTRIES			4096
+#define SNAP_DELTACACHE_SIZE			( 256*1024 )
+
+// encoded entity deltas of the current frame, shared by clients delta compressing
+// from the same old frame, or from the baseline (oldFrameNum 0)
+typedef struct snap_deltacache_s
+{
+	unsigned int frameNum;
+	unsigned int gameTime;
+	int uncachedNum;		// entity whose state is rewritten for each client, 0 if none
+	unsigned int tag;
+	unsigned int headTags[MAX_EDICTS];
+	int heads[MAX_EDICTS];
+	int numEntries;
+	struct
+	{
+		unsigned int oldFrameNum;
+		int next;
+		int offset;
+		int size;
+	} entries[SNAP_DELTACACHE_ENTRIES];
+	int dataSize;
+	uint8_t data[SNAP_DELTACACHE_SIZE];
+
+	unsigned int hits;
+	unsigned int misses;
+} snap_deltacache_t;
+
+void SNAP_ClearDeltaCache( snap_deltacache_t *deltacache );
+void SNAP_WriteDeltaEntity( snap_deltacache_t *deltacache, unsigned int oldFrameNum,
+						   entity_state_t *from, entity_state_t *to, msg_t *msg, bool force, bool updateOtherOrigin );
 
 void SNAP_WriteFrameSnapToClient( struct ginfo_s *gi, struct client_s *client, msg_t *msg, unsigned int frameNum, unsigned int gameTime,
 								 entity_state_t *baselines, struct client_entities_s *client_entities,
-								 int numcmds, gcommand_t *commands, const char *commandsData );
+								 int numcmds, gcommand_t *commands, const char *commandsData, snap_bodycache_t *bodycache,
+								 snap_deltacache_t *deltacache );
+
+unsigned int SNAP_BenchmarkFrameDeltas( struct ginfo_s *gi, struct client_s *client, entity_state_t *baselines, 
+									   struct client_entities_s *client_entities, int iterations );
+void SNAP_MeasurePlayerstateDelta( player_state_t *ops, player_state_t *ps, size_t *standardBytes, size_t *compactBytes );
+void SNAP_MeasurePlayerstateDeltas( struct client_s *client, size_t *standardBytes, size_t *compactBytes );
 
 void SNAP_BuildClientFrameSnap( struct cmodel_state_s *cms, struct ginfo_s *gi, unsigned int frameNum, unsigned int timeStamp,
 							   struct fatvis_s *fatvis, struct client_s *client, 
@@ -161,6 +241,7 @@ size_t SNAP_ClearDemoMeta( char *meta_data, size_t meta_data_max_size );
 size_t SNAP_SetDemoMetaKeyValue( char *meta_data, size_t meta_data_max_size, size_t meta_data_realsize,
 							  const char *key, const char *value );
 size_t SNAP_ReadDemoMetaData( int demofile, char *meta_data, size_t meta_data_size );
+usercmd_t *SNAP_LoadUcmdFile( const char *name, struct mempool_s *mempool, int *numcmds );
 
 //============================================================================
 
@@ -274,6 +355,13 @@ enum clc_ops_e
 #define SV_BITFLAGS_TVSERVER		( 1<<2 )
 #define SV_BITFLAGS_HTTP			( 1<<3 )
 #define SV_BITFLAGS_HTTP_BASEURL	( 1<<4 )
+// player state coordinates are sent as varint deltas. Demos carry the flag but the demo and
+// protocol versions don't change with it, so older builds misparse them: it stays opt-in
+#define SV_BITFLAGS_COMPACTSNAPS	( 1<<5 )
+
+// flags sent as the last argument of the connect packet
+#define CONNECT_FLAG_TVCLIENT		( 1<<0 )
+#define CONNECT_FLAG_COMPACTSNAPS	( 1<<1 )	// client can parse SV_BITFLAGS_COMPACTSNAPS frames
 
 // framesnap flags
 #define FRAMESNAP_FLAG_DELTA		( 1<<0 )
@@ -444,6 +532,16 @@ then searches for a command or variable that matches the first token.
 typedef void ( *xcommand_t )( void );
 typedef char ** ( *xcompletionf_t )( const char *partial );
 
+// tokens of a command line, argv points into buffer
+typedef struct
+{
+	int argc;
+	char *argv[MAX_STRING_TOKENS];
+	char args[MAX_STRING_CHARS];
+	char buffer[MAX_MSG_STRING_CHARS + MAX_STRING_TOKENS];	// fits every token of a message string
+	char spare[MAX_TOKEN_CHARS];		// receives tokens past MAX_STRING_TOKENS
+} cmd_tokens_t;
+
 void	    Cmd_PreInit( void );
 void	    Cmd_Init( void );
 void	    Cmd_Shutdown( void );
@@ -463,6 +561,7 @@ int			Cmd_Argc( void );
 char		*Cmd_Argv( int arg );
 char		*Cmd_Args( void );
 void	    Cmd_TokenizeString( const char *text );
+void	    Cmd_TokenizeStringExt( cmd_tokens_t *tokens, const char *text );
 void	    Cmd_ExecuteString( const char *text );
 void		Cmd_SetCompletionFunc( const char *cmd_name, xcompletionf_t completion_func );
 
@@ -507,6 +606,11 @@ NET
 #define	FRAGMENT_LAST		(	 1<<14 )
 #define	FRAGMENT_BIT			( 1<<31 )
 
+// windowed server downloads: each block fits in a single unfragmented packet,
+// the client acknowledges a base offset plus a bitmask of the blocks past it
+#define	DOWNLOAD_BLOCK_SIZE		1024
+#define	DOWNLOAD_WINDOW_BLOCKS	32          // must fit in the ack bitmask
+
 typedef enum
 {
 	NA_NOTRANSMIT,      // wsw : jal : fakeclients
@@ -729,6 +833,8 @@ static const struct fs_import_s default_fs_imports_s = {
 	.FS_LoadBaseFileExt = FS_LoadBaseFileExt,
 	.FS_FreeFile = FS_FreeFile,
 	.FS_FreeBaseFile = FS_FreeBaseFile,
+	.FS_MMapFile = FS_MMapFile,
+	.FS_UnMMapFile = FS_UnMMapFile,
 	.FS_CopyFile = FS_CopyFile,
 	.FS_CopyBaseFile = FS_CopyBaseFile,
 	.FS_ExtractFile = FS_ExtractFile,
@@ -775,6 +881,7 @@ bool		FS_IsExplicitPurePak( const char *pakname, bool *wrongver );
 * Does *not* work for compressed virtual files.
 *
 * @return mapped pointer to data on disk or NULL if mapping failed or passed size is 0.
+* @see FS_MMapFile for files found in the search path
 */
 void	*FS_MMapBaseFile( int file, size_t size, size_t offset );
 void	FS_UnMMapBaseFile( int file, void *data );
@@ -801,6 +908,8 @@ void 	    Com_DeferConsoleLogReopen( void );
 void	    Com_Printf( const char *format, ... );
 void	    Com_DPrintf( const char *format, ... );
 void	    Com_Error( com_error_code_t code, const char *format, ... );
+void		Com_SetThreadAbortFrame( jmp_buf *frame );
+const char	*Com_ErrorMessage( void );
 void		Com_DeferQuit( void );
 void	    Com_Quit( void );
 
@@ -1024,6 +1133,28 @@ char **ML_CompleteBuildList( const char *partial );
 /*
 ==============================================================
 
+PROFILER
+
+==============================================================
+*/
+#define PROFILE_MAX_ZONES	64
+
+void Com_ProfileInit( void );
+void Com_ProfileShutdown( void );
+void Com_ProfileBeginFrame( void );
+void Com_ProfileEndFrame( void );
+int Com_ProfileZone( const char *name );
+void Com_ProfileBegin( int zone );
+void Com_ProfileEnd( int zone );
+void Com_ProfileAddTime( int zone, uint64_t start, unsigned int duration );
+void Com_ProfilePrintStats( void );
+char *Com_ProfileStatsString( size_t *length );
+bool Com_ProfileWriteTrace( const char *filename );
+void Com_ProfileReset( void );
+
+/*
+==============================================================
+
 MULTITHREADING
 
 ==============================================================
@@ -0,0 +1,106 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "qcommon.h"
+
+/*
+* SNAP_ClearDeltaCache
+*/
+void SNAP_ClearDeltaCache( snap_deltacache_t *deltacache )
+{
+	// tag 0 marks never used heads
+	deltacache->tag++;
+	if( !deltacache->tag )
+	{
+		memset( deltacache->headTags, 0, sizeof( deltacache->headTags ) );
+		deltacache->tag = 1;
+	}
+	deltacache->numEntries = 0;
+	deltacache->dataSize = 0;
+}
+
+/*
+* SNAP_WriteDeltaEntity
+*
+* Entity states are shared by all clients of a frame, so a delta from the same
+* old frame encodes to the same bytes for everyone. Copy it from the cache when possible.
+* The one exception is deltacache->uncachedNum, an entity the caller rewrites per client.
+*/
+void SNAP_WriteDeltaEntity( snap_deltacache_t *deltacache, unsigned int oldFrameNum, 
+								  entity_state_t *from, entity_state_t *to, msg_t *msg, bool force, bool updateOtherOrigin )
+{
+	int i, number;
+	size_t start, size;
+
+	if( !deltacache )
+	{
+		MSG_WriteDeltaEntity( from, to, msg, force, updateOtherOrigin );
+		return;
+	}
+
+	number = to->number;
+	if( number == deltacache->uncachedNum )
+	{
+		MSG_WriteDeltaEntity( from, to, msg, force, updateOtherOrigin );
+		deltacache->misses++;
+		return;
+	}
+
+	if( number > 0 && number < MAX_EDICTS && deltacache->headTags[number] == deltacache->tag )
+	{
+		for( i = deltacache->heads[number]; i >= 0; i = deltacache->entries[i].next )
+		{
+			if( deltacache->entries[i].oldFrameNum != oldFrameNum )
+				continue;
+
+			MSG_WriteData( msg, deltacache->data + deltacache->entries[i].offset, deltacache->entries[i].size );
+			deltacache->hits++;
+			return;
+		}
+	}
+
+	start = msg->cursize;
+	MSG_WriteDeltaEntity( from, to, msg, force, updateOtherOrigin );
+	size = msg->cursize - start;
+	deltacache->misses++;
+
+	if( number <= 0 || number >= MAX_EDICTS )
+		return;
+	if( deltacache->numEntries >= SNAP_DELTACACHE_ENTRIES )
+		return;
+	if( deltacache->dataSize + size > sizeof( deltacache->data ) )
+		return;
+
+	if( deltacache->headTags[number] != deltacache->tag )
+	{
+		deltacache->headTags[number] = deltacache->tag;
+		deltacache->heads[number] = -1;
+	}
+
+	i = deltacache->numEntries++;
+	deltacache->entries[i].oldFrameNum = oldFrameNum;
+	deltacache->entries[i].offset = deltacache->dataSize;
+	deltacache->entries[i].size = size;
+	deltacache->entries[i].next = deltacache->heads[number];
+	deltacache->heads[number] = i;
+
+	memcpy( deltacache->data + deltacache->dataSize, msg->data + start, size );
+	deltacache->dataSize += size;
+}
@@ -377,3 +377,78 @@ size_t SNAP_ReadDemoMetaData( int demofile, char *meta_data, size_t meta_data_si
 
 	return meta_data_realsize;
 }
+
+/*
+* SNAP_LoadUcmdFile
+*
+* Loads a usercmd stream recorded with the client "ucmdrecord" command from ucmds/
+*/
+usercmd_t *SNAP_LoadUcmdFile( const char *name, struct mempool_s *mempool, int *numcmds )
+{
+	char filename[MAX_QPATH];
+	int filenum, length, magiclen;
+	uint8_t *buffer;
+	usercmd_t last, *cmds;
+	msg_t msg;
+
+	*numcmds = 0;
+
+	Q_snprintfz( filename, sizeof( filename ), "ucmds/%s", name );
+	COM_SanitizeFilePath( filename );
+	COM_DefaultExtension( filename, UCMDFILE_EXTENSION, sizeof( filename ) );
+
+	magiclen = strlen( UCMDFILE_MAGIC );
+	length = FS_FOpenFile( filename, &filenum, FS_READ );
+	if( length <= magiclen )
+	{
+		if( length >= 0 )
+			FS_FCloseFile( filenum );
+		Com_Printf( "Couldn't read %s\n", filename );
+		return NULL;
+	}
+
+	buffer = Mem_TempMalloc( length );
+	FS_Read( buffer, length, filenum );
+	FS_FCloseFile( filenum );
+
+	if( memcmp( buffer, UCMDFILE_MAGIC, magiclen ) )
+	{
+		Com_Printf( "%s is not an usercmd recording\n", filename );
+		Mem_TempFree( buffer );
+		return NULL;
+	}
+
+	// every usercmd takes at least two bytes, so this is an upper bound
+	cmds = Mem_Alloc( mempool, sizeof( usercmd_t ) * ( length / 2 + 1 ) );
+
+	MSG_Init( &msg, buffer, length );
+	msg.cursize = length;
+	msg.readcount = magiclen;
+
+	memset( &last, 0, sizeof( last ) );
+	while( msg.readcount < msg.cursize )
+	{
+		int len = MSG_ReadByte( &msg );
+		int start = msg.readcount;
+
+		if( len <= 0 || start + len > (int)msg.cursize )
+			break;
+
+		MSG_ReadDeltaUsercmd( &msg, &last, &cmds[*numcmds] );
+		last = cmds[( *numcmds )++];
+		msg.readcount = start + len;
+	}
+
+	Mem_TempFree( buffer );
+
+	if( !*numcmds )
+	{
+		Com_Printf( "%s holds no usercmds\n", filename );
+		Mem_Free( cmds );
+		return NULL;
+	}
+
+	Com_Printf( "Loaded %i usercmds (%.1f seconds) from %s\n", *numcmds,
+		cmds[*numcmds - 1].serverTimeStamp * 0.001f, filename );
+	return cmds;
+}
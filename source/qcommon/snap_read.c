@@ -107,10 +107,20 @@ static void SNAP_ParseDeltaGameState( msg_t *msg, snapshot_t *oldframe, snapshot
 	}
 }
 
+/*
+* SNAP_ReadPlayerstateCoord
+*/
+static float SNAP_ReadPlayerstateCoord( msg_t *msg, float oldvalue, bool compact )
+{
+	if( compact )
+		return (float)( (int)( oldvalue*PM_VECTOR_SNAP ) + (int)MSG_ReadIntBase128( msg ) )*( 1.0/PM_VECTOR_SNAP );
+	return ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+}
+
 /*
 * SNAP_ParsePlayerstate
 */
-static void SNAP_ParsePlayerstate( msg_t *msg, player_state_t *oldstate, player_state_t *state )
+static void SNAP_ParsePlayerstate( msg_t *msg, player_state_t *oldstate, player_state_t *state, bool compact )
 {
 	int flags;
 	int i, b;
@@ -146,18 +156,18 @@ static void SNAP_ParsePlayerstate( msg_t *msg, player_state_t *oldstate, player_
 		state->pmove.pm_type = (uint8_t)MSG_ReadByte( msg );
 
 	if( flags & PS_M_ORIGIN0 )
-		state->pmove.origin[0] = ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+		state->pmove.origin[0] = SNAP_ReadPlayerstateCoord( msg, state->pmove.origin[0], compact );
 	if( flags & PS_M_ORIGIN1 )
-		state->pmove.origin[1] = ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+		state->pmove.origin[1] = SNAP_ReadPlayerstateCoord( msg, state->pmove.origin[1], compact );
 	if( flags & PS_M_ORIGIN2 )
-		state->pmove.origin[2] = ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+		state->pmove.origin[2] = SNAP_ReadPlayerstateCoord( msg, state->pmove.origin[2], compact );
 
 	if( flags & PS_M_VELOCITY0 )
-		state->pmove.velocity[0] = ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+		state->pmove.velocity[0] = SNAP_ReadPlayerstateCoord( msg, state->pmove.velocity[0], compact );
 	if( flags & PS_M_VELOCITY1 )
-		state->pmove.velocity[1] = ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+		state->pmove.velocity[1] = SNAP_ReadPlayerstateCoord( msg, state->pmove.velocity[1], compact );
 	if( flags & PS_M_VELOCITY2 )
-		state->pmove.velocity[2] = ( (float)MSG_ReadInt3( msg )*( 1.0/PM_VECTOR_SNAP ) );
+		state->pmove.velocity[2] = SNAP_ReadPlayerstateCoord( msg, state->pmove.velocity[2], compact );
 
 	if( flags & PS_M_TIME )
 		state->pmove.pm_time = (uint8_t)MSG_ReadByte( msg );
@@ -555,14 +565,15 @@ static snapshot_t *SNAP_ParseFrameHeader( msg_t *msg, snapshot_t *newframe, int
 */
 void SNAP_SkipFrame( msg_t *msg, snapshot_t *header )
 {
-	static snapshot_t frame;
+	static QF_THREAD_LOCAL snapshot_t frame;
 	SNAP_ParseFrameHeader( msg, header ? header : &frame, NULL, NULL, true );
 }
 
 /*
 * SNAP_ParseFrame
 */
-snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCount, snapshot_t *backup, entity_state_t *baselines, int showNet )
+snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCount, snapshot_t *backup, entity_state_t *baselines, int showNet,
+							bool compactSnaps )
 {
 	int cmd;
 	size_t len;
@@ -658,10 +669,10 @@ snapshot_t *SNAP_ParseFrame( msg_t *msg, snapshot_t *lastFrame, int *suppressCou
 		_SHOWNET( msg, svc_strings[cmd], showNet );
 		if( cmd != svc_playerinfo )
 			Com_Error( ERR_DROP, "SNAP_ParseFrame: not playerinfo" );
-		if( deltaframe && deltaframe->numplayers >= numplayers )
-			SNAP_ParsePlayerstate( msg, &deltaframe->playerStates[numplayers], &newframe->playerStates[numplayers] );
+		if( deltaframe && deltaframe->numplayers > numplayers )
+			SNAP_ParsePlayerstate( msg, &deltaframe->playerStates[numplayers], &newframe->playerStates[numplayers], compactSnaps );
 		else
-			SNAP_ParsePlayerstate( msg, NULL, &newframe->playerStates[numplayers] );
+			SNAP_ParsePlayerstate( msg, NULL, &newframe->playerStates[numplayers], compactSnaps );
 		numplayers++;
 	}
 	newframe->numplayers = numplayers;
@@ -35,7 +35,8 @@ Encode a client frame onto the network channel
 *
 * Writes a delta update of an entity_state_t list to the message.
 */
-static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, client_snapshot_t *to, msg_t *msg, entity_state_t *baselines, entity_state_t *client_entities, int num_client_entities )
+static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, client_snapshot_t *to, msg_t *msg, entity_state_t *baselines, entity_state_t *client_entities, int num_client_entities,
+									snap_deltacache_t *deltacache, unsigned int oldFrameNum )
 {
 	entity_state_t *oldent, *newent;
 	int oldindex, newindex;
@@ -83,7 +84,7 @@ static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, clien
 			// in any bytes being emited if the entity has not changed at all
 			// note that players are always 'newentities', this updates their oldorigin always
 			// and prevents warping ( wsw : jal : I removed it from the players )
-			MSG_WriteDeltaEntity( oldent, newent, msg, false, ( ( EDICT_NUM( newent->number ) )->r.svflags & SVF_TRANSMITORIGIN2 ) ? true : false );
+			SNAP_WriteDeltaEntity( deltacache, oldFrameNum, oldent, newent, msg, false, ( ( EDICT_NUM( newent->number ) )->r.svflags & SVF_TRANSMITORIGIN2 ) ? true : false );
 			oldindex++;
 			newindex++;
 			continue;
@@ -92,7 +93,7 @@ static void SNAP_EmitPacketEntities( ginfo_t *gi, client_snapshot_t *from, clien
 		if( newnum < oldnum )
 		{
 			// this is a new entity, send it from the baseline
-			MSG_WriteDeltaEntity( &baselines[newnum], newent, msg, true, ( ( EDICT_NUM( newent->number ) )->r.svflags & SVF_TRANSMITORIGIN2 ) ? true : false );
+			SNAP_WriteDeltaEntity( deltacache, 0, &baselines[newnum], newent, msg, true, ( ( EDICT_NUM( newent->number ) )->r.svflags & SVF_TRANSMITORIGIN2 ) ? true : false );
 			newindex++;
 			continue;
 		}
@@ -184,25 +185,41 @@ static void SNAP_WriteDeltaGameStateToClient( client_snapshot_t *from, client_sn
 }
 
 /*
-* SNAP_WritePlayerstateToClient
+* SNAP_PlayerstateHasNaN
 */
-static void SNAP_WritePlayerstateToClient( player_state_t *ops, player_state_t *ps, msg_t *msg )
+static bool SNAP_PlayerstateHasNaN( const player_state_t *ps )
 {
 	int i;
-	int pflags;
-	player_state_t dummy;
-	int statbits[SNAP_STATS_LONGS];
 
-	if( !ops )
+	for( i = 0; i < 3; i++ )
 	{
-		memset( &dummy, 0, sizeof( dummy ) );
-		ops = &dummy;
+		if( ps->pmove.origin[i] != ps->pmove.origin[i] || ps->pmove.velocity[i] != ps->pmove.velocity[i] 
+			|| ps->viewangles[i] != ps->viewangles[i] )
+			return true;
 	}
+	return ps->viewheight != ps->viewheight || ps->fov != ps->fov;
+}
 
-	//
-	// determine what needs to be sent
-	//
-	pflags = 0;
+/*
+* SNAP_PlayerstateDeltaFlags
+*
+* Returns the PS_* flags of the fields that differ between the two states
+*/
+static int SNAP_PlayerstateDeltaFlags( const player_state_t *ops, const player_state_t *ps )
+{
+	int i;
+	int pflags = 0;
+
+	// only events are sent regardless of the old state
+	// (NaN never compares equal, so leave those to the field by field checks)
+	if( MSG_DeltaShortcuts() && !memcmp( ops, ps, sizeof( *ps ) ) && !SNAP_PlayerstateHasNaN( ps ) )
+	{
+		if( ps->event[0] )
+			pflags |= PS_EVENT;
+		if( ps->event[1] )
+			pflags |= PS_EVENT2;
+		return pflags;
+	}
 
 	if( ps->pmove.pm_type != ops->pmove.pm_type )
 		pflags |= PS_M_TYPE;
@@ -263,27 +280,113 @@ static void SNAP_WritePlayerstateToClient( player_state_t *ops, player_state_t *
 	if( ps->viewheight != ops->viewheight )
 		pflags |= PS_VIEWHEIGHT;
 
-	for( i = 0; i < PM_STAT_SIZE; i++ )
+	// integer arrays, so bitwise equality is value equality
+	if( MSG_DeltaShortcuts() )
 	{
-		if( ps->pmove.stats[i] != ops->pmove.stats[i] )
-		{
+		if( memcmp( ps->pmove.stats, ops->pmove.stats, sizeof( ps->pmove.stats ) ) )
 			pflags |= PS_PMOVESTATS;
-			break;
-		}
-	}
 
-	for( i = 0; i < MAX_ITEMS; i++ )
+		if( memcmp( ps->inventory, ops->inventory, sizeof( ps->inventory ) ) )
+			pflags |= PS_INVENTORY;
+	}
+	else
 	{
-		if( ps->inventory[i] != ops->inventory[i] )
+		for( i = 0; i < PM_STAT_SIZE; i++ )
 		{
-			pflags |= PS_INVENTORY;
-			break;
+			if( ps->pmove.stats[i] != ops->pmove.stats[i] )
+			{
+				pflags |= PS_PMOVESTATS;
+				break;
+			}
+		}
+
+		for( i = 0; i < MAX_ITEMS; i++ )
+		{
+			if( ps->inventory[i] != ops->inventory[i] )
+			{
+				pflags |= PS_INVENTORY;
+				break;
+			}
 		}
 	}
 
 	if( ps->plrkeys != ops->plrkeys )
 		pflags |= PS_PLRKEYS;
 
+	return pflags;
+}
+
+/*
+* SNAP_StatBits
+*
+* Sets a bit for every changed value, comparing 32 values at once
+* so unchanged ranges are skipped with a single wide compare
+*/
+static void SNAP_StatBits( const short *oldstats, const short *stats, int numstats, int *bits )
+{
+	int i, j, n;
+
+	if( !MSG_DeltaShortcuts() )
+	{
+		memset( bits, 0, ( ( numstats + 31 ) >> 5 ) * sizeof( *bits ) );
+		for( i = 0; i < numstats; i++ )
+		{
+			if( stats[i] != oldstats[i] )
+				bits[i>>5] |= 1<<(i&31);
+		}
+		return;
+	}
+
+	for( i = 0; i < numstats; i += 32 )
+	{
+		n = min( numstats - i, 32 );
+		bits[i>>5] = 0;
+		if( !memcmp( oldstats + i, stats + i, n * sizeof( *stats ) ) )
+			continue;
+
+		for( j = 0; j < n; j++ )
+		{
+			if( stats[i+j] != oldstats[i+j] )
+				bits[i>>5] |= 1<<j;
+		}
+	}
+}
+
+/*
+* SNAP_WritePlayerstateCoord
+*
+* Compact snaps send the difference to the old value in the same 1/PM_VECTOR_SNAP
+* units. The client holds the old value as it was sent, so both sides round it the same.
+*/
+static void SNAP_WritePlayerstateCoord( msg_t *msg, float oldvalue, float value, bool compact )
+{
+	if( compact )
+		MSG_WriteIntBase128( msg, (int)( value*PM_VECTOR_SNAP ) - (int)( oldvalue*PM_VECTOR_SNAP ) );
+	else
+		MSG_WriteInt3( msg, (int)( value*PM_VECTOR_SNAP ) );
+}
+
+/*
+* SNAP_WritePlayerstateToClient
+*/
+static void SNAP_WritePlayerstateToClient( player_state_t *ops, player_state_t *ps, msg_t *msg, bool compact )
+{
+	int i;
+	int pflags;
+	player_state_t dummy;
+	int statbits[SNAP_STATS_LONGS];
+
+	if( !ops )
+	{
+		memset( &dummy, 0, sizeof( dummy ) );
+		ops = &dummy;
+	}
+
+	//
+	// determine what needs to be sent
+	//
+	pflags = SNAP_PlayerstateDeltaFlags( ops, ps );
+
 	//
 	// write it
 	//
@@ -321,18 +424,18 @@ static void SNAP_WritePlayerstateToClient( player_state_t *ops, player_state_t *
 		MSG_WriteByte( msg, ps->pmove.pm_type );
 
 	if( pflags & PS_M_ORIGIN0 )
-		MSG_WriteInt3( msg, (int)( ps->pmove.origin[0]*PM_VECTOR_SNAP ) );
+		SNAP_WritePlayerstateCoord( msg, ops->pmove.origin[0], ps->pmove.origin[0], compact );
 	if( pflags & PS_M_ORIGIN1 )
-		MSG_WriteInt3( msg, (int)( ps->pmove.origin[1]*PM_VECTOR_SNAP ) );
+		SNAP_WritePlayerstateCoord( msg, ops->pmove.origin[1], ps->pmove.origin[1], compact );
 	if( pflags & PS_M_ORIGIN2 )
-		MSG_WriteInt3( msg, (int)( ps->pmove.origin[2]*PM_VECTOR_SNAP ) );
+		SNAP_WritePlayerstateCoord( msg, ops->pmove.origin[2], ps->pmove.origin[2], compact );
 
 	if( pflags & PS_M_VELOCITY0 )
-		MSG_WriteInt3( msg, (int)( ps->pmove.velocity[0]*PM_VECTOR_SNAP ) );
+		SNAP_WritePlayerstateCoord( msg, ops->pmove.velocity[0], ps->pmove.velocity[0], compact );
 	if( pflags & PS_M_VELOCITY1 )
-		MSG_WriteInt3( msg, (int)( ps->pmove.velocity[1]*PM_VECTOR_SNAP ) );
+		SNAP_WritePlayerstateCoord( msg, ops->pmove.velocity[1], ps->pmove.velocity[1], compact );
 	if( pflags & PS_M_VELOCITY2 )
-		MSG_WriteInt3( msg, (int)( ps->pmove.velocity[2]*PM_VECTOR_SNAP ) );
+		SNAP_WritePlayerstateCoord( msg, ops->pmove.velocity[2], ps->pmove.velocity[2], compact );
 
 	if( pflags & PS_M_TIME )
 		MSG_WriteByte( msg, ps->pmove.pm_time );
@@ -441,12 +544,7 @@ static void SNAP_WritePlayerstateToClient( player_state_t *ops, player_state_t *
 		MSG_WriteByte( msg, ps->plrkeys );
 
 	// send stats
-	memset( statbits, 0, sizeof( statbits ) );
-	for( i = 0; i < PS_MAX_STATS; i++ )
-	{
-		if( ps->stats[i] != ops->stats[i] )
-			statbits[i>>5] |= 1<<(i&31);
-	}
+	SNAP_StatBits( ops->stats, ps->stats, PS_MAX_STATS, statbits );
 
 	for( i = 0; i < SNAP_STATS_LONGS; i++ ) {
 		MSG_WriteLong( msg, statbits[i] );
@@ -618,15 +716,76 @@ static void SNAP_RelayMultiPOVCommands( ginfo_t *gi, client_t *client, msg_t *ms
 	}
 }
 
+/*
+* SNAP_WriteCachedFrameBody
+*
+* Copies an already encoded frame body for the same frame and delta base into the message
+*/
+static bool SNAP_WriteCachedFrameBody( snap_bodycache_t *bodycache, unsigned int frameNum,
+									  client_snapshot_t *frame, client_snapshot_t *oldframe, bool compact, msg_t *msg )
+{
+	int i;
+	unsigned int oldSnapId = oldframe ? oldframe->snapId : 0;
+
+	if( bodycache->frameNum != frameNum )
+	{
+		bodycache->frameNum = frameNum;
+		bodycache->numEntries = 0;
+		bodycache->dataSize = 0;
+		return false;
+	}
+
+	for( i = 0; i < bodycache->numEntries; i++ )
+	{
+		if( bodycache->entries[i].snapId != frame->snapId || bodycache->entries[i].oldSnapId != oldSnapId ||
+			bodycache->entries[i].compact != compact )
+			continue;
+		if( msg->cursize + bodycache->entries[i].size > msg->maxsize )
+			return false;
+
+		MSG_WriteData( msg, bodycache->data + bodycache->entries[i].offset, bodycache->entries[i].size );
+		return true;
+	}
+
+	return false;
+}
+
+/*
+* SNAP_StoreCachedFrameBody
+*/
+static void SNAP_StoreCachedFrameBody( snap_bodycache_t *bodycache, client_snapshot_t *frame, client_snapshot_t *oldframe,
+									  bool compact, const msg_t *msg, size_t bodystart )
+{
+	size_t size = msg->cursize - bodystart;
+
+	if( bodycache->numEntries >= SNAP_BODYCACHE_ENTRIES )
+		return;
+	if( bodycache->dataSize + size > sizeof( bodycache->data ) )
+		return;
+
+	bodycache->entries[bodycache->numEntries].snapId = frame->snapId;
+	bodycache->entries[bodycache->numEntries].oldSnapId = oldframe ? oldframe->snapId : 0;
+	bodycache->entries[bodycache->numEntries].compact = compact;
+	bodycache->entries[bodycache->numEntries].offset = bodycache->dataSize;
+	bodycache->entries[bodycache->numEntries].size = size;
+	bodycache->numEntries++;
+
+	memcpy( bodycache->data + bodycache->dataSize, msg->data + bodystart, size );
+	bodycache->dataSize += size;
+}
+
 /*
 * SNAP_WriteFrameSnapToClient
 */
 void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, unsigned int frameNum, unsigned int gameTime,
 								 entity_state_t *baselines, client_entities_t *client_entities,
-								 int numcmds, gcommand_t *commands, const char *commandsData )
+								 int numcmds, gcommand_t *commands, const char *commandsData, snap_bodycache_t *bodycache,
+								 snap_deltacache_t *deltacache )
 {
 	client_snapshot_t *frame, *oldframe;
 	int flags, i, index, pos, length, supcnt;
+	size_t bodystart;
+	bool cached;
 
 	// this is the frame we are creating
 	frame = &client->snapShots[frameNum & UPDATE_MASK];
@@ -721,24 +880,52 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, uns
 	}
 	MSG_WriteShort( msg, -1 );
 
-	// send over the areabits
-	MSG_WriteByte( msg, frame->areabytes );
-	MSG_WriteData( msg, frame->areabits, frame->areabytes );
-
-	SNAP_WriteDeltaGameStateToClient( oldframe, frame, msg );
-
-	// delta encode the playerstate
-	for( i = 0; i < frame->numplayers; i++ )
+	// everything past this point only depends on the frame and its delta base,
+	// so it can be shared between clients receiving the same frame
+	cached = false;
+	if( bodycache && frame->snapId && ( !oldframe || oldframe->snapId ) )
 	{
-		if( oldframe && oldframe->numplayers > i )
-			SNAP_WritePlayerstateToClient( &oldframe->ps[i], &frame->ps[i], msg );
+		cached = SNAP_WriteCachedFrameBody( bodycache, frameNum, frame, oldframe, client->compactSnaps, msg );
+		if( cached )
+			bodycache->hits++;
 		else
-			SNAP_WritePlayerstateToClient( NULL, &frame->ps[i], msg );
+			bodycache->misses++;
 	}
-	MSG_WriteByte( msg, 0 );
 
-	// delta encode the entities
-	SNAP_EmitPacketEntities( gi, oldframe, frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0 );
+	if( !cached )
+	{
+		bodystart = msg->cursize;
+
+		// send over the areabits
+		MSG_WriteByte( msg, frame->areabytes );
+		MSG_WriteData( msg, frame->areabits, frame->areabytes );
+
+		SNAP_WriteDeltaGameStateToClient( oldframe, frame, msg );
+
+		// delta encode the playerstate
+		for( i = 0; i < frame->numplayers; i++ )
+		{
+			if( oldframe && oldframe->numplayers > i )
+				SNAP_WritePlayerstateToClient( &oldframe->ps[i], &frame->ps[i], msg, client->compactSnaps );
+			else
+				SNAP_WritePlayerstateToClient( NULL, &frame->ps[i], msg, client->compactSnaps );
+		}
+		MSG_WriteByte( msg, 0 );
+
+		// delta encode the entities
+		if( deltacache && ( !deltacache->tag || deltacache->frameNum != frameNum || deltacache->gameTime != gameTime ) )
+		{
+			SNAP_ClearDeltaCache( deltacache );
+			deltacache->frameNum = frameNum;
+			deltacache->gameTime = gameTime;
+		}
+
+		SNAP_EmitPacketEntities( gi, oldframe, frame, msg, baselines, client_entities ? client_entities->entities : NULL, client_entities ? client_entities->num_entities : 0,
+			deltacache, oldframe ? (unsigned)client->lastframe : 0 );
+
+		if( bodycache && frame->snapId && ( !oldframe || oldframe->snapId ) )
+			SNAP_StoreCachedFrameBody( bodycache, frame, oldframe, client->compactSnaps, msg, bodystart );
+	}
 
 	// write length into reserved space
 	length = msg->cursize - pos - 2;
@@ -749,6 +936,113 @@ void SNAP_WriteFrameSnapToClient( ginfo_t *gi, client_t *client, msg_t *msg, uns
 	client->lastSentFrameNum = frameNum;
 }
 
+/*
+* SNAP_LastSentFrameDeltaBase
+*
+* Returns the delta base the last frame sent to the client was encoded from, if any
+*/
+static client_snapshot_t *SNAP_LastSentFrameDeltaBase( client_t *client )
+{
+	unsigned int frameNum = client->lastSentFrameNum;
+	client_snapshot_t *frame, *oldframe;
+
+	if( client->lastframe <= 0 || (unsigned)client->lastframe >= frameNum || frameNum >= (unsigned)client->lastframe + UPDATE_MASK )
+		return NULL;
+
+	frame = &client->snapShots[frameNum & UPDATE_MASK];
+	oldframe = &client->snapShots[client->lastframe & UPDATE_MASK];
+	if( oldframe->multipov != frame->multipov )
+		return NULL;
+	return oldframe;
+}
+
+/*
+* SNAP_BenchmarkFrameDeltas
+*
+* Encodes the player state and entity deltas of the last frame sent to the client
+* against its delta base <iterations> times, returns the number of deltas encoded
+*/
+unsigned int SNAP_BenchmarkFrameDeltas( ginfo_t *gi, client_t *client, entity_state_t *baselines, 
+									   client_entities_t *client_entities, int iterations )
+{
+	int i, iter;
+	unsigned int frameNum;
+	client_snapshot_t *frame, *oldframe;
+	msg_t msg;
+	static uint8_t msgbuf[MAX_MSGLEN];
+
+	frameNum = client->lastSentFrameNum;
+	if( !frameNum || !client_entities )
+		return 0;
+
+	frame = &client->snapShots[frameNum & UPDATE_MASK];
+	oldframe = SNAP_LastSentFrameDeltaBase( client );
+
+	for( iter = 0; iter < iterations; iter++ )
+	{
+		MSG_Init( &msg, msgbuf, sizeof( msgbuf ) );
+
+		for( i = 0; i < frame->numplayers; i++ )
+		{
+			if( oldframe && oldframe->numplayers > i )
+				SNAP_WritePlayerstateToClient( &oldframe->ps[i], &frame->ps[i], &msg, client->compactSnaps );
+			else
+				SNAP_WritePlayerstateToClient( NULL, &frame->ps[i], &msg, client->compactSnaps );
+		}
+
+		SNAP_EmitPacketEntities( gi, oldframe, frame, &msg, baselines, client_entities->entities, client_entities->num_entities, 
+			NULL, 0 );
+	}
+
+	return ( frame->numplayers + frame->num_entities ) * iterations;
+}
+
+/*
+* SNAP_MeasurePlayerstateDelta
+*
+* Adds the size of a player state delta as encoded in the standard and in the compact snapshot mode
+*/
+void SNAP_MeasurePlayerstateDelta( player_state_t *ops, player_state_t *ps, size_t *standardBytes, size_t *compactBytes )
+{
+	msg_t msg;
+	uint8_t msgbuf[1024];
+
+	MSG_Init( &msg, msgbuf, sizeof( msgbuf ) );
+	SNAP_WritePlayerstateToClient( ops, ps, &msg, false );
+	*standardBytes += msg.cursize;
+
+	MSG_Init( &msg, msgbuf, sizeof( msgbuf ) );
+	SNAP_WritePlayerstateToClient( ops, ps, &msg, true );
+	*compactBytes += msg.cursize;
+}
+
+/*
+* SNAP_MeasurePlayerstateDeltas
+*
+* Adds the size of the player states of the last frame sent to the client,
+* as encoded in the standard and in the compact snapshot mode
+*/
+void SNAP_MeasurePlayerstateDeltas( client_t *client, size_t *standardBytes, size_t *compactBytes )
+{
+	int i;
+	unsigned int frameNum;
+	client_snapshot_t *frame, *oldframe;
+	player_state_t *ops;
+
+	frameNum = client->lastSentFrameNum;
+	if( !frameNum )
+		return;
+
+	frame = &client->snapShots[frameNum & UPDATE_MASK];
+	oldframe = SNAP_LastSentFrameDeltaBase( client );
+
+	for( i = 0; i < frame->numplayers; i++ )
+	{
+		ops = oldframe && oldframe->numplayers > i ? &oldframe->ps[i] : NULL;
+		SNAP_MeasurePlayerstateDelta( ops, &frame->ps[i], standardBytes, compactBytes );
+	}
+}
+
 /*
 =============================================================================
 
@@ -4,6 +4,10 @@
  * Author     : Bart Meuris (KoFFiE)
  * E-Mail     : bart.meuris@gmail.com
  *
+ * Transfers run on a dedicated thread, which polls the sockets of the
+ * curl multi handle. Callbacks are queued and called from wswcurl_perform
+ * on the main thread.
+ *
  * Todo:
  *  - Add wait for download function.
  *  - Add file resuming for downloading maps etc.
@@ -42,6 +46,9 @@
 // the maximum number of curl_multi handles to be processed simultaneously
 #define WMAXMULTIHANDLES	4
 
+// how long the curl thread waits for socket activity or new requests, in milliseconds
+#define WTHREADWAIT			50
+
 #define WSTATUS_NONE		0	// not started
 #define WSTATUS_STARTED		1	// started
 #define WSTATUS_FINISHED	2	// finished
@@ -75,6 +82,10 @@ struct wswcurl_req_s {
 
 	char headers_done;
 	char paused;
+	char inmulti;	// added to the multi handle, owned by the curl thread until removed
+	char deleted;	// deleted while owned by the curl thread, which frees it
+	char aborted;	// the read callback refused data
+	unsigned drainframe;
 	time_t last_action;
 	time_t timeout;
 	size_t ignore_bytes;
@@ -99,28 +110,56 @@ struct wswcurl_req_s {
 	struct curl_httppost *post;
 	struct curl_httppost *post_last;
 
+	// Response info, cached by the curl thread so that the handle isn't touched by others
+	char *content_type;
+	char *ip;
+	char *effective_url;
+
 	// Linked list stuff
 	struct wswcurl_req_s *next;
 	struct wswcurl_req_s *prev;
 };
 
+// Callbacks the curl thread hands over to the main thread
+#define WEVENT_HEADER		0
+#define WEVENT_DONE			1
+
+typedef struct wswcurl_event_s {
+
+	int type;
+	int status;
+	wswcurl_req *req;
+	struct wswcurl_event_s *next;
+	char data[1];
+} wswcurl_event_t;
+
 ///////////////////////
 // Function defines
-static int wswcurl_checkmsg();
+static void wswcurl_checkmsg( void );
 static size_t wswcurl_write(void *ptr, size_t size, size_t nmemb, void *stream);
 static size_t wswcurl_readheader(void *ptr, size_t size, size_t nmemb, void *stream);
 static void wswcurl_pause(wswcurl_req *req);
 static void wswcurl_unpause(wswcurl_req *req);
 static time_t wswcurl_now( void );
+static void wswcurl_wakethread( void );
+static void wswcurl_freereq( wswcurl_req *req );
 
 ///////////////////////
 // Local variables
 static wswcurl_req *http_requests = NULL; // Linked list of active requests
 static wswcurl_req *http_requests_hnode; // The item node in the list
 static qmutex_t *http_requests_mutex = NULL;
-static CURLM *curlmulti = NULL;		// Curl MULTI handle
+static CURLM *curlmulti = NULL;		// Curl MULTI handle, only touched by the curl thread
 static int curlmulti_num_handles = 0;
 
+static wswcurl_event_t *http_events_head = NULL; // FIFO of pending callbacks
+static wswcurl_event_t *http_events_tail = NULL;
+
+static qthread_t *curlthread = NULL;
+static qcondvar_t *curlthread_cond = NULL;
+static volatile int curlthread_quit = 0;
+static int curlthread_wake = 0;
+
 static struct mempool_s *wswcurl_mempool;
 static CURL *curldummy = NULL;
 static qmutex_t *curldummy_mutex = NULL;
@@ -153,6 +192,7 @@ static CURLMcode (*qcurl_multi_cleanup)(CURLM *);
 static CURLMcode (*qcurl_multi_perform)(CURLM *, int *);
 static CURLMcode (*qcurl_multi_add_handle)(CURLM *, CURL *);
 static CURLMcode (*qcurl_multi_remove_handle)(CURLM *, CURL *);
+static CURLMcode (*qcurl_multi_wait)(CURLM *, struct curl_waitfd *, unsigned int, int, int *);
 static struct curl_slist *(*qcurl_slist_append)(struct curl_slist *, const char *);
 static void (*qcurl_slist_free_all)(struct curl_slist *);
 static void (*qcurl_formfree)(struct curl_httppost *);
@@ -177,6 +217,7 @@ static dllfunc_t libcurlfuncs[] =
 	{ "curl_multi_perform", ( void ** )&qcurl_multi_perform },
 	{ "curl_multi_add_handle", ( void ** )&qcurl_multi_add_handle },
 	{ "curl_multi_remove_handle", ( void ** )&qcurl_multi_remove_handle },
+	{ "curl_multi_wait", ( void ** )&qcurl_multi_wait },
 	{ "curl_slist_append", ( void ** )&qcurl_slist_append },
 	{ "curl_slist_free_all", ( void ** )&qcurl_slist_free_all },
 	{ "curl_formfree", ( void ** )&qcurl_formfree },
@@ -204,6 +245,7 @@ static dllfunc_t libcurlfuncs[] =
 #define qcurl_multi_perform curl_multi_perform
 #define qcurl_multi_add_handle curl_multi_add_handle
 #define qcurl_multi_remove_handle curl_multi_remove_handle
+#define qcurl_multi_wait curl_multi_wait
 #define qcurl_slist_append curl_slist_append
 #define qcurl_slist_free_all curl_slist_free_all
 #define qcurl_formfree curl_formfree
@@ -374,7 +416,7 @@ size_t wswcurl_urldecode( const char *src, char *dst, size_t size )
 
 	QMutex_Lock( curldummy_mutex );
 	curl_unesc = qcurl_easy_unescape( curldummy, src, 0, &unesc_len );
-	QMutex_Lock( curldummy_mutex );
+	QMutex_Unlock( curldummy_mutex );
 
 	Q_strncpyz( dst, curl_unesc, size );
 	qcurl_free( curl_unesc );
@@ -407,18 +449,25 @@ void wswcurl_start(wswcurl_req *req)
 		req->post_last = NULL;
 	}
 
+	// the curl thread picks it up from here
+	QMutex_Lock( http_requests_mutex );
 	req->status = WSTATUS_QUEUED; // queued
+	wswcurl_wakethread();
+	QMutex_Unlock( http_requests_mutex );
 }
 
 size_t wswcurl_getsize( wswcurl_req *req, size_t *rxreceived )
 {
+	size_t expsize;
+
+	QMutex_Lock( http_requests_mutex );
 	if( rxreceived ) {
 		*rxreceived = req->rxreceived;
 	}
-	if( req->status < 0 ) {
-		return 0;
-	}
-	return req->rx_expsize;
+	expsize = req->status < 0 ? 0 : req->rx_expsize;
+	QMutex_Unlock( http_requests_mutex );
+
+	return expsize;
 }
 
 void wswcurl_stream_callbacks(wswcurl_req *req, wswcurl_read_cb read_cb, wswcurl_done_cb done_cb, 
@@ -438,12 +487,14 @@ size_t wswcurl_read(wswcurl_req *req, void *buffer, size_t size)
 	size_t written = 0;
 	chained_buffer_t *cb;
 
-	if( (req->rxreceived-req->rxreturned) < (size+WMINBUFFERING) && req->paused )
-		wswcurl_unpause(req);
+	// the curl thread unpauses the request once we've read enough of the buffered data
+	QMutex_Lock( http_requests_mutex );
 
 	// hmm, signal an error?
-	if( req->status < 0 )
+	if( req->status < 0 ) {
+		QMutex_Unlock( http_requests_mutex );
 		return 0;
+	}
 
 	// go through the buffers in chain, dropping them if not needed
 	// start from the beginning (chronological order)
@@ -488,6 +539,8 @@ size_t wswcurl_read(wswcurl_req *req, void *buffer, size_t size)
 
 	req->rxreturned += written;
 
+	QMutex_Unlock( http_requests_mutex );
+
 	return written;
 }
 
@@ -503,6 +556,310 @@ static void wswcurl_crypto_lockcallback( int mode, int type, const char *file, i
 }
 #endif
 
+/*
+* wswcurl_postevent
+* 
+* Queues a callback for the main thread. Called by the curl thread with the requests mutex held.
+*/
+static void wswcurl_postevent( wswcurl_req *req, int type, int status, const char *data )
+{
+	size_t datalen = data ? strlen( data ) : 0;
+	wswcurl_event_t *ev;
+
+	ev = ( wswcurl_event_t * )WMALLOC( sizeof( *ev ) + datalen );
+	ev->type = type;
+	ev->status = status;
+	ev->req = req;
+	ev->next = NULL;
+	memcpy( ev->data, data ? data : "", datalen + 1 );
+
+	if( http_events_tail )
+		http_events_tail->next = ev;
+	else
+		http_events_head = ev;
+	http_events_tail = ev;
+}
+
+/*
+* wswcurl_popevent
+*/
+static wswcurl_event_t *wswcurl_popevent( void )
+{
+	wswcurl_event_t *ev;
+
+	QMutex_Lock( http_requests_mutex );
+	ev = http_events_head;
+	if( ev ) {
+		http_events_head = ev->next;
+		if( !http_events_head )
+			http_events_tail = NULL;
+	}
+	QMutex_Unlock( http_requests_mutex );
+
+	return ev;
+}
+
+/*
+* wswcurl_purgeevents
+* 
+* Drops pending callbacks of a request that's being deleted. Requests mutex must be held.
+*/
+static void wswcurl_purgeevents( wswcurl_req *req )
+{
+	wswcurl_event_t *ev, *prev, *next;
+
+	prev = NULL;
+	for( ev = http_events_head; ev; ev = next ) {
+		next = ev->next;
+		if( ev->req != req ) {
+			prev = ev;
+			continue;
+		}
+
+		if( prev )
+			prev->next = next;
+		else
+			http_events_head = next;
+		if( http_events_tail == ev )
+			http_events_tail = prev;
+		WFREE( ev );
+	}
+}
+
+/*
+* wswcurl_setinfostring
+*/
+static void wswcurl_setinfostring( char **pstr, const char *value )
+{
+	// set only once, so the main thread can keep using the pointer it got
+	if( *pstr || !value ) {
+		return;
+	}
+	*pstr = ( char * )WMALLOC( strlen( value ) + 1 );
+	memcpy( *pstr, value, strlen( value ) + 1 );
+}
+
+/*
+* wswcurl_cacheinfo
+*/
+static void wswcurl_cacheinfo( wswcurl_req *req, bool done )
+{
+	char *str;
+
+	str = NULL;
+	qcurl_easy_getinfo( req->curl, CURLINFO_CONTENT_TYPE, &str );
+	wswcurl_setinfostring( &req->content_type, str );
+
+	str = NULL;
+	qcurl_easy_getinfo( req->curl, CURLINFO_PRIMARY_IP, &str );
+	wswcurl_setinfostring( &req->ip, str );
+
+	if( done ) {
+		str = NULL;
+		qcurl_easy_getinfo( req->curl, CURLINFO_EFFECTIVE_URL, &str );
+		wswcurl_setinfostring( &req->effective_url, str );
+	}
+}
+
+/*
+* wswcurl_finish
+* 
+* Removes the request from the multi handle and queues its completion callback.
+* Called by the curl thread with the requests mutex held.
+*/
+static void wswcurl_finish( wswcurl_req *req, int status )
+{
+	qcurl_multi_remove_handle( curlmulti, req->curl );
+	req->inmulti = 0;
+	curlmulti_num_handles--;
+
+	if( status >= 0 ) {
+		// Done!
+		req->status = WSTATUS_FINISHED;
+		qcurl_easy_getinfo( req->curl, CURLINFO_RESPONSE_CODE, &(req->respcode) );
+		status = req->respcode;
+	}
+	else {
+		// failed, store and pass to callback negative status value
+		req->status = status;
+		req->respcode = -1;
+	}
+
+	wswcurl_cacheinfo( req, true );
+
+	if( !req->deleted ) {
+		wswcurl_postevent( req, WEVENT_DONE, status, NULL );
+	}
+}
+
+/*
+* wswcurl_wakethread
+* 
+* Requests mutex must be held.
+*/
+static void wswcurl_wakethread( void )
+{
+	if( !curlthread_cond ) {
+		return;
+	}
+	curlthread_wake = 1;
+	QCondVar_Wake( curlthread_cond );
+}
+
+/*
+* wswcurl_thread_frame
+*/
+static void wswcurl_thread_frame( void )
+{
+	int running = 0;
+	size_t buffered;
+	time_t now = wswcurl_now();
+	wswcurl_req *r, *prev;
+
+	QMutex_Lock( http_requests_mutex );
+
+	// process requests in FIFO manner
+	for( r = http_requests_hnode; r; r = prev )
+	{
+		prev = r->prev;
+
+		if( r->deleted ) {
+			wswcurl_freereq( r );
+			continue;
+		}
+
+		if( r->status == WSTATUS_QUEUED && curlmulti_num_handles < WMAXMULTIHANDLES ) {
+			if( qcurl_multi_add_handle( curlmulti, r->curl ) ) {
+				CURLDBG(("OOPS: CURL MULTI ADD HANDLE FAIL!!!"));
+			}
+			r->status = WSTATUS_STARTED;
+			r->inmulti = 1;
+			r->last_action = now;
+			curlmulti_num_handles++;
+		}
+
+		if( r->status != WSTATUS_STARTED ) {
+			continue;
+		}
+
+		// pause requests the reader can't keep up with
+		buffered = r->rxreceived - r->rxreturned;
+		if( buffered >= WMAXBUFFERING ) {
+			wswcurl_pause( r );
+		} else if( buffered < WMINBUFFERING ) {
+			wswcurl_unpause( r );
+		}
+
+		// handle aborts and timeouts
+		if( r->aborted ) {
+			wswcurl_finish( r, -CURLE_WRITE_ERROR );
+		} else if( r->paused ) {
+			r->last_action = now;
+		} else if( r->timeout && ( r->last_action + r->timeout <= now ) ) {
+			wswcurl_finish( r, -CURLE_OPERATION_TIMEDOUT );
+		}
+	}
+
+	QMutex_Unlock( http_requests_mutex );
+
+	// name resolution, TLS handshakes and transfers all happen here, off the main thread
+	while( qcurl_multi_perform( curlmulti, &running ) == CURLM_CALL_MULTI_PERFORM ) {
+		CURLDBG(("   CURL MULTI LOOP\n"));
+	}
+
+	wswcurl_checkmsg();
+}
+
+/*
+* wswcurl_thread
+*/
+static void *wswcurl_thread( void *param )
+{
+	int numfds;
+
+	( void )param;
+
+	while( !curlthread_quit )
+	{
+		wswcurl_thread_frame();
+
+		if( curlmulti_num_handles > 0 ) {
+			// poll the sockets of active transfers
+			numfds = 0;
+			if( qcurl_multi_wait( curlmulti, NULL, 0, WTHREADWAIT, &numfds ) != CURLM_OK || !numfds ) {
+				// nothing to poll (e.g. a threaded name lookup is in progress)
+				Sys_Sleep( 5 );
+			}
+			continue;
+		}
+
+		// idle, wait for new requests
+		QMutex_Lock( http_requests_mutex );
+		if( !curlthread_wake && !curlthread_quit ) {
+			QCondVar_Wait( curlthread_cond, http_requests_mutex, WTHREADWAIT * 10 );
+		}
+		curlthread_wake = 0;
+		QMutex_Unlock( http_requests_mutex );
+	}
+
+	return NULL;
+}
+
+/*
+* wswcurl_drain
+* 
+* Feeds data buffered by the curl thread to the read callback of a streaming request.
+*/
+static void wswcurl_drain( wswcurl_req *req )
+{
+	size_t limit, numb, consumed;
+	float progress;
+	chained_buffer_t *cb;
+
+	QMutex_Lock( http_requests_mutex );
+	limit = req->rxreceived - req->rxreturned;
+	QMutex_Unlock( http_requests_mutex );
+
+	// only what's already here, so a fast transfer can't starve the caller
+	while( limit > 0 )
+	{
+		QMutex_Lock( http_requests_mutex );
+
+		if( !wswcurl_isvalidhandle( req ) || req->aborted || !req->callback_read || !req->bhead ) {
+			QMutex_Unlock( http_requests_mutex );
+			break;
+		}
+
+		cb = req->bhead;
+		req->bhead = cb->next;
+		if( req->btail == cb )
+			req->btail = NULL;
+
+		numb = cb->rxsize;
+		req->rxreturned += numb;
+		progress = !req->rx_expsize ? 0.0 : (float)(((double)req->rxreturned / (double)req->rx_expsize) * 100.0);
+		clamp( progress, 0, 100 );
+
+		QMutex_Unlock( http_requests_mutex );
+
+		consumed = req->callback_read( req, cb->data, numb, progress, req->customp );
+		WFREE( cb );
+
+		if( consumed != numb ) {
+			// abort, the curl thread reports CURLE_WRITE_ERROR back to us
+			QMutex_Lock( http_requests_mutex );
+			if( wswcurl_isvalidhandle( req ) ) {
+				req->aborted = 1;
+				wswcurl_wakethread();
+			}
+			QMutex_Unlock( http_requests_mutex );
+			break;
+		}
+
+		limit -= numb < limit ? numb : limit;
+	}
+}
+
 void wswcurl_init( void )
 {
 	if( wswcurl_mempool )
@@ -538,15 +895,39 @@ void wswcurl_init( void )
 		qCRYPTO_set_locking_callback( wswcurl_crypto_lockcallback );
 	}
 #endif
+
+	if( curlmulti ) {
+		curlthread_quit = 0;
+		curlthread_wake = 0;
+		curlthread_cond = QCondVar_Create();
+		curlthread = QThread_Create( wswcurl_thread, NULL );
+	}
 }
 
 void wswcurl_cleanup( void )
 {
+	wswcurl_event_t *ev;
+
 	if( !wswcurl_mempool )
 		return;
 
+	if( curlthread ) {
+		QMutex_Lock( http_requests_mutex );
+		curlthread_quit = 1;
+		wswcurl_wakethread();
+		QMutex_Unlock( http_requests_mutex );
+
+		QThread_Join( curlthread );
+		curlthread = NULL;
+	}
+	QCondVar_Destroy( &curlthread_cond );
+
 	while( http_requests ) {
-		wswcurl_delete( http_requests );
+		wswcurl_freereq( http_requests );
+	}
+
+	while( ( ev = wswcurl_popevent() ) != NULL ) {
+		WFREE( ev );
 	}
 
 	if( curldummy ) {
@@ -591,71 +972,55 @@ void wswcurl_cleanup( void )
 int wswcurl_perform()
 {
 	int ret = 0;
-	wswcurl_req *r, *next;
+	static unsigned drainframe = 0;
+	wswcurl_event_t *ev;
+	wswcurl_req *r;
 
 	if (!curlmulti) return 0;
 
-	// process requests in FIFO manner
-
-	QMutex_Lock( http_requests_mutex );
-
-	// check for timed out requests and requests that need to be paused
-	r = http_requests_hnode;
-	while( r )
+	// header and completion callbacks, in the order the curl thread queued them
+	while( ( ev = wswcurl_popevent() ) != NULL )
 	{
-		next = r->prev;
-
-		if (r->status == WSTATUS_QUEUED) {
-			// queued
-			if (curlmulti_num_handles < WMAXMULTIHANDLES) {
-				if (qcurl_multi_add_handle(curlmulti, r->curl)) {
-					CURLDBG(("OOPS: CURL MULTI ADD HANDLE FAIL!!!"));
-				}
-				r->status = WSTATUS_STARTED;
-				r->last_action = wswcurl_now();
-				curlmulti_num_handles++;
-			}
-			else {
-				// stay in queue
+		r = ev->req;
+
+		if( ev->type == WEVENT_HEADER ) {
+			if( r->callback_header ) {
+				r->callback_header( r, ev->data, r->customp );
 			}
 		}
-
-		// handle pauses for synchronous requests
-		if( r->status == WSTATUS_STARTED && !r->callback_read ) {
-			if( r->rxreceived >= r->rxreturned + WMAXBUFFERING ) {
-				wswcurl_pause( r );
+		else {
+			// deliver the remaining data before completion
+			wswcurl_drain( r );
+			if( wswcurl_isvalidhandle( r ) && r->callback_done ) {
+				r->callback_done( r, ev->status, r->customp );
 			}
+			ret++;
 		}
 
-		// handle timeouts
-		if( r->status == WSTATUS_STARTED ) {
-			time_t now = wswcurl_now();
-
-			if( r->paused ) {
-				// paused
-				r->last_action = now;
-			} else if( r->timeout && ( r->last_action + r->timeout <= now ) ) {
-				// timed out
-				r->respcode = -1;
-				r->status = -CURLE_OPERATION_TIMEDOUT;
-				if( r->callback_done ) {
-					r->callback_done( r, r->status, r->customp );
-				}
+		WFREE( ev );
+	}
+
+	// feed received data to streaming requests, visiting each one once
+	drainframe++;
+	do {
+		QMutex_Lock( http_requests_mutex );
+		for( r = http_requests; r; r = r->next ) {
+			if( !r->deleted && r->callback_read && r->bhead && r->drainframe != drainframe ) {
+				r->drainframe = drainframe;
+				break;
 			}
 		}
+		QMutex_Unlock( http_requests_mutex );
 
-		r = next;
-	}
+		if( r ) {
+			wswcurl_drain( r );
+		}
+	} while( r );
 
+	QMutex_Lock( http_requests_mutex );
+	ret += curlmulti_num_handles;
 	QMutex_Unlock( http_requests_mutex );
 
-	//CURLDBG(("CURL BEFORE MULTI_PERFORM\n"));
-	while ( qcurl_multi_perform(curlmulti, &ret) == CURLM_CALL_MULTI_PERFORM) {
-		CURLDBG(("   CURL MULTI LOOP\n"));
-	}
-	ret += wswcurl_checkmsg();
-	//CURLDBG(("CURL after checkmsg\n"));
-
 	return ret;
 }
 
@@ -806,15 +1171,14 @@ void wswcurl_set_resume_from( wswcurl_req *req, long resume )
 	}
 }
 
-void wswcurl_delete(wswcurl_req *req)
+/*
+* wswcurl_freereq
+* 
+* Requests mutex must be held, and the curl thread must not be using the handle.
+*/
+static void wswcurl_freereq( wswcurl_req *req )
 {
-	if ( (!req) || (!wswcurl_isvalidhandle(req)) )
-	{
-		return;
-	}
-
-	// if (req->callback_done && req->active )
-	//	req->callback_done ( req, 0, req->customp );
+	wswcurl_purgeevents( req );
 
 	if (req->txhead)
 	{
@@ -834,6 +1198,16 @@ void wswcurl_delete(wswcurl_req *req)
 		WFREE(req->url);
 	}
 
+	if( req->content_type ) {
+		WFREE( req->content_type );
+	}
+	if( req->ip ) {
+		WFREE( req->ip );
+	}
+	if( req->effective_url ) {
+		WFREE( req->effective_url );
+	}
+
 	if( req->bhead )
 	{
 		chained_buffer_t *cb = req->bhead;
@@ -847,12 +1221,9 @@ void wswcurl_delete(wswcurl_req *req)
 		}
 	}
 
-	// remove from list
-	QMutex_Lock( http_requests_mutex );
-
 	if (req->curl)
 	{
-		if (curlmulti && req->status && req->status != WSTATUS_QUEUED) {
+		if (curlmulti && req->inmulti) {
 			qcurl_multi_remove_handle(curlmulti, req->curl);
 			curlmulti_num_handles--;
 		}
@@ -860,43 +1231,75 @@ void wswcurl_delete(wswcurl_req *req)
 		req->curl = NULL;
 	}
 
+	// remove from list
 	if (http_requests_hnode == req) http_requests_hnode = req->prev;
 	if (http_requests == req) http_requests = req->next;
 	if (req->prev) req->prev->next = req->next;
 	if (req->next) req->next->prev = req->prev;
 
-	QMutex_Unlock( http_requests_mutex );
-
 	WFREE(req);
 }
 
+void wswcurl_delete(wswcurl_req *req)
+{
+	if( !req ) {
+		return;
+	}
+
+	QMutex_Lock( http_requests_mutex );
+
+	if( !wswcurl_isvalidhandle( req ) ) {
+		QMutex_Unlock( http_requests_mutex );
+		return;
+	}
+
+	// if (req->callback_done && req->active )
+	//	req->callback_done ( req, 0, req->customp );
+
+	if( req->inmulti && curlthread ) {
+		// the curl thread may be in the middle of a transfer, let it clean up
+		wswcurl_purgeevents( req );
+		req->deleted = 1;
+		wswcurl_wakethread();
+	}
+	else {
+		wswcurl_freereq( req );
+	}
+
+	QMutex_Unlock( http_requests_mutex );
+}
+
 int wswcurl_isvalidhandle(wswcurl_req *req)
 {
-	wswcurl_req *r = http_requests;
+	int valid = 0;
+	wswcurl_req *r;
+
+	QMutex_Lock( http_requests_mutex );
+
+	r = http_requests;
 	while (r != NULL )
 	{
 		if (r == req)
 		{
-			return 1;
+			valid = !r->deleted;
+			break;
 		}
 		r = r->next;
 	}
 
-	return 0;
+	QMutex_Unlock( http_requests_mutex );
+
+	return valid;
 }
 
 const char *wswcurl_get_content_type( wswcurl_req *req )
 {
-	char *content_type = NULL;
-	qcurl_easy_getinfo( req->curl, CURLINFO_CONTENT_TYPE, &content_type );
-	return content_type;
+	return req->content_type;
 }
 
 const char *wswcurl_getip(wswcurl_req *req)
 {
-	char *ipstr = NULL;
-	qcurl_easy_getinfo( req->curl, CURLINFO_PRIMARY_IP, &ipstr );
-	return ipstr;
+	return req->ip;
 }
 
 const char *wswcurl_errorstr(int status)
@@ -911,9 +1314,7 @@ const char *wswcurl_get_url(const wswcurl_req *req)
 
 const char *wswcurl_get_effective_url(wswcurl_req *req)
 {
-	char *last_url = NULL;
-	qcurl_easy_getinfo( req->curl, CURLINFO_EFFECTIVE_URL, &last_url );
-	return last_url;
+	return req->effective_url ? req->effective_url : req->url;
 }
 
 int wswcurl_get_status(const wswcurl_req *req)
@@ -958,76 +1359,85 @@ static size_t wswcurl_readheader(void *ptr, size_t size, size_t nmemb, void *str
 
 		size = atoi(str);
 		if( size >= 0 ) {
+			QMutex_Lock( http_requests_mutex );
 			req->rx_expsize = size;
+			QMutex_Unlock( http_requests_mutex );
 		}
 	}
 	else if ( (str  = (char*)strstr(buf, "TRANSFER-ENCODING:")) )
 	{
+		QMutex_Lock( http_requests_mutex );
 		req->rx_expsize = 0;
+		QMutex_Unlock( http_requests_mutex );
 	}
 
+	QMutex_Lock( http_requests_mutex );
+
 	qcurl_easy_getinfo( req->curl, CURLINFO_RESPONSE_CODE, &(req->respcode) );
 
-	// call header callback function
-	if( req->callback_header ) {
-		req->callback_header( req, buf, req->customp );
+	// header callback function is called from wswcurl_perform
+	if( req->callback_header && !req->deleted ) {
+		wswcurl_postevent( req, WEVENT_HEADER, 0, buf );
 	}
 
 	req->last_action = wswcurl_now();
+
+	QMutex_Unlock( http_requests_mutex );
+
 	return size * nmemb;
 }
 
 static size_t wswcurl_write(void *ptr, size_t size, size_t nmemb, void *stream)
 {
-	float progress;
 	long numb;
+	chained_buffer_t *cb;
 	wswcurl_req *req = (wswcurl_req*)stream;
 
+	numb = size * nmemb;
+
+	QMutex_Lock( http_requests_mutex );
+
+	// abort the transfer
+	if( req->deleted || req->aborted ) {
+		QMutex_Unlock( http_requests_mutex );
+		return 0;
+	}
+
 	if( !req->headers_done ) {
 		req->headers_done = 1;
+		wswcurl_cacheinfo( req, false );
 	}
 
-	numb = size * nmemb;
 	req->rxreceived += numb;
 	req->last_action = wswcurl_now();
 
-	progress = !req->rx_expsize ? 0.0 : (float)(((double)req->rxreceived / (double)req->rx_expsize) * 100.0);
-	clamp( progress, 0, 100 );
+	// Allocate new buffer, streaming requests are fed from wswcurl_perform
+	cb = ( chained_buffer_t* )WMALLOC( sizeof(*cb) + numb );
+	memset( cb, 0, sizeof(*cb) );
 
-	if( req->callback_read )
-	{
-		return req->callback_read( req, ptr, numb, progress, req->customp );
-	}
-	else
-	{
-		chained_buffer_t *cb;
+	// Stick the buffer to the end of the chain
+	if( req->btail )
+		req->btail->next = cb;
+	req->btail = cb;
+	if( !req->bhead )
+		req->bhead = cb;
 
-		// Allocate new buffer
-		cb = ( chained_buffer_t* )WMALLOC( sizeof(*cb) + numb );
-		memset( cb, 0, sizeof(*cb) );
+	memcpy( cb->data, ptr, numb );
+	cb->data[numb] = '\0';
+	cb->rxsize = numb;
 
-		// Stick the buffer to the end of the chain
-		if( req->btail )
-			req->btail->next = cb;
-		req->btail = cb;
-		if( !req->bhead )
-			req->bhead = cb;
-
-		memcpy( cb->data, ptr, numb );
-		cb->data[numb] = '\0';
-		cb->rxsize = numb;
-	}
+	QMutex_Unlock( http_requests_mutex );
 
 	return numb;
 }
 
-static int wswcurl_checkmsg( void )
+static void wswcurl_checkmsg( void )
 {
 	int cnt = 0;
 	CURLMsg *msg;
 	wswcurl_req *r;
-	int ret = 0;
 	char *info;
+	int status;
 
 	do {
 		msg = qcurl_multi_info_read( curlmulti, &cnt );
@@ -1049,29 +1459,14 @@ static int wswcurl_checkmsg( void )
 			continue;
 		}
 
-		ret++;
-
-		if( msg->data.result == CURLE_OK ) {
-			// Done!
-			r->status = WSTATUS_FINISHED;
-			qcurl_easy_getinfo( r->curl, CURLINFO_RESPONSE_CODE, &(r->respcode) );
-
-			if( r->callback_done ) {
-				r->callback_done( r, r->respcode, r->customp );
-			}
-		}
-		else {
-			// failed, store and pass to callback negative status value
-			r->status = -abs( msg->data.result ); 
-			r->respcode = -1;
+		status = msg->data.result == CURLE_OK ? 0 : -abs( msg->data.result );
 
-			if( r->callback_done ) {
-				r->callback_done( r, r->status, r->customp );
-			}
+		QMutex_Lock( http_requests_mutex );
+		if( r->inmulti ) {
+			wswcurl_finish( r, status );
 		}
+		QMutex_Unlock( http_requests_mutex );
 	} while( cnt && msg );
-
-	return ret;
 }
 
 static void wswcurl_pause( wswcurl_req *req )
@@ -1114,8 +1509,14 @@ static int wswcurl_remaining( wswcurl_req *req )
 
 int wswcurl_eof( wswcurl_req *req )
 {
-	return (req->status == WSTATUS_FINISHED || req->status < 0) // request completed
+	int eof;
+
+	QMutex_Lock( http_requests_mutex );
+	eof = (req->status == WSTATUS_FINISHED || req->status < 0) // request completed
 		&& !wswcurl_remaining( req );
+	QMutex_Unlock( http_requests_mutex );
+
+	return eof;
 }
 
 static time_t wswcurl_now( void )
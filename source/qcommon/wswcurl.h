@@ -45,8 +45,9 @@ void wswcurl_stream_callbacks (wswcurl_req *req, wswcurl_read_cb read_cb, wswcur
  */
 size_t wswcurl_read (wswcurl_req *req, void *buffer, size_t size);
 /**
- * Lets curl handle all connection, treats all messages and returns how many connections are still active.
- * NOT thread-safe.
+ * Calls the header, read and done callbacks queued by the curl thread, which handles all connections.
+ * Returns how many requests completed plus how many connections are still active.
+ * Must be called from the main thread.
  */
 int wswcurl_perform( void );
 /**
@@ -45,6 +45,8 @@ struct texture_buf_s *R_KTXResolveBuffer( struct ktx_context_s *cntx, uint32_t m
 			case R_BASE_FORMAT_FIXED_16:
 			case R_BASE_FORMAT_FIXED_32:
 			case R_BASE_FORMAT_PACKED_16:
+				if( cntx->readOnly )
+					T_PromoteTextureBuf( &img->texture );
 			  T_SwapEndianness( &img->texture );
 				break;
 			default:
@@ -54,11 +56,44 @@ struct texture_buf_s *R_KTXResolveBuffer( struct ktx_context_s *cntx, uint32_t m
 	}
 	return &img->texture;
 }
+// reads a uint32 from the file, which may sit at any alignment in a mapped pak
+static inline bool R_KTXReadUInt32( const struct ktx_context_s *cntx, size_t size, size_t offset, uint32_t *value )
+{
+	if( offset > size || size - offset < sizeof( uint32_t ) )
+		return false;
+	memcpy( value, cntx->buffer + offset, sizeof( uint32_t ) );
+	if( cntx->swapEndianess )
+		*value = LongSwap( *value );
+	return true;
+}
+
+static inline void R_KTXSetTruncated( const struct ktx_context_s *cntx, uint_fast8_t mipLevel, size_t size, size_t expected, struct ktx_context_err_s *err )
+{
+	if( cntx->numberOfMipmapLevels == 0 ) {
+		err->type = KTX_ERR_TRUNCATED;
+		err->errTruncated.size = size;
+		err->errTruncated.expected = expected;
+		return;
+	}
+	err->type = KTX_WARN_MIPLEVEL_TRUNCATED;
+	err->mipTruncated.expectedMipLevels = mipLevel;
+	err->mipTruncated.mipLevels = cntx->numberOfMipmapLevels;
+	err->mipTruncated.size = size;
+	err->mipTruncated.expected = expected;
+}
+
 bool R_InitKTXContext(struct ktx_context_s *cntx, uint8_t *memory, size_t size, struct ktx_context_err_s* err) {
 	assert( sizeof( struct __raw_ktx_header_s ) == 64 );
+	if( size < sizeof( struct __raw_ktx_header_s ) ) {
+		err->type = KTX_ERR_TRUNCATED;
+		err->errTruncated.size = size;
+		err->errTruncated.expected = sizeof( struct __raw_ktx_header_s );
+		return false;
+	}
 	struct __raw_ktx_header_s *rawHeader = (struct __raw_ktx_header_s *)memory;
 	if( memcmp( rawHeader->identifier, "\xABKTX 11\xBB\r\n\x1A\n", 12 ) ) {
-		return KTX_ERR_INVALID_IDENTIFIER;
+		err->type = KTX_ERR_INVALID_IDENTIFIER;
+		return false;
 	}
   assert(cntx->pixelDepth == 0);
 
@@ -78,12 +113,30 @@ bool R_InitKTXContext(struct ktx_context_s *cntx, uint8_t *memory, size_t size,
 	cntx->bytesOfKeyValueData = cntx->swapEndianess ? LongSwap( rawHeader->bytesOfKeyValueData ) : rawHeader->bytesOfKeyValueData;
 
   if((cntx->pixelWidth <= 0 ) || ( cntx->pixelHeight <= 0)) {
-  	return KTX_ERR_ZER_TEXTURE_SIZE;
+		err->type = KTX_ERR_ZER_TEXTURE_SIZE;
+		return false;
   }
 
+	// everything below is sized from these, reject what no valid texture has
+	if( cntx->pixelWidth > KTX_MAX_DIMENSION || cntx->pixelHeight > KTX_MAX_DIMENSION || cntx->pixelDepth < 0 || 
+		cntx->numberOfArrayElements < 0 || cntx->numberOfArrayElements > KTX_MAX_ARRAY_ELEMENTS || 
+		cntx->numberOfFaces < 0 || cntx->numberOfFaces > 6 ||
+		cntx->numberOfMipmapLevels < 0 || cntx->numberOfMipmapLevels > KTX_MAX_MIPLEVELS ) {
+		err->type = KTX_ERR_INVALID_HEADER;
+		return false;
+	}
+
+	if( cntx->bytesOfKeyValueData < 0 || (size_t)cntx->bytesOfKeyValueData > size - sizeof( struct __raw_ktx_header_s ) ) {
+		err->type = KTX_ERR_TRUNCATED;
+		err->errTruncated.size = size;
+		err->errTruncated.expected = sizeof( struct __raw_ktx_header_s ) + (size_t)(unsigned)cntx->bytesOfKeyValueData;
+		return false;
+	}
+
 	const size_t numberOfArrayElements = max( 1, cntx->numberOfArrayElements );
 	const size_t numberOfFaces = max( 1, cntx->numberOfFaces );
 	const size_t numberOfMips = max( 1, cntx->numberOfMipmapLevels );
+	const int headerMipmapLevels = cntx->numberOfMipmapLevels;
 
 	//const size_t keyValueOffset = sizeof(struct __raw_ktx_header_s);
 	const size_t dataOffset = sizeof( struct __raw_ktx_header_s ) + cntx->bytesOfKeyValueData;
@@ -160,44 +213,43 @@ bool R_InitKTXContext(struct ktx_context_s *cntx, uint8_t *memory, size_t size,
 	uint32_t height = cntx->pixelHeight;
 	size_t offset = dataOffset;
 	for( uint_fast16_t mipLevel = 0; mipLevel < numberOfMips; mipLevel++ ) {
-		size_t faceLodSize = *( (uint32_t *)&cntx->buffer[offset] );
-		faceLodSize = ( cntx->swapEndianess == true ) ? LongSwap( faceLodSize ) : faceLodSize;
-		faceLodSize = ALIGN( faceLodSize, 4 ); // pad buffer to multiple of 4
-		offset += sizeof( uint32_t );
-		if( faceLodSize + offset > size ) {
-			err->mipTruncated.expectedMipLevels = mipLevel;
-			cntx->numberOfMipmapLevels = ( mipLevel > 0 ) ? mipLevel - 1 : 0;
-			err->mipTruncated.mipLevels = cntx->numberOfMipmapLevels;
-			err->type = cntx->numberOfMipmapLevels == 0 ? KTX_ERR_TRUNCATED: KTX_WARN_MIPLEVEL_TRUNCATED;
-			err->mipTruncated.size = size;
-			err->mipTruncated.expected = faceLodSize + offset;
+		// mips parsed so far, in case this one turns out to be truncated
+		cntx->numberOfMipmapLevels = mipLevel;
+
+		uint32_t imageSize;
+		if( !R_KTXReadUInt32( cntx, size, offset, &imageSize ) ) {
+			R_KTXSetTruncated( cntx, mipLevel, size, offset + sizeof( uint32_t ), err );
 			goto error;
 		}
+		offset += sizeof( uint32_t );
 
 		for( size_t faceIdx = 0; faceIdx < numberOfFaces; faceIdx++ ) {
+			// pad buffer to multiple of 4, the padding of the last face may be missing
+			if( imageSize > size - offset ) {
+				R_KTXSetTruncated( cntx, mipLevel, size, offset + imageSize, err );
+				goto error;
+			}
+			const size_t faceLodSize = min( ALIGN( (size_t)imageSize, 4 ), size - offset );
+
 			size_t arrByteOffset = 0;
 			for( size_t arrayIdx = 0; arrayIdx < numberOfArrayElements; arrayIdx++ ) {
 				struct ktx_image_s *img = R_KTXGetImage( cntx, mipLevel, faceIdx, arrayIdx );
 				struct texture_buf_desc_s desc = { .width = width, .height = height, .alignment = 4, .def = cntx->desc };
 				const int res = T_AliasTextureBuf( &img->texture, &desc, ( cntx->buffer + offset + arrByteOffset ), 0 );
 				assert(res == TEXTURE_BUF_SUCCESS);
+				if( img->texture.size > imageSize - arrByteOffset ) {
+					R_KTXSetTruncated( cntx, mipLevel, imageSize, arrByteOffset + img->texture.size, err );
+					goto error;
+				}
 				arrByteOffset += img->texture.size;
 			}
-			if( faceLodSize + offset > size ) {
-				err->mipTruncated.expectedMipLevels = mipLevel;
-				cntx->numberOfMipmapLevels = ( mipLevel > 0 ) ? mipLevel - 1 : 0;
-				err->mipTruncated.mipLevels = cntx->numberOfMipmapLevels;
-				err->type = cntx->numberOfMipmapLevels == 0 ? KTX_ERR_TRUNCATED : KTX_WARN_MIPLEVEL_TRUNCATED;
-				err->mipTruncated.size = size;
-				err->mipTruncated.expected = faceLodSize + offset;
-				goto error;
-			}
 			offset += faceLodSize;
 		}
 
 		width = max( 1, width >> 1 );
 		height = max( 1, height >> 1 );
 	}
+	cntx->numberOfMipmapLevels = headerMipmapLevels;
   return true;
 error:
   return false;
@@ -14,9 +14,14 @@ enum ktx_context_result_type_e {
   KTX_ERR_UNHANDLED_TEXTURE_TYPE,
   KTX_ERR_TRUNCATED,
   KTX_WARN_MIPLEVEL_TRUNCATED, 
-  KTX_ERR_ZER_TEXTURE_SIZE 
+  KTX_ERR_ZER_TEXTURE_SIZE,
+  KTX_ERR_INVALID_HEADER
 };
 
+#define KTX_MAX_DIMENSION		16384
+#define KTX_MAX_ARRAY_ELEMENTS	2048
+#define KTX_MAX_MIPLEVELS		15
+
 struct ktx_context_err_s {
 	enum ktx_context_result_type_e type;
 	union {
@@ -53,6 +58,7 @@ struct ktx_context_s {
 	int bytesOfKeyValueData;
 
 	uint8_t *buffer;
+	bool readOnly; // buffer is a read-only view, textures are copied before they are modified in place
 	const struct base_format_def_s *desc;
 	struct ktx_image_s *textures;
 };
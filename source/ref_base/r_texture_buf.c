@@ -263,6 +263,11 @@ void T_FreePogoBuffer( struct texture_buf_pogo_s *pogo )
 }
 
 void T_BlockDecodeETC1( const struct texture_buf_s *src, struct texture_buf_s *dest )
+{
+	T_BlockDecodeETC1Rows( src, dest, 0, T_LogicalH( src ) );
+}
+
+void T_BlockDecodeETC1Rows( const struct texture_buf_s *src, struct texture_buf_s *dest, uint32_t firstBlockRow, uint32_t numBlockRows )
 {
 	assert( dest );
 	assert( src );
@@ -271,46 +276,37 @@ void T_BlockDecodeETC1( const struct texture_buf_s *src, struct texture_buf_s *d
 
 	assert( T_PixelW( src ) == T_PixelW( dest ) );
 	assert( T_PixelH( src ) == T_PixelH( dest ) );
-
-	const uint32_t logicalWidth = T_LogicalW( src );
-	const uint32_t logicalHeight = T_LogicalH( src );
+	assert( firstBlockRow + numBlockRows <= T_LogicalH( src ) );
 
 	const uint32_t width = T_PixelW(src);
 	const uint32_t height = T_PixelH(src);
 
-	struct uint_8_4 decodeColors[ETC1_BLOCK_WIDTH * ETC1_BLOCK_HEIGHT];
-	for( size_t row = 0; row < logicalHeight; row++ ) {
-		for( size_t column = 0; column < logicalWidth; column++ ) {
-			uint8_t *block = &src->buffer[(src->rowPitch * row) + ( column * RT_BlockSize(src->def))];
-			R_ETC1DecodeBlock_RGBA8( block, decodeColors );
-			for( uint16_t subRow = 0; subRow < ETC1_BLOCK_HEIGHT; subRow++ ) {
-				for( uint16_t subCol = 0; subCol < ETC1_BLOCK_WIDTH; subCol++ ) {
-					const uint32_t destX = ( ( column * ETC1_BLOCK_WIDTH ) + subCol );
-					const uint32_t destY = ( ( row * ETC1_BLOCK_HEIGHT ) + subRow );
-					if(destX >= width || destY >= height)
-						continue;
-					const struct uint_8_4* color = &decodeColors[( subRow * ETC1_BLOCK_HEIGHT ) + subCol];
-					uint8_t *const destBlock = &dest->buffer[( dest->rowPitch * destY ) + ( destX * RT_BlockSize( dest->def ) )];
-					for( uint8_t c = 0; c < dest->def->fixed_8.numChannels; c++ ) {
-						switch( dest->def->fixed_8.channels[c] ) {
-							case R_LOGICAL_C_RED:
-								( *(destBlock + c) ) = color->r;
-								break;
-							case R_LOGICAL_C_GREEN:
-								( *(destBlock + c)) = color->g;
-								break;
-							case R_LOGICAL_C_BLUE:
-								( *(destBlock + c) ) = color->b;
-								break;
-							default:
-								( *(destBlock + c)) = 0;
-								break;
-						}
-					}
-				}
-			}
+	// anything that isn't red, green or blue is written as 0
+	uint8_t channels[4];
+	const uint8_t numChannels = dest->def->fixed_8.numChannels;
+	assert( numChannels <= 4 );
+	for( uint8_t c = 0; c < numChannels; c++ ) {
+		switch( dest->def->fixed_8.channels[c] ) {
+			case R_LOGICAL_C_RED:
+				channels[c] = 0;
+				break;
+			case R_LOGICAL_C_GREEN:
+				channels[c] = 1;
+				break;
+			case R_LOGICAL_C_BLUE:
+				channels[c] = 2;
+				break;
+			default:
+				channels[c] = 3;
+				break;
 		}
 	}
+
+	for( size_t row = firstBlockRow; row < firstBlockRow + numBlockRows; row++ ) {
+		const uint32_t destY = row * ETC1_BLOCK_HEIGHT;
+		R_ETC1DecodeBlockRow( &src->buffer[src->rowPitch * row], width, min( height - destY, ETC1_BLOCK_HEIGHT ),
+			&dest->buffer[dest->rowPitch * destY], dest->rowPitch, numChannels, channels );
+	}
 }
 
 void T_SwizzleInplace(struct texture_buf_s* tex, enum texture_logical_channel_e* channels) {
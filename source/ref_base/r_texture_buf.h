@@ -71,6 +71,11 @@ void T_IncrPogoTex(struct texture_buf_pogo_s* pogo);
 void T_FreePogoBuffer(struct texture_buf_pogo_s* pogo);
 
 void T_BlockDecodeETC1( const struct texture_buf_s *src, struct texture_buf_s *dest );
+/**
+* decodes the block rows [firstBlockRow, firstBlockRow + numBlockRows) only, disjoint ranges
+* can be decoded from different threads into the same destination
+**/
+void T_BlockDecodeETC1Rows( const struct texture_buf_s *src, struct texture_buf_s *dest, uint32_t firstBlockRow, uint32_t numBlockRows );
 void T_MipMapQuarterInPlace( struct texture_buf_s *tex);
 void T_SwapEndianness( struct texture_buf_s *tex);
 /**
@@ -96,7 +96,7 @@ void R_ETC1DecodeBlock_RGBA8( uint8_t *block, struct uint_8_4 colors[ETC1_BLOCK_
 		const uint_fast16_t x = ( BCF_FLIP_SET( baseColorsAndFlags ) ? ( index >> 1 ) : ( index >> 2 ) );
 		const uint_fast16_t y = ( BCF_FLIP_SET( baseColorsAndFlags ) ? ( index & 1 ) : ( index & 3 ) );
 		const uint_fast16_t k = y + ( x * 4 );
-		const uint_fast16_t delta = ( ETC1_ModifierTable + ( BCF_CW1( baseColorsAndFlags ) << 2 ) )[( ( pixels >> k ) & 1 ) | ( ( pixels >> ( k + 15 ) ) & 2 )];
+		const int_fast16_t delta = ( ETC1_ModifierTable + ( BCF_CW1( baseColorsAndFlags ) << 2 ) )[( ( pixels >> k ) & 1 ) | ( ( pixels >> ( k + 15 ) ) & 2 )];
 		assert( x < ETC1_BLOCK_WIDTH );
 		assert( y < ETC1_BLOCK_HEIGHT );
 
@@ -110,7 +110,7 @@ void R_ETC1DecodeBlock_RGBA8( uint8_t *block, struct uint_8_4 colors[ETC1_BLOCK_
 		const uint_fast16_t x = ( BCF_FLIP_SET( baseColorsAndFlags ) ? ( index >> 1 ) : ( index >> 2 ) + 2 );
 		const uint_fast16_t y = ( BCF_FLIP_SET( baseColorsAndFlags ) ? ( index & 1 ) + 2 : ( index & 3 ) );
 		const uint_fast16_t k = y + ( x * 4 );
-		const uint_fast16_t delta = ( ETC1_ModifierTable + ( BCF_CW2( baseColorsAndFlags ) << 2 ) )[( ( pixels >> k ) & 1 ) | ( ( pixels >> ( k + 15 ) ) & 2 )];
+		const int_fast16_t delta = ( ETC1_ModifierTable + ( BCF_CW2( baseColorsAndFlags ) << 2 ) )[( ( pixels >> k ) & 1 ) | ( ( pixels >> ( k + 15 ) ) & 2 )];
 		assert( x < ETC1_BLOCK_WIDTH );
 		assert( y < ETC1_BLOCK_HEIGHT );
 
@@ -139,3 +139,103 @@ void R_ETC1DecodeBlock_RGBA8( uint8_t *block, struct uint_8_4 colors[ETC1_BLOCK_
 #undef BCF_CW1
 #undef BCF_CW2
 }
+
+/*
+* writes a full 4x4 block, numChannels is a constant at every call site so the loops unroll
+*/
+static inline void R_ETC1WriteBlock( uint8_t *out, size_t destPitch, uint8_t numChannels, uint32_t low, bool flip, const uint8_t palette[8][4] )
+{
+	for( uint32_t y = 0; y < ETC1_BLOCK_HEIGHT; y++, out += destPitch ) {
+		uint8_t *pixel = out;
+		for( uint32_t x = 0; x < ETC1_BLOCK_WIDTH; x++, pixel += numChannels ) {
+			const uint32_t k = ( x * 4 ) + y;
+			const uint32_t index = ( ( low >> k ) & 1 ) | ( ( low >> ( k + 15 ) ) & 2 );
+			const uint32_t subBlock = flip ? ( y >> 1 ) : ( x >> 1 );
+			memcpy( pixel, palette[( subBlock << 2 ) | index], numChannels );
+		}
+	}
+}
+
+void R_ETC1DecodeBlockRow( const uint8_t *blocks, uint32_t width, uint32_t height, uint8_t *dest, size_t destPitch,
+	uint8_t numChannels, const uint8_t channels[4] )
+{
+	static const int ETC1_ModifierTable[] = {
+		2, 8, -2, -8,
+		5, 17, -5, -17,
+		9, 29, -9, -29,
+		13, 42, -13, -42,
+		18, 60, -18, -60,
+		24, 80, -24, -80,
+		33, 106, -33, -106,
+		47, 183, -47, -183 };
+	static const int ETC1_Lookup[] = { 0, 1, 2, 3, -4, -3, -2, -1 };
+
+	assert( numChannels >= 1 && numChannels <= 4 );
+	assert( height <= ETC1_BLOCK_HEIGHT );
+
+	for( uint32_t blockX = 0; blockX < width; blockX += ETC1_BLOCK_WIDTH, blocks += ETC1_BLOCK_BYTES ) {
+		const uint32_t high = ( (uint32_t)blocks[0] << 24 ) | ( blocks[1] << 16 ) | ( blocks[2] << 8 ) | blocks[3];
+		const uint32_t low = ( (uint32_t)blocks[4] << 24 ) | ( blocks[5] << 16 ) | ( blocks[6] << 8 ) | blocks[7];
+		const bool flip = ( high & 1 ) != 0;
+		const int *tables[2] = { ETC1_ModifierTable + ( ( high >> 3 ) & ( 7 << 2 ) ), ETC1_ModifierTable + ( high & ( 7 << 2 ) ) };
+		int base[2][3];
+
+		if( high & 2 ) {
+			for( int c = 0; c < 3; c++ ) {
+				const int shift = 27 - c * 8;
+				const int c1 = ( high >> shift ) & 0x1f;
+				const int c2 = ( c1 + ETC1_Lookup[( high >> ( shift - 3 ) ) & 7] ) & 0x1f;
+				base[0][c] = ( c1 << 3 ) | ( c1 >> 2 );
+				base[1][c] = ( c2 << 3 ) | ( c2 >> 2 );
+			}
+		} else {
+			for( int c = 0; c < 3; c++ ) {
+				const int shift = 28 - c * 8;
+				base[0][c] = ( ( high >> shift ) & 0xf ) * 0x11;
+				base[1][c] = ( ( high >> ( shift - 4 ) ) & 0xf ) * 0x11;
+			}
+		}
+
+		// the four colors of each sub block, clamped once and already in the destination channel order,
+		// leaves a two bit lookup per pixel
+		uint8_t palette[8][4];
+		for( int i = 0; i < 8; i++ ) {
+			const int delta = tables[i >> 2][i & 3];
+			struct uint_8_4 color;
+			color.r = bound( 0, base[i >> 2][0] + delta, 255 );
+			color.g = bound( 0, base[i >> 2][1] + delta, 255 );
+			color.b = bound( 0, base[i >> 2][2] + delta, 255 );
+			color.a = 0;
+			for( uint8_t c = 0; c < numChannels; c++ ) {
+				palette[i][c] = color.v[channels[c]];
+			}
+		}
+
+		uint8_t *out = dest + blockX * numChannels;
+		if( height == ETC1_BLOCK_HEIGHT && width - blockX >= ETC1_BLOCK_WIDTH ) {
+			switch( numChannels ) {
+				case 3:
+					R_ETC1WriteBlock( out, destPitch, 3, low, flip, palette );
+					break;
+				case 4:
+					R_ETC1WriteBlock( out, destPitch, 4, low, flip, palette );
+					break;
+				default:
+					R_ETC1WriteBlock( out, destPitch, numChannels, low, flip, palette );
+					break;
+			}
+			continue;
+		}
+
+		// partial block on the right or bottom edge
+		const uint32_t columns = width - blockX;
+		for( uint32_t y = 0; y < height; y++, out += destPitch ) {
+			for( uint32_t x = 0; x < columns && x < ETC1_BLOCK_WIDTH; x++ ) {
+				const uint32_t k = ( x * 4 ) + y;
+				const uint32_t index = ( ( low >> k ) & 1 ) | ( ( low >> ( k + 15 ) ) & 2 );
+				const uint32_t subBlock = flip ? ( y >> 1 ) : ( x >> 1 );
+				memcpy( out + x * numChannels, palette[( subBlock << 2 ) | index], numChannels );
+			}
+		}
+	}
+}
@@ -5,6 +5,7 @@
 
 #define ETC1_BLOCK_WIDTH 4
 #define ETC1_BLOCK_HEIGHT 4
+#define ETC1_BLOCK_BYTES 8
 
 struct uint_8_4 {
   union {
@@ -25,4 +26,13 @@ struct uint_8_4 {
 **/
 void R_ETC1DecodeBlock_RGBA8(uint8_t* block, struct uint_8_4 colors[ETC1_BLOCK_WIDTH * ETC1_BLOCK_HEIGHT]);
 
+/**
+* decodes a row of blocks straight into an 8 bit per channel image, bit exact with R_ETC1DecodeBlock_RGBA8
+*
+* channels maps each destination channel to an index in struct uint_8_4, pixels past width and height
+* are not written
+**/
+void R_ETC1DecodeBlockRow( const uint8_t *blocks, uint32_t width, uint32_t height, uint8_t *dest, size_t destPitch,
+	uint8_t numChannels, const uint8_t channels[4] );
+
 #endif
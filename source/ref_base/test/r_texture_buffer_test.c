@@ -1,5 +1,8 @@
 #include "r_texture_format.h"
 #include "r_texture_buf.h"
+#include "r_texture_decode.h"
+#include "r_ktx_loader.h"
+#include "gl_format.h"
 
 #define STB_DS_IMPLEMENTATION 1
 #include "stb_ds.h"
@@ -8,6 +11,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <setjmp.h>
+#include <time.h>
 #include <cmocka.h>
 
 void Sys_Error( const char *format, ... ){
@@ -139,6 +143,211 @@ void test_promote_textuire_buffer(void **state) {
   free(c);
 }
 
+static void fill_etc1_blocks(uint8_t* blocks, size_t size) {
+  uint32_t seed = 1;
+  for(size_t i = 0; i < size; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    blocks[i] = seed >> 24;
+  }
+}
+
+static void decode_etc1(uint8_t* blocks, uint32_t width, uint32_t height, enum texture_format_e format, struct texture_buf_s* src, struct texture_buf_s* dest) {
+  struct texture_buf_desc_s srcdesc = { 
+    .width = width, 
+    .height = height, 
+    .def = R_BaseFormatDef( R_FORMAT_ETC1_R8G8B8_OES ), 
+    .alignment = 1 
+  };
+  struct texture_buf_desc_s destdesc = { 
+    .width = width, 
+    .height = height, 
+    .def = R_BaseFormatDef( format ), 
+    .alignment = 4 
+  };
+  assert_int_equal( TEXTURE_BUF_SUCCESS, T_AliasTextureBuf( src, &srcdesc, blocks, 0 ) );
+  T_ReallocTextureBuf( dest, &destdesc );
+  T_BlockDecodeETC1( src, dest );
+}
+
+void test_decode_etc1_clamp(void **state) {
+  // individual mode, base colors (0xff, 0x00, 0x88) and codeword 7 in both halves,
+  // every pixel picks the -47 modifier so green has to clamp to 0 instead of wrapping
+  uint8_t block[ETC1_BLOCK_BYTES] = { 0xff, 0x00, 0x88, 0xfc, 0xff, 0xff, 0x00, 0x00 };
+  struct texture_buf_s src = {0};
+  struct texture_buf_s dest = {0};
+  decode_etc1(block, 4, 4, R_FORMAT_RGBA8_UNORM, &src, &dest);
+  for(size_t i = 0; i < 16; i++) {
+    const uint8_t expected[] = { 208, 0, 89, 0 };
+    assert_memory_equal(&dest.buffer[i * 4], expected, sizeof(expected));
+  }
+  T_FreeTextureBuf(&src);
+  T_FreeTextureBuf(&dest);
+}
+
+void test_decode_etc1_matches_block_decoder(void **state) {
+  const uint32_t width = 37;
+  const uint32_t height = 21;
+  const uint32_t blocksW = ( width + 3 ) / 4;
+  const uint32_t blocksH = ( height + 3 ) / 4;
+  uint8_t* blocks = malloc(blocksW * blocksH * ETC1_BLOCK_BYTES);
+  fill_etc1_blocks(blocks, blocksW * blocksH * ETC1_BLOCK_BYTES);
+
+  const enum texture_format_e formats[] = { R_FORMAT_RGB8_UNORM, R_FORMAT_BGR8_UNORM, R_FORMAT_RGBA8_UNORM };
+  for(size_t f = 0; f < 3; f++) {
+    struct texture_buf_s src = {0};
+    struct texture_buf_s dest = {0};
+    decode_etc1(blocks, width, height, formats[f], &src, &dest);
+    const uint8_t numChannels = dest.def->fixed_8.numChannels;
+    for(uint32_t by = 0; by < blocksH; by++) {
+      for(uint32_t bx = 0; bx < blocksW; bx++) {
+        struct uint_8_4 colors[ETC1_BLOCK_WIDTH * ETC1_BLOCK_HEIGHT];
+        R_ETC1DecodeBlock_RGBA8(&blocks[( by * blocksW + bx ) * ETC1_BLOCK_BYTES], colors);
+        for(uint32_t y = 0; y < ETC1_BLOCK_HEIGHT && by * 4 + y < height; y++) {
+          for(uint32_t x = 0; x < ETC1_BLOCK_WIDTH && bx * 4 + x < width; x++) {
+            const struct uint_8_4* color = &colors[y * ETC1_BLOCK_WIDTH + x];
+            const uint8_t* pixel = &dest.buffer[dest.rowPitch * ( by * 4 + y ) + ( bx * 4 + x ) * numChannels];
+            for(uint8_t c = 0; c < numChannels; c++) {
+              switch(dest.def->fixed_8.channels[c]) {
+                case R_LOGICAL_C_RED: assert_int_equal(pixel[c], color->r); break;
+                case R_LOGICAL_C_GREEN: assert_int_equal(pixel[c], color->g); break;
+                case R_LOGICAL_C_BLUE: assert_int_equal(pixel[c], color->b); break;
+                default: assert_int_equal(pixel[c], 0); break;
+              }
+            }
+          }
+        }
+      }
+    }
+    T_FreeTextureBuf(&src);
+    T_FreeTextureBuf(&dest);
+  }
+  free(blocks);
+}
+
+void test_decode_etc1_rows(void **state) {
+  const uint32_t width = 37;
+  const uint32_t height = 21;
+  const size_t size = ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * ETC1_BLOCK_BYTES;
+  uint8_t* blocks = malloc(size);
+  fill_etc1_blocks(blocks, size);
+
+  struct texture_buf_s src = {0};
+  struct texture_buf_s full = {0};
+  decode_etc1(blocks, width, height, R_FORMAT_RGB8_UNORM, &src, &full);
+
+  struct texture_buf_s split = {0};
+  T_ReallocTextureBuf( &split, &(struct texture_buf_desc_s){ .width = width, .height = height, .def = full.def, .alignment = 4 } );
+  memset(split.buffer, 0xcd, split.size);
+  T_BlockDecodeETC1Rows(&src, &split, 3, 3);
+  T_BlockDecodeETC1Rows(&src, &split, 0, 1);
+  T_BlockDecodeETC1Rows(&src, &split, 1, 2);
+  for(uint32_t y = 0; y < height; y++) {
+    assert_memory_equal(&full.buffer[full.rowPitch * y], &split.buffer[split.rowPitch * y], width * 3);
+  }
+
+  T_FreeTextureBuf(&src);
+  T_FreeTextureBuf(&full);
+  T_FreeTextureBuf(&split);
+  free(blocks);
+}
+
+void test_decode_etc1_throughput(void **state) {
+  const uint32_t width = 1024;
+  const uint32_t height = 1024;
+  const size_t size = ( width / 4 ) * ( height / 4 ) * ETC1_BLOCK_BYTES;
+  uint8_t* blocks = malloc(size);
+  fill_etc1_blocks(blocks, size);
+
+  struct texture_buf_s src = {0};
+  struct texture_buf_s dest = {0};
+  decode_etc1(blocks, width, height, R_FORMAT_RGB8_UNORM, &src, &dest);
+
+  const int iterations = 16;
+  const clock_t start = clock();
+  for(int i = 0; i < iterations; i++) {
+    T_BlockDecodeETC1(&src, &dest);
+  }
+  const double seconds = (double)( clock() - start ) / CLOCKS_PER_SEC;
+  if(seconds > 0) {
+    print_message("etc1 decode: %.1f Mpixels/s, %.1f MB/s out\n", 
+      ( (double)width * height * iterations ) / seconds / 1e6, 
+      ( (double)dest.size * iterations ) / seconds / ( 1024 * 1024 ));
+  }
+
+  T_FreeTextureBuf(&src);
+  T_FreeTextureBuf(&dest);
+  free(blocks);
+}
+
+static uint8_t *build_ktx_rgba8(size_t *size, uint32_t keyValueBytes, uint32_t lod0Size) {
+  const uint32_t header[13] = { 0x04030201, GL_UNSIGNED_BYTE, 1, GL_RGBA, GL_RGBA8, GL_RGBA, 2, 2, 0, 0, 1, 2, keyValueBytes };
+  const uint32_t lod1Size = 4;
+  *size = 12 + sizeof(header) + 4 + 16 + 4 + 4;
+  uint8_t *data = malloc(*size);
+  memset(data, 0x7f, *size);
+  memcpy(data, "\xABKTX 11\xBB\r\n\x1A\n", 12);
+  memcpy(data + 12, header, sizeof(header));
+  memcpy(data + 64, &lod0Size, 4);
+  memcpy(data + 64 + 4 + 16, &lod1Size, 4);
+  return data;
+}
+
+// every prefix of the file is read through an exact-size copy so overreads are caught
+static bool init_ktx_prefix(const uint8_t *data, size_t size, size_t misalign, struct ktx_context_err_s *err) {
+  uint8_t *block = malloc(size + misalign);
+  memcpy(block + misalign, data, size);
+  struct ktx_context_s cntx = {0};
+  const bool res = R_InitKTXContext(&cntx, block + misalign, size, err);
+  if(res || err->type == KTX_WARN_MIPLEVEL_TRUNCATED) {
+    assert_true(R_KTXGetNumberMips(&cntx) <= 2);
+    for(uint32_t mip = 0; mip < R_KTXGetNumberMips(&cntx); mip++) {
+      const struct texture_buf_s *buf = R_KTXResolveBuffer(&cntx, mip, 0, 0);
+      assert_true(buf->buffer >= block + misalign && buf->buffer + buf->size <= block + misalign + size);
+    }
+  }
+  R_KTXFreeContext(&cntx);
+  free(block);
+  return res;
+}
+
+void test_ktx_bounds(void **state) {
+  size_t size;
+  uint8_t *data = build_ktx_rgba8(&size, 0, 16);
+  struct ktx_context_err_s err;
+
+  assert_true(init_ktx_prefix(data, size, 0, &err));
+  assert_true(init_ktx_prefix(data, size, 1, &err));
+
+  // losing the last mip keeps the first
+  assert_false(init_ktx_prefix(data, size - 1, 0, &err));
+  assert_int_equal(err.type, KTX_WARN_MIPLEVEL_TRUNCATED);
+  assert_int_equal(err.mipTruncated.mipLevels, 1);
+
+  for(size_t prefix = 0; prefix < 64 + 4 + 16 + 4; prefix++) {
+    assert_false(init_ktx_prefix(data, prefix, prefix & 3, &err));
+    if( prefix >= 64 ) {
+      assert_int_equal(err.type, prefix < 64 + 4 + 16 ? KTX_ERR_TRUNCATED : KTX_WARN_MIPLEVEL_TRUNCATED);
+    }
+  }
+  free(data);
+
+  data = build_ktx_rgba8(&size, 0x7ffffff0, 16);
+  assert_false(init_ktx_prefix(data, size, 0, &err));
+  assert_int_equal(err.type, KTX_ERR_TRUNCATED);
+  free(data);
+
+  // image size smaller than the image it claims to hold
+  data = build_ktx_rgba8(&size, 0, 8);
+  assert_false(init_ktx_prefix(data, size, 0, &err));
+  assert_int_equal(err.type, KTX_ERR_TRUNCATED);
+  free(data);
+
+  data = build_ktx_rgba8(&size, 0, 0xfffffff0);
+  assert_false(init_ktx_prefix(data, size, 0, &err));
+  assert_int_equal(err.type, KTX_ERR_TRUNCATED);
+  free(data);
+}
+
 int main( void )
 {
 	const struct CMUnitTest tests[] = {
@@ -146,6 +355,11 @@ int main( void )
 		cmocka_unit_test( test_swizzle_texture_buffer_rgb8_unorm_grba ),
 		cmocka_unit_test( test_promote_textuire_buffer ),
 		cmocka_unit_test( test_swap_texture_buffer_short_4_4_4_4_rgba_grba ),
+		cmocka_unit_test( test_decode_etc1_clamp ),
+		cmocka_unit_test( test_decode_etc1_matches_block_decoder ),
+		cmocka_unit_test( test_decode_etc1_rows ),
+		cmocka_unit_test( test_decode_etc1_throughput ),
+		cmocka_unit_test( test_ktx_bounds ),
 	};
 
 	return cmocka_run_group_tests( tests, NULL, NULL );
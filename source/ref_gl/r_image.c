@@ -414,9 +414,8 @@ static void __R_stbi_free_image(void* p) {
 
 
 static bool __R_ReadImageFromDisk_stbi(char *filename, struct texture_buf_s* buffer ) {
-	uint8_t* data;
-	size_t size = R_LoadFile( filename, ( void ** ) &data );
-	if(data == NULL) {
+	r_mappedfile_t map;
+	if( !R_MMapFile( filename, &map ) ) {
 		ri.Com_Printf(S_COLOR_YELLOW "can't resolve file: %s", filename);
 		return false;
 	}
@@ -428,7 +427,8 @@ static bool __R_ReadImageFromDisk_stbi(char *filename, struct texture_buf_s* buf
 	int channelCount = 0;
 	int w;
 	int h;
-	stbi_uc* stbiBuffer = stbi_load_from_memory( data, size, &w, &h, &channelCount, 0 );
+	stbi_uc* stbiBuffer = stbi_load_from_memory( map.data, map.size, &w, &h, &channelCount, 0 );
+	R_UnMMapFile( &map );
 	desc.width = w;
 	desc.height = h;
 	switch(channelCount) {
@@ -449,7 +449,6 @@ static bool __R_ReadImageFromDisk_stbi(char *filename, struct texture_buf_s* buf
 			ri.Com_Printf(S_COLOR_YELLOW "unhandled channel count: %d", channelCount);
 			return false;
 	}
-	R_FreeFile( data );
 	const int res = T_AliasTextureBuf_Free(buffer, &desc, stbiBuffer, 0, stbiBuffer, __R_stbi_free_image);
 	assert(res == TEXTURE_BUF_SUCCESS);
 	return true;
@@ -1267,6 +1266,62 @@ static void R_UploadMipmapped( int ctx, uint8_t **data,
 }
 
 
+#define ETC1_DECODE_THREADS		4
+#define ETC1_DECODE_MIN_BLOCK_ROWS	64	// below this the thread startup costs more than the decode
+
+typedef struct
+{
+	const struct texture_buf_s *src;
+	struct texture_buf_s *dest;
+	uint32_t firstBlockRow;
+	uint32_t numBlockRows;
+} etc1DecodeSlice_t;
+
+/*
+* R_DecodeETC1SliceThreadProc
+*/
+static void *R_DecodeETC1SliceThreadProc( void *param )
+{
+	etc1DecodeSlice_t *slice = param;
+
+	T_BlockDecodeETC1Rows( slice->src, slice->dest, slice->firstBlockRow, slice->numBlockRows );
+	return NULL;
+}
+
+/*
+* R_DecodeETC1
+*
+* Splits large textures into horizontal bands of block rows, the calling thread decodes the first one
+*/
+static void R_DecodeETC1( const struct texture_buf_s *src, struct texture_buf_s *dest )
+{
+	unsigned i, numSlices;
+	uint32_t blockRows, rowsPerSlice;
+	etc1DecodeSlice_t slices[ETC1_DECODE_THREADS];
+	qthread_t *threads[ETC1_DECODE_THREADS];
+
+	blockRows = T_LogicalH( src );
+	numSlices = bound( 1, blockRows / ETC1_DECODE_MIN_BLOCK_ROWS, ETC1_DECODE_THREADS );
+	rowsPerSlice = ( blockRows + numSlices - 1 ) / numSlices;
+
+	for( i = 0; i < numSlices; i++ ) {
+		slices[i].src = src;
+		slices[i].dest = dest;
+		slices[i].firstBlockRow = i * rowsPerSlice;
+		slices[i].numBlockRows = min( rowsPerSlice, blockRows - slices[i].firstBlockRow );
+	}
+
+	for( i = 1; i < numSlices; i++ ) {
+		threads[i] = ri.Thread_Create( R_DecodeETC1SliceThreadProc, &slices[i] );
+	}
+
+	R_DecodeETC1SliceThreadProc( &slices[0] );
+
+	for( i = 1; i < numSlices; i++ ) {
+		ri.Thread_Join( threads[i] );
+	}
+}
+
 static bool R_IsKTXFormatValid( int format, int type )
 {
 	switch( type )
@@ -1301,14 +1356,15 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname )
 	if( image->flags & ( IT_FLIPX|IT_FLIPY|IT_FLIPDIAGONAL ) )
 		return false;
 
-	uint8_t *buffer = NULL;
-	const size_t bufferSize = R_LoadFile( pathname, ( void ** )&buffer );
-	if( !buffer )
+	// parse and upload straight from the pak when the entry is stored
+	r_mappedfile_t map;
+	if( !R_MMapFile( pathname, &map ) )
 		return false;
 
 	struct ktx_context_s ktxContext = {0};
 	struct ktx_context_err_s err = {0};
-	if( !R_InitKTXContext( &ktxContext, buffer, bufferSize, &err ) ) {
+	ktxContext.readOnly = map.file != 0;
+	if( !R_InitKTXContext( &ktxContext, map.data, map.size, &err ) ) {
 		switch(err.type) {
 			case KTX_ERR_INVALID_IDENTIFIER:
 				ri.Com_Printf( S_COLOR_RED "R_LoadKTX: Bad file identifier: %s\n", pathname );
@@ -1317,16 +1373,20 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname )
 				ri.Com_Printf( S_COLOR_RED "R_LoadKTX: Unhandeled texture (type: %04x internalFormat %04x): %s\n", err.errTextureType.type, err.errTextureType.internalFormat, pathname );
 				goto error;
 			case KTX_ERR_TRUNCATED:
-				ri.Com_Printf( S_COLOR_RED "R_LoadKTX: Truncated Data size:(orignal: %lu expected: %lu): %s\n", err.errTruncated.size, err.errTruncated.expected, pathname );
+				ri.Com_Printf( S_COLOR_RED "R_LoadKTX: Truncated Data size:(orignal: %lu expected: %lu): %s\n", (unsigned long)err.errTruncated.size, (unsigned long)err.errTruncated.expected, pathname );
 				goto error;
 			case KTX_WARN_MIPLEVEL_TRUNCATED:
-				ri.Com_Printf( S_COLOR_YELLOW "R_LoadKTX: Truncated MipLevel size: (orignal: %lu expected: %lu) mip: (orignal: %lu expected: %lu): %s\n", err.errTruncated.size, err.errTruncated.expected,
-							   err.mipTruncated.mipLevels, err.mipTruncated.expectedMipLevels, pathname );
+				ri.Com_Printf( S_COLOR_YELLOW "R_LoadKTX: Truncated MipLevel size: (orignal: %lu expected: %lu) mip: (orignal: %u expected: %u): %s\n", 
+							   (unsigned long)err.mipTruncated.size, (unsigned long)err.mipTruncated.expected,
+							   (unsigned)err.mipTruncated.mipLevels, (unsigned)err.mipTruncated.expectedMipLevels, pathname );
 				break;
 			case KTX_ERR_ZER_TEXTURE_SIZE:
 				ri.Com_Printf( S_COLOR_RED "R_LoadKTX: Zero texture size: %s\n", pathname );
 				goto error;
 				break;
+			case KTX_ERR_INVALID_HEADER:
+				ri.Com_Printf( S_COLOR_RED "R_LoadKTX: Invalid header: %s\n", pathname );
+				goto error;
 		}
 	}
 
@@ -1391,31 +1451,19 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname )
 
 		} else {
 		
-		 // TODO: this logic produces artifacting on mac decode logic behaves differently on osx for some reason need to investigate what happens
-		 // uint8_t *decompressed[6];
-		 // struct texture_buf_s decodeTextures[8] = { 0 };
-		 // for( size_t faceIdx = 0; faceIdx < numFaces; ++faceIdx ) {
-		 // 	struct texture_buf_s *tex = R_KTXResolveBuffer( &ktxContext, 0, faceIdx, 0 );
-		 // 	struct texture_buf_desc_s decodeDesc = {
-		 // 		.width = T_PixelW( tex ), .height = T_PixelH( tex ), .def = glConfig.ext.bgra ? R_BaseFormatDef( R_FORMAT_BGR8_UNORM ) : R_BaseFormatDef( R_FORMAT_RGB8_UNORM ), .alignment = 1 };
-		 // 	T_ReallocTextureBuf( &decodeTextures[faceIdx], &decodeDesc );
-		 // 	T_BlockDecodeETC1( tex, &decodeTextures[faceIdx] );
-		 // 	decompressed[faceIdx] = decodeTextures[faceIdx].buffer;
-		 // }
-		 // R_UploadMipmapped( ctx, decompressed, R_KTXWidth( &ktxContext ), R_KTXHeight( &ktxContext ), 1, image->flags, image->minmipsize, &image->upload_width, &image->upload_height,
-		 // 				   glConfig.ext.bgra ? GL_BGR_EXT : GL_RGB, GL_UNSIGNED_BYTE );
-		 // for( size_t faceIdx = 0; faceIdx < numFaces; faceIdx++ ) {
-		 // 	T_FreeTextureBuf( &decodeTextures[faceIdx] );
-		 // }
-		  
-		  uint8_t *decompressed[6];
-		  for( size_t faceIdx = 0; faceIdx < numFaces; ++faceIdx ) {
-		  	struct texture_buf_s *tex = R_KTXResolveBuffer( &ktxContext, 0, faceIdx, 0 );
-				decompressed[faceIdx] = R_PrepareImageBuffer( ctx, TEXTURE_LOADING_BUF0 + faceIdx, ALIGN( tex->width * 3, 4 ) * tex->height);
-				DecompressETC1( tex->buffer, tex->width, tex->height, decompressed[faceIdx], glConfig.ext.bgra ? true : false );
-		  }
-		  R_UploadMipmapped( ctx, decompressed, R_KTXWidth( &ktxContext ), R_KTXHeight( &ktxContext ), 1, image->flags, image->minmipsize, &image->upload_width, &image->upload_height,
-		  				   glConfig.ext.bgra ? GL_BGR_EXT : GL_RGB, GL_UNSIGNED_BYTE );
+			uint8_t *decompressed[6];
+			struct texture_buf_s decodeTextures[6] = { 0 };
+			for( size_t faceIdx = 0; faceIdx < numFaces; ++faceIdx ) {
+				struct texture_buf_s *tex = R_KTXResolveBuffer( &ktxContext, 0, faceIdx, 0 );
+				struct texture_buf_desc_s decodeDesc = {
+					.width = T_PixelW( tex ), .height = T_PixelH( tex ), .def = glConfig.ext.bgra ? R_BaseFormatDef( R_FORMAT_BGR8_UNORM ) : R_BaseFormatDef( R_FORMAT_RGB8_UNORM ), .alignment = 4 };
+				const size_t decodeSize = ALIGN( decodeDesc.width * 3, 4 ) * decodeDesc.height;
+				decompressed[faceIdx] = R_PrepareImageBuffer( ctx, TEXTURE_LOADING_BUF0 + faceIdx, decodeSize );
+				T_AliasTextureBuf( &decodeTextures[faceIdx], &decodeDesc, decompressed[faceIdx], decodeSize );
+				R_DecodeETC1( tex, &decodeTextures[faceIdx] );
+			}
+			R_UploadMipmapped( ctx, decompressed, R_KTXWidth( &ktxContext ), R_KTXHeight( &ktxContext ), 1, image->flags, image->minmipsize, &image->upload_width, &image->upload_height,
+							   glConfig.ext.bgra ? GL_BGR_EXT : GL_RGB, GL_UNSIGNED_BYTE );
 		}
 
 		image->samples = 3;
@@ -1446,6 +1494,8 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname )
 					swizzleChannel[0] = R_LOGICAL_C_RED;
 					swizzleChannel[1] = R_LOGICAL_C_GREEN;
 					swizzleChannel[2] = R_LOGICAL_C_BLUE;
+					if( ktxContext.readOnly )
+						T_PromoteTextureBuf( texBuffer );
 					T_SwizzleInplace( texBuffer, swizzleChannel );
 				}
 				images[mipIndex * numFaces + faceIndex] = texBuffer->buffer;
@@ -1460,12 +1510,12 @@ static bool R_LoadKTX( int ctx, image_t *image, const char *pathname )
 	image->height = R_KTXHeight(&ktxContext);
 
 	R_KTXFreeContext(&ktxContext);
-	R_FreeFile( buffer );
+	R_UnMMapFile( &map );
 	R_DeferDataSync();
 	return true;
 error: // must not be reached after actually starting uploading the texture
 	R_KTXFreeContext(&ktxContext);
-	R_FreeFile( buffer );
+	R_UnMMapFile( &map );
 	return false;
 }
 
@@ -41,4 +41,3 @@ typedef struct
 
 bool WriteScreenShot( const char * filename, r_imginfo_t *info, int type );
 
-void DecompressETC1( const uint8_t *in, int width, int height, uint8_t *out, bool bgr );
@@ -559,6 +559,19 @@ void		R_FreeFile_( void *buffer, const char *filename, int fileline );
 #define		R_LoadCacheFile(path,buffer) R_LoadFile_(path,FS_CACHE,buffer,__FILE__,__LINE__)
 #define		R_FreeFile(buffer) R_FreeFile_(buffer,__FILE__,__LINE__)
 
+typedef struct
+{
+	uint8_t		*data;
+	size_t		size;
+	int			file;			// kept open while the view is mapped, 0 when data is a loaded copy
+} r_mappedfile_t;
+
+bool		R_MMapFile_( const char *path, r_mappedfile_t *map, const char *filename, int fileline );
+void		R_UnMMapFile_( r_mappedfile_t *map, const char *filename, int fileline );
+
+#define		R_MMapFile(path,map) R_MMapFile_(path,map,__FILE__,__LINE__)
+#define		R_UnMMapFile(map) R_UnMMapFile_(map,__FILE__,__LINE__)
+
 bool		R_IsRenderingToScreen( void );
 void		R_BeginFrame( float cameraSeparation, bool forceClear, bool forceVsync );
 void		R_EndFrame( void );
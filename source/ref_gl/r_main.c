@@ -1778,6 +1778,57 @@ int R_LoadFile_( const char *path, int flags, void **buffer, const char *filenam
 	return len;
 }
 
+/*
+* R_MMapFile
+*
+* Read-only view of a loose file or a stored pak entry without copying it, deflated
+* entries are loaded into memory instead. The data must not be written to either way
+*/
+bool R_MMapFile_( const char *path, r_mappedfile_t *map, const char *filename, int fileline )
+{
+	int len, fhandle;
+
+	memset( map, 0, sizeof( *map ) );
+
+	len = FS_FOpenFile( path, &fhandle, FS_READ );
+	if( !fhandle )
+		return false;
+
+	map->size = len;
+	map->data = FS_MMapFile( fhandle );
+	if( map->data )
+	{
+		map->file = fhandle;
+		return true;
+	}
+
+	map->data = ( uint8_t *)ri.Mem_AllocExt( r_mempool, len + 1, 16, 0, filename, fileline );
+	map->data[len] = 0;
+
+	FS_Read( map->data, len, fhandle );
+	FS_FCloseFile( fhandle );
+
+	return true;
+}
+
+/*
+* R_UnMMapFile
+*/
+void R_UnMMapFile_( r_mappedfile_t *map, const char *filename, int fileline )
+{
+	if( map->file )
+	{
+		FS_UnMMapFile( map->file, map->data );
+		FS_FCloseFile( map->file );
+	}
+	else if( map->data )
+	{
+		ri.Mem_Free( map->data, filename, fileline );
+	}
+
+	memset( map, 0, sizeof( *map ) );
+}
+
 /*
 * R_FreeFile
 */
@@ -65,6 +65,8 @@ typedef struct
 	entity_state_t baselines[MAX_EDICTS];
 	int num_mv_clients;     // current number, <= sv_maxmvclients
 
+	snap_deltacache_t deltacache;	// entity deltas encoded in the current frame
+
 	//
 	// global variables shared between game and server
 	//
@@ -102,6 +104,7 @@ typedef struct
 	int first_entity;                   // into the circular sv.client_entities[]
 	unsigned int sentTimeStamp;         // time at what this frame snap was sent to the clients
 	unsigned int UcmdExecuted;
+	unsigned int snapId;                // nonzero if frames with the same id have identical contents
 	game_state_t gameState;
 } client_snapshot_t;
 
@@ -112,6 +115,24 @@ typedef struct
 	int size;               // total bytes (can't use EOF because of paks)
 	unsigned int timeout;   // so we can free the file being downloaded
 	                        // if client omits sending success or failure message
+
+	// windowed download state
+	bool windowed;          // client acknowledges blocks with dlack instead of polling with nextdl
+	int base;               // offset of the first block not acknowledged yet
+	int next;               // number of blocks past base sent at least once
+	unsigned int acked;     // selectively acknowledged blocks past base
+	unsigned int sendTime[DOWNLOAD_WINDOW_BLOCKS];
+	int cwnd;               // congestion window in blocks
+	int ssthresh;
+	int cwndcount;          // acknowledged blocks towards the next additive increase
+	int budget;             // bytes we're allowed to send, refilled at the client's rate
+	unsigned int lastSendTime;
+	unsigned int lastLossTime;
+
+	uint8_t *data;          // memory-mapped file contents, if mapping succeeded
+	uint8_t *readahead;     // otherwise, a window-sized read-ahead buffer
+	int readaheadOffset;
+	int readaheadSize;
 } client_download_t;
 
 typedef struct
@@ -183,6 +204,7 @@ typedef struct client_s
 	netchan_t netchan;
 
 	bool tvclient;
+	bool compactSnaps;              // player state coordinates are sent as deltas
 
 	bool authenticated; // did user sucesfully authenticate with a steam ticket
 	uint64_t steamid;
@@ -258,6 +280,17 @@ typedef struct fatvis_s
 	uint8_t phs[MAX_MAP_LEAFS/8];
 } fatvis_t;
 
+// timings gathered by the serverbenchmark command
+typedef struct
+{
+	bool active;
+	uint64_t gameTime;                  // usecs spent running game frames
+	uint64_t buildTime;                 // usecs spent building client snapshots
+	uint64_t writeTime;                 // usecs spent encoding and transmitting them
+	uint64_t bytes;                     // snapshot bytes written
+	unsigned int snaps;
+} server_static_bench_t;
+
 typedef struct
 {
 	bool initialized;               // sv_init has completed
@@ -289,6 +322,8 @@ typedef struct
 
 	server_static_demo_t *race_demos;   // [sv_maxclients->integer];
 
+	server_static_bench_t bench;
+
 	purelist_t *purelist;				// pure file support
 
 	cmodel_state_t *cms;                // passed to CM-functions
@@ -309,6 +344,7 @@ typedef struct
 	bool autostarted;
 	unsigned int lastMasterResolve;
 	unsigned int autoUpdateMinute;	// the minute number we should run the autoupdate check, in the range 0 to 59
+	unsigned int gameSeed;			// random seed passed to the game when non-zero, instead of the time
 } server_constant_t;
 
 //=============================================================================
@@ -348,11 +384,14 @@ extern cvar_t *sv_maxmvclients;
 extern cvar_t *sv_showRcon;
 extern cvar_t *sv_showChallenge;
 extern cvar_t *sv_showInfoQueries;
+extern cvar_t *sv_ooblimit;
+extern cvar_t *sv_ooblimit_burst;
 extern cvar_t *sv_highchars;
 
 //wsw : jal
 extern cvar_t *sv_maxrate;
 extern cvar_t *sv_compresspackets;
+extern cvar_t *sv_compactsnaps;
 extern cvar_t *sv_public;         // should heartbeats be sent
 extern cvar_t *sv_log_heartbeats;         // should the sending heartbeat message be printed
 extern cvar_t *sv_whitelist;
@@ -364,6 +403,7 @@ extern cvar_t *sv_uploads_http;
 extern cvar_t *sv_uploads_baseurl;
 extern cvar_t *sv_uploads_demos;
 extern cvar_t *sv_uploads_demos_baseurl;
+extern cvar_t *sv_uploads_window;
 
 extern cvar_t *sv_pure;
 extern cvar_t *sv_pure_forcemodulepk3;
@@ -410,6 +450,7 @@ void SVC_MasterInfoResponse( const socket_t *socket, const netadr_t *address );
 int SVC_FakeConnect( char *fakeUserinfo, char *fakeSocketType, const char *fakeIP );
 
 void SV_UpdateActivity( void );
+bool SV_BenchmarkFrame( int msec );
 
 //
 // sv_oob.c
@@ -483,6 +524,7 @@ void SV_DropClient( client_t *drop, int type, const char *format, ... );
 void SV_ExecuteClientThinks( int clientNum );
 void SV_ClientResetCommandBuffers( client_t *client );
 void SV_ClientCloseDownload( client_t *client );
+void SV_SendClientDownloads( void );
 
 //
 // sv_mv.c
@@ -495,6 +537,11 @@ bool SV_Multiview_CreateStartMessages( bool ( *callback )( msg_t *msg, void *ext
 //
 void SV_Status_f( void );
 
+//
+// sv_bench.c
+//
+void SV_Benchmark_f( void );
+
 //
 // sv_ents.c
 //
@@ -0,0 +1,376 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// sv_bench.c -- deterministic server benchmark
+//
+// Loads a map, spawns a number of players that take their input from a usercmd recording
+// (see the client "ucmdrecord" command) or from a fixed synthetic pattern, and runs the
+// game and snapshot part of the server frame back to back on a simulated clock. The
+// snapshots go through the regular netchan to an address that never transmits, so the
+// whole send path is timed without any sockets involved.
+
+#include "server.h"
+
+#define SV_BENCH_SEED			0x5eed
+#define SV_BENCH_FRAMETIME		16		// WORLDFRAMETIME in sv_main.c, one game frame per step
+#define SV_BENCH_WARMUP			62		// frames run before measuring, lets the players spawn
+
+// the netchan needs an open socket, sends to a NA_NOTRANSMIT address never reach it
+static socket_t sv_bench_socket;
+
+typedef struct
+{
+	unsigned int total;
+	unsigned int game;
+	unsigned int build;
+	unsigned int write;
+	bool snap;
+} sv_benchframe_t;
+
+/*
+* SV_Bench_CompareUInt
+*/
+static int SV_Bench_CompareUInt( const void *a, const void *b )
+{
+	unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+	return x < y ? -1 : ( x > y ? 1 : 0 );
+}
+
+/*
+* SV_Bench_PrintTimes
+*
+* Sorts the samples in place and prints their distribution in milliseconds
+*/
+static void SV_Bench_PrintTimes( const char *name, unsigned int *samples, int count )
+{
+	int i;
+	uint64_t total;
+
+	if( !count )
+	{
+		Com_Printf( "%-9s no samples\n", name );
+		return;
+	}
+
+	qsort( samples, count, sizeof( *samples ), SV_Bench_CompareUInt );
+
+	for( i = 0, total = 0; i < count; i++ )
+		total += samples[i];
+
+	Com_Printf( "%-9s avg %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f ms\n", name,
+		total * 0.001 / count, samples[count * 50 / 100] * 0.001, samples[count * 90 / 100] * 0.001,
+		samples[count * 99 / 100] * 0.001, samples[count - 1] * 0.001 );
+}
+
+/*
+* SV_Bench_FindMap
+*/
+static bool SV_Bench_FindMap( const char *map, char *mapname, size_t size )
+{
+	Q_strncpyz( mapname, map, size );
+	if( ML_ValidateFilename( mapname ) )
+	{
+		COM_StripExtension( mapname );
+		if( ML_FilenameExists( mapname ) )
+			return true;
+
+		ML_Update();
+		if( ML_FilenameExists( mapname ) )
+			return true;
+	}
+
+	if( ML_ValidateFullname( map ) )
+	{
+		Q_strncpyz( mapname, ML_GetFilename( map ), size );
+		if( *mapname )
+			return true;
+	}
+
+	return false;
+}
+
+/*
+* SV_Bench_ConnectClient
+*/
+static client_t *SV_Bench_ConnectClient( int num )
+{
+	int i;
+	char userinfo[MAX_INFO_STRING];
+	netadr_t address;
+	client_t *client;
+
+	for( i = 0, client = svs.clients; i < sv_maxclients->integer; i++, client++ )
+	{
+		if( client->state == CS_FREE )
+			break;
+	}
+	if( i == sv_maxclients->integer )
+		return NULL;
+
+	userinfo[0] = '\0';
+	Info_SetValueForKey( userinfo, "name", va( "bench%03i", num ) );
+	Info_SetValueForKey( userinfo, "socket", NET_SocketTypeToString( sv_bench_socket.type ) );
+	Info_SetValueForKey( userinfo, "ip", "127.0.0.1" );
+
+	NET_InitAddress( &address, NA_NOTRANSMIT );
+	if( !SV_ClientConnect( &sv_bench_socket, &address, client, userinfo, num, -1, false, false, 0, 0 ) )
+		return NULL;
+
+	// skip the download and configstring handshake, as SVC_FakeConnect does
+	client->state = CS_SPAWNED;
+	ge->ClientBegin( client->edict );
+
+	Cmd_TokenizeString( "join" );
+	ge->ClientCommand( client->edict );
+
+	return client;
+}
+
+/*
+* SV_Bench_FillUcmd
+*/
+static void SV_Bench_FillUcmd( usercmd_t *ucmd, const usercmd_t *replay, int numreplay, unsigned int t )
+{
+	memset( ucmd, 0, sizeof( *ucmd ) );
+
+	if( numreplay )
+	{
+		int low, high, mid;
+
+		// the recording loops, find the last command at or before t
+		t %= replay[numreplay - 1].serverTimeStamp + 1;
+		low = 0;
+		high = numreplay - 1;
+		while( low < high )
+		{
+			mid = ( low + high + 1 ) / 2;
+			if( replay[mid].serverTimeStamp <= t )
+				low = mid;
+			else
+				high = mid - 1;
+		}
+
+		*ucmd = replay[low];
+	}
+	else
+	{
+		// run around in circles, strafing, jumping and shooting every now and then
+		ucmd->forwardmove = 1.0f;
+		ucmd->sidemove = ( ( t / 1500 ) & 1 ) ? 1.0f : -1.0f;
+		ucmd->upmove = ( t % 2000 ) < 100 ? 1.0f : 0.0f;
+		ucmd->angles[YAW] = ANGLE2SHORT( ( t % 7200 ) * 0.05f );
+		ucmd->buttons = ( t % 3000 ) < 500 ? BUTTON_ATTACK : 0;
+	}
+
+	if( ucmd->buttons || ucmd->forwardmove || ucmd->sidemove || ucmd->upmove )
+		ucmd->buttons |= BUTTON_ANY;
+}
+
+/*
+* SV_Benchmark_f
+* serverbenchmark <map> [clients] [frames] [ucmds]
+* Runs the map for the given number of game frames as fast as possible, with every client
+* replaying the usercmd recording, and reports where the frame time goes.
+* The map is restarted from scratch, so it refuses to run while real clients are connected.
+*/
+void SV_Benchmark_f( void )
+{
+	char mapname[MAX_CONFIGSTRING_CHARS];
+	int i, j, numclients, numframes, numreplay, numsnaps;
+	unsigned int startTime;
+	usercmd_t *replay;
+	client_t **clients;
+	sv_benchframe_t *frames;
+	unsigned int *samples;
+	server_static_bench_t last;
+	uint64_t start, frameStart, elapsed, bytes;
+
+	if( Cmd_Argc() < 2 )
+	{
+		Com_Printf( "Usage: %s <map> [clients] [frames] [ucmds]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	if( sv.state != ss_dead && svs.clients )
+	{
+		for( i = 0; i < sv_maxclients->integer; i++ )
+		{
+			if( svs.clients[i].state >= CS_CONNECTING && svs.clients[i].edict
+				&& !( svs.clients[i].edict->r.svflags & SVF_FAKECLIENT ) )
+			{
+				Com_Printf( "Can't benchmark with clients connected, the map is restarted from scratch\n" );
+				return;
+			}
+		}
+	}
+
+	if( strlen( Cmd_Argv( 1 ) ) >= MAX_CONFIGSTRING_CHARS || !SV_Bench_FindMap( Cmd_Argv( 1 ), mapname, sizeof( mapname ) ) )
+	{
+		Com_Printf( "Couldn't find map: %s\n", Cmd_Argv( 1 ) );
+		return;
+	}
+
+	numclients = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 16;
+	numframes = Cmd_Argc() > 3 ? atoi( Cmd_Argv( 3 ) ) : 3000;
+	clamp( numclients, 0, sv_maxclients->integer );
+	clamp( numframes, 1, 1000000 );
+
+	numreplay = 0;
+	replay = NULL;
+	if( Cmd_Argc() > 4 )
+	{
+		replay = SNAP_LoadUcmdFile( Cmd_Argv( 4 ), sv_mempool, &numreplay );
+		if( !replay )
+			return;
+	}
+
+	// start the map from scratch, with the same random sequence every run
+	// (the game reseeds from the value it gets in its Init)
+	srand( SV_BENCH_SEED );
+	svc.gameSeed = SV_BENCH_SEED;
+	sv.state = ss_dead;
+	SV_Map( mapname, false );
+	svc.gameSeed = 0;
+	Q_strncpyz( svs.mapcmd, mapname, sizeof( svs.mapcmd ) );
+
+	if( sv.state != ss_game )
+	{
+		if( replay )
+			Mem_Free( replay );
+		return;
+	}
+
+	sv_bench_socket.type = SOCKET_LOOPBACK;
+	sv_bench_socket.open = true;
+
+	clients = Mem_Alloc( sv_mempool, sizeof( *clients ) * max( numclients, 1 ) );
+	for( i = 0; i < numclients; i++ )
+	{
+		clients[i] = SV_Bench_ConnectClient( i );
+		if( !clients[i] )
+		{
+			Com_Printf( "Couldn't connect benchmark client %i\n", i );
+			break;
+		}
+	}
+	numclients = i;
+
+	frames = Mem_Alloc( sv_mempool, sizeof( *frames ) * numframes );
+	samples = Mem_Alloc( sv_mempool, sizeof( *samples ) * numframes );
+
+	Com_Printf( "Benchmarking %s: %i clients, %i frames, %s input\n", mapname, numclients, numframes,
+		replay ? "recorded" : "synthetic" );
+
+	memset( &svs.bench, 0, sizeof( svs.bench ) );
+	svs.bench.active = true;
+
+	startTime = svs.gametime;
+	start = 0;
+	for( i = -SV_BENCH_WARMUP; i < numframes; i++ )
+	{
+		if( i == 0 )
+		{
+			memset( &svs.bench, 0, sizeof( svs.bench ) );
+			svs.bench.active = true;
+			start = Sys_Microseconds();
+		}
+
+		// every client sends one command per frame, stamped just before the new game time
+		for( j = 0; j < numclients; j++ )
+		{
+			client_t *client = clients[j];
+			usercmd_t *ucmd;
+
+			if( client->state < CS_SPAWNED )
+				continue;
+
+			client->UcmdReceived++;
+			ucmd = &client->ucmds[client->UcmdReceived & CMD_MASK];
+			SV_Bench_FillUcmd( ucmd, replay, numreplay, svs.gametime - startTime + j * 777 );
+			ucmd->serverTimeStamp = svs.gametime + SV_BENCH_FRAMETIME - 1;
+		}
+
+		last = svs.bench;
+		frameStart = Sys_Microseconds();
+
+		if( SV_BenchmarkFrame( SV_BENCH_FRAMETIME ) )
+		{
+			// and acknowledges every snapshot straight away
+			for( j = 0; j < numclients; j++ )
+			{
+				if( clients[j]->state >= CS_SPAWNED )
+					clients[j]->lastframe = sv.framenum;
+			}
+		}
+
+		if( i < 0 )
+			continue;
+
+		frames[i].total = (unsigned int)( Sys_Microseconds() - frameStart );
+		frames[i].game = (unsigned int)( svs.bench.gameTime - last.gameTime );
+		frames[i].build = (unsigned int)( svs.bench.buildTime - last.buildTime );
+		frames[i].write = (unsigned int)( svs.bench.writeTime - last.writeTime );
+		frames[i].snap = svs.bench.snaps != last.snaps;
+	}
+	elapsed = Sys_Microseconds() - start;
+	numsnaps = svs.bench.snaps;
+	bytes = svs.bench.bytes;
+
+	svs.bench.active = false;
+
+	for( j = 0; j < numclients; j++ )
+	{
+		if( clients[j]->state >= CS_CONNECTING )
+			SV_DropClient( clients[j], DROP_TYPE_GENERAL, "Benchmark finished" );
+	}
+
+	Com_Printf( "%i frames in %.3f seconds: %.1f frames per second, %.1fx realtime\n", numframes, elapsed * 0.000001,
+		elapsed ? numframes * 1000000.0 / elapsed : 0.0, elapsed ? numframes * SV_BENCH_FRAMETIME * 1000.0 / elapsed : 0.0 );
+	Com_Printf( "%i client snapshots, %.1f bytes each\n", numsnaps, numsnaps ? (double)bytes / numsnaps : 0.0 );
+
+	for( i = 0; i < numframes; i++ )
+		samples[i] = frames[i].total;
+	SV_Bench_PrintTimes( "frame", samples, numframes );
+
+	for( i = 0; i < numframes; i++ )
+		samples[i] = frames[i].game;
+	SV_Bench_PrintTimes( "game", samples, numframes );
+
+	// the snapshot figures only make sense for the frames that sent one
+	for( i = 0, j = 0; i < numframes; i++ )
+	{
+		if( frames[i].snap )
+			samples[j++] = frames[i].build;
+	}
+	SV_Bench_PrintTimes( "build", samples, j );
+
+	for( i = 0, j = 0; i < numframes; i++ )
+	{
+		if( frames[i].snap )
+			samples[j++] = frames[i].write;
+	}
+	SV_Bench_PrintTimes( "encode", samples, j );
+
+	Mem_Free( samples );
+	Mem_Free( frames );
+	Mem_Free( clients );
+	if( replay )
+		Mem_Free( replay );
+}
@@ -405,6 +405,135 @@ static void SV_CvarCheck_f( void )
 	SV_SendServerCommand( client, "cvarinfo \"%s\"", Cmd_Argv( 2 ) );
 }
 
+/*
+* SV_SnapStats_f
+*/
+static void SV_SnapStats_f( void )
+{
+	unsigned int deltas;
+
+	if( sv.state != ss_game )
+	{
+		Com_Printf( "No server running.\n" );
+		return;
+	}
+
+	deltas = sv.deltacache.hits + sv.deltacache.misses;
+	Com_Printf( "Entity deltas: %u encoded, %u shared (%.1f%% hit rate)\n", sv.deltacache.misses, sv.deltacache.hits,
+		deltas ? 100.0 * sv.deltacache.hits / deltas : 0.0 );
+}
+
+/*
+* SV_SnapBenchRun
+*/
+static uint64_t SV_SnapBenchRun( int iterations, unsigned int *deltas )
+{
+	int i;
+	uint64_t start;
+	client_t *client;
+
+	*deltas = 0;
+	start = Sys_Microseconds();
+	for( i = 0, client = svs.clients; i < sv_maxclients->integer; i++, client++ )
+	{
+		if( client->state < CS_SPAWNED )
+			continue;
+		if( client->edict && ( client->edict->r.svflags & SVF_FAKECLIENT ) )
+			continue;
+
+		*deltas += SNAP_BenchmarkFrameDeltas( &sv.gi, client, sv.baselines, &svs.client_entities, iterations );
+	}
+	return Sys_Microseconds() - start;
+}
+
+/*
+* SV_SnapBench_f
+* snapbench [iterations]
+* Re-encodes the last snapshot deltas sent to every client, first with the field by field
+* compares only (baseline), then with the whole state compares, and reports both throughputs,
+* and the player state bandwidth of the standard and the compact snapshot mode
+*/
+static void SV_SnapBench_f( void )
+{
+	int i, iterations;
+	unsigned int deltas;
+	size_t standardBytes, compactBytes;
+	uint64_t baseline, elapsed;
+	client_t *client;
+
+	if( sv.state != ss_game )
+	{
+		Com_Printf( "No server running.\n" );
+		return;
+	}
+
+	iterations = Cmd_Argc() > 1 ? bound( 1, atoi( Cmd_Argv( 1 ) ), 100000 ) : 1000;
+
+	MSG_SetDeltaShortcuts( false );
+	baseline = SV_SnapBenchRun( iterations, &deltas );
+	MSG_SetDeltaShortcuts( true );
+	elapsed = SV_SnapBenchRun( iterations, &deltas );
+
+	if( !deltas || !elapsed || !baseline )
+	{
+		Com_Printf( "No snapshots to encode\n" );
+		return;
+	}
+
+	Com_Printf( "baseline: %u deltas in %.3f ms: %.0f deltas per second\n", deltas, baseline * 0.001, deltas * 1000000.0 / baseline );
+	Com_Printf( "current: %u deltas in %.3f ms: %.0f deltas per second (%.2fx)\n", deltas, elapsed * 0.001, deltas * 1000000.0 / elapsed,
+		(double)baseline / elapsed );
+
+	standardBytes = compactBytes = 0;
+	for( i = 0, client = svs.clients; i < sv_maxclients->integer; i++, client++ )
+	{
+		if( client->state < CS_SPAWNED )
+			continue;
+		if( client->edict && ( client->edict->r.svflags & SVF_FAKECLIENT ) )
+			continue;
+
+		SNAP_MeasurePlayerstateDeltas( client, &standardBytes, &compactBytes );
+	}
+
+	if( standardBytes )
+		Com_Printf( "Player states: %u bytes standard, %u bytes compact (%.1f%%)\n", (unsigned)standardBytes,
+			(unsigned)compactBytes, compactBytes * 100.0 / standardBytes );
+}
+
+/*
+* SV_Profile_f
+* sv_profile [reset | trace [filename]]
+* Prints the frame profiler zone percentiles, or writes the slow frames as a Chrome trace
+*/
+static void SV_Profile_f( void )
+{
+	char filename[MAX_QPATH];
+
+	if( !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+	{
+		Com_ProfileReset();
+		return;
+	}
+
+	if( !Q_stricmp( Cmd_Argv( 1 ), "trace" ) )
+	{
+		Q_strncpyz( filename, Cmd_Argc() > 2 ? Cmd_Argv( 2 ) : "slowframes", sizeof( filename ) );
+		COM_SanitizeFilePath( filename );
+		COM_DefaultExtension( filename, ".json", sizeof( filename ) );
+
+		if( !COM_ValidateRelativeFilename( filename ) )
+		{
+			Com_Printf( "Invalid filename\n" );
+			return;
+		}
+
+		Com_ProfileWriteTrace( filename );
+		return;
+	}
+
+	Com_ProfilePrintStats();
+}
+
 //===========================================================
 
 /*
@@ -440,6 +569,10 @@ void SV_InitOperatorCommands( void )
 	}
 
 	Cmd_AddCommand( "cvarcheck", SV_CvarCheck_f );
+	Cmd_AddCommand( "snapstats", SV_SnapStats_f );
+	Cmd_AddCommand( "snapbench", SV_SnapBench_f );
+	Cmd_AddCommand( "serverbenchmark", SV_Benchmark_f );
+	Cmd_AddCommand( "sv_profile", SV_Profile_f );
 
 	Cmd_SetCompletionFunc( "map", SV_MapComplete_f );
 	Cmd_SetCompletionFunc( "devmap", SV_MapComplete_f );
@@ -479,4 +612,8 @@ void SV_ShutdownOperatorCommands( void )
 	}
 
 	Cmd_RemoveCommand( "cvarcheck" );
+	Cmd_RemoveCommand( "snapstats" );
+	Cmd_RemoveCommand( "snapbench" );
+	Cmd_RemoveCommand( "serverbenchmark" );
+	Cmd_RemoveCommand( "sv_profile" );
 }
@@ -51,6 +51,10 @@ void SV_ClientResetCommandBuffers( client_t *client )
 
 void SV_ClientCloseDownload( client_t *client )
 {
+	if( client->download.data )
+		FS_UnMMapBaseFile( client->download.file, client->download.data );
+	if( client->download.readahead )
+		Mem_ZoneFree( client->download.readahead );
 	if( client->download.file )
 		FS_FCloseFile( client->download.file );
 	if( client->download.name )
@@ -331,6 +335,8 @@ static void SV_New_f( client_t *client )
 			sv_bitflags |= SV_BITFLAGS_PURE;
 		if( client->reliable )
 			sv_bitflags |= SV_BITFLAGS_RELIABLE;
+		if( client->compactSnaps )
+			sv_bitflags |= SV_BITFLAGS_COMPACTSNAPS;
 		if( SV_Web_Running() )
 		{
 			const char *baseurl = SV_Web_UpstreamBaseUrl();
@@ -529,17 +535,277 @@ static void SV_Begin_f( client_t *client )
 //=============================================================================
 
 
+/*
+* SV_DownloadBlockData
+* 
+* Returns the file contents at offset, either straight from the memory-mapped file
+* or from the read-ahead buffer, which is refilled a whole window at a time
+*/
+static const uint8_t *SV_DownloadBlockData( client_t *client, int offset, int blocksize )
+{
+	client_download_t *dl = &client->download;
+
+	if( dl->data )
+		return dl->data + offset;
+
+	if( offset < dl->readaheadOffset || offset + blocksize > dl->readaheadOffset + dl->readaheadSize )
+	{
+		if( !dl->readahead )
+			dl->readahead = Mem_ZoneMalloc( DOWNLOAD_WINDOW_BLOCKS * DOWNLOAD_BLOCK_SIZE );
+
+		dl->readaheadOffset = offset;
+		dl->readaheadSize = min( dl->size - offset, DOWNLOAD_WINDOW_BLOCKS * DOWNLOAD_BLOCK_SIZE );
+		if( FS_Seek( dl->file, offset, FS_SEEK_SET ) < 0 )
+			dl->readaheadSize = 0;
+		else
+			dl->readaheadSize = max( FS_Read( dl->readahead, dl->readaheadSize, dl->file ), 0 );
+
+		if( offset + blocksize > dl->readaheadOffset + dl->readaheadSize )
+			return NULL;
+	}
+
+	return dl->readahead + offset - dl->readaheadOffset;
+}
+
+/*
+* SV_RestartDownloadWindow
+*/
+static void SV_RestartDownloadWindow( client_t *client, int offset )
+{
+	client_download_t *dl = &client->download;
+
+	dl->base = offset;
+	dl->next = 0;
+	dl->acked = 0;
+	dl->cwnd = 4;
+	dl->ssthresh = DOWNLOAD_WINDOW_BLOCKS;
+	dl->cwndcount = 0;
+	dl->budget = DOWNLOAD_BLOCK_SIZE;
+	dl->lastSendTime = svs.realtime;
+	dl->lastLossTime = 0;
+	dl->timeout = svs.realtime + 10000;
+}
+
+/*
+* SV_SendDownloadBlock
+* 
+* Sends the block at given index past the window base in its own unreliable message.
+* Returns the message size or -1 on error.
+*/
+static int SV_SendDownloadBlock( client_t *client, int index )
+{
+	client_download_t *dl = &client->download;
+	int offset, blocksize;
+	const uint8_t *data;
+
+	offset = dl->base + index * DOWNLOAD_BLOCK_SIZE;
+	blocksize = min( dl->size - offset, DOWNLOAD_BLOCK_SIZE );
+
+	data = SV_DownloadBlockData( client, offset, blocksize );
+	if( !data )
+	{
+		Com_Printf( "Error reading %s for uploading\n", dl->name );
+		return -1;
+	}
+
+	// reliable commands are left to the regular client messages, so
+	// that the block always fits in a single packet
+	SV_InitClientMessage( client, &tmpMessage, NULL, 0 );
+	MSG_WriteByte( &tmpMessage, svc_download );
+	MSG_WriteString( &tmpMessage, dl->name );
+	MSG_WriteLong( &tmpMessage, offset );
+	MSG_WriteLong( &tmpMessage, blocksize );
+	MSG_CopyData( &tmpMessage, data, blocksize );
+	if( !SV_SendMessageToClient( client, &tmpMessage ) )
+	{
+		Com_Printf( "Error sending download block to %s: %s\n", client->name, NET_ErrorString() );
+		return -1;
+	}
+
+	dl->sendTime[index] = svs.realtime;
+	return tmpMessage.cursize;
+}
+
+/*
+* SV_SendDownloadWindow
+* 
+* Sends new and lost blocks of a windowed download, paced by the client's rate.
+* Every message sent to the client is charged to the same budget, so the download
+* only takes the bandwidth the snapshots leave.
+* The window follows slow start and additive increase, and is halved on loss.
+*/
+static void SV_SendDownloadWindow( client_t *client )
+{
+	client_download_t *dl = &client->download;
+	int i, rate, window, numblocks, rto;
+	unsigned int elapsed, age;
+
+	// refill the budget at the client's rate, allowing bursts of up to 100ms,
+	// and let a burst of other messages hold the download back for a second at most
+	rate = client->rate;
+	if( sv_maxrate->integer && rate > sv_maxrate->integer )
+		rate = sv_maxrate->integer;
+
+	elapsed = min( svs.realtime - dl->lastSendTime, 1000 );
+	dl->lastSendTime = svs.realtime;
+	dl->budget = max( dl->budget, -rate );
+	dl->budget = min( dl->budget + (int)( rate * elapsed / 1000 ), max( rate / 10, 2 * DOWNLOAD_BLOCK_SIZE ) );
+
+	// don't clobber a fragmented message that's still being sent
+	if( client->netchan.unsentFragments )
+		return;
+
+	// an empty block completes downloads resumed at the end of the file
+	numblocks = max( ( dl->size - dl->base + DOWNLOAD_BLOCK_SIZE - 1 ) / DOWNLOAD_BLOCK_SIZE, 1 );
+	rto = max( 2 * client->ping + 100, 200 );
+
+	while( dl->budget > 0 )
+	{
+		// resend the oldest block that timed out or that later blocks overtook
+		for( i = 0; i < dl->next; i++ )
+		{
+			if( dl->acked & ( 1u << i ) )
+				continue;
+			age = svs.realtime - dl->sendTime[i];
+			if( age >= (unsigned)rto || ( ( dl->acked >> i ) && age >= (unsigned)rto / 2 ) )
+				break;
+		}
+
+		if( i < dl->next )
+		{
+			if( svs.realtime - dl->lastLossTime >= (unsigned)rto )
+			{
+				dl->ssthresh = max( dl->cwnd / 2, 2 );
+				dl->cwnd = dl->ssthresh;
+				dl->cwndcount = 0;
+				dl->lastLossTime = svs.realtime;
+			}
+		}
+		else
+		{
+			window = min( dl->cwnd, sv_uploads_window->integer );
+			window = min( window, min( numblocks, DOWNLOAD_WINDOW_BLOCKS ) );
+			if( dl->next >= window )
+				break;
+			i = dl->next++;
+		}
+
+		// SV_SendMessageToClient charges the block to the budget
+		if( SV_SendDownloadBlock( client, i ) < 0 )
+		{
+			SV_ClientCloseDownload( client );
+			return;
+		}
+	}
+}
+
+/*
+* SV_SendClientDownloads
+*/
+void SV_SendClientDownloads( void )
+{
+	int i;
+	client_t *client;
+
+	for( i = 0, client = svs.clients; i < sv_maxclients->integer; i++, client++ )
+	{
+		if( client->state == CS_FREE || client->state == CS_ZOMBIE )
+			continue;
+		if( !client->download.windowed || !client->download.file )
+			continue;
+
+		SV_SendDownloadWindow( client );
+	}
+}
+
+/*
+* SV_DownloadAck_f
+* 
+* Acknowledges all data of a windowed download up to given offset,
+* plus a bitmask of the blocks the client has already received past it
+*/
+static void SV_DownloadAck_f( client_t *client )
+{
+	client_download_t *dl = &client->download;
+	int i, offset, shift, newacks;
+	unsigned int mask;
+
+	if( !dl->name || !dl->windowed || !dl->file )
+		return;
+
+	if( Q_stricmp( dl->name, Cmd_Argv( 1 ) ) )
+	{
+		Com_Printf( "dlack message for wrong filename, from: %s\n", client->name );
+		return;
+	}
+
+	offset = atoi( Cmd_Argv( 2 ) );
+	mask = strtoul( Cmd_Argv( 3 ), NULL, 10 );
+
+	// ignore stale acks from before a restart or reordered acks
+	if( offset < dl->base || offset > dl->size )
+		return;
+	if( offset < dl->size && ( offset - dl->base ) % DOWNLOAD_BLOCK_SIZE )
+		return;
+
+	shift = ( offset - dl->base + DOWNLOAD_BLOCK_SIZE - 1 ) / DOWNLOAD_BLOCK_SIZE;
+	if( shift > dl->next )
+		return;
+
+	// slide the window
+	newacks = 0;
+	for( i = 0; i < shift; i++ )
+	{
+		if( !( dl->acked & ( 1u << i ) ) )
+			newacks++;
+	}
+
+	if( shift )
+	{
+		dl->acked = shift < DOWNLOAD_WINDOW_BLOCKS ? dl->acked >> shift : 0;
+		dl->next -= shift;
+		memmove( dl->sendTime, dl->sendTime + shift, dl->next * sizeof( dl->sendTime[0] ) );
+		dl->base = offset;
+	}
+
+	// selective acks, only for blocks we have actually sent
+	if( dl->next < DOWNLOAD_WINDOW_BLOCKS )
+		mask &= ( 1u << dl->next ) - 1;
+	for( i = 0; i < dl->next; i++ )
+	{
+		if( ( mask & ~dl->acked ) & ( 1u << i ) )
+			newacks++;
+	}
+	dl->acked |= mask;
+
+	// slow start, then additive increase
+	for( ; newacks > 0; newacks-- )
+	{
+		if( dl->cwnd < dl->ssthresh )
+			dl->cwnd++;
+		else if( ++dl->cwndcount >= dl->cwnd )
+		{
+			dl->cwnd++;
+			dl->cwndcount = 0;
+		}
+	}
+	dl->cwnd = min( dl->cwnd, DOWNLOAD_WINDOW_BLOCKS );
+
+	dl->timeout = svs.realtime + 10000;
+}
+
 /*
 * SV_NextDownload_f
 * 
 * Responds to reliable nextdl packet with unreliable download packet
 * If nextdl packet's offet information is negative, download will be stopped
+* For windowed downloads, nextdl (re)starts the window at given offset
 */
 static void SV_NextDownload_f( client_t *client )
 {
 	int blocksize;
 	int offset;
-	uint8_t data[FRAGMENT_SIZE*2];
+	const uint8_t *data;
 
 	if( !client->download.name )
 	{
@@ -586,24 +852,27 @@ static void SV_NextDownload_f( client_t *client )
 			SV_ClientCloseDownload( client );
 			return;
 		}
+
+		// falls back to the read-ahead buffer if the file can't be mapped
+		client->download.data = FS_MMapBaseFile( client->download.file, client->download.size, 0 );
+	}
+
+	if( client->download.windowed )
+	{
+		SV_RestartDownloadWindow( client, offset );
+		return;
 	}
 
 	SV_InitClientMessage( client, &tmpMessage, NULL, 0 );
 	SV_AddReliableCommandsToMessage( client, &tmpMessage );
 
-	blocksize = client->download.size - offset;
-	// jalfixme: adapt download to user rate setting and sv_maxrate setting.
-	if( blocksize > sizeof( data ) )
-		blocksize = sizeof( data );
-	if( offset + blocksize > client->download.size )
-		blocksize = client->download.size - offset;
-	if( blocksize < 0 )
-		blocksize = 0;
-
+	blocksize = min( client->download.size - offset, FRAGMENT_SIZE*2 );
+	data = NULL;
 	if( blocksize > 0 )
 	{
-		FS_Seek( client->download.file, offset, FS_SEEK_SET );
-		blocksize = FS_Read( data, blocksize, client->download.file );
+		data = SV_DownloadBlockData( client, offset, blocksize );
+		if( !data )
+			blocksize = 0;
 	}
 
 	MSG_WriteByte( &tmpMessage, svc_download );
@@ -699,6 +968,7 @@ static bool SV_FilenameForDownloadRequest( const char *requestname, bool request
 /*
 * SV_BeginDownload_f
 * Responds to reliable download packet with reliable initdownload packet
+* Old clients ignore the trailing windowed download flag of initdownload
 */
 static void SV_BeginDownload_f( client_t *client )
 {
@@ -783,6 +1053,9 @@ static void SV_BeginDownload_f( client_t *client )
 	client->download.name = Mem_ZoneMalloc( alloc_size );
 	Q_strncpyz( client->download.name, uploadname, alloc_size );
 
+	// clients that understand windowed downloads advertise it after the file name
+	client->download.windowed = atoi( Cmd_Argv( 3 ) ) > 0 && sv_uploads_window->integer > 0;
+
 	Com_Printf( "Offering %s to %s\n", client->download.name, client->name );
 
 	if( FS_CheckPakExtension( uploadname ) && ( local_http || sv_uploads_baseurl->string[0] != 0 ) )
@@ -824,8 +1097,8 @@ local_download:
 
 	// start the download
 	SV_InitClientMessage( client, &tmpMessage, NULL, 0 );
-	SV_SendServerCommand( client, "initdownload \"%s\" %i %u %i \"%s\"", client->download.name,
-		client->download.size, checksum, local_http ? 1 : 0, ( url ? url : "" ) );
+	SV_SendServerCommand( client, "initdownload \"%s\" %i %u %i \"%s\" %i", client->download.name,
+		client->download.size, checksum, local_http ? 1 : 0, ( url ? url : "" ), client->download.windowed ? 1 : 0 );
 	SV_AddReliableCommandsToMessage( client, &tmpMessage );
 	SV_SendMessageToClient( client, &tmpMessage );
 
@@ -963,6 +1236,7 @@ ucmd_t ucmds[] =
 
 	{ "download", SV_BeginDownload_f },
 	{ "nextdl", SV_NextDownload_f },
+	{ "dlack", SV_DownloadAck_f },
 
 	// server demo downloads
 	{ "demolist", SV_DemoList_f },
@@ -491,6 +491,11 @@ void SV_InitGameProgs( void )
 	import.CM_LeafArea = PF_CM_LeafArea;
 
 	import.Milliseconds = Sys_Milliseconds;
+	import.Microseconds = Sys_Microseconds;
+
+	import.ProfileZone = Com_ProfileZone;
+	import.ProfileBegin = Com_ProfileBegin;
+	import.ProfileEnd = Com_ProfileEnd;
 
 	import.ModelIndex = SV_ModelIndex;
 	import.SoundIndex = SV_SoundIndex;
@@ -591,5 +596,5 @@ void SV_InitGameProgs( void )
 
 	SV_SetServerConfigStrings();
 
-	ge->Init( time( NULL ), svc.snapFrameTime, APP_PROTOCOL_VERSION, APP_DEMO_EXTENSION_STR );
+	ge->Init( svc.gameSeed ? svc.gameSeed : time( NULL ), svc.snapFrameTime, APP_PROTOCOL_VERSION, APP_DEMO_EXTENSION_STR );
 }
@@ -42,6 +42,7 @@ cvar_t *sv_uploads_http;
 cvar_t *sv_uploads_baseurl;
 cvar_t *sv_uploads_demos;
 cvar_t *sv_uploads_demos_baseurl;
+cvar_t *sv_uploads_window;
 
 cvar_t *sv_pure;
 cvar_t *sv_pure_forcemodulepk3;
@@ -75,6 +76,8 @@ cvar_t *sv_defaultmap;
 cvar_t *sv_whitelist;
 
 cvar_t *sv_iplimit;
+cvar_t *sv_ooblimit;
+cvar_t *sv_ooblimit_burst;
 
 cvar_t *sv_reconnectlimit; // minimum seconds between connect messages
 
@@ -82,6 +85,7 @@ cvar_t *sv_reconnectlimit; // minimum seconds between connect messages
 
 cvar_t *sv_maxrate;
 cvar_t *sv_compresspackets;
+cvar_t *sv_compactsnaps;
 cvar_t *sv_masterservers;
 cvar_t *sv_masterservers_steam;
 cvar_t *sv_skilllevel;
@@ -99,6 +103,16 @@ cvar_t *sv_lastAutoUpdate;
 cvar_t *sv_demodir;
 cvar_t *sv_useSteamAuth;
 
+// profiler zones
+static int sv_zone_readpackets;
+static int sv_zone_rungameframe;
+static int sv_zone_gameframe;
+static int sv_zone_sendclientmessages;
+static int sv_zone_demowritesnap;
+static int sv_zone_racedemowritesnap;
+static int sv_zone_mmframe;
+static int sv_zone_webgameframe;
+
 //============================================================================
 
 /*
@@ -500,7 +514,7 @@ static bool SV_RunGameFrame( int msec )
 	}
 
 	// if there aren't pending packets to be sent, we can sleep
-	if( dedicated->integer && !sentFragments && !refreshSnapshot )
+	if( dedicated->integer && !sentFragments && !refreshSnapshot && !svs.bench.active )
 	{
 		int sleeptime = min( WORLDFRAMETIME - ( accTime + 1 ), sv.nextSnapTime - ( svs.gametime + 1 ) );
 
@@ -550,7 +564,9 @@ static bool SV_RunGameFrame( int msec )
 		if( host_speeds->integer )
 			time_before_game = Sys_Milliseconds();
 
+		Com_ProfileBegin( sv_zone_gameframe );
 		ge->RunFrame( moduleTime, svs.gametime );
+		Com_ProfileEnd( sv_zone_gameframe );
 
 		if( host_speeds->integer )
 			time_after_game = Sys_Milliseconds();
@@ -678,6 +694,7 @@ static void SV_CheckMatchUUID( void )
 void SV_Frame( int realmsec, int gamemsec )
 {
 	const unsigned int wrappingPoint = 0x70000000;
+	bool gameFrame;
 
 	time_before_game = time_after_game = 0;
 
@@ -703,27 +720,41 @@ void SV_Frame( int realmsec, int gamemsec )
 	SV_CheckTimeouts();
 
 	// get packets from clients
+	Com_ProfileBegin( sv_zone_readpackets );
 	SV_ReadPackets();
+	Com_ProfileEnd( sv_zone_readpackets );
 
 	// apply latched userinfo changes
 	SV_CheckLatchedUserinfoChanges();
 
 	// let everything in the world think and move
-	if( SV_RunGameFrame( gamemsec ) )
+	Com_ProfileBegin( sv_zone_rungameframe );
+	gameFrame = SV_RunGameFrame( gamemsec );
+	Com_ProfileEnd( sv_zone_rungameframe );
+
+	if( gameFrame )
 	{
 		// send messages back to the clients that had packets read this frame
+		Com_ProfileBegin( sv_zone_sendclientmessages );
 		SV_SendClientMessages();
+		Com_ProfileEnd( sv_zone_sendclientmessages );
 
 		// write snap to server demo file
+		Com_ProfileBegin( sv_zone_demowritesnap );
 		SV_Demo_WriteSnap();
+		Com_ProfileEnd( sv_zone_demowritesnap );
 
 		// write snap to client demo files
+		Com_ProfileBegin( sv_zone_racedemowritesnap );
 		SV_RaceDemo_WriteSnap();
+		Com_ProfileEnd( sv_zone_racedemowritesnap );
 
 		// run matchmaker stuff
 		SV_CheckMatchUUID();
 
+		Com_ProfileBegin( sv_zone_mmframe );
 		SV_MM_Frame();
+		Com_ProfileEnd( sv_zone_mmframe );
 
 		SV_Steam_RunFrame();
 
@@ -734,14 +765,54 @@ void SV_Frame( int realmsec, int gamemsec )
 		ge->ClearSnap();
 	}
 
+	// pace out windowed downloads
+	SV_SendClientDownloads();
+
 	// handle HTTP connections
+	Com_ProfileBegin( sv_zone_webgameframe );
 	SV_Web_GameFrame( ge->WebRequest );
+	Com_ProfileEnd( sv_zone_webgameframe );
 
 	SV_CheckAutoUpdate();
 
 	SV_CheckPostUpdateRestart();
 }
 
+/*
+* SV_BenchmarkFrame
+*
+* The game and snapshot half of SV_Frame, without reading packets, timeouts or any
+* of the periodic housekeeping, for the serverbenchmark command. Returns true if
+* snapshots were sent
+*/
+bool SV_BenchmarkFrame( int msec )
+{
+	bool gameFrame;
+	uint64_t start;
+
+	svs.realtime += msec;
+	svs.gametime += msec;
+
+	SV_CheckLatchedUserinfoChanges();
+
+	start = Sys_Microseconds();
+	Com_ProfileBegin( sv_zone_rungameframe );
+	gameFrame = SV_RunGameFrame( msec );
+	Com_ProfileEnd( sv_zone_rungameframe );
+	svs.bench.gameTime += Sys_Microseconds() - start;
+
+	if( gameFrame )
+	{
+		Com_ProfileBegin( sv_zone_sendclientmessages );
+		SV_SendClientMessages();
+		Com_ProfileEnd( sv_zone_sendclientmessages );
+
+		ge->ClearSnap();
+	}
+
+	return gameFrame;
+}
+
 //============================================================================
 
 /*
@@ -896,6 +967,7 @@ void SV_Init( void )
 	sv_uploads_baseurl =	Cvar_Get( "sv_uploads_baseurl", "", CVAR_ARCHIVE );
 	sv_uploads_demos =	    Cvar_Get( "sv_uploads_demos", "1", CVAR_ARCHIVE );
 	sv_uploads_demos_baseurl =	Cvar_Get( "sv_uploads_demos_baseurl", "", CVAR_ARCHIVE );
+	sv_uploads_window =	    Cvar_Get( "sv_uploads_window", va( "%i", DOWNLOAD_WINDOW_BLOCKS ), CVAR_ARCHIVE );
 	if( dedicated->integer )
 	{
 		sv_autoUpdate = Cvar_Get( "sv_autoUpdate", "1", CVAR_ARCHIVE );
@@ -920,6 +992,8 @@ void SV_Init( void )
 	sv_whitelist = Cvar_Get( "sv_whitelist", "", CVAR_ARCHIVE );
 
 	sv_iplimit = Cvar_Get( "sv_iplimit", "3", CVAR_ARCHIVE );
+	sv_ooblimit = Cvar_Get( "sv_ooblimit", "10", CVAR_ARCHIVE );
+	sv_ooblimit_burst = Cvar_Get( "sv_ooblimit_burst", "20", CVAR_ARCHIVE );
 
 	sv_lastAutoUpdate = Cvar_Get( "sv_lastAutoUpdate", "0", CVAR_READONLY|CVAR_ARCHIVE );
 	sv_pure_forcemodulepk3 =    Cvar_Get( "sv_pure_forcemodulepk3", "", CVAR_LATCH );
@@ -948,6 +1022,7 @@ void SV_Init( void )
 	// wsw : jal : cap client's exceding server rules
 	sv_maxrate =		    Cvar_Get( "sv_maxrate", "0", CVAR_DEVELOPER );
 	sv_compresspackets =	    Cvar_Get( "sv_compresspackets", "1", CVAR_DEVELOPER );
+	sv_compactsnaps =	    Cvar_Get( "sv_compactsnaps", "0", CVAR_ARCHIVE );
 	sv_skilllevel =		    Cvar_Get( "sv_skilllevel", "2", CVAR_SERVERINFO|CVAR_ARCHIVE|CVAR_LATCH );
 
 	if( sv_skilllevel->integer > 2 )
@@ -1005,6 +1080,15 @@ void SV_Init( void )
 
 	ML_Init();
 
+	sv_zone_readpackets = Com_ProfileZone( "SV_ReadPackets" );
+	sv_zone_rungameframe = Com_ProfileZone( "SV_RunGameFrame" );
+	sv_zone_gameframe = Com_ProfileZone( "G_RunFrame" );
+	sv_zone_sendclientmessages = Com_ProfileZone( "SV_SendClientMessages" );
+	sv_zone_demowritesnap = Com_ProfileZone( "SV_Demo_WriteSnap" );
+	sv_zone_racedemowritesnap = Com_ProfileZone( "SV_RaceDemo_WriteSnap" );
+	sv_zone_mmframe = Com_ProfileZone( "SV_MM_Frame" );
+	sv_zone_webgameframe = Com_ProfileZone( "SV_Web_GameFrame" );
+
 	SV_Web_Init();
 
 	if (Steam_Active()) {
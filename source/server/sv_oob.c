@@ -451,6 +451,145 @@ static char *SV_ShortInfoString( void )
 	return string;
 }
 
+/*
+* Info string cache
+*
+* Server browsers and master list scrapers poll getinfo/getstatus constantly,
+* so the strings are only rebuilt when the cvars, the map or the clients they
+* are made of changed. The check itself runs at most once per server frame.
+*/
+#define SV_INFOCACHE_SHORTINFO		0
+#define SV_INFOCACHE_INFO			1
+#define SV_INFOCACHE_STATUS			2
+#define SV_INFOCACHE_TOTAL			3
+
+typedef struct
+{
+	bool valid;
+	unsigned int realtime;
+	unsigned int cvarModCount;
+	int spawncount;
+	unsigned int clientsHash;
+	int numClients;
+	size_t length;
+	char string[MAX_MSGLEN - 16];
+} sv_infocache_t;
+
+static sv_infocache_t sv_infoCache[SV_INFOCACHE_TOTAL];
+
+/*
+* SV_InfoCacheHash
+*/
+static unsigned int SV_InfoCacheHash( unsigned int hash, const void *data, size_t size )
+{
+	const uint8_t *p = ( const uint8_t * )data;
+
+	while( size-- )
+	{
+		hash ^= *p++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/*
+* SV_InfoCacheClientsHash
+* Hashes what the cached strings show of the connected clients
+*/
+static unsigned int SV_InfoCacheClientsHash( bool fullStatus, int *numClients )
+{
+	int i, count = 0;
+	int values[4];
+	unsigned int hash = 2166136261u;
+	client_t *cl;
+
+	for( i = 0, cl = svs.clients; i < sv_maxclients->integer; i++, cl++ )
+	{
+		if( cl->state < CS_CONNECTED )
+			continue;
+
+		count++;
+		values[0] = i;
+		values[1] = ( cl->edict->r.svflags & SVF_FAKECLIENT ) || cl->tvclient;
+		hash = SV_InfoCacheHash( hash, values, 2 * sizeof( int ) );
+
+		if( fullStatus )
+		{
+			values[0] = cl->edict->r.client->r.frags;
+			values[1] = cl->ping;
+			values[2] = cl->edict->s.team;
+			hash = SV_InfoCacheHash( hash, values, 3 * sizeof( int ) );
+			hash = SV_InfoCacheHash( hash, cl->name, strlen( cl->name ) );
+		}
+	}
+
+	*numClients = count;
+	return hash;
+}
+
+/*
+* SV_CachedInfoString
+*/
+static sv_infocache_t *SV_CachedInfoString( int type )
+{
+	sv_infocache_t *cache = &sv_infoCache[type];
+	unsigned int clientsHash;
+	int numClients;
+	const char *string;
+
+	if( cache->valid && cache->realtime == svs.realtime )
+		return cache;
+
+	clientsHash = SV_InfoCacheClientsHash( type == SV_INFOCACHE_STATUS, &numClients );
+	cache->realtime = svs.realtime;
+
+	if( cache->valid && cache->cvarModCount == cvar_modcount && cache->spawncount == svs.spawncount
+		&& cache->clientsHash == clientsHash )
+		return cache;
+
+	if( type == SV_INFOCACHE_SHORTINFO )
+		string = SV_ShortInfoString();
+	else
+		string = SV_LongInfoString( type == SV_INFOCACHE_STATUS );
+
+	Q_strncpyz( cache->string, string, sizeof( cache->string ) );
+	cache->length = strlen( cache->string );
+	cache->cvarModCount = cvar_modcount;
+	cache->spawncount = svs.spawncount;
+	cache->clientsHash = clientsHash;
+	cache->numClients = numClients;
+	cache->valid = true;
+
+	return cache;
+}
+
+/*
+* SV_SendCachedInfoString
+* Sends header, challenge and the cached string as one out-of-band packet
+*/
+static void SV_SendCachedInfoString( const socket_t *socket, const netadr_t *address, const char *header,
+	const char *challenge, const sv_infocache_t *cache )
+{
+	uint8_t packet[MAX_PACKETLEN - 4];
+	size_t length = 0, size;
+	const char *parts[3];
+	int i;
+
+	parts[0] = header;
+	parts[1] = challenge;
+	parts[2] = cache->string;
+
+	for( i = 0; i < 3 && length < sizeof( packet ); i++ )
+	{
+		size = ( i == 2 ) ? cache->length : strlen( parts[i] );
+		size = min( size, sizeof( packet ) - length );
+		memcpy( packet + length, parts[i], size );
+		length += size;
+	}
+
+	Netchan_OutOfBand( socket, address, length, packet );
+}
+
 
 
 //==============================================================================
@@ -487,7 +626,7 @@ static void SVC_Ping( const socket_t *socket, const netadr_t *address )
 static void SVC_InfoResponse( const socket_t *socket, const netadr_t *address )
 {
 	int i, count;
-	char *string;
+	sv_infocache_t *cache;
 	bool allow_empty = false, allow_full = false;
 
 	if( sv_showInfoQueries->integer )
@@ -523,14 +662,8 @@ static void SVC_InfoResponse( const socket_t *socket, const netadr_t *address )
 			allow_empty = true;
 	}
 
-	count = 0;
-	for( i = 0; i < sv_maxclients->integer; i++ )
-	{
-		if( svs.clients[i].state >= CS_CONNECTED )
-		{
-			count++;
-		}
-	}
+	cache = SV_CachedInfoString( SV_INFOCACHE_SHORTINFO );
+	count = cache->numClients;
 
 	if( ( count == sv_maxclients->integer ) && !allow_full )
 	{
@@ -542,17 +675,16 @@ static void SVC_InfoResponse( const socket_t *socket, const netadr_t *address )
 		return;
 	}
 
-	string = SV_ShortInfoString();
-	if( string )
-		Netchan_OutOfBandPrint( socket, address, "info\n%s", string );
+	SV_SendCachedInfoString( socket, address, "info\n", "", cache );
 }
 
 /*
 * SVC_SendInfoString
 */
-static void SVC_SendInfoString( const socket_t *socket, const netadr_t *address, const char *requestType, const char *responseType, bool fullStatus )
+static void SVC_SendInfoString( const socket_t *socket, const netadr_t *address, const char *requestType, const char *responseType,
+	const char *challenge, bool fullStatus )
 {
-	char *string;
+	char header[64];
 
 	if( sv_showInfoQueries->integer )
 		Com_Printf( "%s Packet %s\n", requestType, NET_AddressToString( address ) );
@@ -574,9 +706,9 @@ static void SVC_SendInfoString( const socket_t *socket, const netadr_t *address,
 	//	return;
 
 	// send the same string that we would give for a status OOB command
-	string = SV_LongInfoString( fullStatus );
-	if( string )
-		Netchan_OutOfBandPrint( socket, address, "%s\n\\challenge\\%s%s", responseType, Cmd_Argv( 1 ), string );
+	Q_snprintfz( header, sizeof( header ), "%s\n\\challenge\\", responseType );
+	SV_SendCachedInfoString( socket, address, header, challenge,
+		SV_CachedInfoString( fullStatus ? SV_INFOCACHE_STATUS : SV_INFOCACHE_INFO ) );
 }
 
 /*
@@ -584,7 +716,7 @@ static void SVC_SendInfoString( const socket_t *socket, const netadr_t *address,
 */
 static void SVC_GetInfoResponse( const socket_t *socket, const netadr_t *address )
 {
-	SVC_SendInfoString( socket, address, "GetInfo", "infoResponse", false );
+	SVC_SendInfoString( socket, address, "GetInfo", "infoResponse", Cmd_Argv( 1 ), false );
 }
 
 /*
@@ -592,7 +724,53 @@ static void SVC_GetInfoResponse( const socket_t *socket, const netadr_t *address
 */
 static void SVC_GetStatusResponse( const socket_t *socket, const netadr_t *address )
 {
-	SVC_SendInfoString( socket, address, "GetStatus", "statusResponse", true );
+	SVC_SendInfoString( socket, address, "GetStatus", "statusResponse", Cmd_Argv( 1 ), true );
+}
+
+/*
+* SVC_FastInfoQuery
+* 
+* Answers plain "getinfo <challenge>" and "getstatus <challenge>" packets
+* without going through the command tokenizer. Anything else, including
+* quoted challenges, is left to SV_ConnectionlessPacket.
+*/
+static bool SVC_FastInfoQuery( const socket_t *socket, const netadr_t *address, const char *s )
+{
+	char challenge[64];
+	size_t len;
+	bool fullStatus;
+
+	if( !strncmp( s, "getinfo", 7 ) && (unsigned char)s[7] <= ' ' )
+	{
+		fullStatus = false;
+		s += 7;
+	}
+	else if( !strncmp( s, "getstatus", 9 ) && (unsigned char)s[9] <= ' ' )
+	{
+		fullStatus = true;
+		s += 9;
+	}
+	else
+	{
+		return false;
+	}
+
+	// tokens end at any control character or space, as with COM_Parse
+	while( *s && (unsigned char)*s <= ' ' )
+		s++;
+
+	for( len = 0; (unsigned char)s[len] > ' '; len++ );
+	if( len >= sizeof( challenge ) || strcspn( s, "\"\\/" ) < len )
+		return false;
+
+	memcpy( challenge, s, len );
+	challenge[len] = '\0';
+
+	if( fullStatus )
+		SVC_SendInfoString( socket, address, "GetStatus", "statusResponse", challenge, true );
+	else
+		SVC_SendInfoString( socket, address, "GetInfo", "infoResponse", challenge, false );
+	return true;
 }
 
 
@@ -658,7 +836,8 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 	int session_id;
 	char *session_id_str;
 	unsigned int ticket_id;
-	bool tv_client;
+	bool tv_client, compact_snaps;
+	int connect_flags;
 	unsigned int time;
 	char* steam_ticket;
 
@@ -683,7 +862,9 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 
 	game_port = atoi( Cmd_Argv( 2 ) );
 	challenge = atoi( Cmd_Argv( 3 ) );
-	tv_client = ( atoi( Cmd_Argv( 5 ) ) & 1 ? true : false );
+	connect_flags = atoi( Cmd_Argv( 5 ) );
+	tv_client = ( connect_flags & CONNECT_FLAG_TVCLIENT ? true : false );
+	compact_snaps = ( connect_flags & CONNECT_FLAG_COMPACTSNAPS ) && sv_compactsnaps->integer ? true : false;
 
 	if( !Info_Validate( Cmd_Argv( 4 ) ) )
 	{
@@ -873,6 +1054,8 @@ static void SVC_DirectConnect( const socket_t *socket, const netadr_t *address )
 		return;
 	}
 
+	newcl->compactSnaps = compact_snaps;
+
 	// send the connect packet to the client
 	Netchan_OutOfBandPrint( socket, address, "client_connect\n%s", newcl->session );
 
@@ -1307,6 +1490,85 @@ connectionless_cmd_t connectionless_cmds[] =
 	{ NULL, NULL }
 };
 
+/*
+* Connectionless packet rate limiting
+*
+* Every source address gets a token bucket of sv_ooblimit_burst info queries,
+* refilled at sv_ooblimit queries per second. The bucket is kept as the time
+* at which it would be full again, which needs a single value per address.
+* Addresses share a fixed number of slots, a colliding address simply takes
+* the slot over.
+*/
+#define OOB_RATELIMIT_SLOTS		1024
+
+typedef struct
+{
+	netadr_t address;
+	uint64_t fullTime;			// microseconds
+} sv_oobratelimit_t;
+
+static sv_oobratelimit_t sv_oobRateLimits[OOB_RATELIMIT_SLOTS];
+
+/*
+* SV_OOBRateLimited
+*/
+static bool SV_OOBRateLimited( const netadr_t *address )
+{
+	unsigned int hash;
+	uint64_t now, interval;
+	sv_oobratelimit_t *slot;
+
+	if( sv_ooblimit->value <= 0 )
+		return false;
+
+	if( address->type == NA_IP )
+		hash = SV_InfoCacheHash( 2166136261u, address->address.ipv4.ip, sizeof( address->address.ipv4.ip ) );
+	else if( address->type == NA_IP6 )
+		hash = SV_InfoCacheHash( 2166136261u, address->address.ipv6.ip, sizeof( address->address.ipv6.ip ) );
+	else
+		return false;
+
+	now = (uint64_t)svs.realtime * 1000;
+	interval = (uint64_t)( 1000000.0 / sv_ooblimit->value );
+
+	slot = &sv_oobRateLimits[hash & ( OOB_RATELIMIT_SLOTS - 1 )];
+	if( !NET_CompareBaseAddress( &slot->address, address ) )
+	{
+		slot->address = *address;
+		slot->fullTime = now;
+	}
+
+	if( slot->fullTime < now )
+		slot->fullTime = now;
+	if( slot->fullTime - now >= interval * max( sv_ooblimit_burst->integer, 1 ) )
+		return true;
+
+	slot->fullTime += interval;
+	return false;
+}
+
+/*
+* SV_OOBIsInfoQuery
+* 
+* Only info and status queries are rate limited, the challenge, connect and rcon
+* packets of several players or tools behind one address must all get through.
+*/
+static bool SV_OOBIsInfoQuery( const char *s )
+{
+	size_t len;
+
+	// steam server info and player queries
+	if( !strcmp( s, "TSource Engine Query" ) || s[0] == 'U' )
+		return true;
+
+	while( *s && (unsigned char)*s <= ' ' )
+		s++;
+	for( len = 0; (unsigned char)s[len] > ' '; len++ );
+
+	return ( len == 4 && !strncmp( s, "info", 4 ) ) || ( len == 7 && !strncmp( s, "getinfo", 7 ) ) 
+		|| ( len == 9 && !strncmp( s, "getstatus", 9 ) );
+}
+
 /*
 * SV_ConnectionlessPacket
 * 
@@ -1325,9 +1587,16 @@ void SV_ConnectionlessPacket( const socket_t *socket, const netadr_t *address, m
 
 	s = MSG_ReadStringLine( msg );
 
+	// drop query floods before building any reply
+	if( SV_OOBIsInfoQuery( s ) && SV_OOBRateLimited( address ) )
+		return;
+
 	if( SV_SteamServerQuery( s, socket, address, msg ) )
 		return;
 
+	if( SVC_FastInfoQuery( socket, address, s ) )
+		return;
+
 	Cmd_TokenizeString( s );
 
 	c = Cmd_Argv( 0 );
@@ -344,6 +344,8 @@ void SV_InitClientMessage( client_t *client, msg_t *msg, uint8_t *data, size_t s
 */
 bool SV_SendMessageToClient( client_t *client, msg_t *msg )
 {
+	bool sent;
+
 	assert( client );
 
 	if( client->edict && ( client->edict->r.svflags & SVF_FAKECLIENT ) )
@@ -351,7 +353,13 @@ bool SV_SendMessageToClient( client_t *client, msg_t *msg )
 
 	// transmit the message data
 	client->lastPacketSentTime = svs.realtime;
-	return SV_Netchan_Transmit( &client->netchan, msg );
+	sent = SV_Netchan_Transmit( &client->netchan, msg );
+
+	// windowed downloads get what the snapshots and other messages leave of the client's rate
+	if( client->download.windowed && client->download.file )
+		client->download.budget -= msg->cursize + 28; // UDP/IP header
+
+	return sent;
 }
 
 /*
@@ -379,7 +387,7 @@ void SV_ResetClientFrameCounters( void )
 void SV_WriteFrameSnapToClient( client_t *client, msg_t *msg )
 {
 	SNAP_WriteFrameSnapToClient( &sv.gi, client, msg, sv.framenum, svs.gametime, sv.baselines,
-		&svs.client_entities, 0, NULL, NULL );
+		&svs.client_entities, 0, NULL, NULL, NULL, &sv.deltacache );
 }
 
 /*
@@ -414,6 +422,9 @@ void SV_BuildClientFrameSnap( client_t *client )
 */
 static bool SV_SendClientDatagram( client_t *client )
 {
+	bool sent;
+	uint64_t start = 0, now;
+
 	if( client->edict && ( client->edict->r.svflags & SVF_FAKECLIENT ) )
 		return true;
 
@@ -421,13 +432,32 @@ static bool SV_SendClientDatagram( client_t *client )
 
 	SV_AddReliableCommandsToMessage( client, &tmpMessage );
 
+	if( svs.bench.active )
+		start = Sys_Microseconds();
+
 	// send over all the relevant entity_state_t
 	// and the player_state_t
 	SV_BuildClientFrameSnap( client );
 
+	if( svs.bench.active )
+	{
+		now = Sys_Microseconds();
+		svs.bench.buildTime += now - start;
+		start = now;
+	}
+
 	SV_WriteFrameSnapToClient( client, &tmpMessage );
 
-	return SV_SendMessageToClient( client, &tmpMessage );
+	sent = SV_SendMessageToClient( client, &tmpMessage );
+
+	if( svs.bench.active )
+	{
+		svs.bench.writeTime += Sys_Microseconds() - start;
+		svs.bench.bytes += tmpMessage.cursize;
+		svs.bench.snaps++;
+	}
+
+	return sent;
 }
 
 /*
@@ -438,6 +468,9 @@ void SV_SendClientMessages( void )
 	int i;
 	client_t *client;
 
+	// game commands may have changed entities since the last send of this frame
+	SNAP_ClearDeltaCache( &sv.deltacache );
+
 	// send a message to each connected client
 	for( i = 0, client = svs.clients; i < sv_maxclients->integer; i++, client++ )
 	{
@@ -155,6 +155,9 @@ static qbufPipe_t *sv_http_outgoing_queue;
 static qthread_t *sv_http_thread = NULL;
 static void *SV_Web_ThreadProc( void *param );
 
+static int sv_http_profile_zone;
+static unsigned int sv_http_busy_time;
+
 // ============================================================================
 
 /*
@@ -634,6 +637,7 @@ unsigned SV_Web_HandleOutQueryCmd( void *pcmd )
 		return sizeof( *cmd );
 	}
 
+	response->code = cmd->code ? cmd->code : HTTP_RESP_OK;
 	response->content = cmd->content;
 	response->content_length = cmd->content_length;
 	response->content_state = CONTENT_STATE_RECEIVED;
@@ -1083,6 +1087,23 @@ static void SV_Web_RouteRequest( const sv_http_request_t *request, sv_http_respo
 	if( !resource ) {
 		response->code = HTTP_RESP_BAD_REQUEST;
 	}
+	else if( !Q_stricmp( resource, "profile" ) ) {
+		// frame profiler percentiles, only served while com_profile is on
+		if( request->method != HTTP_METHOD_GET && request->method != HTTP_METHOD_HEAD ) {
+			response->code = HTTP_RESP_BAD_REQUEST;
+			return;
+		}
+
+		response->content = Com_ProfileStatsString( &response->content_length );
+		if( !response->content ) {
+			response->code = HTTP_RESP_NOT_FOUND;
+			return;
+		}
+
+		response->code = HTTP_RESP_OK;
+		*content = response->content;
+		*content_length = response->content_length;
+	}
 	else if( !Q_strnicmp( resource, "game/", 5 ) ) {
 		// request to game module
 		response->content_state = CONTENT_STATE_AWAITING;
@@ -1153,8 +1174,6 @@ static void SV_Web_RespondToQuery( sv_http_connection_t *con )
 	else if( response->content_state == CONTENT_STATE_RECEIVED ) {
 		content = response->content;
 		content_length = response->content_length;
-		
-		response->code = HTTP_RESP_OK;
 	}
 	else {
 		SV_Web_RouteRequest( request, response, &content, &content_length );
@@ -1483,9 +1502,32 @@ void SV_Web_Init( void )
 
 	Trie_Create( TRIE_CASE_SENSITIVE, &sv_http_clients );
 	sv_http_clients_mutex = QMutex_Create();
+	sv_http_profile_zone = Com_ProfileZone( "SV_Web_Frame" );
 	sv_http_thread = QThread_Create( SV_Web_ThreadProc, NULL );
 }
 
+/*
+* SV_Web_MonitorRecv
+*/
+static void SV_Web_MonitorRecv( socket_t *socket, void *con )
+{
+	uint64_t start = Sys_Microseconds();
+
+	SV_Web_ReceiveRequest( socket, con );
+	sv_http_busy_time += Sys_Microseconds() - start;
+}
+
+/*
+* SV_Web_MonitorSend
+*/
+static void SV_Web_MonitorSend( socket_t *socket, void *con )
+{
+	uint64_t start = Sys_Microseconds();
+
+	SV_Web_WriteResponse( socket, con );
+	sv_http_busy_time += Sys_Microseconds() - start;
+}
+
 /*
 * SV_Web_Frame
 */
@@ -1496,11 +1538,14 @@ static void SV_Web_Frame( void )
 	void *connections[MAX_INCOMING_HTTP_CONNECTIONS];
 	int num_sockets = 0;
 	bool upstream_is_set;
+	uint64_t frame_start, wait_end;
 
 	if( !sv_http_initialized ) {
 		return;
 	}
 
+	frame_start = Sys_Microseconds();
+
 	upstream_is_set = sv_http_upstream_ip->string[0] != '\0' && sv_http_upstream_baseurl->string[0] != '\0';
 	if( upstream_is_set )
 	{
@@ -1546,10 +1591,12 @@ static void SV_Web_Frame( void )
 	// read query results from the game module
 	SV_Web_ReadOutgoingQueueCmds();
 
+	// the profiler only gets the time spent working, not waiting on sockets
+	sv_http_busy_time = Sys_Microseconds() - frame_start;
+
 	if( num_sockets != 0 ) {
 		NET_Monitor( HTTP_SERVER_SLEEP_TIME, sockets,
-			(void (*)(socket_t *, void*))SV_Web_ReceiveRequest,
-			(void (*)(socket_t *, void*))SV_Web_WriteResponse,
+			SV_Web_MonitorRecv, SV_Web_MonitorSend,
 			NULL, connections );
 	}
 	else {
@@ -1564,6 +1611,8 @@ static void SV_Web_Frame( void )
 		NET_Sleep( HTTP_SERVER_SLEEP_TIME, sockets );
 	}
 
+	wait_end = Sys_Microseconds();
+
 	// close dead connections
 	for( con = hnode->prev; con != hnode; con = next )
 	{
@@ -1598,6 +1647,8 @@ static void SV_Web_Frame( void )
 			SV_Web_FreeConnection( con );
 		}
 	}
+
+	Com_ProfileAddTime( sv_http_profile_zone, frame_start, sv_http_busy_time + ( Sys_Microseconds() - wait_end ) );
 }
 
 /*
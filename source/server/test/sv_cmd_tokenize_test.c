@@ -0,0 +1,91 @@
+#include "../../qcommon/qcommon.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+static cmd_tokens_t tokens;
+
+void Com_Error( com_error_code_t code, const char *format, ... ){
+	assert_true( false );
+}
+
+void Com_Printf( const char *format, ... ){
+}
+
+void Sys_Error( const char *format, ... ){
+	assert_true( false );
+}
+
+// client commands are read with MSG_ReadString, so they can be longer than MAX_STRING_CHARS
+static void test_tokenize_long_client_command( void **state )
+{
+	char text[MAX_MSG_STRING_CHARS];
+	char arg[16];
+	size_t len;
+	int i;
+
+	len = Q_snprintfz( text, sizeof( text ), "cmd" );
+	for( i = 0; i < 200; i++ )
+		len += Q_snprintfz( text + len, sizeof( text ) - len, " arg%04i", i );
+	assert_true( len > MAX_STRING_CHARS && len < MAX_MSG_STRING_CHARS );
+
+	Cmd_TokenizeStringExt( &tokens, text );
+
+	assert_int_equal( tokens.argc, 201 );
+	assert_string_equal( tokens.argv[0], "cmd" );
+	for( i = 0; i < 200; i++ )
+	{
+		Q_snprintfz( arg, sizeof( arg ), "arg%04i", i );
+		assert_string_equal( tokens.argv[i + 1], arg );
+	}
+}
+
+static void test_tokenize_long_tokens( void **state )
+{
+	char text[MAX_MSG_STRING_CHARS];
+	const size_t toklen = MAX_TOKEN_CHARS - 100;
+
+	// two tokens just under MAX_TOKEN_CHARS followed by a short one
+	memset( text, 'a', toklen );
+	text[toklen] = ' ';
+	memset( text + toklen + 1, 'b', toklen );
+	strcpy( text + 2 * toklen + 1, " tail" );
+
+	Cmd_TokenizeStringExt( &tokens, text );
+
+	assert_int_equal( tokens.argc, 3 );
+	assert_int_equal( strlen( tokens.argv[0] ), toklen );
+	assert_int_equal( strlen( tokens.argv[1] ), toklen );
+	assert_string_equal( tokens.argv[2], "tail" );
+}
+
+static void test_tokenize_excess_tokens( void **state )
+{
+	char text[MAX_MSG_STRING_CHARS];
+	size_t len = 0;
+	int i;
+
+	for( i = 0; i < MAX_STRING_TOKENS + 10; i++ )
+		len += Q_snprintfz( text + len, sizeof( text ) - len, "%i ", i % 10 );
+	strcpy( text + len, "\nnext" );
+
+	Cmd_TokenizeStringExt( &tokens, text );
+
+	// tokens past MAX_STRING_TOKENS are dropped, the command still ends at the newline
+	assert_int_equal( tokens.argc, MAX_STRING_TOKENS );
+	assert_string_equal( tokens.argv[MAX_STRING_TOKENS - 1], "5" );
+}
+
+int main( void )
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_tokenize_long_client_command ),
+		cmocka_unit_test( test_tokenize_long_tokens ),
+		cmocka_unit_test( test_tokenize_excess_tokens ),
+	};
+
+	return cmocka_run_group_tests( tests, NULL, NULL );
+}
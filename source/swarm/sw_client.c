@@ -0,0 +1,704 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// sw_client.c -- a single synthetic connection, mirrors the TV upstream handshake
+
+#include "sw_local.h"
+
+#define SW_UCMD_RESEND		3
+
+// the swarm never looks at the entities, so all clients share the same scratch baselines
+static entity_state_t sw_baselines[MAX_EDICTS];
+
+/*
+* SW_Client_ClearState
+*/
+static void SW_Client_ClearState( swclient_t *client )
+{
+	client->lastExecutedServerCommand = 0;
+	client->reliableAcknowledge = 0;
+	client->reliableSequence = 0;
+	client->reliableSent = 0;
+	memset( client->reliableCommands, 0, sizeof( client->reliableCommands ) );
+
+	client->lastPacketSentTime = 0;
+	client->lastUcmdTime = 0;
+
+	client->serverFrame = 0;
+	client->serverTime = 0;
+	client->serverTimeReceived = 0;
+	client->ucmdExecuted = 0;
+	client->ucmdAcknowledged = 0;
+	client->lastSnapUsec = 0;
+
+	client->cmdNum = 0;
+	memset( client->cmds, 0, sizeof( client->cmds ) );
+	memset( client->cmdSentUsec, 0, sizeof( client->cmdSentUsec ) );
+}
+
+/*
+* SW_Client_Userinfo
+*/
+static const char *SW_Client_Userinfo( swclient_t *client )
+{
+	static char userinfo[MAX_INFO_STRING];
+
+	userinfo[0] = '\0';
+	Info_SetValueForKey( userinfo, "name", va( "swarm%03i", client->number ) );
+	Info_SetValueForKey( userinfo, "password", sw_password->string );
+	Info_SetValueForKey( userinfo, "cl_download", "0" );
+
+	return userinfo;
+}
+
+/*
+* SW_Client_AddReliableCommand
+*/
+static void SW_Client_AddReliableCommand( swclient_t *client, const char *cmd )
+{
+	int index;
+
+	if( client->reliableSequence > MAX_RELIABLE_COMMANDS + client->reliableAcknowledge )
+	{
+		// so we don't get recursive error from disconnect commands
+		client->reliableAcknowledge = client->reliableSequence;
+		SW_Client_Disconnect( client, "Client command overflow" );
+		return;
+	}
+
+	client->reliableSequence++;
+	index = client->reliableSequence & ( MAX_RELIABLE_COMMANDS - 1 );
+	Q_strncpyz( client->reliableCommands[index], cmd, sizeof( client->reliableCommands[index] ) );
+}
+
+/*
+* SW_Client_WriteReliableCommands
+*/
+static void SW_Client_WriteReliableCommands( swclient_t *client, msg_t *msg )
+{
+	unsigned int i;
+
+	for( i = client->reliableAcknowledge + 1; i <= client->reliableSequence; i++ )
+	{
+		if( !strlen( client->reliableCommands[i & ( MAX_RELIABLE_COMMANDS - 1 )] ) )
+			continue;
+
+		MSG_WriteByte( msg, clc_clientcommand );
+		if( !client->reliable )
+			MSG_WriteLong( msg, i );
+		MSG_WriteString( msg, client->reliableCommands[i & ( MAX_RELIABLE_COMMANDS - 1 )] );
+	}
+
+	client->reliableSent = client->reliableSequence;
+	if( client->reliable )
+		client->reliableAcknowledge = client->reliableSent;
+}
+
+/*
+* SW_Client_Transmit
+*/
+static void SW_Client_Transmit( swclient_t *client, msg_t *msg )
+{
+	Netchan_PushAllFragments( &client->netchan );
+	Netchan_Transmit( &client->netchan, msg );
+
+	client->lastPacketSentTime = sws.realtime;
+	sws.stats.packetsOut++;
+	sws.stats.bytesOut += msg->cursize;
+}
+
+/*
+* SW_Client_NextUcmd
+*
+* Fills the next usercmd either from the recorded stream or with synthetic movement
+*/
+static void SW_Client_NextUcmd( swclient_t *client, usercmd_t *ucmd )
+{
+	unsigned int elapsed, stamp;
+
+	memset( ucmd, 0, sizeof( *ucmd ) );
+
+	if( sws.numreplay )
+	{
+		const usercmd_t *last = &sws.replay[sws.numreplay - 1];
+
+		// time driven, so the replay keeps its pace whatever sw_ucmdfps is
+		elapsed = sws.realtime - client->replayStart;
+		if( client->replayPos >= (unsigned)sws.numreplay - 1 && elapsed > last->serverTimeStamp )
+		{
+			client->replayStart = sws.realtime;
+			client->replayPos = 0;
+			elapsed = 0;
+		}
+		while( client->replayPos + 1 < (unsigned)sws.numreplay && sws.replay[client->replayPos + 1].serverTimeStamp <= elapsed )
+			client->replayPos++;
+
+		*ucmd = sws.replay[client->replayPos];
+	}
+	else
+	{
+		unsigned int t = sws.realtime + client->number * 777;
+
+		// run around in circles, strafing, jumping and shooting every now and then
+		ucmd->forwardmove = 1.0f;
+		ucmd->sidemove = ( ( t / 1500 ) & 1 ) ? 1.0f : -1.0f;
+		ucmd->upmove = ( t % 2000 ) < 100 ? 1.0f : 0.0f;
+		ucmd->angles[YAW] = ANGLE2SHORT( ( t % 7200 ) * 0.05f );
+		ucmd->buttons = ( t % 3000 ) < 500 ? BUTTON_ATTACK : 0;
+	}
+
+	if( ucmd->buttons || ucmd->forwardmove || ucmd->sidemove || ucmd->upmove )
+		ucmd->buttons |= BUTTON_ANY;
+
+	// the server derives msec from the timestamps, and won't run anything ahead of its own clock,
+	// so extrapolate from the last snap and never go backwards
+	stamp = client->serverTime + ( sws.realtime - client->serverTimeReceived );
+	if( stamp <= client->cmds[client->cmdNum & CMD_MASK].serverTimeStamp )
+		stamp = client->cmds[client->cmdNum & CMD_MASK].serverTimeStamp + 1;
+	ucmd->serverTimeStamp = stamp;
+	ucmd->msec = 1;
+}
+
+/*
+* SW_Client_WriteUcmdsToMessage
+*/
+static void SW_Client_WriteUcmdsToMessage( swclient_t *client, msg_t *msg )
+{
+	usercmd_t nullcmd;
+	unsigned int i, ucmdFirst, ucmdHead;
+
+	ucmdHead = client->cmdNum + 1;
+
+	// everything the server hasn't acknowledged, and always a few old ones against packet loss
+	ucmdFirst = client->ucmdAcknowledged + 1;
+	if( ucmdFirst + SW_UCMD_RESEND > ucmdHead )
+		ucmdFirst = ucmdHead > SW_UCMD_RESEND ? ucmdHead - SW_UCMD_RESEND : 1;
+	if( ucmdHead - ucmdFirst > CMD_MASK / 2 )
+		ucmdFirst = ucmdHead - CMD_MASK / 2;
+
+	MSG_WriteByte( msg, clc_move );
+	MSG_WriteLong( msg, client->serverFrame > 0 ? client->serverFrame : -1 );
+	MSG_WriteLong( msg, ucmdHead );
+	MSG_WriteByte( msg, (uint8_t)( ucmdHead - ucmdFirst ) );
+
+	memset( &nullcmd, 0, sizeof( nullcmd ) );
+	for( i = ucmdFirst; i < ucmdHead; i++ )
+	{
+		if( i == ucmdFirst )
+			MSG_WriteDeltaUsercmd( msg, &nullcmd, &client->cmds[i & CMD_MASK] );
+		else
+			MSG_WriteDeltaUsercmd( msg, &client->cmds[( i - 1 ) & CMD_MASK], &client->cmds[i & CMD_MASK] );
+	}
+}
+
+/*
+* SW_Client_SendMessages
+*/
+static void SW_Client_SendMessages( swclient_t *client, bool sendNow )
+{
+	msg_t message;
+	uint8_t messageData[MAX_MSGLEN];
+	bool ucmd = false;
+	int ucmdmsec;
+
+	if( client->state < CA_HANDSHAKE )
+		return;
+
+	MSG_Init( &message, messageData, sizeof( messageData ) );
+	MSG_Clear( &message );
+
+	ucmdmsec = sw_ucmdfps->integer > 0 ? 1000 / sw_ucmdfps->integer : 16;
+	if( client->state == CA_ACTIVE && ( sendNow || sws.realtime >= client->lastUcmdTime + ucmdmsec ) )
+	{
+		usercmd_t *cmd;
+
+		ucmd = true;
+		client->lastUcmdTime = sws.realtime;
+
+		cmd = &client->cmds[( client->cmdNum + 1 ) & CMD_MASK];
+		SW_Client_NextUcmd( client, cmd );
+		client->cmdNum++;
+		client->cmdSentUsec[client->cmdNum & CMD_MASK] = Sys_Microseconds();
+
+		SW_Client_WriteUcmdsToMessage( client, &message );
+	}
+
+	if( !client->reliable && ( ucmd || sendNow || sws.realtime > client->lastPacketSentTime + 100 ) )
+	{
+		MSG_WriteByte( &message, clc_svcack );
+		MSG_WriteLong( &message, (unsigned int)client->lastExecutedServerCommand );
+	}
+
+	SW_Client_WriteReliableCommands( client, &message );
+
+	if( message.cursize > 0 || sws.realtime > client->lastPacketSentTime + 1000 )
+		SW_Client_Transmit( client, &message );
+}
+
+/*
+* SW_Client_Connect
+*/
+void SW_Client_Connect( swclient_t *client )
+{
+	netadr_t socketaddress;
+
+	assert( client->state <= CA_DISCONNECTED );
+
+	NET_InitAddress( &socketaddress, sws.serveraddress.type );
+	if( !NET_OpenSocket( &client->socket, SOCKET_UDP, &socketaddress, false ) )
+	{
+		Com_Printf( "swarm%03i: Couldn't open UDP socket: %s\n", client->number, NET_ErrorString() );
+		client->rejected = true;
+		return;
+	}
+
+	client->serveraddress = sws.serveraddress;
+	client->reliable = false;
+	client->state = CA_CONNECTING;
+	client->connect_time = sws.realtime - 99999; // SW_Client_CheckForResend will fire immediately
+	client->connect_count = 0;
+	client->lastPacketReceivedTime = sws.realtime;
+	SW_Client_ClearState( client );
+
+	// start every client at a different spot of the recording
+	client->replayPos = 0;
+	client->replayStart = sws.realtime;
+	if( sws.numreplay )
+		client->replayStart -= ( client->number * 1543 ) % ( sws.replay[sws.numreplay - 1].serverTimeStamp + 1 );
+}
+
+/*
+* SW_Client_Disconnect
+*/
+void SW_Client_Disconnect( swclient_t *client, const char *reason )
+{
+	if( client->state <= CA_DISCONNECTED )
+		return;
+
+	Com_Printf( "swarm%03i: Disconnected: %s\n", client->number, reason );
+
+	if( client->state > CA_CONNECTING )
+	{
+		int i;
+
+		for( i = 0; i < 3; i++ )
+		{
+			SW_Client_AddReliableCommand( client, "disconnect" );
+			SW_Client_SendMessages( client, true );
+		}
+		sws.stats.drops++;
+	}
+
+	NET_CloseSocket( &client->socket );
+	client->state = CA_DISCONNECTED;
+}
+
+/*
+* SW_Client_CheckForResend
+*/
+static void SW_Client_CheckForResend( swclient_t *client )
+{
+	if( sws.realtime - client->connect_time < 3000 )
+		return;
+
+	if( client->connect_count >= 5 )
+	{
+		SW_Client_Disconnect( client, "Connection timed out" );
+		return;
+	}
+
+	client->connect_count++;
+	client->connect_time = sws.realtime;
+	Netchan_OutOfBandPrint( &client->socket, &client->serveraddress, "getchallenge\n" );
+}
+
+//=============================================================================
+
+/*
+* SW_Client_ConnectionlessPacket
+*/
+static void SW_Client_ConnectionlessPacket( swclient_t *client, msg_t *msg )
+{
+	char *s, *c;
+
+	MSG_BeginReading( msg );
+	MSG_ReadLong( msg ); // skip the -1 marker
+
+	s = MSG_ReadStringLine( msg );
+	Cmd_TokenizeString( s );
+	c = Cmd_Argv( 0 );
+
+	if( client->state != CA_CONNECTING )
+		return;
+
+	if( !strcmp( c, "challenge" ) )
+	{
+		int flags = 0;
+
+		if( sw_compactsnaps->integer )
+			flags |= CONNECT_FLAG_COMPACTSNAPS;
+
+		client->challenge = atoi( Cmd_Argv( 1 ) );
+		client->connect_time = sws.realtime;
+		Netchan_OutOfBandPrint( &client->socket, &client->serveraddress, "connect %i %i %i \"%s\" %i\n",
+			APP_PROTOCOL_VERSION, client->qport, client->challenge, SW_Client_Userinfo( client ), flags );
+	}
+	else if( !strcmp( c, "client_connect" ) )
+	{
+		Netchan_Setup( &client->netchan, &client->socket, &client->serveraddress, client->qport );
+		client->state = CA_HANDSHAKE;
+		SW_Client_AddReliableCommand( client, "new" );
+		sws.stats.connects++;
+	}
+	else if( !strcmp( c, "reject" ) )
+	{
+		int rejectflag;
+		char rejectmessage[MAX_STRING_CHARS];
+
+		MSG_ReadStringLine( msg ); // reject type
+		rejectflag = atoi( MSG_ReadStringLine( msg ) );
+		Q_strncpyz( rejectmessage, MSG_ReadStringLine( msg ), sizeof( rejectmessage ) );
+
+		// only retry later if the server says it's worth it
+		client->rejected = ( rejectflag & DROP_FLAG_AUTORECONNECT ) ? false : true;
+		SW_Client_Disconnect( client, va( "Server refused: %s", rejectmessage ) );
+	}
+}
+
+/*
+* SW_Client_ParseServerCommand
+*/
+static void SW_Client_ParseServerCommand( swclient_t *client, msg_t *msg )
+{
+	const char *s;
+
+	Cmd_TokenizeString( MSG_ReadString( msg ) );
+	s = Cmd_Argv( 0 );
+
+	if( !strcmp( s, "precache" ) )
+	{
+		SW_Client_AddReliableCommand( client, va( "begin %i\n", atoi( Cmd_Argv( 1 ) ) ) );
+		if( sw_join->integer )
+			SW_Client_AddReliableCommand( client, "join" );
+	}
+	else if( !strcmp( s, "cmd" ) )
+	{
+		if( Cmd_Argc() > 1 )
+			SW_Client_AddReliableCommand( client, Cmd_Args() );
+	}
+	else if( !strcmp( s, "reconnect" ) )
+	{
+		// the server is changing levels
+		client->state = CA_HANDSHAKE;
+		SW_Client_AddReliableCommand( client, "new" );
+	}
+	else if( !strcmp( s, "disconnect" ) || !strcmp( s, "disc" ) )
+	{
+		SW_Client_Disconnect( client, va( "Server disconnected: %s", Cmd_Argv( 2 ) ) );
+	}
+	else if( !strcmp( s, "forcereconnect" ) )
+	{
+		SW_Client_Disconnect( client, "Server forced reconnect" );
+	}
+	else if( !strcmp( s, "steamauth" ) )
+	{
+		client->rejected = true;
+		SW_Client_Disconnect( client, "Server requires Steam authentication, set sv_useSteamAuth 0" );
+	}
+}
+
+/*
+* SW_Client_ParseServerData
+*/
+static bool SW_Client_ParseServerData( swclient_t *client, msg_t *msg )
+{
+	int i, numpure;
+
+	SW_Client_ClearState( client );
+	client->state = CA_CONNECTED;
+
+	i = MSG_ReadLong( msg );
+	if( i != APP_PROTOCOL_VERSION )
+	{
+		client->rejected = true;
+		SW_Client_Disconnect( client, va( "Server returned version %i, not %i", i, APP_PROTOCOL_VERSION ) );
+		return false;
+	}
+
+	client->servercount = MSG_ReadLong( msg );
+	client->snapFrameTime = (unsigned int)MSG_ReadShort( msg );
+	MSG_ReadString( msg ); // basegame
+	MSG_ReadString( msg ); // game
+	client->playernum = MSG_ReadShort( msg );
+	MSG_ReadString( msg ); // levelname
+
+	client->sv_bitflags = MSG_ReadByte( msg );
+	client->reliable = ( client->sv_bitflags & SV_BITFLAGS_RELIABLE ) ? true : false;
+	if( ( client->sv_bitflags & SV_BITFLAGS_HTTP ) != 0 )
+	{
+		if( ( client->sv_bitflags & SV_BITFLAGS_HTTP_BASEURL ) != 0 )
+			MSG_ReadString( msg );
+		else
+			sws.httpport = (unsigned short)MSG_ReadShort( msg );
+	}
+
+	numpure = MSG_ReadShort( msg );
+	while( numpure > 0 )
+	{
+		MSG_ReadString( msg );
+		MSG_ReadLong( msg );
+		numpure--;
+	}
+
+	SW_Client_AddReliableCommand( client, va( "configstrings %i 0", client->servercount ) );
+	return true;
+}
+
+/*
+* SW_Client_ParseFrame
+*/
+static void SW_Client_ParseFrame( swclient_t *client, msg_t *msg )
+{
+	snapshot_t snap;
+	uint64_t now;
+	unsigned int i, first;
+
+	SNAP_SkipFrame( msg, &snap );
+
+	now = Sys_Microseconds();
+	sws.stats.snaps++;
+	if( client->lastSnapUsec )
+		SW_Stats_AddSample( &sws.stats.interval, now - client->lastSnapUsec );
+	client->lastSnapUsec = now;
+
+	if( client->serverFrame > 0 && snap.serverFrame > client->serverFrame + 1 )
+		sws.stats.framesSkipped += snap.serverFrame - client->serverFrame - 1;
+
+	// every usercmd that got executed since the last snap is answered by this one
+	if( snap.ucmdExecuted > client->ucmdExecuted && snap.ucmdExecuted <= client->cmdNum )
+	{
+		first = client->ucmdExecuted + 1;
+		if( snap.ucmdExecuted - first >= CMD_BACKUP )
+			first = snap.ucmdExecuted - CMD_BACKUP + 1;
+
+		for( i = first; i <= snap.ucmdExecuted; i++ )
+		{
+			if( !client->cmdSentUsec[i & CMD_MASK] )
+				continue;
+			SW_Stats_AddSample( &sws.stats.latency, now - client->cmdSentUsec[i & CMD_MASK] );
+			client->cmdSentUsec[i & CMD_MASK] = 0;
+		}
+		client->ucmdExecuted = snap.ucmdExecuted;
+	}
+
+	if( snap.serverFrame > client->serverFrame )
+	{
+		client->serverFrame = snap.serverFrame;
+		client->serverTime = snap.serverTime;
+		client->serverTimeReceived = sws.realtime;
+	}
+
+	client->state = CA_ACTIVE;
+}
+
+/*
+* SW_Client_ParseServerMessage
+*/
+static void SW_Client_ParseServerMessage( swclient_t *client, msg_t *msg )
+{
+	int cmd;
+
+	while( client->state >= CA_HANDSHAKE )
+	{
+		if( msg->readcount > msg->cursize )
+		{
+			SW_Client_Disconnect( client, "Bad server message" );
+			return;
+		}
+
+		cmd = MSG_ReadByte( msg );
+		if( cmd == -1 )
+			break;
+
+		switch( cmd )
+		{
+		case svc_nop:
+			break;
+
+		case svc_servercmd:
+			if( !client->reliable )
+			{
+				int cmdNum = MSG_ReadLong( msg );
+				if( cmdNum < 0 )
+				{
+					SW_Client_Disconnect( client, "Invalid cmdNum value" );
+					return;
+				}
+				if( cmdNum <= client->lastExecutedServerCommand )
+				{
+					MSG_ReadString( msg ); // read but ignore
+					break;
+				}
+				client->lastExecutedServerCommand = cmdNum;
+			}
+			// fall trough
+		case svc_servercs:
+			SW_Client_ParseServerCommand( client, msg );
+			break;
+
+		case svc_serverdata:
+			if( client->state != CA_HANDSHAKE )
+				return; // ignore rest of the packet (serverdata is always sent alone)
+			if( !SW_Client_ParseServerData( client, msg ) )
+				return;
+			break;
+
+		case svc_spawnbaseline:
+			SNAP_ParseBaseline( msg, sw_baselines );
+			break;
+
+		case svc_clcack:
+			if( client->reliable )
+			{
+				SW_Client_Disconnect( client, "clack message while reliable" );
+				return;
+			}
+			client->reliableAcknowledge = (unsigned)MSG_ReadLong( msg );
+			client->ucmdAcknowledged = (unsigned)MSG_ReadLong( msg );
+			break;
+
+		case svc_frame:
+			SW_Client_ParseFrame( client, msg );
+			break;
+
+		case svc_extension:
+			if( 1 )
+			{
+				int len;
+
+				MSG_ReadByte( msg );			// extension id
+				MSG_ReadByte( msg );			// version number
+				len = MSG_ReadShort( msg );		// command length
+				MSG_SkipData( msg, len );		// command data
+			}
+			break;
+
+		default:
+			SW_Client_Disconnect( client, va( "Unexpected server message %i", cmd ) );
+			return;
+		}
+	}
+}
+
+/*
+* SW_Client_ReadPacket
+*/
+void SW_Client_ReadPacket( swclient_t *client )
+{
+	msg_t msg;
+	uint8_t msgData[MAX_MSGLEN];
+	int ret;
+	netadr_t address;
+
+	MSG_Init( &msg, msgData, sizeof( msgData ) );
+	MSG_Clear( &msg );
+
+	while( client->state > CA_DISCONNECTED && ( ret = NET_GetPacket( &client->socket, &address, &msg ) ) != 0 )
+	{
+		if( ret == -1 )
+		{
+			SW_Client_Disconnect( client, va( "Error receiving packet: %s", NET_ErrorString() ) );
+			return;
+		}
+
+		if( !NET_CompareAddress( &client->serveraddress, &address ) )
+			continue;
+
+		sws.stats.packetsIn++;
+		sws.stats.bytesIn += msg.cursize;
+
+		// remote command packet
+		if( *(int *)msg.data == -1 )
+		{
+			SW_Client_ConnectionlessPacket( client, &msg );
+			continue;
+		}
+
+		if( client->state < CA_HANDSHAKE )
+			continue;
+
+		if( !Netchan_Process( &client->netchan, &msg ) )
+			continue;
+
+		MSG_BeginReading( &msg );
+		MSG_ReadLong( &msg ); // sequence
+		MSG_ReadLong( &msg ); // sequence_ack
+		if( msg.compressed && Netchan_DecompressMessage( &msg ) < 0 )
+			continue;
+
+		client->lastPacketReceivedTime = sws.realtime;
+		SW_Client_ParseServerMessage( client, &msg );
+	}
+}
+
+/*
+* SW_Client_Run
+*/
+void SW_Client_Run( swclient_t *client )
+{
+	if( client->state <= CA_DISCONNECTED )
+		return;
+
+	if( client->state == CA_CONNECTING )
+	{
+		SW_Client_CheckForResend( client );
+		return;
+	}
+
+	if( sws.realtime > client->lastPacketReceivedTime + sw_timeout->value * 1000 )
+	{
+		SW_Client_Disconnect( client, "Server timed out" );
+		return;
+	}
+
+	if( client->netchan.unsentFragments )
+		Netchan_TransmitNextFragment( &client->netchan );
+	else
+		SW_Client_SendMessages( client, false );
+}
+
+/*
+* SW_Client_LoadReplay
+*/
+bool SW_Client_LoadReplay( const char *name )
+{
+	if( sws.replay )
+	{
+		Mem_Free( sws.replay );
+		sws.replay = NULL;
+		sws.numreplay = 0;
+	}
+
+	if( !name || !name[0] )
+		return true;
+
+	sws.replay = SNAP_LoadUcmdFile( name, sw_mempool, &sws.numreplay );
+	return sws.replay != NULL;
+}
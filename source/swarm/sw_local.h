@@ -0,0 +1,156 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// sw_local.h -- synthetic client swarm for server load testing
+
+#ifndef __SW_LOCAL_H
+#define __SW_LOCAL_H
+
+#include "../qcommon/qcommon.h"
+#include "../cgame/cg_public.h"
+
+#define SW_MAX_CLIENTS			256
+
+#define SW_HISTOGRAM_BUCKETS	400
+#define SW_HISTOGRAM_USEC		250	// bucket width, so the histograms cover 100ms
+
+typedef struct
+{
+	unsigned int count;
+	uint64_t total;
+	uint64_t max;
+	unsigned int buckets[SW_HISTOGRAM_BUCKETS];
+} sw_histogram_t;
+
+typedef struct
+{
+	uint64_t bytesIn, bytesOut;
+	unsigned int packetsIn, packetsOut;
+	unsigned int snaps;
+	unsigned int framesSkipped;         // serverFrame gaps seen by the clients
+	unsigned int connects, drops;
+
+	sw_histogram_t latency;             // ucmd sent -> first snap that executed it
+	sw_histogram_t interval;            // snap inter-arrival time
+} sw_stats_t;
+
+typedef struct swclient_s
+{
+	int number;
+	connstate_t state;
+	bool rejected;
+
+	socket_t socket;
+	netadr_t serveraddress;
+	netchan_t netchan;
+	int qport;
+	int challenge;
+
+	unsigned int connect_time;
+	int connect_count;
+	unsigned int lastPacketSentTime;
+	unsigned int lastPacketReceivedTime;
+	unsigned int lastUcmdTime;
+
+	// reliable commands
+	bool reliable;
+	unsigned int reliableSequence;
+	unsigned int reliableSent;
+	unsigned int reliableAcknowledge;
+	int lastExecutedServerCommand;
+	char reliableCommands[MAX_RELIABLE_COMMANDS][MAX_STRING_CHARS];
+
+	// serverdata
+	int servercount;
+	unsigned int snapFrameTime;
+	int playernum;
+	int sv_bitflags;
+
+	// last snap
+	int serverFrame;
+	unsigned int serverTime;
+	unsigned int serverTimeReceived;    // local realtime serverTime was received at
+	unsigned int ucmdExecuted;
+	unsigned int ucmdAcknowledged;
+	uint64_t lastSnapUsec;
+
+	// usercmds
+	unsigned int cmdNum;
+	usercmd_t cmds[CMD_BACKUP];
+	uint64_t cmdSentUsec[CMD_BACKUP];
+	unsigned int replayPos;
+	unsigned int replayStart;
+} swclient_t;
+
+typedef struct
+{
+	unsigned int realtime;
+	bool initialized;
+
+	char servername[MAX_QPATH];
+	netadr_t serveraddress;
+	unsigned short httpport;
+
+	int numclients;
+	swclient_t *clients;
+	unsigned int nextConnectTime;
+
+	// recorded input shared by all clients
+	int numreplay;
+	usercmd_t *replay;
+
+	sw_stats_t stats;
+	uint64_t statsStartUsec;
+	unsigned int nextReportTime;
+	sw_stats_t reportBase;
+	uint64_t reportBaseUsec;
+} swarm_t;
+
+extern swarm_t sws;
+extern mempool_t *sw_mempool;
+
+extern cvar_t *sw_connectrate;
+extern cvar_t *sw_ucmdfps;
+extern cvar_t *sw_ucmds;
+extern cvar_t *sw_join;
+extern cvar_t *sw_compactsnaps;
+extern cvar_t *sw_timeout;
+extern cvar_t *sw_report;
+extern cvar_t *sw_password;
+
+//
+// sw_client.c
+//
+void SW_Client_Connect( swclient_t *client );
+void SW_Client_Disconnect( swclient_t *client, const char *reason );
+void SW_Client_ReadPacket( swclient_t *client );
+void SW_Client_Run( swclient_t *client );
+bool SW_Client_LoadReplay( const char *name );
+
+//
+// sw_stats.c
+//
+void SW_Stats_Reset( void );
+void SW_Stats_AddSample( sw_histogram_t *histogram, uint64_t usec );
+void SW_Stats_Frame( void );
+void SW_Stats_f( void );
+void SW_Stats_Shutdown( void );
+
+#endif // __SW_LOCAL_H
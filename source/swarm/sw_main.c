@@ -0,0 +1,253 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// sw_main.c -- headless client swarm, connects many synthetic players to a server
+//
+// Every client has its own UDP socket and qport and speaks the regular client protocol,
+// so the server can't tell them apart from real players. Loading a server with more than
+// a few of them from one host needs sv_iplimit 0 and sv_useSteamAuth 0 on the server.
+// For the server frame times in swarm_stats, run it with com_profile 1.
+
+#include "sw_local.h"
+
+swarm_t sws;
+
+mempool_t *sw_mempool;
+
+cvar_t *sw_connectrate;
+cvar_t *sw_ucmdfps;
+cvar_t *sw_ucmds;
+cvar_t *sw_join;
+cvar_t *sw_compactsnaps;
+cvar_t *sw_timeout;
+cvar_t *sw_report;
+cvar_t *sw_password;
+
+static socket_t *sw_sockets[SW_MAX_CLIENTS + 1];
+static void *sw_socket_clients[SW_MAX_CLIENTS + 1];
+
+/*
+* SW_Disconnect_f
+*/
+static void SW_Disconnect_f( void )
+{
+	int i;
+
+	if( !sws.numclients )
+		return;
+
+	for( i = 0; i < sws.numclients; i++ )
+		SW_Client_Disconnect( &sws.clients[i], "Swarm disconnected" );
+
+	Mem_Free( sws.clients );
+	sws.clients = NULL;
+	sws.numclients = 0;
+	sws.servername[0] = '\0';
+	sws.httpport = 0;
+}
+
+/*
+* SW_Connect_f
+*/
+static void SW_Connect_f( void )
+{
+	int i, count;
+	netadr_t address;
+
+	if( Cmd_Argc() < 2 )
+	{
+		Com_Printf( "Usage: %s <address> [count]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	if( !NET_StringToAddress( Cmd_Argv( 1 ), &address ) )
+	{
+		Com_Printf( "Bad server address: %s\n", Cmd_Argv( 1 ) );
+		return;
+	}
+	if( NET_GetAddressPort( &address ) == 0 )
+		NET_SetAddressPort( &address, PORT_SERVER );
+
+	count = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 1;
+	clamp( count, 1, SW_MAX_CLIENTS );
+
+	SW_Disconnect_f();
+
+	if( !SW_Client_LoadReplay( sw_ucmds->string ) )
+		return;
+
+	Q_strncpyz( sws.servername, Cmd_Argv( 1 ), sizeof( sws.servername ) );
+	sws.serveraddress = address;
+	sws.numclients = count;
+	sws.clients = Mem_Alloc( sw_mempool, sizeof( swclient_t ) * count );
+	for( i = 0; i < count; i++ )
+	{
+		sws.clients[i].number = i;
+		sws.clients[i].state = CA_DISCONNECTED;
+		// a distinct qport for each, the server tells reconnecting clients apart by IP and qport
+		sws.clients[i].qport = ( Netchan_GamePort() + i ) & 0xffff;
+	}
+	sws.nextConnectTime = sws.realtime;
+
+	SW_Stats_Reset();
+	sws.nextReportTime = sws.realtime + sw_report->value * 1000;
+
+	Com_Printf( "Connecting %i clients to %s\n", count, NET_AddressToString( &address ) );
+}
+
+/*
+* SW_Init
+*/
+void SW_Init( void )
+{
+	Com_Printf( "Initializing " APPLICATION " client swarm\n" );
+
+	sw_mempool = Mem_AllocPool( NULL, "Swarm" );
+
+	sw_connectrate = Cvar_Get( "sw_connectrate", "10", CVAR_ARCHIVE );
+	sw_ucmdfps = Cvar_Get( "sw_ucmdfps", "62", CVAR_ARCHIVE );
+	sw_ucmds = Cvar_Get( "sw_ucmds", "", CVAR_ARCHIVE );
+	sw_join = Cvar_Get( "sw_join", "1", CVAR_ARCHIVE );
+	sw_compactsnaps = Cvar_Get( "sw_compactsnaps", "1", CVAR_ARCHIVE );
+	sw_timeout = Cvar_Get( "sw_timeout", "30", CVAR_ARCHIVE );
+	sw_report = Cvar_Get( "sw_report", "5", CVAR_ARCHIVE );
+	sw_password = Cvar_Get( "sw_password", "", 0 );
+
+	Cmd_AddCommand( "swarm_connect", SW_Connect_f );
+	Cmd_AddCommand( "swarm_disconnect", SW_Disconnect_f );
+	Cmd_AddCommand( "swarm_stats", SW_Stats_f );
+
+	SW_Stats_Reset();
+	sws.initialized = true;
+}
+
+/*
+* SW_Shutdown
+*/
+void SW_Shutdown( const char *finalmsg )
+{
+	if( !sws.initialized )
+		return;
+
+	SW_Disconnect_f();
+	SW_Client_LoadReplay( NULL );
+
+	Cmd_RemoveCommand( "swarm_connect" );
+	Cmd_RemoveCommand( "swarm_disconnect" );
+	Cmd_RemoveCommand( "swarm_stats" );
+
+	SW_Stats_Shutdown();
+
+	Mem_FreePool( &sw_mempool );
+	sws.initialized = false;
+}
+
+/*
+* SW_ReadCallback
+*/
+static void SW_ReadCallback( socket_t *socket, void *client )
+{
+	SW_Client_ReadPacket( ( swclient_t * )client );
+}
+
+/*
+* SW_CheckConnects
+*
+* The server keeps one challenge per IP, so the handshakes have to go one after another
+*/
+static void SW_CheckConnects( void )
+{
+	int i;
+	swclient_t *next = NULL;
+
+	if( sws.realtime < sws.nextConnectTime )
+		return;
+
+	for( i = 0; i < sws.numclients; i++ )
+	{
+		if( sws.clients[i].state == CA_CONNECTING )
+			return;
+		if( !next && sws.clients[i].state == CA_DISCONNECTED && !sws.clients[i].rejected )
+			next = &sws.clients[i];
+	}
+
+	if( !next )
+		return;
+
+	SW_Client_Connect( next );
+	sws.nextConnectTime = sws.realtime + 1000 / max( sw_connectrate->integer, 1 );
+}
+
+/*
+* SW_Frame
+*/
+void SW_Frame( int realmsec, int gamemsec )
+{
+	int i, numsockets;
+
+	sws.realtime += realmsec;
+
+	// wait for the next packet from any of the clients, but no longer than a usercmd frame
+	numsockets = 0;
+	for( i = 0; i < sws.numclients; i++ )
+	{
+		if( sws.clients[i].state <= CA_DISCONNECTED )
+			continue;
+		sw_sockets[numsockets] = &sws.clients[i].socket;
+		sw_socket_clients[numsockets] = &sws.clients[i];
+		numsockets++;
+	}
+	sw_sockets[numsockets] = NULL;
+
+	if( numsockets )
+		NET_Monitor( 1, sw_sockets, SW_ReadCallback, NULL, NULL, sw_socket_clients );
+	else
+		Sys_Sleep( 5 );
+
+	SW_CheckConnects();
+
+	for( i = 0; i < sws.numclients; i++ )
+		SW_Client_Run( &sws.clients[i] );
+
+	SW_Stats_Frame();
+}
+
+/*
+* Just some renaming so we can call the functions above SW not SV
+*/
+
+void SV_Init( void )
+{
+	SW_Init();
+}
+
+void SV_Shutdown( const char *finalmsg )
+{
+	SW_Shutdown( finalmsg );
+}
+
+void SV_ShutdownGame( const char *finalmsg, bool reconnect )
+{
+}
+
+void SV_Frame( int realmsec, int gamemsec )
+{
+	SW_Frame( realmsec, gamemsec );
+}
@@ -0,0 +1,285 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+// sw_stats.c -- swarm traffic and latency accounting
+
+#include "sw_local.h"
+#include "../qcommon/wswcurl.h"
+
+#define SW_PROFILE_MAXLEN	0x10000
+
+static wswcurl_req *sw_profile_req;
+static char *sw_profile_buf;
+static size_t sw_profile_len;
+
+/*
+* SW_Stats_Reset
+*/
+void SW_Stats_Reset( void )
+{
+	memset( &sws.stats, 0, sizeof( sws.stats ) );
+	memset( &sws.reportBase, 0, sizeof( sws.reportBase ) );
+	sws.statsStartUsec = sws.reportBaseUsec = Sys_Microseconds();
+}
+
+/*
+* SW_Stats_AddSample
+*/
+void SW_Stats_AddSample( sw_histogram_t *histogram, uint64_t usec )
+{
+	uint64_t bucket;
+
+	bucket = usec / SW_HISTOGRAM_USEC;
+	if( bucket >= SW_HISTOGRAM_BUCKETS )
+		bucket = SW_HISTOGRAM_BUCKETS - 1;
+
+	histogram->buckets[bucket]++;
+	histogram->count++;
+	histogram->total += usec;
+	if( usec > histogram->max )
+		histogram->max = usec;
+}
+
+/*
+* SW_Stats_Percentile
+*
+* Returns the upper edge of the bucket holding the given percentile, in milliseconds
+*/
+static float SW_Stats_Percentile( const sw_histogram_t *histogram, float percentile )
+{
+	unsigned int i, target, sum;
+
+	if( !histogram->count )
+		return 0;
+
+	target = (unsigned int)( histogram->count * percentile / 100.0f );
+	if( target >= histogram->count )
+		target = histogram->count - 1;
+
+	sum = 0;
+	for( i = 0; i < SW_HISTOGRAM_BUCKETS - 1; i++ )
+	{
+		sum += histogram->buckets[i];
+		if( sum > target )
+			break;
+	}
+
+	// the last bucket is open ended
+	if( i == SW_HISTOGRAM_BUCKETS - 1 )
+		return histogram->max * 0.001f;
+	return ( i + 1 ) * SW_HISTOGRAM_USEC * 0.001f;
+}
+
+/*
+* SW_Stats_Delta
+*/
+static void SW_Stats_Delta( const sw_histogram_t *now, const sw_histogram_t *base, sw_histogram_t *delta )
+{
+	int i;
+
+	delta->count = now->count - base->count;
+	delta->total = now->total - base->total;
+	delta->max = now->max;
+	for( i = 0; i < SW_HISTOGRAM_BUCKETS; i++ )
+		delta->buckets[i] = now->buckets[i] - base->buckets[i];
+}
+
+/*
+* SW_Stats_PrintHistogram
+*/
+static void SW_Stats_PrintHistogram( const char *name, const sw_histogram_t *histogram )
+{
+	if( !histogram->count )
+	{
+		Com_Printf( "%-10s no samples\n", name );
+		return;
+	}
+
+	Com_Printf( "%-10s %8u samples  avg %6.2f  p50 %6.2f  p90 %6.2f  p99 %6.2f  max %6.2f ms\n", name, histogram->count,
+		histogram->total * 0.001 / histogram->count, SW_Stats_Percentile( histogram, 50 ), SW_Stats_Percentile( histogram, 90 ),
+		SW_Stats_Percentile( histogram, 99 ), histogram->max * 0.001f );
+}
+
+/*
+* SW_Stats_NumActive
+*/
+static int SW_Stats_NumActive( void )
+{
+	int i, count;
+
+	for( i = 0, count = 0; i < sws.numclients; i++ )
+	{
+		if( sws.clients[i].state == CA_ACTIVE )
+			count++;
+	}
+
+	return count;
+}
+
+/*
+* SW_Stats_Frame
+*
+* Prints a one line summary of the last sw_report seconds
+*/
+void SW_Stats_Frame( void )
+{
+	sw_histogram_t latency;
+	uint64_t now;
+	float seconds;
+
+	if( sw_report->value <= 0 || !sws.numclients )
+		return;
+	if( sws.realtime < sws.nextReportTime )
+		return;
+	sws.nextReportTime = sws.realtime + sw_report->value * 1000;
+
+	now = Sys_Microseconds();
+	seconds = ( now - sws.reportBaseUsec ) * 0.000001f;
+	if( seconds <= 0 )
+		return;
+
+	SW_Stats_Delta( &sws.stats.latency, &sws.reportBase.latency, &latency );
+
+	Com_Printf( "swarm: %i/%i active  in %.1f kB/s  out %.1f kB/s  snaps %.0f/s  skipped %u  latency p50 %.2f p99 %.2f ms\n",
+		SW_Stats_NumActive(), sws.numclients,
+		( sws.stats.bytesIn - sws.reportBase.bytesIn ) / 1024.0f / seconds,
+		( sws.stats.bytesOut - sws.reportBase.bytesOut ) / 1024.0f / seconds,
+		( sws.stats.snaps - sws.reportBase.snaps ) / seconds,
+		sws.stats.framesSkipped - sws.reportBase.framesSkipped,
+		SW_Stats_Percentile( &latency, 50 ), SW_Stats_Percentile( &latency, 99 ) );
+
+	sws.reportBase = sws.stats;
+	sws.reportBaseUsec = now;
+}
+
+/*
+* SW_Stats_ProfileRead
+*/
+static size_t SW_Stats_ProfileRead( wswcurl_req *req, const void *buf, size_t numb, float percentage, void *customp )
+{
+	if( sw_profile_len + numb >= SW_PROFILE_MAXLEN )
+		numb = SW_PROFILE_MAXLEN - 1 - sw_profile_len;
+
+	memcpy( sw_profile_buf + sw_profile_len, buf, numb );
+	sw_profile_len += numb;
+	sw_profile_buf[sw_profile_len] = '\0';
+	return numb;
+}
+
+/*
+* SW_Stats_ProfileDone
+*/
+static void SW_Stats_ProfileDone( wswcurl_req *req, int status, void *customp )
+{
+	if( status == 200 )
+		Com_Printf( "Server frame profile:\n%s", sw_profile_buf );
+	else if( status == 404 )
+		Com_Printf( "Server frame profile: not available, set com_profile 1 on the server\n" );
+	else if( status < 0 )
+		Com_Printf( "Server frame profile: %s\n", wswcurl_errorstr( status ) );
+	else
+		Com_Printf( "Server frame profile: HTTP error %i\n", status );
+
+	wswcurl_delete( req );
+	sw_profile_req = NULL;
+}
+
+/*
+* SW_Stats_FetchProfile
+*
+* The server publishes its frame time percentiles over HTTP, see sv_web.c
+*/
+static void SW_Stats_FetchProfile( void )
+{
+	netadr_t address;
+
+	if( sw_profile_req )
+		return;
+
+	if( !sws.httpport )
+	{
+		Com_Printf( "Server frame profile: the server doesn't run a HTTP server\n" );
+		return;
+	}
+
+	address = sws.serveraddress;
+	NET_SetAddressPort( &address, sws.httpport );
+
+	if( !sw_profile_buf )
+		sw_profile_buf = Mem_Alloc( sw_mempool, SW_PROFILE_MAXLEN );
+	sw_profile_buf[0] = '\0';
+	sw_profile_len = 0;
+
+	sw_profile_req = wswcurl_create( NULL, "http://%s/profile", NET_AddressToString( &address ) );
+	if( !sw_profile_req )
+		return;
+
+	wswcurl_stream_callbacks( sw_profile_req, SW_Stats_ProfileRead, SW_Stats_ProfileDone, NULL, NULL );
+	wswcurl_start( sw_profile_req );
+}
+
+/*
+* SW_Stats_Shutdown
+*
+* The profile buffer lives in sw_mempool, so the request writing to it has to go first
+*/
+void SW_Stats_Shutdown( void )
+{
+	if( sw_profile_req )
+	{
+		wswcurl_delete( sw_profile_req );
+		sw_profile_req = NULL;
+	}
+
+	sw_profile_buf = NULL;
+	sw_profile_len = 0;
+}
+
+/*
+* SW_Stats_f
+*/
+void SW_Stats_f( void )
+{
+	float seconds;
+
+	if( Cmd_Argc() > 1 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) )
+	{
+		SW_Stats_Reset();
+		Com_Printf( "Swarm stats reset\n" );
+		return;
+	}
+
+	seconds = ( Sys_Microseconds() - sws.statsStartUsec ) * 0.000001f;
+	if( seconds <= 0 )
+		seconds = 1;
+
+	Com_Printf( "Swarm: %i/%i clients active on %s, %.0f seconds\n", SW_Stats_NumActive(), sws.numclients,
+		sws.servername[0] ? sws.servername : "nothing", seconds );
+	Com_Printf( "connects %u, drops %u\n", sws.stats.connects, sws.stats.drops );
+	Com_Printf( "in:  %u packets, %.1f kB/s\n", sws.stats.packetsIn, sws.stats.bytesIn / 1024.0f / seconds );
+	Com_Printf( "out: %u packets, %.1f kB/s\n", sws.stats.packetsOut, sws.stats.bytesOut / 1024.0f / seconds );
+	Com_Printf( "snaps: %u (%.1f/s), %u server frames skipped\n", sws.stats.snaps, sws.stats.snaps / seconds,
+		sws.stats.framesSkipped );
+	SW_Stats_PrintHistogram( "latency", &sws.stats.latency );
+	SW_Stats_PrintHistogram( "snap gap", &sws.stats.interval );
+
+	if( sws.numclients )
+		SW_Stats_FetchProfile();
+}
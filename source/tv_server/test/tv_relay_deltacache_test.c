@@ -0,0 +1,111 @@
+#include "../../qcommon/qcommon.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+// the relay occupies player slot 2 on the upstream server,
+// so entity 3 is rewritten with each spectator's own state
+#define RELAY_PLAYERNUM		2
+#define RELAY_OLDFRAME		10
+
+static snap_deltacache_t deltacache;
+
+void Com_Error( com_error_code_t code, const char *format, ... ){
+	assert_true( false );
+}
+
+void Com_Printf( const char *format, ... ){
+}
+
+void Sys_Error( const char *format, ... ){
+	assert_true( false );
+}
+
+static void make_state( entity_state_t *state, int number, float x, float y, int povnum )
+{
+	memset( state, 0, sizeof( *state ) );
+	state->number = number;
+	state->modelindex = 1;
+	state->origin[0] = x;
+	state->origin[1] = y;
+	state->ownerNum = povnum;
+}
+
+// writes what a spectator chasing povnum gets sent for the relay slot and for a shared entity
+static size_t write_spectator_frame( snap_deltacache_t *cache, msg_t *msg, uint8_t *buf, size_t size, float x, int povnum )
+{
+	entity_state_t oldself, newself, oldshared, newshared;
+
+	make_state( &oldself, RELAY_PLAYERNUM + 1, x, 0, povnum );
+	make_state( &newself, RELAY_PLAYERNUM + 1, x + 16, 8, povnum );
+	make_state( &oldshared, 5, 64, 64, 0 );
+	make_state( &newshared, 5, 80, 64, 0 );
+
+	MSG_Init( msg, buf, size );
+	if( cache )
+	{
+		SNAP_WriteDeltaEntity( cache, RELAY_OLDFRAME, &oldself, &newself, msg, false, false );
+		SNAP_WriteDeltaEntity( cache, RELAY_OLDFRAME, &oldshared, &newshared, msg, false, false );
+	}
+	else
+	{
+		MSG_WriteDeltaEntity( &oldself, &newself, msg, false, false );
+		MSG_WriteDeltaEntity( &oldshared, &newshared, msg, false, false );
+	}
+	return msg->cursize;
+}
+
+void test_deltacache_spectators_on_different_povs( void **state )
+{
+	uint8_t buf1[1024], buf2[1024], expected[1024];
+	msg_t msg1, msg2, msgexpected;
+
+	memset( &deltacache, 0, sizeof( deltacache ) );
+	SNAP_ClearDeltaCache( &deltacache );
+	deltacache.uncachedNum = RELAY_PLAYERNUM + 1;
+
+	// two spectators acknowledged the same old frame but chase different players
+	write_spectator_frame( &deltacache, &msg1, buf1, sizeof( buf1 ), 100, 4 );
+	write_spectator_frame( &deltacache, &msg2, buf2, sizeof( buf2 ), -300, 7 );
+
+	// the second spectator must get its own state for the relay slot
+	write_spectator_frame( NULL, &msgexpected, expected, sizeof( expected ), -300, 7 );
+	assert_int_equal( msg2.cursize, msgexpected.cursize );
+	assert_memory_equal( msg2.data, msgexpected.data, msgexpected.cursize );
+	assert_memory_not_equal( msg1.data, msg2.data, min( msg1.cursize, msg2.cursize ) );
+
+	// while the shared entity still comes from the cache
+	assert_int_equal( deltacache.hits, 1 );
+	assert_int_equal( deltacache.misses, 3 );
+}
+
+void test_deltacache_shares_same_oldframe( void **state )
+{
+	uint8_t buf1[1024], buf2[1024];
+	msg_t msg1, msg2;
+
+	memset( &deltacache, 0, sizeof( deltacache ) );
+	SNAP_ClearDeltaCache( &deltacache );
+
+	// no slot rewritten per client, e.g. the game server
+	write_spectator_frame( &deltacache, &msg1, buf1, sizeof( buf1 ), 100, 4 );
+	write_spectator_frame( &deltacache, &msg2, buf2, sizeof( buf2 ), 100, 4 );
+
+	assert_int_equal( msg1.cursize, msg2.cursize );
+	assert_memory_equal( msg1.data, msg2.data, msg1.cursize );
+	assert_int_equal( deltacache.hits, 2 );
+	assert_int_equal( deltacache.misses, 2 );
+}
+
+int main( void )
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_deltacache_spectators_on_different_povs ),
+		cmocka_unit_test( test_deltacache_shares_same_oldframe ),
+	};
+
+	return cmocka_run_group_tests( tests, NULL, NULL );
+}
@@ -48,6 +48,34 @@ static char *TV_ConnstateToString( connstate_t state )
 	}
 }
 
+/*
+* TV_Relay_SnapCacheStatus
+*/
+static void TV_Relay_SnapCacheStatus( relay_t *relay )
+{
+	unsigned int snaps, encodes, deltas;
+
+	snaps = relay->snapsBuilt + relay->snapsShared;
+	encodes = relay->bodycache.hits + relay->bodycache.misses;
+	deltas = relay->deltacache.hits + relay->deltacache.misses;
+
+	Com_Printf( "Snapshots: %u built, %u shared (%.1f%% hit rate)\n", relay->snapsBuilt, relay->snapsShared,
+		snaps ? 100.0 * relay->snapsShared / snaps : 0.0 );
+	Com_Printf( "Snapshot encoding: %u encoded, %u shared (%.1f%% hit rate)\n", relay->bodycache.misses, relay->bodycache.hits,
+		encodes ? 100.0 * relay->bodycache.hits / encodes : 0.0 );
+	Com_Printf( "Entity deltas: %u encoded, %u shared (%.1f%% hit rate)\n", relay->deltacache.misses, relay->deltacache.hits,
+		deltas ? 100.0 * relay->deltacache.hits / deltas : 0.0 );
+
+	if( relay->measuredFrames && relay->measuredFrameBytes )
+	{
+		Com_Printf( "Received frames: %u, %.1f bytes per frame\n", relay->measuredFrames,
+			(double)relay->measuredFrameBytes / relay->measuredFrames );
+		Com_Printf( "Player states: %.1f bytes per frame standard, %.1f compact (%.1f%% of frame bytes saved)\n",
+			(double)relay->measuredStandardBytes / relay->measuredFrames, (double)relay->measuredCompactBytes / relay->measuredFrames,
+			100.0 * ( (double)relay->measuredStandardBytes - (double)relay->measuredCompactBytes ) / relay->measuredFrameBytes );
+	}
+}
+
 /*
 * TV_Upstream_Status_f
 */
@@ -70,6 +98,7 @@ static void TV_Upstream_Status_f( void )
 		Com_Printf( "Server name: %s\n", upstream->servername );
 		Com_Printf( "Connection: %s\n", TV_ConnstateToString( upstream->state ) );
 		Com_Printf( "Relay: %s\n", TV_ConnstateToString( upstream->relay.state ) );
+		TV_Relay_SnapCacheStatus( &upstream->relay );
 	}
 	else
 	{
@@ -329,6 +358,75 @@ exit:
 	Mem_TempFree( servername );
 }
 
+/*
+* TV_RelayBench_f
+*
+* relaybench <pattern|playlist> <count>
+* Replays the demos as <count> fake upstreams and resets the relay timings,
+* without arguments prints the timings gathered since then
+*/
+static void TV_RelayBench_f( void )
+{
+	int i, count, numrelays;
+	char *demoname;
+	upstream_t *upstream;
+	double elapsed, busy, cores;
+
+	if( Cmd_Argc() >= 3 )
+	{
+		demoname = TempCopyString( Cmd_Argv( 1 ) );
+		count = bound( 1, atoi( Cmd_Argv( 2 ) ), 1024 );
+
+		for( i = 0; i < count; i++ )
+		{
+			upstream = TV_Upstream_New( demoname, va( "bench%i", i + 1 ), RELAY_MIN_DELAY );
+			TV_Upstream_StartDemo( upstream, demoname, false );
+		}
+
+		Mem_TempFree( demoname );
+
+		tvs.relaybench.starttime = Sys_Microseconds();
+		tvs.relaybench.frames = 0;
+		tvs.relaybench.relaytime = 0;
+		tvs.relaybench.runtime = 0;
+		return;
+	}
+
+	if( Cmd_Argc() != 1 )
+	{
+		Com_Printf( "Usage: %s [<pattern|playlist> <count>]\n", Cmd_Argv( 0 ) );
+		return;
+	}
+
+	numrelays = 0;
+	for( i = 0; i < tvs.numupstreams; i++ )
+	{
+		if( tvs.upstreams[i] && tvs.upstreams[i]->relay.state == CA_ACTIVE )
+			numrelays++;
+	}
+
+	elapsed = ( Sys_Microseconds() - tvs.relaybench.starttime ) * 0.001;
+	if( !tvs.relaybench.starttime || !tvs.relaybench.frames || elapsed <= 0 )
+	{
+		Com_Printf( "No relay timings yet\n" );
+		return;
+	}
+
+	// wall time of the relay section, and the cores kept busy by running the upstreams,
+	// which only differ with relay threads
+	busy = tvs.relaybench.relaytime * 0.001 / elapsed;
+	cores = tvs.relaybench.runtime * 0.001 / elapsed;
+
+	Com_Printf( "%i active relays, %i relay threads, %u frames in %.1f seconds\n", numrelays, tv_relaythreads->integer,
+		tvs.relaybench.frames, elapsed * 0.001 );
+	Com_Printf( "Relay time: %.3f ms per frame, %.1f%% of wall time\n",
+		tvs.relaybench.relaytime * 0.001 / tvs.relaybench.frames, busy * 100.0 );
+	Com_Printf( "Upstream run time: %.3f ms per frame, %.2f cores busy\n",
+		tvs.relaybench.runtime * 0.001 / tvs.relaybench.frames, cores );
+	if( numrelays && cores > 0 )
+		Com_Printf( "Estimated relays per core: %.1f\n", numrelays / cores );
+}
+
 /*
 * TV_Record_f
 *
@@ -491,6 +589,7 @@ static cmd_function_t cmdlist[] =
 	{ "disconnect", TV_Disconnect_f },
 
 	{ "demo", TV_Demo_f },
+	{ "relaybench", TV_RelayBench_f },
 	{ "record", TV_Record_f },
 	{ "stop", TV_Stop_f },
 
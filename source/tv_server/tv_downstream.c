@@ -27,6 +27,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_downstream_parse.h"
 #include "tv_downstream_oob.h"
 #include "tv_relay_client.h"
+#include "tv_relay_threads.h"
 
 /*
 * TV_Downstream_ClientResetCommandBuffers
@@ -277,8 +278,11 @@ void TV_Downstream_UserinfoChanged( client_t *client )
 	}
 
 	// we handle name ourselves here, since tv module doesn't know about all the players
+	// the name is unique among all clients, which relay threads may be renaming as well
+	TV_RelayThreads_Lock();
 	val = TV_Downstream_FixName( Info_ValueForKey( client->userinfo, "name" ), client );
 	Q_strncpyz( client->name, val, sizeof( client->name ) );
+	TV_RelayThreads_Unlock();
 	if( !Info_SetValueForKey( client->userinfo, "name", client->name ) )
 	{
 		TV_Downstream_DropClient( client, DROP_TYPE_GENERAL, "Error: Couldn't set userinfo (name)" );
@@ -531,7 +535,9 @@ void TV_Downstream_DropClient( client_t *drop, int type, const char *format, ...
 
 	if( drop->mv )
 	{
+		TV_RelayThreads_Lock();
 		tvs.nummvclients--;
+		TV_RelayThreads_Unlock();
 		drop->mv = false;
 	}
 
@@ -134,6 +134,8 @@ void TV_Downstream_New_f( client_t *client )
 	tv_bitflags = SV_BITFLAGS_TVSERVER;
 	if( client->reliable )
 		tv_bitflags |= SV_BITFLAGS_RELIABLE;
+	if( client->compactSnaps )
+		tv_bitflags |= SV_BITFLAGS_COMPACTSNAPS;
 
 	MSG_WriteByte( &message, tv_bitflags ); // sv_bitflags
 
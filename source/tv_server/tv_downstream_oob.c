@@ -274,7 +274,7 @@ static void TV_Downstream_GetStatusResponse( const socket_t *socket, const netad
 * TV_Downstream_ClientConnect
 */
 static bool TV_Downstream_ClientConnect( const socket_t *socket, const netadr_t *address, client_t *client,
-											char *userinfo, int game_port, int challenge, bool tv_client )
+											char *userinfo, int game_port, int challenge, bool tv_client, bool compact_snaps )
 {
 	assert( socket );
 	assert( address );
@@ -296,6 +296,7 @@ static bool TV_Downstream_ClientConnect( const socket_t *socket, const netadr_t
 	// the upstream is accepted, set up the client slot
 	client->challenge = challenge; // save challenge for checksumming
 	client->tv = (tv_client ? true : false);
+	client->compactSnaps = compact_snaps;
 
 	switch( socket->type )
 	{
@@ -353,7 +354,8 @@ static void TV_Downstream_DirectConnect( const socket_t *socket, const netadr_t
 	char userinfo[MAX_INFO_STRING], *name;
 	client_t *cl, *newcl;
 	int i, version, game_port, challenge;
-	bool tv_client;
+	bool tv_client, compact_snaps;
+	int connect_flags;
 
 	version = atoi( Cmd_Argv( 1 ) );
 	if( version != APP_PROTOCOL_VERSION )
@@ -373,7 +375,9 @@ static void TV_Downstream_DirectConnect( const socket_t *socket, const netadr_t
 
 	game_port = atoi( Cmd_Argv( 2 ) );
 	challenge = atoi( Cmd_Argv( 3 ) );
-	tv_client = ( atoi( Cmd_Argv( 5 ) ) & 1 ? true : false );
+	connect_flags = atoi( Cmd_Argv( 5 ) );
+	tv_client = ( connect_flags & CONNECT_FLAG_TVCLIENT ? true : false );
+	compact_snaps = ( connect_flags & CONNECT_FLAG_COMPACTSNAPS ) && tv_compactsnaps->integer ? true : false;
 
 	if( !Info_Validate( Cmd_Argv( 4 ) ) )
 	{
@@ -496,7 +500,7 @@ static void TV_Downstream_DirectConnect( const socket_t *socket, const netadr_t
 	}
 
 	// get the game a chance to reject this upstream or modify the userinfo
-	if( !TV_Downstream_ClientConnect( socket, address, newcl, userinfo, game_port, challenge, tv_client ) )
+	if( !TV_Downstream_ClientConnect( socket, address, newcl, userinfo, game_port, challenge, tv_client, compact_snaps ) )
 	{
 		char *rejtypeflag, *rejmsg;
 
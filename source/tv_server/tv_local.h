@@ -102,6 +102,7 @@ typedef struct
 	int first_entity;                   // into the circular sv_packet_entities[]
 	unsigned int sentTimeStamp;         // time at what this frame snap was sent to the clients
 	unsigned int UcmdExecuted;
+	unsigned int snapId;                // nonzero if frames with the same id have identical contents
 	game_state_t gameState;
 } client_snapshot_t;
 
@@ -189,6 +190,7 @@ typedef struct client_s
 
 	int challenge;                  // challenge of this user, randomly generated
 	bool tv;
+	bool compactSnaps;              // player state coordinates are sent as deltas
 	client_flood_t flood;
 
 	netchan_t netchan;
@@ -231,6 +233,15 @@ typedef struct
 	// relay
 	int numupstreams;
 	upstream_t **upstreams; // maxrelay
+
+	// time spent running the upstreams and relays, see relaybench
+	struct
+	{
+		uint64_t starttime;
+		unsigned int frames;
+		uint64_t relaytime;		// wall time of the whole relay section of the frames
+		uint64_t runtime;		// time spent running upstreams, summed over the relay threads
+	} relaybench;
 } tv_t;
 
 extern mempool_t *tv_mempool;
@@ -249,7 +260,9 @@ extern cvar_t *tv_timeout;
 extern cvar_t *tv_zombietime;
 extern cvar_t *tv_maxclients;
 extern cvar_t *tv_maxmvclients;
+extern cvar_t *tv_relaythreads;
 extern cvar_t *tv_compresspackets;
+extern cvar_t *tv_compactsnaps;
 extern cvar_t *tv_reconnectlimit;
 extern cvar_t *tv_public;
 extern cvar_t *tv_autorecord;
@@ -26,6 +26,7 @@
 #include "tv_cmds.h"
 #include "tv_downstream.h"
 #include "tv_lobby.h"
+#include "tv_relay_threads.h"
 
 tv_t tvs;
 
@@ -52,7 +53,9 @@ cvar_t *tv_zombietime;
 
 cvar_t *tv_maxclients;
 cvar_t *tv_maxmvclients;
+cvar_t *tv_relaythreads;
 cvar_t *tv_compresspackets;
+cvar_t *tv_compactsnaps;
 cvar_t *tv_name;
 cvar_t *tv_reconnectlimit; // minimum seconds between connect messages
 
@@ -102,8 +105,10 @@ void TV_Init( void )
 	tv_zombietime = Cvar_Get( "tv_zombietime", "2", 0 );
 	tv_name = Cvar_Get( "tv_name", APPLICATION "[TV]", CVAR_SERVERINFO | CVAR_ARCHIVE );
 	tv_compresspackets = Cvar_Get( "tv_compresspackets", "1", 0 );
+	tv_compactsnaps = Cvar_Get( "tv_compactsnaps", "0", CVAR_ARCHIVE );
 	tv_maxclients = Cvar_Get( "tv_maxclients", "64", CVAR_ARCHIVE | CVAR_SERVERINFO | CVAR_NOSET );
 	tv_maxmvclients = Cvar_Get( "tv_maxmvclients", "4", CVAR_ARCHIVE | CVAR_SERVERINFO | CVAR_NOSET );
+	tv_relaythreads = Cvar_Get( "tv_relaythreads", "0", CVAR_ARCHIVE | CVAR_NOSET );
 	tv_public = Cvar_Get( "tv_public", "1", CVAR_ARCHIVE | CVAR_SERVERINFO );
 	tv_rcon_password = Cvar_Get( "tv_rcon_password", "", 0 );
 	tv_autorecord = Cvar_Get( "tv_autorecord", "", CVAR_ARCHIVE );
@@ -211,6 +216,8 @@ void TV_Init( void )
 #endif
 
 	TV_Downstream_InitMaster();
+
+	TV_RelayThreads_Init();
 }
 
 /*
@@ -219,23 +226,46 @@ void TV_Init( void )
 void TV_Frame( int realmsec, int gamemsec )
 {
 	int i;
+	uint64_t relaystart, relaytime;
 
 	tvs.realtime += realmsec;
 
 	TV_Lobby_Run();
 
-	for( i = 0; i < tvs.numupstreams; i++ )
+	relaystart = Sys_Microseconds();
+
+	if( TV_RelayThreads_Active() )
 	{
-		if( !tvs.upstreams[i] )
-			continue;
+		for( i = 0; i < tvs.numupstreams; i++ )
+		{
+			if( tvs.upstreams[i] && userinfo_modified )
+				tvs.upstreams[i]->userinfo_modified = true;
+		}
+
+		tvs.relaybench.runtime += TV_RelayThreads_Run( realmsec );
+		relaytime = Sys_Microseconds() - relaystart;
+	}
+	else
+	{
+		for( i = 0; i < tvs.numupstreams; i++ )
+		{
+			if( !tvs.upstreams[i] )
+				continue;
 
-		if( userinfo_modified )
-			tvs.upstreams[i]->userinfo_modified = true;
+			if( userinfo_modified )
+				tvs.upstreams[i]->userinfo_modified = true;
 
-		TV_Upstream_Run( tvs.upstreams[i], realmsec );
+			TV_Upstream_Run( tvs.upstreams[i], realmsec );
+		}
+
+		relaytime = Sys_Microseconds() - relaystart;
+		tvs.relaybench.runtime += relaytime;
 	}
 	userinfo_modified = false;
 
+	tvs.relaybench.frames++;
+	tvs.relaybench.relaytime += relaytime;
+
 	TV_Downstream_ReadPackets();
 	TV_Downstream_SendClientMessages();
 	TV_Downstream_CheckTimeouts();
@@ -268,6 +298,8 @@ void TV_Shutdown( const char *finalmsg )
 	tvs.upstreams = NULL;
 	tvs.numupstreams = 0;
 
+	TV_RelayThreads_Shutdown();
+
 	TV_RemoveCommands();
 }
 
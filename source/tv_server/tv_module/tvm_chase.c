@@ -81,9 +81,6 @@ static int TVM_Chase_FindFollowPOV( edict_t *ent )
 	int newpov = -1;
 	tvm_relay_t *relay = ent->relay;
 	edict_t *target;
-	static int ctfpov = -1, poweruppov = -1;
-	static unsigned int flagswitchTime = 0;
-	static unsigned int pwupswitchTime = 0;
 #define CARRIERSWITCHDELAY 8000
 
 	if( !ent->r.client || !ent->r.client->chase.active || !ent->r.client->chase.followmode )
@@ -116,10 +113,10 @@ static int TVM_Chase_FindFollowPOV( edict_t *ent )
 		if( !TVM_Chase_IsValidTarget( ent, target ) )
 		{
 			// check if old targets are still valid
-			if( ctfpov == ENTNUM( target ) )
-				ctfpov = -1;
-			if( poweruppov == ENTNUM( target ) )
-				poweruppov = -1;
+			if( relay->chase.ctfpov == ENTNUM( target ) )
+				relay->chase.ctfpov = -1;
+			if( relay->chase.poweruppov == ENTNUM( target ) )
+				relay->chase.poweruppov = -1;
 			continue;
 		}
 		if( target->s.team <= 0 || target->s.team >= sizeof( flags ) / sizeof( flags[0] ) )
@@ -167,14 +164,14 @@ static int TVM_Chase_FindFollowPOV( edict_t *ent )
 	if( i < maxteam )
 	{
 		// default to old ctfpov
-		if( ctfpov >= 0 )
-			newctfpov = ctfpov;
-		if( ctfpov < 0 || relay->serverTime > flagswitchTime )
+		if( relay->chase.ctfpov >= 0 )
+			newctfpov = relay->chase.ctfpov;
+		if( relay->chase.ctfpov < 0 || relay->serverTime > relay->chase.flagswitchTime )
 		{
 			// alternate between flag carriers
 			for( i = 0; i < maxteam; i++ )
 			{
-				if( flags[i] != ctfpov )
+				if( flags[i] != relay->chase.ctfpov )
 					continue;
 
 				for( j = 0; j < maxteam-1; j++ )
@@ -189,37 +186,37 @@ static int TVM_Chase_FindFollowPOV( edict_t *ent )
 			}
 		}
 
-		if( newctfpov != ctfpov )
+		if( newctfpov != relay->chase.ctfpov )
 		{
-			ctfpov = newctfpov;
-			flagswitchTime = relay->serverTime + CARRIERSWITCHDELAY;
+			relay->chase.ctfpov = newctfpov;
+			relay->chase.flagswitchTime = relay->serverTime + CARRIERSWITCHDELAY;
 		}
 	}
 	else
 	{
-		ctfpov = newctfpov;
-		flagswitchTime = 0;
+		relay->chase.ctfpov = newctfpov;
+		relay->chase.flagswitchTime = 0;
 	}
 
 	if( quad != -1 && warshell != -1 && quad != warshell )
 	{
 		// default to old powerup
-		if( poweruppov >= 0 )
-			newpoweruppov = poweruppov;
-		if( poweruppov < 0 || relay->serverTime > pwupswitchTime )
+		if( relay->chase.poweruppov >= 0 )
+			newpoweruppov = relay->chase.poweruppov;
+		if( relay->chase.poweruppov < 0 || relay->serverTime > relay->chase.pwupswitchTime )
 		{
-			if( poweruppov == quad )
+			if( relay->chase.poweruppov == quad )
 				newpoweruppov = warshell;
-			else if( poweruppov == warshell )
+			else if( relay->chase.poweruppov == warshell )
 				newpoweruppov = quad;
 			else 
 				newpoweruppov = ( rand() & 1 ) ? quad : warshell;
 		}
 
-		if( poweruppov != newpoweruppov )
+		if( relay->chase.poweruppov != newpoweruppov )
 		{
-			poweruppov = newpoweruppov;
-			pwupswitchTime = relay->serverTime + CARRIERSWITCHDELAY;
+			relay->chase.poweruppov = newpoweruppov;
+			relay->chase.pwupswitchTime = relay->serverTime + CARRIERSWITCHDELAY;
 		}
 	}
 	else
@@ -231,15 +228,15 @@ static int TVM_Chase_FindFollowPOV( edict_t *ent )
 		else if( regen != -1 )
 			newpoweruppov = regen;
 
-		poweruppov = newpoweruppov;
-		pwupswitchTime = 0;
+		relay->chase.poweruppov = newpoweruppov;
+		relay->chase.pwupswitchTime = 0;
 	}
 
 	// so, we got all, select what we prefer to show
-	if( ctfpov != -1 && ( ent->r.client->chase.followmode & 4 ) )
-		newpov = ctfpov;
-	else if( poweruppov != -1 && ( ent->r.client->chase.followmode & 2 ) )
-		newpov = poweruppov;
+	if( relay->chase.ctfpov != -1 && ( ent->r.client->chase.followmode & 4 ) )
+		newpov = relay->chase.ctfpov;
+	else if( relay->chase.poweruppov != -1 && ( ent->r.client->chase.followmode & 2 ) )
+		newpov = relay->chase.poweruppov;
 	else if( scorelead != -1 && ( ent->r.client->chase.followmode & 1 ) )
 		newpov = scorelead;
 
@@ -77,6 +77,14 @@ struct tvm_relay_s
 	{
 		int quad, shell, regen, enemy_flag;
 	} effects;
+
+	// players picked by the chasecam follow modes, shared by all spectators of this relay
+	struct
+	{
+		int ctfpov, poweruppov;
+		unsigned int flagswitchTime;
+		unsigned int pwupswitchTime;
+	} chase;
 };
 
 typedef struct
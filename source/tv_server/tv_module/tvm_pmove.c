@@ -35,8 +35,9 @@ typedef struct
 	float forwardPush, sidePush, upPush;
 } pml_t;
 
-pmove_t	*pm;
-pml_t pml;
+// per thread, relays run their client thinks from TV relay threads
+QF_THREAD_LOCAL pmove_t	*pm;
+QF_THREAD_LOCAL pml_t pml;
 
 vec3_t playerbox_stand_mins = { -16, -16, -24 };
 vec3_t playerbox_stand_maxs = { 16, 16, 40 };
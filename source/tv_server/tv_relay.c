@@ -27,11 +27,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_relay_module.h"
 #include "tv_relay_client.h"
 #include "tv_downstream.h"
-
-#include <setjmp.h>
-
-// for jumping over relay handling when it's disconnected
-jmp_buf relay_abortframe;
+#include "tv_relay_threads.h"
 
 /*
 * TV_Relay_RunSnap
@@ -145,9 +141,11 @@ void TV_Relay_InitMap( relay_t *relay )
 		Q_snprintfz( relay->configstrings[CS_MAPCHECKSUM], sizeof( relay->configstrings[CS_MAPCHECKSUM] ), "%u", relay->map_checksum );
 	}
 
-	// load and spawn all other entities
+	// load and spawn all other entities, the game commands table is shared by all relays
+	TV_RelayThreads_Lock();
 	relay->module_export->SpawnEntities( relay->module, relay->configstrings[CS_WORLDMODEL],
 		CM_EntityString( relay->cms ), CM_EntityStringLen( relay->cms ) );
+	TV_RelayThreads_Unlock();
 
 	TV_Relay_SetAudioTrack( relay, relay->upstream->audiotrack );
 
@@ -172,7 +170,7 @@ void TV_Relay_Error( relay_t *relay, const char *format, ... )
 	va_end( argptr );
 
 	TV_Relay_Shutdown( relay, "%s", msg );
-	longjmp( relay_abortframe, -1 );
+	longjmp( relay->abortframe, -1 );
 }
 
 /*
@@ -195,6 +193,17 @@ void TV_Relay_Shutdown( relay_t *relay, const char *format, ... )
 	Q_vsnprintfz( msg, sizeof( msg ), format, argptr );
 	va_end( argptr );
 
+	// the clients may be moved to other relays, leave it to TV_RelayThreads_Run
+	if( TV_RelayThreads_InWorker() )
+	{
+		if( !relay->shutdownPending )
+		{
+			relay->shutdownPending = true;
+			Q_strncpyz( relay->shutdownReason, msg, sizeof( relay->shutdownReason ) );
+		}
+		return;
+	}
+
 	Com_Printf( "%s" S_COLOR_WHITE ": Relay shutdown: %s\n", relay->upstream->name, msg );
 
 	// send a message to each connected client
@@ -313,6 +322,13 @@ void TV_Relay_NameNotify( relay_t *relay, client_t *client )
 	const char *addr = NET_AddressToString( &relay->upstream->serveraddress );
 	int numplayers = 0, numspecs = 0;
 
+	// the broadcast reaches clients of other relays, TV_RelayThreads_Run sends it
+	if( !client && TV_RelayThreads_InWorker() )
+	{
+		relay->nameNotifyPending = true;
+		return;
+	}
+
 	numplayers = TV_Relay_NumPlayers( relay );
 	numspecs = relay->num_active_specs;
 
@@ -387,10 +403,16 @@ static void TV_Relay_ReadPackets( relay_t *relay )
 */
 void TV_Relay_Run( relay_t *relay, int msec )
 {
+	if( relay->shutdownPending )
+		return;
+
 	relay->realtime += msec;
 
-	if( setjmp( relay_abortframe ) )  // disconnect while running
+	if( setjmp( relay->abortframe ) )  // disconnect while running
+	{
+		TV_RelayThreads_UnlockAll();
 		return;
+	}
 
 	relay->serverTime = relay->realtime + relay->serverTimeDelta;
 
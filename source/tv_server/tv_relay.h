@@ -56,6 +56,18 @@ typedef struct fatvis_s
 	uint8_t phs[MAX_MAP_LEAFS/8];
 } fatvis_t;
 
+#define MAX_RELAY_SNAPGROUPS	64
+
+// downstream clients seeing the world from the same state share one built frame
+typedef struct relay_snapgroup_s
+{
+	client_t *leader;					// client which has the built frame
+	bool mv;
+	edict_t *clent;
+	entity_state_t s;
+	player_state_t ps;
+} relay_snapgroup_t;
+
 typedef struct client_entities_s
 {
 	unsigned num_entities;				// maxclients->integer*UPDATE_BACKUP*MAX_PACKET_ENTITIES
@@ -66,6 +78,10 @@ typedef struct client_entities_s
 struct relay_s
 {
 	connstate_t state;
+	jmp_buf abortframe;         // TV_Relay_Error jumps back to TV_Relay_Run
+	bool shutdownPending;       // asked for from a relay thread, done by the main thread
+	char shutdownReason[1024];
+	bool nameNotifyPending;     // same for TV_Relay_NameNotify to all clients
 
 	upstream_t *upstream;
 
@@ -105,6 +121,22 @@ struct relay_s
 
 	client_entities_t client_entities;
 
+	// snapshot sharing between downstream clients
+	vec3_t skyorigin;
+	int numsnapgroups;
+	relay_snapgroup_t snapgroups[MAX_RELAY_SNAPGROUPS];
+	unsigned int lastSnapId;
+	unsigned int snapsBuilt;
+	unsigned int snapsShared;
+	snap_bodycache_t bodycache;
+	snap_deltacache_t deltacache;
+
+	// received frame sizes, and what their player states take in each snapshot mode
+	unsigned int measuredFrames;
+	size_t measuredFrameBytes;
+	size_t measuredStandardBytes;
+	size_t measuredCompactBytes;
+
 	// serverdata
 	int playernum;
 	int servercount;
@@ -26,26 +26,151 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_downstream.h"
 
 /*
-* TV_Relay_BuildClientFrameSnap
+* TV_Relay_NewSnapId
 */
-void TV_Relay_BuildClientFrameSnap( relay_t *relay, client_t *client )
+static unsigned int TV_Relay_NewSnapId( relay_t *relay )
 {
-	edict_t *clent;
-	entity_state_t backup_state = { 0 };
-	entity_shared_t backup_shared = { 0 };
-	vec_t *skyorg = NULL, origin[3];
+	relay->lastSnapId++;
+	if( !relay->lastSnapId )	// zero is for frames which can't be shared
+		relay->lastSnapId++;
+	return relay->lastSnapId;
+}
+
+/*
+* TV_Relay_SetSkyOrigin
+*
+* Parses the sky portal origin once per frame, instead of once per client
+*/
+static void TV_Relay_SetSkyOrigin( relay_t *relay )
+{
+	relay->fatvis.skyorg = NULL;
 
 	if( relay->configstrings[CS_SKYBOX][0] != '\0' )
 	{
 		int noents = 0;
 		float f1 = 0, f2 = 0;
 
-		if( sscanf( relay->configstrings[CS_SKYBOX], "%f %f %f %f %f %i", &origin[0], &origin[1], &origin[2], &f1, &f2, &noents ) >= 3 )
+		if( sscanf( relay->configstrings[CS_SKYBOX], "%f %f %f %f %f %i", &relay->skyorigin[0], &relay->skyorigin[1], &relay->skyorigin[2], &f1, &f2, &noents ) >= 3 )
 		{
 			if( !noents )
-				skyorg = origin;
+				relay->fatvis.skyorg = relay->skyorigin;		// HACK HACK HACK
 		}
 	}
+}
+
+/*
+* TV_Relay_FindSnapGroup
+*
+* Returns the group of clients which already got a frame built from the same view state
+*/
+static relay_snapgroup_t *TV_Relay_FindSnapGroup( relay_t *relay, client_t *client )
+{
+	int i;
+	edict_t *clent = client->edict;
+	relay_snapgroup_t *group;
+
+	for( i = 0, group = relay->snapgroups; i < relay->numsnapgroups; i++, group++ )
+	{
+		if( group->mv != client->mv || group->clent != clent )
+			continue;
+		if( !clent )
+			return group;
+		if( !clent->r.client )
+			return NULL;
+		if( group->ps.POVnum != clent->r.client->ps.POVnum )
+			continue;
+		if( memcmp( &group->s, &clent->s, sizeof( entity_state_t ) ) )
+			continue;
+		if( memcmp( &group->ps, &clent->r.client->ps, sizeof( player_state_t ) ) )
+			continue;
+		return group;
+	}
+
+	return NULL;
+}
+
+/*
+* TV_Relay_AddSnapGroup
+*/
+static void TV_Relay_AddSnapGroup( relay_t *relay, client_t *client )
+{
+	edict_t *clent = client->edict;
+	relay_snapgroup_t *group;
+
+	if( relay->numsnapgroups >= MAX_RELAY_SNAPGROUPS )
+		return;
+
+	group = &relay->snapgroups[relay->numsnapgroups++];
+	group->leader = client;
+	group->mv = client->mv;
+	group->clent = clent;
+	if( clent )
+	{
+		group->s = clent->s;
+		group->ps = clent->r.client->ps;
+	}
+}
+
+/*
+* TV_Relay_CopyClientFrameSnap
+*
+* Shares the frame built for the group leader. Entities are referenced from the
+* common client_entities buffer, so only the areabits and player states are copied.
+*/
+static void TV_Relay_CopyClientFrameSnap( relay_t *relay, client_t *leader, client_t *client )
+{
+	client_snapshot_t *from, *frame;
+	uint8_t *areabits;
+	player_state_t *ps;
+	int numareas, ps_size;
+
+	from = &leader->snapShots[relay->framenum & UPDATE_MASK];
+	frame = &client->snapShots[relay->framenum & UPDATE_MASK];
+
+	numareas = CM_NumAreas( relay->cms );
+	if( frame->numareas < numareas )
+	{
+		frame->numareas = numareas;
+		if( frame->areabits )
+			Mem_Free( frame->areabits );
+		frame->areabits = ( uint8_t * )Mem_Alloc( tv_mempool, numareas * CM_AreaRowSize( relay->cms ) );
+	}
+
+	if( frame->ps_size < from->numplayers )
+	{
+		if( frame->ps )
+			Mem_Free( frame->ps );
+		frame->ps = ( player_state_t * )Mem_Alloc( tv_mempool, sizeof( player_state_t ) * from->numplayers );
+		frame->ps_size = from->numplayers;
+	}
+
+	// keep our own buffers and everything which is per client
+	areabits = frame->areabits;
+	numareas = frame->numareas;
+	ps = frame->ps;
+	ps_size = frame->ps_size;
+
+	*frame = *from;
+	frame->areabits = areabits;
+	frame->numareas = numareas;
+	frame->ps = ps;
+	frame->ps_size = ps_size;
+	frame->sentTimeStamp = relay->realtime;
+	frame->UcmdExecuted = client->UcmdExecuted;
+
+	memcpy( frame->areabits, from->areabits, from->areabytes );
+	memcpy( frame->ps, from->ps, sizeof( player_state_t ) * from->numplayers );
+}
+
+/*
+* TV_Relay_BuildClientFrameSnap
+*/
+void TV_Relay_BuildClientFrameSnap( relay_t *relay, client_t *client )
+{
+	edict_t *clent;
+	entity_state_t backup_state = { 0 };
+	entity_shared_t backup_shared = { 0 };
+	relay_snapgroup_t *group;
 
 	// pretend client occupies our slot on real server
 	clent = client->edict;
@@ -76,11 +201,28 @@ void TV_Relay_BuildClientFrameSnap( relay_t *relay, client_t *client )
 		}
 	}
 
-	relay->fatvis.skyorg = skyorg;		// HACK HACK HACK
-	SNAP_BuildClientFrameSnap( relay->cms, &relay->gi, relay->framenum, relay->realtime, &relay->fatvis,
-		client, relay->module_export->GetGameState( relay->module ),
-		&relay->client_entities,
-		true, tv_mempool );
+	group = TV_Relay_FindSnapGroup( relay, client );
+	if( group )
+	{
+		TV_Relay_CopyClientFrameSnap( relay, group->leader, client );
+		relay->snapsShared++;
+	}
+	else if( client->edict && !client->edict->r.client )
+	{
+		// not in game yet, nothing gets built
+		client->snapShots[relay->framenum & UPDATE_MASK].snapId = 0;
+	}
+	else
+	{
+		SNAP_BuildClientFrameSnap( relay->cms, &relay->gi, relay->framenum, relay->realtime, &relay->fatvis,
+			client, relay->module_export->GetGameState( relay->module ),
+			&relay->client_entities,
+			true, tv_mempool );
+
+		client->snapShots[relay->framenum & UPDATE_MASK].snapId = TV_Relay_NewSnapId( relay );
+		TV_Relay_AddSnapGroup( relay, client );
+		relay->snapsBuilt++;
+	}
 
 	if( relay->playernum >= 0 )
 	{
@@ -111,9 +253,13 @@ static bool TV_Relay_SendClientDatagram( relay_t *relay, client_t *client )
 	// and the player_state_t
 	TV_Relay_BuildClientFrameSnap( relay, client );
 
+	// the entity in our player slot carries each client's own state, see TV_Relay_BuildClientFrameSnap
+	relay->deltacache.uncachedNum = relay->playernum >= 0 ? relay->playernum + 1 : 0;
+
 	frame = relay->curFrame;
 	SNAP_WriteFrameSnapToClient( &relay->gi, client, &msg, relay->framenum, relay->serverTime, relay->baselines,
-		&relay->client_entities, frame->numgamecommands, frame->gamecommands, frame->gamecommandsData );
+		&relay->client_entities, frame->numgamecommands, frame->gamecommands, frame->gamecommandsData, &relay->bodycache,
+		&relay->deltacache );
 
 	return TV_Downstream_SendMessageToClient( client, &msg );
 }
@@ -163,14 +309,21 @@ void TV_Relay_ReconnectClients( relay_t *relay )
 
 /*
 * TV_Relay_SendClientMessages
+*
+* Only touches the relay and its own clients, so relays can be sent in parallel.
 */
 void TV_Relay_SendClientMessages( relay_t *relay )
 {
 	int i;
 	client_t *client;
+	char error[MAX_PRINTMSG];
 
 	assert( relay );
 
+	// frames are shared between clients watching from the same state during this frame only
+	relay->numsnapgroups = 0;
+	TV_Relay_SetSkyOrigin( relay );
+
 	// send a message to each connected client
 	for( i = 0, client = tvs.clients; i < tv_maxclients->integer; i++, client++ )
 	{
@@ -181,14 +334,15 @@ void TV_Relay_SendClientMessages( relay_t *relay )
 
 		if( !TV_Relay_SendClientDatagram( relay, client ) )
 		{
-			Com_Printf( "%s" S_COLOR_WHITE ": Error sending message: %s\n", client->name, NET_ErrorString() );
+			// the error string belongs to the thread which failed the send
+			Q_strncpyz( error, NET_ErrorString(), sizeof( error ) );
+			Com_Printf( "%s" S_COLOR_WHITE ": Error sending message: %s\n", client->name, error );
 			if( client->reliable )
-			{
-				TV_Downstream_DropClient( client, DROP_TYPE_GENERAL, "Error sending message: %s\n",
-					NET_ErrorString() );
-			}
+				TV_Downstream_DropClient( client, DROP_TYPE_GENERAL, "Error sending message: %s\n", error );
 		}
 	}
+
+	relay->fatvis.skyorg = NULL;
 }
 
 /*
@@ -25,6 +25,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_upstream.h"
 #include "tv_relay.h"
 #include "tv_downstream.h"
+#include "tv_relay_threads.h"
 
 typedef struct tv_module_s tv_module_t;
 
@@ -634,10 +635,14 @@ void TV_Relay_ShutdownModule( relay_t *relay )
 	if( !relay->module_export )
 		return;
 
+	TV_RelayThreads_Lock();
+
 	TV_Relay_FreeModule( relay );
 
 	TV_ReleaseModule( relay->game );
 
+	TV_RelayThreads_Unlock();
+
 	// update upstream name for upstream
 	TV_Relay_UpstreamUserinfoChanged( relay );
 }
@@ -651,6 +656,9 @@ void TV_Relay_InitModule( relay_t *relay )
 {
 	tv_module_t *module;
 
+	// the module list and the module's own init (cvars, commands) are shared by all relays
+	TV_RelayThreads_Lock();
+
 	if( relay->module )
 		TV_Relay_FreeModule( relay );
 
@@ -662,6 +670,8 @@ void TV_Relay_InitModule( relay_t *relay )
 	relay->module_mempool = _Mem_AllocPool( relay->upstream->mempool, va( "TV Module Progs" ), MEMPOOL_GAMEPROGS, __FILE__, __LINE__ );
 	relay->module = relay->module_export->InitRelay( relay, relay->snapFrameTime, relay->playernum );
 
+	TV_RelayThreads_Unlock();
+
 	Mem_DebugCheckSentinelsGlobal( );
 
 	// update upstream name for upstream
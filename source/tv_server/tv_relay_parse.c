@@ -27,15 +27,20 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_relay_svcmd.h"
 #include "tv_relay_client.h"
 #include "tv_downstream_clcmd.h"
+#include "tv_relay_threads.h"
 
 /*
 * TV_Relay_ParseFrame
 */
 static void TV_Relay_ParseFrame( relay_t *relay, msg_t *msg )
 {
+	int i;
+	size_t start;
 	snapshot_t *snap;
 
-	snap = SNAP_ParseFrame( msg, relay->lastFrame, NULL, relay->frames, relay->baselines, 0 );
+	start = msg->readcount;
+	snap = SNAP_ParseFrame( msg, relay->lastFrame, NULL, relay->frames, relay->baselines, 0,
+		( relay->sv_bitflags & SV_BITFLAGS_COMPACTSNAPS ) != 0 );
 
 	// ignore older than already received
 	if( relay->lastFrame && snap->serverFrame <= relay->lastFrame->serverFrame )
@@ -53,6 +58,16 @@ static void TV_Relay_ParseFrame( relay_t *relay, msg_t *msg )
 		return;
 	}
 
+	// player states re-encoded against the previous frame in both modes, entity deltas
+	// are the same in either, so this shows what compact snaps save on real traffic (demos)
+	relay->measuredFrames++;
+	relay->measuredFrameBytes += msg->readcount - start;
+	for( i = 0; i < snap->numplayers; i++ )
+	{
+		SNAP_MeasurePlayerstateDelta( relay->lastFrame && relay->lastFrame->numplayers > i ? &relay->lastFrame->playerStates[i] : NULL,
+			&snap->playerStates[i], &relay->measuredStandardBytes, &relay->measuredCompactBytes );
+	}
+
 	relay->serverTimeDelta = (snap->serverTime - relay->realtime);
 	relay->serverTime = relay->realtime + relay->serverTimeDelta;
 
@@ -214,7 +229,8 @@ void TV_Relay_ParseServerMessage( relay_t *relay, msg_t *msg )
 
 			if( relay->state == CA_HANDSHAKE )
 			{
-				Cbuf_Execute(); // make sure any stuffed commands are done
+				if( !TV_RelayThreads_InWorker() )
+					Cbuf_Execute(); // make sure any stuffed commands are done
 				TV_Relay_ParseServerData( relay, msg );
 			}
 			else
@@ -0,0 +1,337 @@
+/*
+Copyright (C) 1997-2001 Id Software, Inc.
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+*/
+
+#include "tv_local.h"
+
+#include "tv_relay_threads.h"
+
+#include "tv_upstream.h"
+#include "tv_relay.h"
+
+// Upstreams and their relays are run by worker threads: reading and parsing the
+// upstream packets, the module frame and sending the snapshots to the downstream
+// clients. An upstream is always handled by the same thread, which is the only one
+// touching the upstream, its relay, cmodel state, module relay and clients.
+// What's shared with other relays (the module list, the module globals set up
+// on spawn, demo lists, client counters) is serialized with TV_RelayThreads_Lock.
+// Shutting relays and upstreams down and notifying all clients of relay changes
+// touch other relays' clients and the upstream list, so they are left to the main
+// thread once the workers are done.
+//
+// The isolation is partial. Downstream packets arrive on the shared sockets and
+// are read and dispatched from the main thread. The main thread also waits for
+// every worker each frame, since downstream handling relies on no worker running.
+// So a busy upstream no longer delays relays on other threads within a frame,
+// but it still delays the next frame for all of them.
+
+#define MAX_RELAY_THREADS	32
+
+typedef struct
+{
+	qthread_t *thread;
+	qmutex_t *mutex;
+	qcondvar_t *wakeCond;
+	qcondvar_t *doneCond;
+
+	upstream_t **upstreams;
+	int numupstreams;
+	int maxupstreams;
+	int msec;
+
+	uint64_t runtime;			// microseconds spent running upstreams, for relaybench
+
+	bool busy;
+	bool quit;
+} tv_relaythread_t;
+
+static int numrelaythreads;
+static tv_relaythread_t relaythreads[MAX_RELAY_THREADS];
+static qmutex_t *relaythreads_lock;
+
+static QF_THREAD_LOCAL bool relaythread_worker;
+static QF_THREAD_LOCAL int relaythread_lockdepth;
+
+/*
+* TV_RelayThread_RunUpstream
+*/
+static void TV_RelayThread_RunUpstream( upstream_t *upstream, int msec )
+{
+	jmp_buf abortframe;
+
+	// an ERR_DROP raised by this upstream only takes it down
+	if( setjmp( abortframe ) )
+	{
+		Com_SetThreadAbortFrame( NULL );
+		TV_RelayThreads_UnlockAll();
+		TV_Relay_Shutdown( &upstream->relay, "Server crashed: %s", Com_ErrorMessage() );
+		return;
+	}
+
+	Com_SetThreadAbortFrame( &abortframe );
+	TV_Upstream_Run( upstream, msec );
+	Com_SetThreadAbortFrame( NULL );
+}
+
+/*
+* TV_RelayThread_Proc
+*/
+static void *TV_RelayThread_Proc( void *param )
+{
+	int i;
+	uint64_t start;
+	tv_relaythread_t *thread = param;
+
+	relaythread_worker = true;
+
+	QMutex_Lock( thread->mutex );
+
+	while( true )
+	{
+		while( !thread->busy && !thread->quit )
+			QCondVar_Wait( thread->wakeCond, thread->mutex, Q_THREADS_WAIT_INFINITE );
+
+		if( thread->quit )
+			break;
+
+		QMutex_Unlock( thread->mutex );
+
+		for( i = 0; i < thread->numupstreams; i++ )
+		{
+			start = Sys_Microseconds();
+			TV_RelayThread_RunUpstream( thread->upstreams[i], thread->msec );
+			thread->runtime += Sys_Microseconds() - start;
+		}
+
+		QMutex_Lock( thread->mutex );
+
+		thread->busy = false;
+		QCondVar_Wake( thread->doneCond );
+	}
+
+	QMutex_Unlock( thread->mutex );
+
+	return NULL;
+}
+
+/*
+* TV_RelayThreads_Init
+*/
+void TV_RelayThreads_Init( void )
+{
+	int i;
+	tv_relaythread_t *thread;
+
+	numrelaythreads = bound( 0, tv_relaythreads->integer, MAX_RELAY_THREADS );
+	if( !numrelaythreads )
+		return;
+
+	Com_Printf( "Starting %i relay threads\n", numrelaythreads );
+
+	relaythreads_lock = QMutex_Create();
+
+	for( i = 0, thread = relaythreads; i < numrelaythreads; i++, thread++ )
+	{
+		memset( thread, 0, sizeof( *thread ) );
+		thread->mutex = QMutex_Create();
+		thread->wakeCond = QCondVar_Create();
+		thread->doneCond = QCondVar_Create();
+		thread->thread = QThread_Create( TV_RelayThread_Proc, thread );
+	}
+}
+
+/*
+* TV_RelayThreads_Shutdown
+*/
+void TV_RelayThreads_Shutdown( void )
+{
+	int i;
+	tv_relaythread_t *thread;
+
+	for( i = 0, thread = relaythreads; i < numrelaythreads; i++, thread++ )
+	{
+		QMutex_Lock( thread->mutex );
+		thread->quit = true;
+		QCondVar_Wake( thread->wakeCond );
+		QMutex_Unlock( thread->mutex );
+
+		QThread_Join( thread->thread );
+
+		QCondVar_Destroy( &thread->doneCond );
+		QCondVar_Destroy( &thread->wakeCond );
+		QMutex_Destroy( &thread->mutex );
+
+		if( thread->upstreams )
+			Mem_Free( thread->upstreams );
+		memset( thread, 0, sizeof( *thread ) );
+	}
+
+	if( relaythreads_lock )
+		QMutex_Destroy( &relaythreads_lock );
+
+	numrelaythreads = 0;
+}
+
+/*
+* TV_RelayThreads_Active
+*/
+bool TV_RelayThreads_Active( void )
+{
+	return numrelaythreads > 0;
+}
+
+/*
+* TV_RelayThreads_InWorker
+*/
+bool TV_RelayThreads_InWorker( void )
+{
+	return relaythread_worker;
+}
+
+/*
+* TV_RelayThreads_Lock
+* 
+* Serializes the relay threads around state shared between relays.
+* The main thread only runs relays while the workers sleep, so it doesn't need it.
+*/
+void TV_RelayThreads_Lock( void )
+{
+	if( !relaythread_worker )
+		return;
+
+	QMutex_Lock( relaythreads_lock );
+	relaythread_lockdepth++;
+}
+
+/*
+* TV_RelayThreads_Unlock
+*/
+void TV_RelayThreads_Unlock( void )
+{
+	if( !relaythread_worker )
+		return;
+
+	assert( relaythread_lockdepth > 0 );
+	relaythread_lockdepth--;
+	QMutex_Unlock( relaythreads_lock );
+}
+
+/*
+* TV_RelayThreads_UnlockAll
+* 
+* Releases the lock after an error longjmp'd out of a locked section
+*/
+void TV_RelayThreads_UnlockAll( void )
+{
+	while( relaythread_lockdepth > 0 )
+		TV_RelayThreads_Unlock();
+}
+
+/*
+* TV_RelayThreads_Run
+*
+* Runs all upstreams and their relays on the relay threads and waits for them,
+* then does what they left to the main thread.
+* Returns the time the relay threads spent running them, in microseconds.
+*/
+uint64_t TV_RelayThreads_Run( int msec )
+{
+	int i;
+	uint64_t runtime;
+	upstream_t *upstream;
+	tv_relaythread_t *thread;
+
+	assert( numrelaythreads );
+
+	for( i = 0, thread = relaythreads; i < numrelaythreads; i++, thread++ )
+	{
+		thread->numupstreams = 0;
+		thread->msec = msec;
+		thread->runtime = 0;
+	}
+
+	// upstream slots don't move, so each relay sticks to the same thread
+	for( i = 0; i < tvs.numupstreams; i++ )
+	{
+		upstream = tvs.upstreams[i];
+		if( !upstream )
+			continue;
+
+		thread = &relaythreads[i % numrelaythreads];
+		if( thread->numupstreams == thread->maxupstreams )
+		{
+			thread->maxupstreams = thread->maxupstreams ? thread->maxupstreams * 2 : 8;
+			if( thread->upstreams )
+				thread->upstreams = Mem_Realloc( thread->upstreams, sizeof( upstream_t * ) * thread->maxupstreams );
+			else
+				thread->upstreams = Mem_Alloc( tv_mempool, sizeof( upstream_t * ) * thread->maxupstreams );
+		}
+		thread->upstreams[thread->numupstreams++] = upstream;
+	}
+
+	for( i = 0, thread = relaythreads; i < numrelaythreads; i++, thread++ )
+	{
+		if( !thread->numupstreams )
+			continue;
+
+		QMutex_Lock( thread->mutex );
+		thread->busy = true;
+		QCondVar_Wake( thread->wakeCond );
+		QMutex_Unlock( thread->mutex );
+	}
+
+	runtime = 0;
+	for( i = 0, thread = relaythreads; i < numrelaythreads; i++, thread++ )
+	{
+		if( !thread->numupstreams )
+			continue;
+
+		QMutex_Lock( thread->mutex );
+		while( thread->busy )
+			QCondVar_Wait( thread->doneCond, thread->mutex, Q_THREADS_WAIT_INFINITE );
+		QMutex_Unlock( thread->mutex );
+
+		runtime += thread->runtime;
+	}
+
+	for( i = 0; i < tvs.numupstreams; i++ )
+	{
+		upstream = tvs.upstreams[i];
+		if( !upstream )
+			continue;
+
+		if( upstream->relay.nameNotifyPending )
+		{
+			upstream->relay.nameNotifyPending = false;
+			if( !upstream->relay.shutdownPending )
+				TV_Relay_NameNotify( &upstream->relay, NULL );
+		}
+
+		if( upstream->relay.shutdownPending )
+		{
+			upstream->relay.shutdownPending = false;
+			TV_Relay_Shutdown( &upstream->relay, "%s", upstream->relay.shutdownReason );
+		}
+
+		if( upstream->relay.state == CA_UNINITIALIZED )
+			TV_Upstream_Shutdown( upstream, "Relay was shutdown" );
+	}
+
+	return runtime;
+}
@@ -26,11 +26,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_upstream_parse.h"
 #include "tv_upstream_demos.h"
 #include "tv_downstream.h"
-
-#include <setjmp.h>
-
-// for jumping over upstream handling when it's disconnected
-jmp_buf upstream_abortframe;
+#include "tv_relay_threads.h"
 
 /*
 * TV_UpstreamForText
@@ -433,8 +429,8 @@ static void TV_Upstream_FreePackets( upstream_t *upstream )
 */
 static void TV_Upstream_ReadDemoMessage( upstream_t *upstream, int timeBias )
 {
-	static uint8_t msgbuf[MAX_MSGLEN];
-	static msg_t demomsg;
+	static QF_THREAD_LOCAL uint8_t msgbuf[MAX_MSGLEN];
+	static QF_THREAD_LOCAL msg_t demomsg;
 	bool init = true;
 	int read;
 
@@ -586,10 +582,16 @@ static void TV_Upstream_ReadPackets( upstream_t *upstream )
 */
 void TV_Upstream_SendConnectPacket( upstream_t *upstream )
 {
+	int flags;
+
 	upstream->userinfo_modified = false;
 
+	flags = CONNECT_FLAG_TVCLIENT;
+	if( tv_compactsnaps->integer )
+		flags |= CONNECT_FLAG_COMPACTSNAPS;
+
 	Netchan_OutOfBandPrint( upstream->socket, &upstream->serveraddress, "connect %i %i %i \"%s\" %i\n",
-		APP_PROTOCOL_VERSION, Netchan_GamePort(), upstream->challenge, TV_Upstream_Userinfo( upstream ), 1 );
+		APP_PROTOCOL_VERSION, Netchan_GamePort(), upstream->challenge, TV_Upstream_Userinfo( upstream ), flags );
 }
 
 /*
@@ -609,7 +611,7 @@ void TV_Upstream_Error( upstream_t *upstream, const char *format, ... )
 	va_end( argptr );
 
 	TV_Upstream_Disconnect( upstream, "%s", msg );
-	longjmp( upstream_abortframe, -1 );
+	longjmp( upstream->abortframe, -1 );
 }
 
 /*
@@ -798,8 +800,11 @@ void TV_Upstream_UpdateReliableCommandsToServer( upstream_t *upstream, msg_t *ms
 */
 void TV_Upstream_Run( upstream_t *upstream, int msec )
 {
-	if( setjmp( upstream_abortframe ) )  // disconnect while running
+	if( setjmp( upstream->abortframe ) )  // disconnect while running
+	{
+		TV_RelayThreads_UnlockAll();
 		return;
+	}
 
 	if( upstream->state > CA_DISCONNECTED )
 	{
@@ -835,7 +840,8 @@ void TV_Upstream_Run( upstream_t *upstream, int msec )
 		TV_Upstream_FreePackets( upstream );
 	}
 
-	if( upstream->relay.state == CA_UNINITIALIZED )
+	// relay threads leave it to TV_RelayThreads_Run
+	if( upstream->relay.state == CA_UNINITIALIZED && !TV_RelayThreads_InWorker() )
 		TV_Upstream_Shutdown( upstream, "Relay was shutdown" );
 }
 
@@ -869,9 +875,14 @@ void TV_Upstream_SetName( upstream_t *upstream, const char *name )
 	{
 		if( !strcmp( upstream->name, name ) )
 			return;
-		Mem_Free( upstream->name );
 	}
+
+	// other relay threads may be looking the upstream up by name
+	TV_RelayThreads_Lock();
+	if( upstream->name )
+		Mem_Free( upstream->name );
 	upstream->name = TV_Upstream_CopyString( upstream, name );
+	TV_RelayThreads_Unlock();
 
 	if( upstream->relay.state != CA_UNINITIALIZED )
 		TV_Relay_NameNotify( &upstream->relay, NULL );
@@ -21,6 +21,7 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_local.h"
 #include "tv_upstream.h"
 #include "tv_upstream_demos.h"
+#include "tv_relay_threads.h"
 
 #define TV_Upstream_SetDemoMetaKeyValue(u,k,v) (u)->demo.meta_data_realsize = SNAP_SetDemoMetaKeyValue((u)->demo.meta_data, sizeof((u)->demo.meta_data), (u)->demo.meta_data_realsize, k, v)
 
@@ -52,6 +53,9 @@ bool TV_Upstream_IsAutoRecordable( upstream_t *upstream )
 	// search for the given upstream in record list (semicolon separated)
 	s = TempCopyString( tv_autorecord->string );
 
+	// neither strtok nor TV_UpstreamForText are reentrant
+	TV_RelayThreads_Lock();
+
 	t = strtok( s, seps );
 	while( t != NULL )
 	{
@@ -65,6 +69,8 @@ bool TV_Upstream_IsAutoRecordable( upstream_t *upstream )
 		t = strtok( NULL, seps );
 	}
 
+	TV_RelayThreads_Unlock();
+
 	Mem_TempFree( s );
 	if( match )
 		return true;
@@ -85,10 +91,12 @@ static const char *TV_Upstream_AutoRecordName( upstream_t *upstream, char *name,
 
 	// date & time
 	time( &long_time );
+	TV_RelayThreads_Lock();
 	newtime = localtime( &long_time );
 
 	Q_snprintfz( datetime, sizeof( datetime ), "%04d-%02d-%02d_%02d-%02d", newtime->tm_year + 1900,
 		newtime->tm_mon+1, newtime->tm_mday, newtime->tm_hour, newtime->tm_min );
+	TV_RelayThreads_Unlock();
 
 	Q_strncpyz( matchname, upstream->configstrings[CS_MATCHNAME], sizeof( matchname ) );
 	if( matchname[0] != '\0')
@@ -526,7 +534,10 @@ void TV_Upstream_StartDemo( upstream_t *upstream, const char *demoname, bool ran
 	tempdemofilehandle = 0;
 	tempdemofilelen = -1;
 
+	// the demo list is parsed with strtok and picked with rand
+	TV_RelayThreads_Lock();
 	TV_Upstream_NextDemo( demoname, upstream->demo.filename, randomize, &name, &filepath );
+	TV_RelayThreads_Unlock();
 
 	if( filepath )
 	{
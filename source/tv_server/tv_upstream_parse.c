@@ -26,13 +26,14 @@ Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
 #include "tv_upstream_svcmd.h"
 #include "tv_upstream_demos.h"
 #include "tv_downstream_clcmd.h"
+#include "tv_relay_threads.h"
 
 /*
 * TV_Upstream_ParseFrame
 */
 static void TV_Upstream_ParseFrame( upstream_t *upstream, msg_t *msg )
 {
-	static snapshot_t snap;
+	static QF_THREAD_LOCAL snapshot_t snap;
 
 	SNAP_SkipFrame( msg, &snap );
 
@@ -49,7 +50,8 @@ static void TV_Upstream_ParseFrame( upstream_t *upstream, msg_t *msg )
 
 			// write out messages to hold the startup information
 			SNAP_BeginDemoRecording( upstream->demo.filehandle, 0x10000 + upstream->servercount, 
-				upstream->snapFrameTime, upstream->levelname, upstream->reliable ? SV_BITFLAGS_RELIABLE : 0, 
+				upstream->snapFrameTime, upstream->levelname, 
+				( upstream->reliable ? SV_BITFLAGS_RELIABLE : 0 ) | ( upstream->sv_bitflags & SV_BITFLAGS_COMPACTSNAPS ), 
 				upstream->purelist, upstream->configstrings[0], upstream->baselines );
 		}
 
@@ -187,7 +189,8 @@ void TV_Upstream_ParseServerMessage( upstream_t *upstream, msg_t *msg )
 		case svc_serverdata:
 			if( upstream->state == CA_HANDSHAKE )
 			{
-				Cbuf_Execute(); // make sure any stuffed commands are done
+				if( !TV_RelayThreads_InWorker() )
+					Cbuf_Execute(); // make sure any stuffed commands are done
 
 				FS_Rescan();	// FIXME?
 
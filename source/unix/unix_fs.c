@@ -495,7 +495,7 @@ void *Sys_FS_MMapFile( int fileno, size_t size, size_t offset, void **mapping, s
 	offsetpad = offset - (offset & offsetmask);
 
 	void *data = mmap( NULL, size + offsetpad, PROT_READ, MAP_PRIVATE, fileno, offset - offsetpad );
-	if( !data )
+	if( !data || data == MAP_FAILED )
 		return NULL;
 
 	*mapping = (void *)1;